@@ -11,7 +11,9 @@
 #include <cesk/cesk_frame.h>
 #include <cesk/cesk_block.h>
 #include <cesk/cesk_addr_arithmetic.h>
+#include <cesk/cesk_domain.h>
 #include <cesk/cesk_reloc.h>
+#include <cesk/cesk_method.h>
 
 /**
  * @file cesk.h
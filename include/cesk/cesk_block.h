@@ -10,16 +10,41 @@
  * empty. For each iteration, we analysis the code blocks and 
  * if all frame remains unchanged after one iteration, 
  * We find a fix point. Then we return the result
+ *
+ * The iteration is driven by a worklist (see cesk_block_graph_fixpoint),
+ * so only the blocks whose input is changed are analyzed again.
  */
 #include <constants.h>
 #include <dalvik/dalvik_block.h>
 #include <dalvik/dalvik_instruction.h>
 #include <cesk/cesk_frame.h>
 
+/**
+ * @brief the pre-decoded form of an instruction, the operands are lowered
+ *        to register indices and constant addresses when the block graph
+ *        is built, so the interpreter does not decode the operands again
+ *        in each iteration
+ **/
+typedef struct {
+	uint8_t                     opcode;    /*!<the opcode of the instruction */
+	uint8_t                     flags;     /*!<the flags of the instruction */
+	uint8_t                     konst;     /*!<bit i is set if args[i] is a constant address rather than a register index, see CESK_BLOCK_CODE_REAL for bit 7 */
+	uint8_t                     handler;   /*!<the handler of the instruction, selected by the opcode and flags */
+	uint32_t                    args[3];   /*!<the register indices or constant addresses */
+	const dalvik_instruction_t* inst;      /*!<the verbose form, used for diagnostics and the allocation site */
+} cesk_block_code_t;
+
+/** @brief the argument is a constant address */
+#define CESK_BLOCK_CODE_IS_CONST(code, i) (((code)->konst >> (i)) & 1)
+
+/** @brief the bit in konst indicates the operands are real numbers, which are only abstracted by the sign lattice */
+#define CESK_BLOCK_CODE_REAL 0x80
+
 typedef struct _cesk_block_t cesk_block_t;
 /** @brief data type for a block in block graph */
 struct _cesk_block_t{
     const dalvik_block_t* code_block;      /*!<the code block */
+    cesk_block_code_t*    code;            /*!<the pre-decoded instructions, code_block->end - code_block->begin entries */
     cesk_frame_t*   input;      /*!<input frame */
     cesk_block_t*   fanout[0];  /*!<output blocks, contains block->nbranches possible branch */
 };
@@ -42,4 +67,32 @@ void cesk_block_graph_free(cesk_block_t* graph);
  */
 cesk_frame_t* cesk_block_interpret(cesk_block_t* block);
 
+/** @brief the dispatch modes of the block interpreter */
+enum {
+	CESK_BLOCK_DISPATCH_SWITCH,    /*!<dispatch the instructions with a switch statement */
+	CESK_BLOCK_DISPATCH_THREADED   /*!<jump to the next handler directly with computed goto */
+};
+
+/** @brief set the dispatch mode of the block interpreter
+ *  @param mode the dispatch mode, the threaded mode falls back to the switch mode
+ *              if the compiler does not support computed goto
+ *  @return nothing
+ */
+void cesk_block_set_dispatch(int mode);
+
+/** @brief get the dispatch mode of the block interpreter
+ *  @return the dispatch mode
+ */
+int cesk_block_get_dispatch();
+
+/** @brief find the fixpoint of a block graph with a worklist
+ *  @details the blocks are visited in reverse post-order, the output of a block is
+ *  	     merged to the input frame of all its successors, and a successor is put
+ *  	     back to the worklist only if its input frame is changed by the merge.
+ *  	     After the function returns, the input frame of each block is the fixpoint
+ *  @param graph the entry of the block graph
+ *  @return the number of blocks that have been interpreted, < 0 indicates error
+ */
+int cesk_block_graph_fixpoint(cesk_block_t* graph);
+
 #endif
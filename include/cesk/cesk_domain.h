@@ -0,0 +1,109 @@
+#ifndef __CESK_DOMAIN_H__
+#define __CESK_DOMAIN_H__
+/** @file cesk_domain.h
+ *  @brief the abstract domains of numeric values
+ *
+ *  @details
+ *  A numeric value is abstracted to a constant address (see cesk_store.h),
+ *  the 24-bit suffix of the address is the abstract value:
+ *
+ *  bit 0 - 2 : the sign mask {NEG, ZERO, POS}, which is always a sound
+ *              abstraction of the value, so the code only aware of the sign
+ *              lattice (e.g. cesk_addr_arithmetic.h) works with any domain
+ *
+ *  bit 23    : CESK_DOMAIN_REFINED, the value is further refined by bit 3 - 22,
+ *              the meaning of the refinement depends on the domain
+ *
+ *  A refined value always means the intersection of the sign mask and the
+ *  refinement, and if the refinement does not exclude any value of the sign
+ *  mask, it's dropped. So the same value always has the same address, and
+ *  the constant 0 is always CESK_STORE_ADDR_ZERO.
+ *
+ *  The domain is pluggable, the analyzer calls the operations of the current
+ *  domain, which should be selected before any block graph is built:
+ *
+ *  1. CESK_DOMAIN_SIGN: only the sign mask, this is the default
+ *
+ *  2. CESK_DOMAIN_CONSTSET: the set of small constants, bit i + 3 is set if
+ *     CESK_DOMAIN_CONSTSET_MIN + i is a possible value
+ *
+ *  3. CESK_DOMAIN_INTERVAL: an interval, bit 3 - 12 is the lower bound and
+ *     bit 13 - 22 is the upper bound, each one is biased by 512, and 0/1023
+ *     means -inf/+inf. A bound beyond CESK_DOMAIN_INTERVAL_LIMIT is widened,
+ *     so that the loop counters converge in a few iterations
+ */
+#include <constants.h>
+#include <cesk/cesk_store.h>
+#include <cesk/cesk_addr_arithmetic.h>
+
+#if (CESK_STORE_ADDR_CONST_PREFIX & 0xfffffful) != 0
+#	error "the numeric domains require a 24-bit suffix of the constant address"
+#endif
+
+/** @brief the numeric domains */
+enum {
+	CESK_DOMAIN_SIGN,       /*!<the sign lattice */
+	CESK_DOMAIN_CONSTSET,   /*!<the set of small constants */
+	CESK_DOMAIN_INTERVAL,   /*!<the interval */
+	CESK_DOMAIN_NUM_DOMAINS
+};
+
+/** @brief the possible results of a comparison */
+enum {
+	CESK_DOMAIN_LT = 1,   /*!<a < b is possible */
+	CESK_DOMAIN_EQ = 2,   /*!<a == b is possible */
+	CESK_DOMAIN_GT = 4    /*!<a > b is possible */
+};
+
+/** @brief the bits of the sign mask in the suffix */
+#define CESK_DOMAIN_SIGN_BITS 0x7ul
+/** @brief the value is refined by the domain */
+#define CESK_DOMAIN_REFINED 0x800000ul
+/** @brief the bits of the refinement in the suffix */
+#define CESK_DOMAIN_REFINE_BITS 0x7ffff8ul
+
+/** @brief the interface of a numeric domain, all values are constant addresses */
+typedef struct {
+	const char* name;                                       /*!<the name of the domain */
+	uint32_t (*from_int)(int64_t value);                    /*!<the abstract value of an integer */
+	uint32_t (*join)(uint32_t a, uint32_t b);               /*!<the least upper bound of a and b */
+	uint32_t (*unop)(int op, uint32_t a);                   /*!<an unary operator, see cesk_addr_arithmetic.h */
+	uint32_t (*binop)(int op, uint32_t a, uint32_t b);      /*!<a binary operator, see cesk_addr_arithmetic.h */
+	int      (*compare)(uint32_t a, uint32_t b);            /*!<the possible results of comparing a to b, see CESK_DOMAIN_LT */
+} cesk_domain_t;
+
+/** @brief the sign lattice */
+extern const cesk_domain_t cesk_domain_sign;
+/** @brief the small constant set domain */
+extern const cesk_domain_t cesk_domain_constset;
+/** @brief the interval domain */
+extern const cesk_domain_t cesk_domain_interval;
+
+/** @brief select the default numeric domain (CESK_DOMAIN_DEFAULT)
+ *  @return nothing
+ */
+void cesk_domain_init(void);
+
+/** @brief select the numeric domain, it should be called before any block graph is built
+ *  @param domain the domain, CESK_DOMAIN_SIGN, CESK_DOMAIN_CONSTSET or CESK_DOMAIN_INTERVAL
+ *  @return < 0 indicates an error
+ */
+int cesk_domain_set(int domain);
+
+/** @brief get the current numeric domain
+ *  @return the domain
+ */
+const cesk_domain_t* cesk_domain_get(void);
+
+/** @brief check if the address is a refined numeric value */
+#define CESK_DOMAIN_IS_REFINED(addr) (CESK_STORE_ADDR_IS_CONST(addr) && CESK_STORE_ADDR_NULL != (addr) && ((addr) & CESK_DOMAIN_REFINED))
+
+/** @brief drop the refinement, returns the sign of the value
+ *  @param addr the value
+ *  @return the sign address
+ */
+static inline uint32_t cesk_domain_sign_of(uint32_t addr)
+{
+	return CESK_STORE_ADDR_CONST_PREFIX | CESK_ADDR_ARITHMETIC_MASK(addr);
+}
+#endif
@@ -62,12 +62,40 @@ void cesk_frame_free(cesk_frame_t* frame);
  */
 int cesk_frame_equal(const cesk_frame_t* first, const cesk_frame_t* second);
 
-/** @brief run garbage collector on a frame 
+/** @brief the statistics of the garbage collector */
+typedef struct {
+	uint64_t minor;         /*!<the number of incremental collections */
+	uint64_t major;         /*!<the number of full collections */
+	uint64_t visited;       /*!<the number of objects traced */
+	uint64_t reclaimed;     /*!<the number of objects swiped out */
+	uint64_t pause_ns;      /*!<the total time spent in the collector, in nanoseconds */
+	uint64_t max_pause_ns;  /*!<the longest collection, in nanoseconds */
+} cesk_frame_gc_stat_t;
+
+/** @brief run garbage collector on a frame, it only traces the objects reachable from the remembered set 
+ *         of the store, and it runs a full collection if the remembered set overflowed
  * @param frame
  * @return >=0 means success
  */
 int cesk_frame_gc(cesk_frame_t* frame);
 
+/** @brief run full garbage collector on a frame, all objects unreachable from the registers are swiped out
+ *  @param frame
+ *  @return >=0 means success
+ */
+int cesk_frame_gc_full(cesk_frame_t* frame);
+
+/** @brief get the statistics of the garbage collector since the program starts or the last reset
+ *  @param stat the buffer for the statistics
+ *  @return nothing
+ */
+void cesk_frame_gc_get_stat(cesk_frame_gc_stat_t* stat);
+
+/** @brief reset the statistics of the garbage collector
+ *  @return nothing
+ */
+void cesk_frame_gc_reset_stat();
+
 /** @brief the hash fucntion of this frame 
  *  @param frame
  *  @return the hash code of the frame
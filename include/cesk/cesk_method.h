@@ -0,0 +1,56 @@
+#ifndef __CESK_METHOD_H__
+#define __CESK_METHOD_H__
+/** @file cesk_method.h
+ *  @brief the method analyzer
+ *
+ *  @details the analysis of a method is independent to other methods,
+ *  so we can analyze a large number of methods with a group of worker
+ *  threads.
+ *
+ *  Each worker owns a range of methods, and when a worker finishes its
+ *  range, it steals half of the remaining methods from other workers.
+ *  The result of each method is saved in its task, so the result does
+ *  not depend on which thread analyzes the method, and it is the same
+ *  as the serial analyzer.
+ */
+#include <constants.h>
+#include <dalvik/dalvik_type.h>
+#include <cesk/cesk_block.h>
+
+/** @brief the analysis task of a method */
+typedef struct {
+	const char*                   classpath;   /*!<the class path of the method */
+	const char*                   methodname;  /*!<the name of the method */
+	const dalvik_type_t * const * typelist;    /*!<the argument type list */
+	cesk_block_t*                 graph;       /*!<the result block graph, free it with cesk_block_graph_free */
+	int                           rc;          /*!<the number of blocks has been interpreted, < 0 means error */
+} cesk_method_task_t;
+
+/** @brief analyze a single method, the result is saved in the task
+ *  @param task the task
+ *  @return the result of operation, < 0 means error
+ */
+int cesk_method_analyze(cesk_method_task_t* task);
+
+/** @brief analyze a group of methods
+ *  @details if the number of analyzer threads is greater than 1, the methods are
+ *           analyzed by a work-stealing thread pool. The result is identical to
+ *           the serial analyzer
+ *  @param tasks the tasks
+ *  @param ntasks the number of tasks
+ *  @return the number of methods failed to analyze, < 0 means error
+ */
+int cesk_method_analyze_all(cesk_method_task_t* tasks, int ntasks);
+
+/** @brief set how many threads the analyzer uses
+ *  @param nthreads number of threads, 1 means analyze methods serially
+ *  @return nothing
+ */
+void cesk_method_set_nthreads(int nthreads);
+
+/** @brief get the number of threads the analyzer is using
+ *  @return the number of threads
+ */
+int cesk_method_get_nthreads();
+
+#endif
@@ -8,6 +8,7 @@ typedef struct _cesk_object_t cesk_object_t;
 #include <cesk/cesk_value.h>
 #include <cesk/cesk_reloc.h>
 #include <dalvik/dalvik_class.h>
+#include <dalvik/dalvik_instruction.h>
 /**
  * @brief an abstract object value
  *
@@ -51,6 +52,71 @@ struct _cesk_object_t {
  **/
 #define CESK_OBJECT_STRUCT_ADVANCE(cur) do{ cur = (typeof(cur))((cur)->valuelist + (cur)->num_members); } while(0)
 
+/**
+ * @brief the memory layout of the instances of a class, it's computed once
+ *        when the first instance of the class is created
+ **/
+typedef struct _cesk_object_layout_t cesk_object_layout_t;
+struct _cesk_object_layout_t {
+	const char*           classpath;  /*!<the class path of the class */
+	uint16_t              depth;      /*!<the number of classes in the inherence chain */
+	size_t                size;       /*!<the size of an instance */
+	size_t                num_fields; /*!<the number of fields of all classes in the chain */
+	cesk_object_t*        prototype;  /*!<an instance with all fields unset, a new instance is a copy of it */
+	cesk_object_layout_t* next;       /*!<the next layout in the hash slot */
+};
+/**
+ * @brief a resolved field, it locates the field in every instance of the class which
+ *        defines the field as well as the instances of its subclasses.
+ * @details the high 32 bits is the distance from the class struct to the end of
+ *          the object, because the structs of superclasses are always behind the
+ *          struct of the class. The low 32 bits is the index of the field in the struct
+ **/
+typedef uint64_t cesk_object_field_ref_t;
+/** @brief an unresolved field */
+#define CESK_OBJECT_FIELD_REF_NULL 0
+/** @brief initialize the object layout cache */
+void cesk_object_init();
+/** @brief finalize the object layout cache */
+void cesk_object_finalize();
+/**
+ * @brief get the layout of a class, the layout is computed at the first time
+ * @param classpath the class path
+ * @return the layout, NULL if the class is not found
+ */
+const cesk_object_layout_t* cesk_object_layout(const char* classpath);
+/**
+ * @brief resolve a field defined in class
+ * @param classpath the class which defines the field
+ * @param field_name the field name
+ * @return the field reference, CESK_OBJECT_FIELD_REF_NULL if the field can not be resolved
+ */
+cesk_object_field_ref_t cesk_object_field_resolve(const char* classpath, const char* field_name);
+/**
+ * @brief resolve the field used by an instruction, if the instruction is
+ *        an instance-get or instance-put of this field, the result is cached
+ *        in the instruction
+ * @param inst the instruction
+ * @param classpath the class which defines the field
+ * @param field_name the field name
+ * @return the field reference, CESK_OBJECT_FIELD_REF_NULL if the field can not be resolved
+ */
+cesk_object_field_ref_t cesk_object_field_resolve_cached(const dalvik_instruction_t* inst, const char* classpath, const char* field_name);
+/**
+ * @brief get the field of an object by the resolved field reference
+ * @param object the object
+ * @param classpath the class which defines the field
+ * @param ref the field reference
+ * @return the pointer contains the set address, NULL if the object is not an instance of the class
+ */
+static inline uint32_t* cesk_object_field(const cesk_object_t* object, const char* classpath, cesk_object_field_ref_t ref)
+{
+	size_t tail = ref >> 32;
+	if(CESK_OBJECT_FIELD_REF_NULL == ref || tail > object->size - sizeof(cesk_object_t)) return NULL;
+	cesk_object_struct_t* this = (cesk_object_struct_t*)(((const char*)object) + object->size - tail);
+	if(this->class->path != classpath) return NULL;
+	return this->valuelist + (uint32_t)ref;
+}
 /**
  * @brief Create a new instance object of class in classpath 
  * @param classpath the class path of the object
@@ -1,7 +1,7 @@
 #ifndef __CESK_RELOC_H__
 #define __CESK_RELOC_H__
 /**
- * @file  cesk_reloc.c
+ * @file  cesk_reloc.h
  * @brief the relocation support for store
  * @details Altough we guarantee that all allocation performed by different instruction
  * 			will return a different address in same store. 
@@ -35,8 +35,13 @@ cesk_reloc_table_t* cesk_reloc_table_from_store(cesk_store_t** p_dest, const ces
  */
 void cesk_reloc_table_free(cesk_reloc_table_t* table);
 
+/** @brief release the relocation tables cached for reuse
+ *  @return nothing
+ */
+void cesk_reloc_finalize();
+
 /** @brief look for the relocation table, if the address should be relocated, return the relocated address
- * 		   otherwise return the input address
+ * 		   otherwise return the input address. The constant addresses are never relocated
  * 	@param table the relocation table
  * 	@param addr  address
  * 	@return a store address, CESK_STORE_ADDR_NULL when error
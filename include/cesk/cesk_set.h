@@ -6,8 +6,6 @@
  *  @brief the address used for CESK Virtual Machine 
  */
 /* this file need previous definations */
-/** @brief the node in the hash table */
-typedef struct _cesk_set_node_t cesk_set_node_t;
 /** @brief the data structure for the set */
 typedef struct _cesk_set_t cesk_set_t;
 /** @brief the data structure for the iterator */
@@ -18,7 +16,8 @@ typedef struct _cesk_set_iter_t cesk_set_iter_t;
 #include <cesk/cesk_reloc.h>
 
 struct _cesk_set_iter_t{
-    cesk_set_node_t *next;
+    const uint32_t *next;   /*!<the next slot */
+    const uint32_t *end;    /*!<the end of the slots */
 };
 
 /** @brief Create an empty set 
@@ -32,6 +31,15 @@ cesk_set_t* cesk_set_empty_set();
  * @return the result of the operation
  */
 int cesk_set_merge(cesk_set_t* dest, const cesk_set_t* sour); 
+/** @brief merge a group of sets. dest := dest + sours[0] + ... + sours[n-1].
+ *         This is faster than merging the sets one by one, because the 
+ *         destination is written only once
+ *  @param dest the destination set
+ *  @param sours the source sets
+ *  @param n the number of source sets
+ *  @return the result of the operation
+ */
+int cesk_set_merge_n(cesk_set_t* dest, const cesk_set_t* const* sours, int n);
 /** @brief apply relocation table and then merge two set.
  *  @param dest the destination set
  *  @param sour source set
@@ -97,6 +105,18 @@ void cesk_set_init();
  */
 void cesk_set_finalize();
 
+/** @brief enable or disable hash-consing. If it's enabled, the sets with same
+ *         content share the same memory, and the comparison of sets is O(1)
+ *  @param enabled 1 to enable, 0 to disable
+ *  @return nothing
+ */
+void cesk_set_hashcons_enable(int enabled);
+
+/** @brief check if hash-consing is enabled
+ *  @return the result
+ */
+int cesk_set_hashcons_enabled();
+
 /** @brief hash code of two set 
  *  @param set the set
  *  @return hash code
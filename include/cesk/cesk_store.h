@@ -21,6 +21,11 @@
  * So we can just copy the block table which is much smaller than the 
  * actual store.
  *
+ * If CESK_STORE_PERSISTENT is set, the block table is not a flat array
+ * but a persistent trie of blocks (see cesk_store_node_t). In this case
+ * forking a store only shares the root of the trie, and writing to a 
+ * block only copies the path from the root to the block.
+ *
  * The store also have reference counters for each slot, in this way
  * we can perform gabage collection in the store.
  *
@@ -39,6 +44,7 @@
 
 /* previous defs */
 typedef struct _cesk_store_t cesk_store_t;
+struct _cesk_reloc_table_t;
 
 #include <cesk/cesk_value.h>
 #include <dalvik/dalvik_instruction.h>
@@ -74,31 +80,139 @@ typedef struct _cesk_store_t cesk_store_t;
 /** @brief return a new address that contains a value */
 #define CESK_STORE_ADDR_CONST_SET(addr, elem) ((addr) | CESK_STORE_ADDR_CONST_SUFFIX(CESK_STORE_ADDR_##elem))
 
-/** @brief slot in virtual store */
+/** @brief slot in virtual store, if CESK_STORE_SLOT_SOA is set, the value is not in the slot */
 typedef struct {
     uint32_t        refcnt:31;        /*!<this refcnt is the counter inside this frame */
     uint8_t         reuse:1;          /*!<if this address is reused, because same insturction should allocate same address */
     uint32_t        idx;              /*!<instruction index created this object */
 	uint32_t		parent;			  /*!<the parent address of this slot */
 	uint32_t		field;		      /*!<filed name of the member */
+#if !CESK_STORE_SLOT_SOA
     cesk_value_t*   value;			  /*!<the data payload */
+#endif
 } cesk_store_slot_t;
 /** @brief the store block of virtual store */
 typedef struct {
     uint32_t       refcnt;     /*!<for Copy-on-Write */
     uint32_t       num_ent;    /*!<number of entities */
+    uint32_t       nslots;     /*!<number of slots in this block */
+    uint32_t       copied;     /*!<if this block has been copied since it get current id */
+    uint64_t       id;         /*!<the unique id of the content of this block, see cesk_store_block_diff */
+    uint64_t       base;       /*!<the id of the content this block copied from, 0 means none */
+#if CESK_STORE_SLOT_SOA
+    cesk_value_t*  values[0];  /*!<the values, followed by the slots */
+#else
     cesk_store_slot_t  slots[0];
+#endif
 } cesk_store_block_t;
-/** @brief the number of slots in one block */
-#define CESK_STORE_BLOCK_NSLOTS ((CESK_STORE_BLOCK_SIZE - sizeof(cesk_store_block_t))/sizeof(cesk_store_slot_t))
+#if CESK_STORE_SLOT_SOA
+/** @brief the value at the offset of a block */
+#	define CESK_STORE_BLOCK_VALUE(block, ofs) ((block)->values[ofs])
+/** @brief the pointer to the slot at the offset of a block */
+#	define CESK_STORE_BLOCK_SLOT(block, ofs) (((cesk_store_slot_t*)((block)->values + (block)->nslots)) + (ofs))
+/** @brief the size of a block with n slots */
+#	define CESK_STORE_BLOCK_BYTES(n) (sizeof(cesk_store_block_t) + (n) * (sizeof(cesk_value_t*) + sizeof(cesk_store_slot_t)))
+#else
+#	define CESK_STORE_BLOCK_VALUE(block, ofs) ((block)->slots[ofs].value)
+#	define CESK_STORE_BLOCK_SLOT(block, ofs) ((block)->slots + (ofs))
+#	define CESK_STORE_BLOCK_BYTES(n) (sizeof(cesk_store_block_t) + (n) * sizeof(cesk_store_slot_t))
+#endif
+/** @brief the number of words in the bitmap of a block with n slots */
+#define CESK_STORE_BITMAP_WORDS(n) (((n) + 31) / 32)
+/** @brief the index from (instruction, parent, field) to the address, see cesk_store.c */
+typedef struct _cesk_store_index_t cesk_store_index_t;
+/** @brief the addresses that might become garbage since the last garbage collection, see cesk_store.c */
+typedef struct _cesk_store_remset_t cesk_store_remset_t;
+#if CESK_STORE_PERSISTENT
+/** @brief the fanout of the block trie */
+#define CESK_STORE_TRIE_FANOUT (1u << CESK_STORE_TRIE_BITS)
+/** @brief a node of the block trie, the children of the nodes at level 1 are blocks */
+typedef struct _cesk_store_node_t cesk_store_node_t;
+struct _cesk_store_node_t {
+	uint32_t refcnt;                            /*!<for Copy-on-Write, how many parents (nodes or stores) refer this node */
+	union {
+		cesk_store_node_t*  node;               /*!<the child node */
+		cesk_store_block_t* block;              /*!<the child block, if this node is at level 1 */
+	} child[CESK_STORE_TRIE_FANOUT];            /*!<the children */
+};
+#endif
 /** @brief the virtual store object */
 struct _cesk_store_t {
     uint32_t            nblocks;    /*!<number of blocks */
+    uint32_t            nslots;     /*!<number of slots in each block */
     uint32_t            num_ent;    /*!<number of entities */
     hashval_t           hashcode;   /*!<hashcode of content of this store */
+    cesk_store_index_t* index;      /*!<the address index, copy-on-write */
+    cesk_store_remset_t* remset;    /*!<the remembered set for the garbage collector, copy-on-write */
+#if CESK_STORE_PERSISTENT
+    uint32_t            depth;      /*!<the number of levels of the block trie */
+    cesk_store_node_t*  root;       /*!<the root of the block trie, NULL if there's no block */
+#else
     cesk_store_block_t* blocks[0];  /*!<block array */
+#endif
 };
+/** @brief get a read-only pointer to a block of the store
+ *  @param store the virtual store
+ *  @param b_idx the index of the block, must be less than store->nblocks
+ *  @return the block
+ */
+static inline const cesk_store_block_t* cesk_store_get_block(const cesk_store_t* store, uint32_t b_idx)
+{
+#if CESK_STORE_PERSISTENT
+	const cesk_store_node_t* node = store->root;
+	uint32_t level;
+	for(level = store->depth; level > 1; level --)
+		node = node->child[(b_idx >> ((level - 1) * CESK_STORE_TRIE_BITS)) & (CESK_STORE_TRIE_FANOUT - 1)].node;
+	return node->child[b_idx & (CESK_STORE_TRIE_FANOUT - 1)].block;
+#else
+	return store->blocks[b_idx];
+#endif
+}
 
+/** @brief find the slots that might be different in two blocks at the same index of two stores
+ *  @details each block records the slots written since it was copied from another block, 
+ *           if two blocks are copied from the same block, or one is copied from another,
+ *           only the written slots might be different. Otherwise all slots are set in the bitmap.
+ *  @param first the first block
+ *  @param second the second block
+ *  @param diff the result bitmap, must have CESK_STORE_BITMAP_WORDS(nslots) words
+ *  @return nothing
+ */
+void cesk_store_block_diff(const cesk_store_block_t* first, const cesk_store_block_t* second, uint32_t* diff);
+/** @brief get the next slot that is set in the bitmap
+ *  @param bitmap the bitmap
+ *  @param nslots the number of slots
+ *  @param ofs look for the slot from this offset
+ *  @return the offset of the slot, nslots if there's no more slot
+ */
+static inline uint32_t cesk_store_bitmap_next(const uint32_t* bitmap, uint32_t nslots, uint32_t ofs)
+{
+	uint32_t i = ofs / 32;
+	if(ofs >= nslots) return nslots;
+	uint32_t word = bitmap[i] & (~0u << (ofs % 32));
+	while(0 == word)
+	{
+		if(++ i >= CESK_STORE_BITMAP_WORDS(nslots)) return nslots;
+		word = bitmap[i];
+	}
+	ofs = i * 32 + __builtin_ctz(word);
+	return ofs < nslots ? ofs : nslots;
+}
+/** @brief release the buffers of the store module kept by the current thread, the buffers of the other
+ *         threads are released when they exit
+ *  @return nothing
+ */
+void cesk_store_finalize(void);
+/** @brief set the block size of the stores made by cesk_store_empty_store in the current thread,
+ *         the stores with different block size can not be merged
+ *  @param size the block size in bytes, 0 means CESK_STORE_BLOCK_SIZE
+ *  @return >=0 for success
+ */
+int cesk_store_set_block_size(size_t size);
+/** @brief get the block size of the stores made by cesk_store_empty_store in the current thread
+ *  @return the block size in bytes
+ */
+size_t cesk_store_get_block_size();
 /** @brief make an empty store 
  *  @return nothing
  */
@@ -225,6 +339,20 @@ uint32_t cesk_store_const_addr_from_operand(const dalvik_operand_t* operand);
  */
 uint32_t cesk_store_get_refcnt(const cesk_store_t* store, uint32_t addr);
 
+/** @brief get the remembered set of the store, which contains the addresses that might become garbage 
+ *         since the remembered set is cleared. That is the addresses whose refcnt is decreased but not
+ *         to zero, and the addresses that get a value before anyone refers them.
+ *  @param store the virtual store
+ *  @param p_addrs the buffer for the pointer to the addresses, there might be duplicated addresses
+ *  @return the number of addresses, -1 if the remembered set overflowed, which means any address might be garbage
+ */
+int cesk_store_get_remset(const cesk_store_t* store, const uint32_t** p_addrs);
+/** @brief clear the remembered set, it's called after a garbage collection
+ *  @param store the virtual store
+ *  @return nothing
+ */
+void cesk_store_clear_remset(cesk_store_t* store);
+
 /** @brief set the refcnt @ addr to zero, use for garbage clean 
  * @return the result of operation
  */
@@ -254,7 +382,17 @@ int cesk_store_clear_refcnt(cesk_store_t* store, uint32_t addr);
  *   @param  p_dest destination store
  *   @param  sour source store
  *   @return the number of values has been modified, negative return value means errors during merge
- *   @todo   implementation
  */
 int cesk_store_merge(cesk_store_t** p_dest, const cesk_store_t* sour);
+
+/** @brief   merge the source store to the destination store, and return the relocation table used by the merge
+ *  @details the relocation table tells where the objects in the source store is placed in the destination store,
+ *  		 so that the caller is able to relocate the addresses that refers the source store (e.g. registers).
+ *  		 The caller is responsible for freeing the table with cesk_reloc_table_free.
+ *  @param   p_dest destination store
+ *  @param   sour source store
+ *  @param   p_reloc the buffer for the relocation table, NULL means we do not need the table
+ *  @return  the result of operation, negative return value means errors during merge
+ */
+int cesk_store_merge_reloc(cesk_store_t** p_dest, const cesk_store_t* sour, struct _cesk_reloc_table_t** p_reloc);
 #endif
@@ -50,8 +50,6 @@ struct _cesk_value_t {
 	} pointer; /*!<actuall data pointer*/
     uint32_t    refcnt;     /*!<the reference counter */
     hashval_t   hashcode;   /*!<the hashcode */
-    struct _cesk_value_t 
-                *prev, *next; /*!<the previous and next pointer used by value list */
 }; 
 
 /** @brief the abstruct value that can not be modified */
@@ -15,8 +15,38 @@
 #endif
 
 #ifndef STRING_POOL_SIZE
-/** @brief the number of slots in hash table for string pool */ 
-#   define STRING_POOL_SIZE 100003
+/** @brief the initial number of slots in hash table for string pool, the table grows when it's full */ 
+#   define STRING_POOL_SIZE 131072
+#endif
+
+#ifndef STRINGPOOL_PAGE_SIZE
+/** @brief the size of a slab page which holds the pooled strings */
+#   define STRINGPOOL_PAGE_SIZE 0x10000
+#endif
+
+#ifndef STRINGPOOL_LOCK_STRIPES
+/** @brief the number of locks used for inserting strings to the string pool, lookups do not lock */
+#   define STRINGPOOL_LOCK_STRIPES 64
+#endif
+
+#ifndef STRINGPOOL_MAX_LOAD_NUM
+/** @brief the max load factor of the string pool hash table is NUM/DEN */
+#   define STRINGPOOL_MAX_LOAD_NUM 1
+#endif
+
+#ifndef STRINGPOOL_MAX_LOAD_DEN
+/** @brief the max load factor of the string pool hash table is NUM/DEN */
+#   define STRINGPOOL_MAX_LOAD_DEN 2
+#endif
+
+#ifndef SEXP_ARENA_PAGE_SIZE
+/** @brief the size of a page in S-Expression arena */
+#   define SEXP_ARENA_PAGE_SIZE 0x10000
+#endif
+
+#ifndef SEXP_PARSE_STACK_INIT
+/** @brief the initial depth of the parser stack, the stack grows when the S-Expression is deeper */
+#   define SEXP_PARSE_STACK_INIT 64
 #endif
 
 #ifndef DALVIK_POOL_INIT_SIZE
@@ -44,10 +74,74 @@
 #   define DALVIK_BLOCK_MAX_KEYS 1024
 #endif
 
+#ifndef DALVIK_LOADER_NTHREADS
+/** @brief the default number of threads used by the loader, 1 means serial loading */
+#   define DALVIK_LOADER_NTHREADS 1
+#endif
+
+#ifndef DALVIK_LOADER_MAX_THREADS
+/** @brief the max number of threads the loader can use */
+#   define DALVIK_LOADER_MAX_THREADS 64
+#endif
+
+#ifndef DALVIK_LOADER_QUEUE_SIZE
+/** @brief how many parsed files can be waiting for the loader */
+#   define DALVIK_LOADER_QUEUE_SIZE 256
+#endif
+
+#ifndef DALVIK_CACHE_VERSION
+/** @brief the version of the program cache format, a cache file with other version is ignored */
+#   define DALVIK_CACHE_VERSION 1
+#endif
+
+#ifndef CESK_STORE_PERSISTENT
+/** @brief use a persistent trie rather than a flat array as the block table of cesk store */
+#   define CESK_STORE_PERSISTENT 0
+#endif
+
+#ifndef CESK_STORE_TRIE_BITS
+/** @brief the number of address bits consumed by each level of the block trie, the fanout is 2^bits */
+#   define CESK_STORE_TRIE_BITS 5
+#endif
 
 #ifndef CESK_STORE_BLOCK_SIZE
 /** @brief the size of one block in cesk store */
-#   define CESK_STORE_BLOCK_SIZE 0x4000   /* 16k for each block */
+#   if CESK_STORE_PERSISTENT
+#       define CESK_STORE_BLOCK_SIZE 0x400    /* 1k for each block, because only the path to the block is copied */
+#   else
+#       define CESK_STORE_BLOCK_SIZE 0x4000   /* 16k for each block */
+#   endif
+#endif
+
+#ifndef CESK_STORE_BLOCK_MIN_SLOTS
+/** @brief the minimal number of slots in a store block */
+#   define CESK_STORE_BLOCK_MIN_SLOTS 16
+#endif
+
+#ifndef CESK_STORE_SLOT_SOA
+/** @brief store the value pointers of a block in a separate array from the slot metadata, so that scanning the values
+ *         touches less memory */
+#   define CESK_STORE_SLOT_SOA 0
+#endif
+
+#ifndef LOG_MAX_MODULES
+/** @brief the max number of modules that have their own runtime log level */
+#   define LOG_MAX_MODULES 256
+#endif
+
+#ifndef LOG_MAX_RULES
+/** @brief the max number of runtime log level settings */
+#   define LOG_MAX_RULES 32
+#endif
+
+#ifndef LOG_RING_SIZE
+/** @brief the number of logs kept in the ring buffer of a thread */
+#   define LOG_RING_SIZE 1024
+#endif
+
+#ifndef LOG_RING_RECORD_SIZE
+/** @brief the max length of a log in the ring buffer, a longer log is truncated */
+#   define LOG_RING_RECORD_SIZE 256
 #endif
 
 #ifndef CONFIG_PATH
@@ -60,9 +154,69 @@
 #   define DALVIK_METHOD_LABEL_STACK_SIZE 32
 #endif
 
-#ifndef CESK_SET_HASH_SIZE
-/** @brief the number of slots that used for implementation of set */
-#   define CESK_SET_HASH_SIZE 100007
+#ifndef CESK_VALUE_SLAB_SIZE
+/** @brief the number of values in a slab of the value allocator */
+#	define CESK_VALUE_SLAB_SIZE 256
+#endif
+
+#ifndef CESK_OBJECT_LAYOUT_HASH_SIZE
+/** @brief the number of slots in the hash table of the object layout cache */
+#	define CESK_OBJECT_LAYOUT_HASH_SIZE 1021
+#endif
+
+#ifndef CESK_SET_INIT_CAPACITY
+/** @brief the initial number of slots of a set */
+#   define CESK_SET_INIT_CAPACITY 4
+#endif
+
+#ifndef CESK_SET_ARRAY_MAX
+/** @brief the max size of a set which is stored as a sorted array, a larger set is stored 
+ *         in a hash table. Must be a power of 2 */
+#   define CESK_SET_ARRAY_MAX 16
+#endif
+
+#ifndef CESK_SET_HASHCONS
+/** @brief if the sets are hash-consed by default */
+#   define CESK_SET_HASHCONS 0
+#endif
+
+#ifndef CESK_SET_HASHCONS_SIZE
+/** @brief the number of slots of the set hash-consing table */
+#   define CESK_SET_HASHCONS_SIZE 100007
+#endif
+
+#ifndef CESK_SET_HASHCONS_LOCKS
+/** @brief the number of locks protecting the slots of the set hash-consing table */
+#   define CESK_SET_HASHCONS_LOCKS 256
+#endif
+
+#ifndef CESK_BLOCK_THREADED_DISPATCH
+/** @brief use computed goto to dispatch the instructions in the block interpreter by default */
+#	ifdef __GNUC__
+#		define CESK_BLOCK_THREADED_DISPATCH 1
+#	else
+#		define CESK_BLOCK_THREADED_DISPATCH 0
+#	endif
+#endif
+
+#ifndef CESK_METHOD_NTHREADS
+/** @brief the default number of threads used by the method analyzer, 1 means serial analysis */
+#   define CESK_METHOD_NTHREADS 1
+#endif
+
+#ifndef CESK_METHOD_MAX_THREADS
+/** @brief the max number of threads the method analyzer can use */
+#   define CESK_METHOD_MAX_THREADS 64
+#endif
+
+#ifndef CESK_METHOD_ADAPTIVE_BLOCK
+/** @brief choose the store block size by the size of the method under analysis */
+#   define CESK_METHOD_ADAPTIVE_BLOCK 0
+#endif
+
+#ifndef CESK_METHOD_SLOTS_PER_INST
+/** @brief the number of store slots per instruction if the block size is adaptive */
+#   define CESK_METHOD_SLOTS_PER_INST 2
 #endif
 
 #ifndef CESK_STORE_ALLOC_ATTEMPT
@@ -70,9 +224,44 @@
 #	define CESK_STORE_ALLOC_ATTEMPT 5
 #endif
 
+#ifndef CESK_STORE_INDEX_INIT_SIZE
+/** @brief the initial number of slots of the address index of a store, must be a power of 2 */
+#	define CESK_STORE_INDEX_INIT_SIZE 64
+#endif
+
+#ifndef CESK_STORE_REMSET_INIT_SIZE
+/** @brief the initial capacity of the remembered set of a store */
+#	define CESK_STORE_REMSET_INIT_SIZE 16
+#endif
+
+#ifndef CESK_STORE_REMSET_MAX_SIZE
+/** @brief the max capacity of the remembered set, a full garbage collection is needed if the remembered set overflows */
+#	define CESK_STORE_REMSET_MAX_SIZE 4096
+#endif
+
 #ifndef CESK_STORE_ADDR_CONST_PREFIX
-/** @brief the address prefix for constant address */
-#	define CESK_STORE_ADDR_CONST_PREFIX 0xffffff00ul
+/** @brief the address prefix for constant address, the 24-bit suffix is the abstract value (see cesk_domain.h) */
+#	define CESK_STORE_ADDR_CONST_PREFIX 0xff000000ul
+#endif
+
+#ifndef CESK_BLOCK_PRUNE_BRANCHES
+/** @brief skip the branches which can not be taken with the output of the block during the fixpoint iteration */
+#	define CESK_BLOCK_PRUNE_BRANCHES 1
+#endif
+
+#ifndef CESK_DOMAIN_DEFAULT
+/** @brief the default numeric domain, see cesk_domain.h */
+#	define CESK_DOMAIN_DEFAULT CESK_DOMAIN_SIGN
+#endif
+
+#ifndef CESK_DOMAIN_CONSTSET_MIN
+/** @brief the smallest value tracked by the small constant set domain, the domain tracks 20 consecutive values */
+#	define CESK_DOMAIN_CONSTSET_MIN -4
+#endif
+
+#ifndef CESK_DOMAIN_INTERVAL_LIMIT
+/** @brief the bounds of the interval domain beyond the limit are widened to infinity, must be less than 511 */
+#	define CESK_DOMAIN_INTERVAL_LIMIT 32
 #endif
 
 #ifndef CESK_SET_EMPTY_HASH
@@ -90,11 +279,19 @@
 #	define CESK_FRAME_INIT_HASH 0xa3efab97ul
 #endif
 
-#ifndef CESK_RELOC_TABLE_SIZE
-/** @brief slot size of cesk relocation table
- *  @todo adjust this value cuz i don't know if conlisions are usuall
- */
-#	define CESK_RELOC_TABLE_SIZE 1023
+#ifndef CESK_RELOC_TABLE_INIT_SIZE
+/** @brief the initial size of the hash table of cesk relocation table, the table grows with the number of conflicts */
+#	define CESK_RELOC_TABLE_INIT_SIZE 16
+#endif
+
+#ifndef CESK_RELOC_BLOOM_BITS
+/** @brief the number of bits in the bloom filter of cesk relocation table, must be a multiple of 32 */
+#	define CESK_RELOC_BLOOM_BITS 256
+#endif
+
+#ifndef CESK_RELOC_TABLE_POOL_SIZE
+/** @brief the max number of freed relocation tables kept for reuse */
+#	define CESK_RELOC_TABLE_POOL_SIZE 16
 #endif
 
 /** @brief the invalid address in the virtual store */
@@ -104,34 +301,20 @@
 #define MH_MULTIPLY (2654435761ul)
 
 /** @brief the constants used for hash functions for string pool */
-#define STRINGPOOL_MURMUR_C1 0xcc9e2d51ul
+#define STRINGPOOL_HASH_SEED 0x2d358dccaa6c78a5ull
 /** @brief the constants used for hash functions for string pool */
-#define STRINGPOOL_MURMUR_C2 0x1b873593ul
+#define STRINGPOOL_HASH_P0   0x8bb84b93962eacc9ull
 /** @brief the constants used for hash functions for string pool */
-#define STRINGPOOL_MURMUR_N  0xe6546b64ul
+#define STRINGPOOL_HASH_P1   0xa0761d6478bd642full
 /** @brief the constants used for hash functions for string pool */
-#define STRINGPOOL_MURMUR_R1 15
+#define STRINGPOOL_HASH_P2   0xe7037ed1a0b428dbull
 /** @brief the constants used for hash functions for string pool */
-#define STRINGPOOL_MURMUR_R2 13
-/** @brief the constants used for hash functions for string pool */
-#define STRINGPOOL_MURMUR_M  5
-/** @brief the constants used for hash functions for string pool */
-#define STRINGPOOL_MURMUR_SEED 0xf3f53423l
-
-/** @brief the constants used for hash functions for string pool */
-#define STRINGPOOL_MULTIPLY_SEED 0x23f4537l
-/** @brief the constants used for hash functions for string pool */
-#define STRINGPOOL_MULTIPLY_M    0xee6b27ebul
+#define STRINGPOOL_HASH_P3   0x4b33a62ed433d4a3ull
 
-/** @brief the constants used for hash functions for string pool */
-#define STRINGPOOL_SUM_M  0xfffe7985ul
-/** @brief the constants used for hash functions for string pool */
-#define STRINGPOOL_SUM_R1 17
-/** @brief the constants used for hash functions for string pool */
-#define STRINGPOOL_SUM_R2 15
-
-/** @brief the constants used for hash functions for string pool */
-#define STRINGPOOL_ELF_MSK 0xf0000000ul
+/** @brief the constants used for the 64 bit hash function of the program cache */
+#define DALVIK_CACHE_HASH_M 0xc6a4a7935bd1e995ull
+/** @brief the constants used for the 64 bit hash function of the program cache */
+#define DALVIK_CACHE_HASH_R 47
 
 /** @brief define the type of a hash function returns */
 #define hashval_t uint32_t
@@ -0,0 +1,50 @@
+#ifndef __DALVIK_CACHE_H__
+#define __DALVIK_CACHE_H__
+/** @file dalvik_cache.h
+ *  @brief the binary cache of loaded dalvik programs
+ *
+ *  @details
+ *  Parsing the S-Expression files is the most expensive part of loading a
+ *  program. So after a program is loaded, we can dump everything we get from
+ *  the files into a binary snapshot: the pooled strings, the instruction pool,
+ *  the label jump table, the exception handlers, and all classes, methods and
+ *  fields in the member dictionary.
+ *
+ *  Next time, we map the snapshot into memory and rebuild the program without
+ *  parsing. All strings are pooled again, so the pointer-equality of pooled
+ *  strings still holds.
+ *
+ *  The snapshot carries a key which is computed from the input files, if the
+ *  key does not match, the snapshot is stale and is ignored.
+ *
+ *  A snapshot can only be loaded when no program has been loaded, because the
+ *  instruction indices and label ids in the snapshot must not be changed.
+ */
+#include <stdint.h>
+#include <stddef.h>
+#include <constants.h>
+
+/** @brief the 64 bit hash function used for the cache key and checksum
+ *  @param data the data to hash
+ *  @param size the size of the data
+ *  @param seed the seed (or the hash value of previous data)
+ *  @return the hash value
+ */
+uint64_t dalvik_cache_hash(const void* data, size_t size, uint64_t seed);
+
+/** @brief save current program to a cache file
+ *  @param filename the cache file
+ *  @param key the key of the input files
+ *  @return the result of operation, < 0 means error
+ */
+int dalvik_cache_save(const char* filename, uint64_t key);
+
+/** @brief load a program from a cache file
+ *  @param filename the cache file
+ *  @param key the key of the input files
+ *  @return 0 means the program is loaded, > 0 means the cache file is not usable
+ *          (not exists, stale or not compatible), < 0 means error
+ */
+int dalvik_cache_load(const char* filename, uint64_t key);
+
+#endif /* __DALVIK_CACHE_H__ */
@@ -29,6 +29,13 @@ dalvik_exception_handler_t* dalvik_exception_handler_from_sexp(const sexpression
  */
 dalvik_exception_handler_set_t* dalvik_exception_new_handler_set(size_t count, dalvik_exception_handler_t** set);
 
+/** @brief Create a new exception handler 
+ *  @param exception the exception this handler catches, NULL means all exceptions
+ *  @param handler_label the label of the handler
+ *  @return the handler object
+ */
+dalvik_exception_handler_t* dalvik_exception_new_handler(const char* exception, int handler_label);
+
 
 /* The memory for exception handler is managed by dalvik_exception.c,
  * So there's no interface for free
@@ -245,6 +245,8 @@ dalvik_instruction_t* dalvik_instruction_new( void );
 int dalvik_instruction_init( void );
 /** @brief finalization */
 int dalvik_instruction_finalize( void );
+/** @brief the number of instructions in the pool */
+size_t dalvik_instruction_pool_size( void );
 
 /** 
  * @brief make a new dalvik instruction from a S-Expression
@@ -270,6 +272,18 @@ static inline void dalvik_instruction_read_annotation(const dalvik_instruction_t
 {
     memcpy(buf, ins->annotation_begin + ins->num_operands, count);
 }
+/** @brief get the cache slot of the instruction. The slot is the operand slot following the annotation,
+ *         it is zero when the instruction is created and it is not saved to the instruction cache file,
+ *         so the analyzer can use it for the information computed at run time
+ *  @param ins the instruction
+ *  @return the pointer to the slot, NULL if there is no space for the slot
+ */
+static inline uint64_t* dalvik_instruction_cache_slot(const dalvik_instruction_t* ins)
+{
+    const dalvik_operand_t* slot = ins->annotation_begin + ins->num_operands + 1;
+    if((const char*)(slot + 1) > ins->annotation_end) return NULL;
+    return (uint64_t*)&slot->payload.uint64;
+}
 /**@brief get a instruction by instruction index */
 static inline uint32_t dalvik_instruction_get_index(const dalvik_instruction_t* inst)
 {
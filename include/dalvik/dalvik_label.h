@@ -26,4 +26,16 @@ void dalvik_label_free(void);
  */
 int dalvik_label_get_label_id(const char* label);
 
+/** @brief get the number of labels that has been created 
+ *  @return the number of labels
+ */
+int dalvik_label_get_count(void);
+
+/** @brief get the names of all labels, names[label_id] = label name 
+ *  @param names the output buffer
+ *  @param count the size of the buffer, must be at least dalvik_label_get_count()
+ *  @return the number of labels, < 0 means error
+ */
+int dalvik_label_get_names(const char** names, int count);
+
 #endif /* __LABEL_H__ */
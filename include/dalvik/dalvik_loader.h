@@ -3,9 +3,35 @@
 /** @file dalvik_loader.h
  *  @brief dalvik package loader
  */
+#include <constants.h>
 #include <log.h>
-/**@brief load from path */
+/**@brief load from path 
+ * @details if the number of loader threads is greater than 1, the files are parsed 
+ *          by a group of worker threads, but the classes are still registered in the
+ *          same order as the serial loader, so the result is identical
+ * @param path the directory to load
+ * @return >=0 means success
+ */
 int dalvik_loader_from_directory(const char* path);
+/**@brief load from path, with a program cache
+ * @details the key of the input files is computed from the file names and contents,
+ *          if the cache file matches the key, the program is loaded from the cache
+ *          without parsing any file. Otherwise, the files are loaded and the program
+ *          is saved to the cache file. The cache is only used when no program is loaded
+ * @param path the directory to load
+ * @param cache_file the cache file, NULL means do not use cache
+ * @return >=0 means success
+ */
+int dalvik_loader_from_directory_cached(const char* path, const char* cache_file);
+/**@brief set how many threads the loader uses to parse files 
+ * @param nthreads number of threads, 1 means load files serially
+ * @return nothing
+ */
+void dalvik_loader_set_nthreads(int nthreads);
+/**@brief get the number of threads the loader is using 
+ * @return the number of threads
+ */
+int dalvik_loader_get_nthreads();
 /**@brief print a summary */
 void dalvik_loader_summary();
 
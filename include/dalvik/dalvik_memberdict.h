@@ -14,6 +14,12 @@
 
 #include <log.h>
 
+/** @brief the type of objects in the member dictionary */
+enum {
+    DALVIK_MEMBERDICT_TYPE_METHOD,   /*!<a dalvik_method_t */
+    DALVIK_MEMBERDICT_TYPE_FIELD,    /*!<a dalvik_field_t */
+    DALVIK_MEMBERDICT_TYPE_CLASS     /*!<a dalvik_class_t */
+};
 /**
  * @brief initialization
  * @return nothing
@@ -62,5 +68,12 @@ dalvik_field_t* dalvik_memberdict_get_field(const char* class_path, const char*
  */
 dalvik_class_t* dalvik_memberdict_get_class(const char* class_path);
 
+/** @brief visit all objects in the member dictionary 
+ *  @param visitor the callback, type is DALVIK_MEMBERDICT_TYPE_*, a negative return value stops the iteration
+ *  @param data the additional data passed to visitor
+ *  @return the result of operation, < 0 means error
+ */
+int dalvik_memberdict_foreach(int (*visitor)(int type, void* object, void* data), void* data);
+
 
 #endif /* __DALVIK_MEMBERDICT_H__ */
@@ -16,7 +16,18 @@
  * 			 Config file log.conf is used for redirect log to a file. For each log level, we 
  * 			 can define an output file, so that we can seperately record log in different  level in 
  * 			 different files.
+ *
+ * 			 Besides the compile time LOG_LEVEL, each module (a source file, named by the file name 
+ * 			 without extension) has a runtime level. The level is checked before the arguments are 
+ * 			 evaluated, so a disabled log costs only a load and a test. A level whose output is 
+ * 			 /dev/null is disabled as well.
+ *
+ * 			 With the ring backend, the logs are formatted into a per-thread ring buffer without 
+ * 			 any lock, and the buffers are written to the output files by log_flush, log_finalize and when
+ * 			 the thread exits.
  */
+#include <stdint.h>
+#include <stdio.h>
 /* log levels */
 enum{
     /** Use this level when something would stop the program */
@@ -39,7 +50,8 @@ enum{
  *  @return nothing
  */
 void log_init();
-/** @brief initlaization 
+/** @brief finalization, the ring buffer of the calling thread is flushed and released,
+ *         the ring buffer of any other thread is flushed and released when the thread exits
  *  @return nothing
  */
 void log_finalize();
@@ -55,9 +67,72 @@ void log_finalize();
 void log_write(int level, const char* file, const char* function, int line, const char* fmt, ...) 
 	__attribute__((format (printf, 5, 6)));
 
+/** @brief the log backends */
+enum{
+    /** write the log to the output file immediately */
+    LOG_BACKEND_FILE,
+    /** keep the log in the ring buffer of the thread, until log_flush is called */
+    LOG_BACKEND_RING
+};
+
+/** @brief set the log backend
+ *  @param backend the backend, LOG_BACKEND_FILE or LOG_BACKEND_RING
+ *  @return nothing
+ */
+void log_set_backend(int backend);
+
+/** @brief set the runtime level of the modules
+ *  @param module the prefix of the module names, e.g. "cesk_store" or "cesk", NULL means the default level.
+ *         If more than one prefix matches a module, the longest one is used
+ *  @param level the max level of the log that is written, -1 disables all logs of the modules
+ *  @return < 0 if there are too many rules
+ */
+int log_set_level(const char* module, int level);
+
+/** @brief write the logs in the ring buffer of the calling thread to the output files, and clear the buffer.
+ *         The buffers of other threads are written when they exit
+ *  @return nothing
+ */
+void log_flush();
+
+/** @brief write the logs in the ring buffers of the living threads to a file, the buffers are not cleared.
+ *         The threads should not be writing logs when this function is called
+ *  @param fp the output file
+ *  @return the number of logs written
+ */
+int log_ring_dump(FILE* fp);
+
+/** @brief register a source file as a module, do not use it directly
+ *  @param file the source file name
+ *  @return the module id
+ */
+int log_module_register(const char* file);
+
+/** @brief the enabled levels of each module, bit i is set if level i is enabled. do not use it directly */
+extern uint8_t log_module_mask[];
+
+/** @brief check if a log should be written, the module id of the call site is resolved at the first time
+ *  @param level the log level
+ *  @param file the source file
+ *  @param p_module the module id cache of the call site, -1 if not resolved
+ *  @return if the log is enabled
+ */
+static inline int log_enabled(int level, const char* file, int* p_module)
+{
+    int module = __atomic_load_n(p_module, __ATOMIC_RELAXED);
+    if(module < 0)
+    {
+        module = log_module_register(file);
+        __atomic_store_n(p_module, module, __ATOMIC_RELAXED);
+    }
+    return (__atomic_load_n(log_module_mask + module, __ATOMIC_RELAXED) >> level) & 1;
+}
+
 /** @brief helper macros for write a log, do not use it directly */
 #define __LOG__(level,fmt,arg...) do{\
-        log_write(level,__FILE__,__FUNCTION__,__LINE__,fmt, ##arg);\
+        static int __log_module = -1;\
+        if(log_enabled(level, __FILE__, &__log_module))\
+            log_write(level,__FILE__,__FUNCTION__,__LINE__,fmt, ##arg);\
 }while(0)
 
 #ifndef LOG_LEVEL
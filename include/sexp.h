@@ -2,6 +2,7 @@
 #define __SEXP_H__
 #include <stdint.h>
 #include <stdlib.h>
+#include <constants.h>
 /**
  * @file sexp.h
  * @brief Utils for maintanance of S-Expression.
@@ -85,9 +86,75 @@ struct _sexpression_t {
  */
 const char* sexp_parse(const char* str, sexpression_t** buf);
 
+/** @brief callbacks for the event style parser.
+ *  @details The parser do not build the tree, it calls the callbacks instead:
+ *
+ *           "(a (b) c)" ==> begin_list, atom(a), begin_list, atom(b), end_list, atom(c), end_list
+ *
+ *           The seperator is the char right after the element, which is the same as
+ *           the seperator field of the cons that holds the element.
+ *
+ *           Any callback can be NULL, a negative return value stops the parser.
+ *           All strings passed to the callbacks are pooled strings.
+ */
+typedef struct {
+    /** a list begins */
+    int (*begin_list)(void* context);
+    /** a list ends */
+    int (*end_list)(void* context, char seperator);
+    /** a string (SEXP_TYPE_STR) or a literal (SEXP_TYPE_LIT) */
+    int (*atom)(void* context, int type, const char* value, char seperator);
+} sexp_event_handler_t;
+
+/**@brief Parse a S-Expression without building a tree, the parser is not recursive
+ * @param str String to parse
+ * @param handler the callbacks
+ * @param context the first argument passed to the callbacks
+ * @return The remaining string after current S-Expression has been parsed
+ *               NULL indicates an error
+ */
+const char* sexp_parse_events(const char* str, const sexp_event_handler_t* handler, void* context);
+
 /**@brief free memory for a S-Expression recursively */
 void sexp_free(sexpression_t* buf);
 
+/** @brief a memory arena for S-Expressions.
+ *  @details The S-Expression tree of a class is thrown away after the class
+ *           is built. So we can allocate all nodes of the tree from an arena
+ *           and release them at once, rather than calling malloc/free for 
+ *           each node. 
+ *
+ *           A S-Expression allocated in an arena must not be freed by sexp_free,
+ *           and it is invalid after the arena is reset or freed.
+ */
+typedef struct _sexp_arena_t sexp_arena_t;
+
+/** @brief create a new empty arena
+ *  @return the new arena, NULL means error
+ */
+sexp_arena_t* sexp_arena_new(void);
+
+/** @brief release all S-Expressions in the arena, but keep the memory for reuse
+ *  @param arena the arena
+ *  @return nothing
+ */
+void sexp_arena_reset(sexp_arena_t* arena);
+
+/** @brief free the arena and all S-Expressions allocated in it
+ *  @param arena the arena
+ *  @return nothing
+ */
+void sexp_arena_free(sexp_arena_t* arena);
+
+/**@brief Parse a string into sexpression, allocate memory from an arena
+ * @param arena the arena
+ * @param str String to parse
+ * @param buf the output buffer 
+ * @return The remaining string after current S-Expression has been parsed
+ *               NULL indicates an error
+ */
+const char* sexp_parse_arena(sexp_arena_t* arena, const char* str, sexpression_t** buf);
+
 /** 
  * @brief Check S-Expression matches a pattern 
  * @details Like printf function, pattern only describe the property of following function
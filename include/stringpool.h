@@ -13,6 +13,13 @@
  * In this project, only string read from file are not pooled. In this way, we always
  * compare two string by comparing thier address
  *
+ * The pool is an open addressing hash table which grows when it's half full, and the
+ * strings are stored in slab pages which are never moved, so the address of a pooled
+ * string never changes.
+ *
+ * All functions except init and finalize are safe to call from multiple threads. A lookup
+ * of a string which is already in the pool does not take any lock.
+ *
  */
 #include <constants.h>
 #include <stdint.h>
@@ -42,12 +49,13 @@ void stringpool_fianlize(void);
  * The user provide the char in the string one by one,
  * rather than provide an array of char .
  * This is more effctive way, when the program is scanning
- * a string
+ * a string, because we do not need to find the end of the 
+ * string again. The pooled string is the first count chars
+ * from begin, and the hash code is computed when the accumulator
+ * is queried.
  */
 typedef struct {
     int         count; /*!<how many chars recieved before */
-    uint32_t    h[4];  /*!<current hash functions */
-    uint32_t    last;  /*!<the last 4 bytes */
     const char* begin; /*!<begin of the string */
 } stringpool_accumulator_t;
 
@@ -59,34 +67,11 @@ typedef struct {
 void stringpool_accumulator_init(stringpool_accumulator_t* buf, const char* begin);
 /** @brief put a char to the accumulator
  * @param acc the accumulator
- * @param c   the char
+ * @param c   the char, which should be begin[count]
  * @return nothing
  */
 static inline void stringpool_accumulator_next(stringpool_accumulator_t* acc, char c)
 {
-    uint8_t data = (uint8_t)c;
-    /* TODO: Little endian */
-    if(acc->count%4 == 0 && acc->count != 0)
-    {
-        uint32_t k = acc->last;
-        k *= STRINGPOOL_MURMUR_C1;
-        k  = (k << STRINGPOOL_MURMUR_R1) | (k >> (32 - STRINGPOOL_MURMUR_R1));
-        k *= STRINGPOOL_MURMUR_C2;
-
-        acc->h[0] ^= k;
-        acc->h[0] *= (acc->h[0] << STRINGPOOL_MURMUR_R2) | 
-                     (acc->h[0] >> (32 - STRINGPOOL_MURMUR_R2)); 
-        acc->h[0] ^= acc->h[0] * STRINGPOOL_MURMUR_M + STRINGPOOL_MURMUR_N;
-    }
-    
-    acc->last = (acc->last >> 8) | (data<<24);   /* assume big endian */
-    
-    acc->h[1] = (acc->h[1] + data + (data << STRINGPOOL_SUM_R1) + (data >> STRINGPOOL_SUM_R2))%STRINGPOOL_SUM_M;
-    acc->h[2] = (acc->h[2] + data * data);
-    acc->h[3] = (acc->h[3] << 4) + data;
-    uint32_t g = acc->h[3] & STRINGPOOL_ELF_MSK;
-    if(g) acc->h[3] ^= g >> 24;
-    acc->h[3] &= ~g;
     acc->count ++;
 }
 /**@brief query current string
@@ -1,11 +1,16 @@
 #include <cesk/cesk.h>
 void cesk_init(void)
 {
+    cesk_object_init();
     cesk_value_init();
     cesk_set_init();
+    cesk_domain_init();
 }
 void cesk_finalize(void)
 {
+    cesk_reloc_finalize();
+    cesk_store_finalize();
     cesk_set_finalize();
     cesk_value_finalize();
+    cesk_object_finalize();
 }
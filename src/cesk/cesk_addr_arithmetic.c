@@ -0,0 +1,160 @@
+/**
+ * @file cesk_addr_arithmetic.c
+ * @brief the result tables of the address arithmetic
+ *
+ * @details An operator is defined by its result on single element sets, i.e.
+ *          the result of {x} op {y} for x, y in {NEG, ZERO, POS}. The result
+ *          on an arbitrary set is the union of the results of the elements.
+ *          Both are expanded by the preprocessor, so the tables are constant
+ *          data and nothing is computed at runtime.
+ */
+#include <cesk/cesk_addr_arithmetic.h>
+
+#define N CESK_STORE_ADDR_CONST_SUFFIX(CESK_STORE_ADDR_NEG)
+#define Z CESK_STORE_ADDR_CONST_SUFFIX(CESK_STORE_ADDR_ZERO)
+#define P CESK_STORE_ADDR_CONST_SUFFIX(CESK_STORE_ADDR_POS)
+#define T CESK_STORE_ADDR_CONST_SUFFIX(CESK_STORE_ADDR_TRUE)
+#define F CESK_STORE_ADDR_CONST_SUFFIX(CESK_STORE_ADDR_FALSE)
+#define ANY (N | Z | P)
+#define BOOL (T | F)
+
+/* The binary operators, the results of
+ * 		N op N, N op Z, N op P,
+ * 		Z op N, Z op Z, Z op P,
+ * 		P op N, P op Z, P op P
+ * 0 means the operation does not produce any value (e.g. divided by zero).
+ * The overflow is not considered, which is the same as other parts of the analyzer.
+ * For booleans, FALSE is the bit of ZERO and TRUE is the bit of POS, so the
+ * boolean operators are defined in the same way, and NEG is never a boolean */
+#define __CA_ADD \
+	N,   N, ANY, \
+	N,   Z, P,   \
+	ANY, P, P
+#define __CA_SUB \
+	ANY, N, N, \
+	P,   Z, N, \
+	P,   P, ANY
+#define __CA_RSUB \
+	ANY, P, P, \
+	N,   Z, P, \
+	N,   N, ANY
+#define __CA_MUL \
+	P, Z, N, \
+	Z, Z, Z, \
+	N, Z, P
+/* the integer division truncates the result, so 1 / 2 = 0 */
+#define __CA_DIV \
+	Z|P, 0, N|Z, \
+	Z,   0, Z,   \
+	N|Z, 0, Z|P
+/* the sign of the remainder is the sign of the dividend */
+#define __CA_REM \
+	N|Z, 0, N|Z, \
+	Z,   0, Z,   \
+	Z|P, 0, Z|P
+/* the result is negative iff the sign bits of both operands are set */
+#define __CA_BITWISE_AND \
+	N,   Z, Z|P, \
+	Z,   Z, Z,   \
+	Z|P, Z, Z|P
+#define __CA_BITWISE_OR \
+	N, N, N, \
+	N, Z, P, \
+	N, P, P
+#define __CA_BITWISE_XOR \
+	Z|P, N, N, \
+	N,   Z, P, \
+	N,   P, Z|P
+/* a shift by zero keeps the operand, otherwise any bit could be shifted into the sign bit,
+ * notice the shift distance is masked, so a nonzero distance might also be zero */
+#define __CA_SHL \
+	ANY, N, ANY, \
+	Z,   Z, Z,   \
+	ANY, P, ANY
+#define __CA_SHR \
+	N,   N, N,   \
+	Z,   Z, Z,   \
+	Z|P, P, Z|P
+#define __CA_USHR \
+	N|P, N, N|P, \
+	Z,   Z, Z,   \
+	Z|P, P, Z|P
+#define __CA_AND \
+	0, 0, 0, \
+	0, F, F, \
+	0, F, T
+#define __CA_OR \
+	0, 0, 0, \
+	0, F, T, \
+	0, T, T
+#define __CA_XOR \
+	0, 0, 0, \
+	0, F, T, \
+	0, T, F
+#define __CA_GT \
+	BOOL, F, F, \
+	T,    F, F, \
+	T,    T, BOOL
+#define __CA_GE \
+	BOOL, F, F, \
+	T,    T, F, \
+	T,    T, BOOL
+#define __CA_EQ \
+	BOOL, F, F, \
+	F,    T, F, \
+	F,    F, BOOL
+
+/* The unary operators, the results of op N, op Z, op P */
+#define __CA_NEG                  P, Z, N
+#define __CA_BITWISE_NEG          Z|P, N, N
+#define __CA_NOT                  0, T, F
+#define __CA_SIGN_BIT             T, F, F
+#define __CA_SIGN_BIT_TO_NUMERIC  0, Z|P, N
+
+/** @brief the result of a binary operator on the set a and the set b */
+#define __CA_LIFT2(a, b, nn, nz, np, zn, zz, zp, pn, pz, pp) ( \
+	(((a) & N) && ((b) & N) ? (nn) : 0) | (((a) & N) && ((b) & Z) ? (nz) : 0) | (((a) & N) && ((b) & P) ? (np) : 0) | \
+	(((a) & Z) && ((b) & N) ? (zn) : 0) | (((a) & Z) && ((b) & Z) ? (zz) : 0) | (((a) & Z) && ((b) & P) ? (zp) : 0) | \
+	(((a) & P) && ((b) & N) ? (pn) : 0) | (((a) & P) && ((b) & Z) ? (pz) : 0) | (((a) & P) && ((b) & P) ? (pp) : 0))
+/* the operator is expanded to the list of results before it is passed to __CA_LIFT2 */
+#define __CA_ROW(a, ...) {\
+	__CA_LIFT2(a, 0, __VA_ARGS__), __CA_LIFT2(a, 1, __VA_ARGS__), __CA_LIFT2(a, 2, __VA_ARGS__), __CA_LIFT2(a, 3, __VA_ARGS__), \
+	__CA_LIFT2(a, 4, __VA_ARGS__), __CA_LIFT2(a, 5, __VA_ARGS__), __CA_LIFT2(a, 6, __VA_ARGS__), __CA_LIFT2(a, 7, __VA_ARGS__)}
+#define __CA_BINOP(op) [CESK_ADDR_ARITHMETIC_##op] = {\
+	__CA_ROW(0, __CA_##op), __CA_ROW(1, __CA_##op), __CA_ROW(2, __CA_##op), __CA_ROW(3, __CA_##op), \
+	__CA_ROW(4, __CA_##op), __CA_ROW(5, __CA_##op), __CA_ROW(6, __CA_##op), __CA_ROW(7, __CA_##op)}
+
+/** @brief the result of an unary operator on the set a */
+#define __CA_LIFT1(a, n, z, p) (((a) & N ? (n) : 0) | ((a) & Z ? (z) : 0) | ((a) & P ? (p) : 0))
+#define __CA_LIFT1_ALL(...) {\
+	__CA_LIFT1(0, __VA_ARGS__), __CA_LIFT1(1, __VA_ARGS__), __CA_LIFT1(2, __VA_ARGS__), __CA_LIFT1(3, __VA_ARGS__), \
+	__CA_LIFT1(4, __VA_ARGS__), __CA_LIFT1(5, __VA_ARGS__), __CA_LIFT1(6, __VA_ARGS__), __CA_LIFT1(7, __VA_ARGS__)}
+#define __CA_UNOP(op) [CESK_ADDR_ARITHMETIC_##op] = __CA_LIFT1_ALL(__CA_##op)
+
+const uint8_t cesk_addr_arithmetic_binop_table[CESK_ADDR_ARITHMETIC_NUM_BINOPS][8][8] = {
+	__CA_BINOP(ADD),
+	__CA_BINOP(SUB),
+	__CA_BINOP(RSUB),
+	__CA_BINOP(MUL),
+	__CA_BINOP(DIV),
+	__CA_BINOP(REM),
+	__CA_BINOP(BITWISE_AND),
+	__CA_BINOP(BITWISE_OR),
+	__CA_BINOP(BITWISE_XOR),
+	__CA_BINOP(SHL),
+	__CA_BINOP(SHR),
+	__CA_BINOP(USHR),
+	__CA_BINOP(AND),
+	__CA_BINOP(OR),
+	__CA_BINOP(XOR),
+	__CA_BINOP(GT),
+	__CA_BINOP(GE),
+	__CA_BINOP(EQ)
+};
+const uint8_t cesk_addr_arithmetic_unop_table[CESK_ADDR_ARITHMETIC_NUM_UNOPS][8] = {
+	__CA_UNOP(NEG),
+	__CA_UNOP(BITWISE_NEG),
+	__CA_UNOP(NOT),
+	__CA_UNOP(SIGN_BIT),
+	__CA_UNOP(SIGN_BIT_TO_NUMERIC)
+};
@@ -5,20 +5,202 @@
 #include <cesk/cesk_frame.h>
 #include <cesk/cesk_block.h>
 #include <cesk/cesk_addr_arithmetic.h>
-/** @brief the buffer holds all nodes of graph when the graph is constructing */
-static cesk_block_t* _cesk_block_buf[DALVIK_BLOCK_MAX_KEYS];
-/** @brief the maximum code block index, used for building a graph */
-static int32_t      _cesk_block_max_idx;
+#include <cesk/cesk_domain.h>
+/** @brief the buffer holds all nodes of graph when the graph is constructing, 
+ *         we do not use a global buffer, because graphs might be built by different threads */
+typedef struct {
+	cesk_block_t* nodes[DALVIK_BLOCK_MAX_KEYS];  /*!<the nodes of the graph, indexed by the code block index */
+	int32_t       max_idx;                       /*!<the maximum code block index, used for building a graph */
+} _cesk_block_buf_t;
+/** @brief the list of handlers, the handler of an instruction is selected by the opcode
+ *         and the flags when the instruction is lowered */
+#define __CB_HANDLERS(H) \
+	H(INVALID) H(NOP) H(MOVE) H(CONST) H(CONST_STRING) H(MONITOR) H(CHECK_CAST) H(THROW) H(CMP) H(ARRAY) \
+	H(INSTANCE_OF) H(INSTANCE_GET) H(INSTANCE_PUT) H(INSTANCE_NEW) H(INSTANCE_STATIC) \
+	H(UNOP_NEG) H(UNOP_NOT) H(UNOP_TO) \
+	H(BINOP_ADD) H(BINOP_SUB) H(BINOP_MUL) H(BINOP_DIV) H(BINOP_REM) H(BINOP_AND) H(BINOP_OR) H(BINOP_XOR) \
+	H(BINOP_SHR) H(BINOP_SHL) H(BINOP_USHR) H(BINOP_RSUB)
+#define __CB_ENUM(name) _CESK_BLOCK_HANDLER_##name,
+/** @brief the handler index */
+enum {
+	__CB_HANDLERS(__CB_ENUM)
+	_CESK_BLOCK_NUM_HANDLERS
+};
+#undef __CB_ENUM
+/** @brief the dispatch mode of the interpreter */
+static int _cesk_block_dispatch = CESK_BLOCK_THREADED_DISPATCH ? CESK_BLOCK_DISPATCH_THREADED : CESK_BLOCK_DISPATCH_SWITCH;
+/** @brief convert an register referencing operand to index of register */
+static inline uint32_t _cesk_block_operand_to_regidx(const dalvik_operand_t* operand)
+{
+	if(operand->header.info.is_const)
+	{
+		LOG_ERROR("can not convert a constant operand to register index");
+		return CESK_STORE_ADDR_NULL;
+	}
+	/* the exception type is special, it just means we want to use the exception register */
+	if(operand->header.info.type == DVM_OPERAND_TYPE_EXCEPTION)
+	{
+		return CESK_FRAME_EXCEPTION_REG;
+	}
+	else if(operand->header.info.is_result)
+	{
+		return CESK_FRAME_RESULT_REG;
+	}
+	else 
+	{
+		/* general registers */
+		return CESK_FRAME_GENERAL_REG(operand->payload.uint16);
+	}
+}
+/** @brief lower an operand which is either a constant or a register to the argument of the code */
+static inline void _cesk_block_lower_value(const dalvik_operand_t* operand, cesk_block_code_t* code, int i)
+{
+	if(operand->header.info.is_const)
+	{
+		code->args[i] = cesk_store_const_addr_from_operand(operand);
+		code->konst |= (1 << i);
+	}
+	else
+		code->args[i] = _cesk_block_operand_to_regidx(operand);
+}
+/** @brief check if the operand is a real number */
+static inline int _cesk_block_operand_is_real(const dalvik_operand_t* operand)
+{
+	return DVM_OPERAND_TYPE_FLOAT == operand->header.info.type || DVM_OPERAND_TYPE_DOUBLE == operand->header.info.type;
+}
+/** @brief select the handler for the instruction */
+static inline uint8_t _cesk_block_lower_handler(const dalvik_instruction_t* inst)
+{
+#define __CB_SELECT(flag, name) case flag: return _CESK_BLOCK_HANDLER_##name
+	switch(inst->opcode)
+	{
+		__CB_SELECT(DVM_NOP, NOP);
+		__CB_SELECT(DVM_MOVE, MOVE);
+		__CB_SELECT(DVM_MONITOR, MONITOR);
+		__CB_SELECT(DVM_CHECK_CAST, CHECK_CAST);
+		__CB_SELECT(DVM_THROW, THROW);
+		__CB_SELECT(DVM_CMP, CMP);
+		__CB_SELECT(DVM_ARRAY, ARRAY);
+		case DVM_CONST:
+			if(inst->operands[1].header.info.type == DVM_OPERAND_TYPE_STRING)
+				return _CESK_BLOCK_HANDLER_CONST_STRING;
+			return _CESK_BLOCK_HANDLER_CONST;
+		case DVM_INSTANCE:
+			switch(inst->flags)
+			{
+				__CB_SELECT(DVM_FLAG_INSTANCE_OF, INSTANCE_OF);
+				__CB_SELECT(DVM_FLAG_INSTANCE_GET, INSTANCE_GET);
+				__CB_SELECT(DVM_FLAG_INSTANCE_PUT, INSTANCE_PUT);
+				__CB_SELECT(DVM_FLAG_INSTANCE_NEW, INSTANCE_NEW);
+				__CB_SELECT(DVM_FLAG_INSTANCE_SGET, INSTANCE_STATIC);
+				__CB_SELECT(DVM_FLAG_INSTANCE_SPUT, INSTANCE_STATIC);
+			}
+			break;
+		case DVM_UNOP:
+			switch(inst->flags)
+			{
+				__CB_SELECT(DVM_FLAG_UOP_NEG, UNOP_NEG);
+				__CB_SELECT(DVM_FLAG_UOP_NOT, UNOP_NOT);
+				__CB_SELECT(DVM_FLAG_UOP_TO, UNOP_TO);
+			}
+			break;
+		case DVM_BINOP:
+			switch(inst->flags)
+			{
+				__CB_SELECT(DVM_FLAG_BINOP_ADD, BINOP_ADD);
+				__CB_SELECT(DVM_FLAG_BINOP_SUB, BINOP_SUB);
+				__CB_SELECT(DVM_FLAG_BINOP_MUL, BINOP_MUL);
+				__CB_SELECT(DVM_FLAG_BINOP_DIV, BINOP_DIV);
+				__CB_SELECT(DVM_FLAG_BINOP_REM, BINOP_REM);
+				__CB_SELECT(DVM_FLAG_BINOP_AND, BINOP_AND);
+				__CB_SELECT(DVM_FLAG_BINOP_OR, BINOP_OR);
+				__CB_SELECT(DVM_FLAG_BINOP_XOR, BINOP_XOR);
+				__CB_SELECT(DVM_FLAG_BINOP_SHR, BINOP_SHR);
+				__CB_SELECT(DVM_FLAG_BINOP_SHL, BINOP_SHL);
+				__CB_SELECT(DVM_FLAG_BINOP_USHR, BINOP_USHR);
+				__CB_SELECT(DVM_FLAG_BINOP_RSUB, BINOP_RSUB);
+			}
+			break;
+	}
+#undef __CB_SELECT
+	return _CESK_BLOCK_HANDLER_INVALID;
+}
+/** @brief lower an instruction to the pre-decoded form */
+static inline void _cesk_block_lower(const dalvik_instruction_t* inst, cesk_block_code_t* code)
+{
+	memset(code, 0, sizeof(cesk_block_code_t));
+	code->opcode = inst->opcode;
+	code->flags  = inst->flags;
+	code->inst   = inst;
+	code->handler = _cesk_block_lower_handler(inst);
+	switch(inst->opcode)
+	{
+		case DVM_MOVE:
+			code->args[0] = _cesk_block_operand_to_regidx(inst->operands + 0);
+			code->args[1] = _cesk_block_operand_to_regidx(inst->operands + 1);
+			break;
+		case DVM_CONST:
+			code->args[0] = _cesk_block_operand_to_regidx(inst->operands + 0);
+			/* the string constant is not supported yet */
+			if(_CESK_BLOCK_HANDLER_CONST == code->handler)
+			{
+				code->args[1] = cesk_store_const_addr_from_operand(inst->operands + 1);
+				code->konst = 2;
+			}
+			break;
+		case DVM_CMP:
+		case DVM_BINOP:
+			code->args[0] = _cesk_block_operand_to_regidx(inst->operands + 0);
+			_cesk_block_lower_value(inst->operands + 1, code, 1);
+			_cesk_block_lower_value(inst->operands + 2, code, 2);
+			if(_cesk_block_operand_is_real(inst->operands + 1)) code->konst |= CESK_BLOCK_CODE_REAL;
+			break;
+		case DVM_UNOP:
+			code->args[0] = _cesk_block_operand_to_regidx(inst->operands + 0);
+			_cesk_block_lower_value(inst->operands + 1, code, 1);
+			if(_cesk_block_operand_is_real(inst->operands + 1)) code->konst |= CESK_BLOCK_CODE_REAL;
+			break;
+		case DVM_INSTANCE:
+			switch(inst->flags)
+			{
+				case DVM_FLAG_INSTANCE_OF:
+				case DVM_FLAG_INSTANCE_GET:
+				case DVM_FLAG_INSTANCE_PUT:
+					code->args[0] = _cesk_block_operand_to_regidx(inst->operands + 0);
+					code->args[1] = _cesk_block_operand_to_regidx(inst->operands + 1);
+					break;
+				case DVM_FLAG_INSTANCE_NEW:
+					code->args[0] = _cesk_block_operand_to_regidx(inst->operands + 0);
+					break;
+			}
+			break;
+	}
+}
+/** @brief lower all instructions in the code block */
+static inline cesk_block_code_t* _cesk_block_lower_block(const dalvik_block_t* block)
+{
+	size_t n = block->end - block->begin;
+	cesk_block_code_t* ret = (cesk_block_code_t*)malloc(sizeof(cesk_block_code_t) * (n ? n : 1));
+	if(NULL == ret)
+	{
+		LOG_ERROR("can not allocate memory for the pre-decoded instructions of block %d", block->index);
+		return NULL;
+	}
+	int i;
+	for(i = 0; i < n; i ++)
+		_cesk_block_lower(dalvik_instruction_get(block->begin + i), ret + i);
+	return ret;
+}
 /** @brief implementation of analyzer block construction */
-static inline int _cesk_block_graph_new_imp(const dalvik_block_t* entry)
+static inline int _cesk_block_graph_new_imp(const dalvik_block_t* entry, _cesk_block_buf_t* buf)
 {
-    if(NULL != _cesk_block_buf[entry->index]) 
+    if(NULL != buf->nodes[entry->index]) 
     {
         /* the block has been visited */
         return 0;
     }
     
-    if(_cesk_block_max_idx < entry->index) _cesk_block_max_idx = entry->index;
+    if(buf->max_idx < (int32_t)entry->index) buf->max_idx = entry->index;
 
     size_t size = sizeof(cesk_block_t) + sizeof(cesk_block_t*) * entry->nbranches;
 
@@ -30,11 +212,18 @@ static inline int _cesk_block_graph_new_imp(const dalvik_block_t* entry)
         return -1;
     }
     
-    _cesk_block_buf[entry->index] = ret;
+    buf->nodes[entry->index] = ret;
     
     ret->code_block = entry;
+    ret->code = _cesk_block_lower_block(entry);
     ret->input = cesk_frame_new(entry->nregs);
 
+	if(NULL == ret->code)
+	{
+		LOG_ERROR("can not lower the instructions in the block");
+		return -1;
+	}
+
 	if(NULL == ret->input)
 	{
 		LOG_ERROR("can not create stack frame for the block");
@@ -45,7 +234,7 @@ static inline int _cesk_block_graph_new_imp(const dalvik_block_t* entry)
     for(i = 0; i < entry->nbranches; i ++)
     {
         if(entry->branches[i].disabled) continue;
-        if(-1 == _cesk_block_graph_new_imp(entry->branches[i].block)) 
+        if(-1 == _cesk_block_graph_new_imp(entry->branches[i].block, buf)) 
             return -1;
     }
     return 0;
@@ -54,84 +243,83 @@ cesk_block_t* cesk_block_graph_new(const dalvik_block_t* entry)
 {
     if(NULL == entry)
         return NULL;
-    memset(_cesk_block_buf, 0, sizeof(_cesk_block_buf));
-    _cesk_block_max_idx = -1;
+    _cesk_block_buf_t* buf = (_cesk_block_buf_t*)calloc(1, sizeof(_cesk_block_buf_t));
+    if(NULL == buf)
+    {
+        LOG_ERROR("can not allocate memory for graph construction");
+        return NULL;
+    }
+    buf->max_idx = -1;
     
-    _cesk_block_graph_new_imp(entry);
+    _cesk_block_graph_new_imp(entry, buf);
 
     int i;
 
-    for(i = 0; i <= _cesk_block_max_idx; i ++)
-        if(_cesk_block_buf[i] != NULL)
+    for(i = 0; i <= buf->max_idx; i ++)
+        if(buf->nodes[i] != NULL)
         {
             int j;
-            for(j = 0; j < _cesk_block_buf[i]->code_block->nbranches; j ++)
+            for(j = 0; j < buf->nodes[i]->code_block->nbranches; j ++)
             {
-				_cesk_block_buf[i]->fanout[j] = NULL;
-                if(_cesk_block_buf[i]->code_block->branches[j].disabled) continue;
+				buf->nodes[i]->fanout[j] = NULL;
+                if(buf->nodes[i]->code_block->branches[j].disabled) continue;
 				/* the index of next block */
-				uint32_t next_block = _cesk_block_buf[i]->code_block->branches[j].block->index;
-                _cesk_block_buf[i]->fanout[j]  = _cesk_block_buf[next_block];
+				uint32_t next_block = buf->nodes[i]->code_block->branches[j].block->index;
+                buf->nodes[i]->fanout[j]  = buf->nodes[next_block];
             }
         }
-    return _cesk_block_buf[entry->index];
+    cesk_block_t* ret = buf->nodes[entry->index];
+    free(buf);
+    return ret;
 }
-void _cesk_block_graph_free_imp(cesk_block_t* node)
+static inline void _cesk_block_graph_free_imp(cesk_block_t* node, _cesk_block_buf_t* buf)
 {
 	if(NULL == node->input)
 	{
 		/* the node is already visited */
 		return;
 	}
-	_cesk_block_buf[_cesk_block_max_idx++] = node;
+	buf->nodes[buf->max_idx++] = node;
 	int i;
 	cesk_frame_free(node->input);
 	node->input = NULL;
 	for(i = 0; i < node->code_block->nbranches; i ++)
 	{
 		if(node->fanout[i] != NULL)
-			_cesk_block_graph_free_imp(node->fanout[i]);
+			_cesk_block_graph_free_imp(node->fanout[i], buf);
 	}
 }
 void cesk_block_graph_free(cesk_block_t* graph)
 {
-	_cesk_block_max_idx = 0;
+	if(NULL == graph) return;
+    _cesk_block_buf_t* buf = (_cesk_block_buf_t*)malloc(sizeof(_cesk_block_buf_t));
+    if(NULL == buf)
+    {
+        LOG_ERROR("can not allocate memory for graph destruction");
+        return;
+    }
+	buf->max_idx = 0;
 	int i;
-	_cesk_block_graph_free_imp(graph);
-	for(i = 0; i < _cesk_block_max_idx; i ++)
-		free(_cesk_block_buf[i]);
-}
-#define __CB_HANDLER(name) static inline int _cesk_block_interpreter_handler_##name(const dalvik_instruction_t* inst, cesk_frame_t* output)
-#define __CB_INST(name) case DVM_##name: rc = _cesk_block_interpreter_handler_##name(inst, frame); break
-/** @brief convert an register referencing operand to index of register */
-static inline uint32_t _cesk_block_operand_to_regidx(const dalvik_operand_t* operand)
-{
-	if(operand->header.info.is_const)
+	_cesk_block_graph_free_imp(graph, buf);
+	for(i = 0; i < buf->max_idx; i ++)
 	{
-		LOG_ERROR("can not convert a constant operand to register index");
-		return CESK_STORE_ADDR_NULL;
-	}
-	/* the exception type is special, it just means we want to use the exception register */
-	if(operand->header.info.type == DVM_OPERAND_TYPE_EXCEPTION)
-	{
-		return CESK_FRAME_EXCEPTION_REG;
-	}
-	else if(operand->header.info.is_result)
-	{
-		return CESK_FRAME_RESULT_REG;
-	}
-	else 
-	{
-		/* general registers */
-		return CESK_FRAME_GENERAL_REG(operand->payload.uint16);
+		free(buf->nodes[i]->code);
+		free(buf->nodes[i]);
 	}
+	free(buf);
+}
+#define __CB_HANDLER(name) static inline int _cesk_block_interpreter_handler_##name(const cesk_block_code_t* code, cesk_frame_t* frame)
+__CB_HANDLER(INVALID)
+{
+	LOG_ERROR("unsupported instruction (opcode = 0x%x, flags = 0x%x)", code->opcode, code->flags);
+	return -1;
 }
 __CB_HANDLER(MOVE)
 {
-	uint32_t dest = _cesk_block_operand_to_regidx(inst->operands + 0);
-	uint32_t sour = _cesk_block_operand_to_regidx(inst->operands + 1);
+	uint32_t dest = code->args[0];
+	uint32_t sour = code->args[1];
 	LOG_DEBUG("current operation: move register %d --> register %d", sour, dest);
-	cesk_frame_register_move(output, inst, dest, sour);  
+	cesk_frame_register_move(frame, code->inst, dest, sour);  
 	return 0;
 }
 __CB_HANDLER(NOP)
@@ -141,17 +329,17 @@ __CB_HANDLER(NOP)
 }
 __CB_HANDLER(CONST)
 {
-	uint32_t dest = _cesk_block_operand_to_regidx(inst->operands + 0);
-	if(inst->operands[1].header.info.type == DVM_OPERAND_TYPE_STRING)
-	{
-		LOG_TRACE("fixme : string constant requires implementation of java/lang/String");
-		return 0;
-	}
-	uint32_t sour = cesk_store_const_addr_from_operand(&inst->operands[1]);
+	uint32_t dest = code->args[0];
+	uint32_t sour = code->args[1];
 
 	LOG_DEBUG("current operation: load constant @0x%x --> register %d", sour, dest);
 	
-	return cesk_frame_register_load(output, inst, dest, sour); 
+	return cesk_frame_register_load(frame, code->inst, dest, sour); 
+}
+__CB_HANDLER(CONST_STRING)
+{
+	LOG_TRACE("fixme : string constant requires implementation of java/lang/String");
+	return 0;
 }
 __CB_HANDLER(MONITOR)
 {
@@ -171,22 +359,28 @@ __CB_HANDLER(THROW)
 	LOG_TRACE("fixme: throw is a part of execption system");
 	return 0;
 }
-/** @brief convert a operand to an address, this actually require the operand 
+/** @brief the numeric domain used by the code */
+static inline const cesk_domain_t* _cesk_block_domain(const cesk_block_code_t* code)
+{
+	return (code->konst & CESK_BLOCK_CODE_REAL) ? &cesk_domain_sign : cesk_domain_get();
+}
+/** @brief convert an argument of the code to an address, this actually require the argument 
  * 		   is either a constant or a register which constains atomtic value.
- * 		   Otherwise you may get unexcepted result
+ * 		   Otherwise you may get unexcepted result. The values in the register are joined
+ * 		   in the numeric domain
  */
-static inline uint32_t _cesk_block_operand_to_addr(cesk_frame_t* frame,const dalvik_operand_t* val)
+static inline uint32_t _cesk_block_arg_to_addr(cesk_frame_t* frame, const cesk_block_code_t* code, int i)
 {
-	if(val->header.info.is_const)
+	if(CESK_BLOCK_CODE_IS_CONST(code, i))
 	{
-		/* if the value is a constant value */
-		return cesk_store_const_addr_from_operand(val);
+		/* if the value is a constant value, it has been resolved */
+		return code->args[i];
 	}
 	else
 	{
 		/* if it refer to a register */
-		uint32_t reg = _cesk_block_operand_to_regidx(val);
-		if(reg < 0 || reg > frame->size) 
+		uint32_t reg = code->args[i];
+		if(reg >= frame->size) 
 		{
 			LOG_ERROR("invalid register reference %d", reg);
 			return CESK_STORE_ADDR_NULL;
@@ -197,6 +391,7 @@ static inline uint32_t _cesk_block_operand_to_addr(cesk_frame_t* frame,const dal
 			LOG_ERROR("can not get a iterator for register %d", reg);
 			return CESK_STORE_ADDR_NULL;
 		}
+		const cesk_domain_t* domain = _cesk_block_domain(code);
 		uint32_t ret = 0;
 		uint32_t addr;
 		while((addr = cesk_set_iter_next(&iter)) != CESK_STORE_ADDR_NULL)
@@ -206,7 +401,7 @@ static inline uint32_t _cesk_block_operand_to_addr(cesk_frame_t* frame,const dal
 				LOG_WARNING("the address @%x is not a value constant address, ignoring", addr);
 				continue;
 			}
-			ret |= addr;
+			ret = (0 == ret) ? addr : domain->join(ret, addr);
 		}
 		if(0 == ret)
 		{
@@ -218,30 +413,35 @@ static inline uint32_t _cesk_block_operand_to_addr(cesk_frame_t* frame,const dal
 }
 __CB_HANDLER(CMP)
 {
-	uint32_t dest = _cesk_block_operand_to_regidx(inst->operands + 0);
-	uint32_t val1 = _cesk_block_operand_to_addr(output, inst->operands + 1);
-	uint32_t val2 = _cesk_block_operand_to_addr(output, inst->operands + 2);
+	uint32_t dest = code->args[0];
+	uint32_t val1 = _cesk_block_arg_to_addr(frame, code, 1);
+	uint32_t val2 = _cesk_block_arg_to_addr(frame, code, 2);
 
 	LOG_DEBUG("current operation: compare address@0x%x to address@0x%x", val1, val2);
 
-	uint32_t res  = cesk_addr_arithmetic_sub(val1, val2);
+	/* the result is -1, 0 or 1 */
+	const cesk_domain_t* domain = _cesk_block_domain(code);
+	int outcomes = domain->compare(val1, val2);
+	uint32_t res = CESK_STORE_ADDR_EMPTY;
+	if(outcomes & CESK_DOMAIN_LT) res = domain->join(res, domain->from_int(-1));
+	if(outcomes & CESK_DOMAIN_EQ) res = domain->join(res, domain->from_int(0));
+	if(outcomes & CESK_DOMAIN_GT) res = domain->join(res, domain->from_int(1));
 
 	if(res == CESK_STORE_ADDR_CONST_PREFIX)
 	{
 		LOG_WARNING("the result set is empty, just clear the register");
-		cesk_frame_register_clear(output, inst, dest);
+		cesk_frame_register_clear(frame, code->inst, dest);
 		return 0;
 	}
-	cesk_frame_register_load(output, inst, dest, res);
+	cesk_frame_register_load(frame, code->inst, dest, res);
 	return 0;
 }
-static inline int _cesk_block_handler_instance_of(const dalvik_instruction_t* inst, cesk_frame_t* frame)
+__CB_HANDLER(INSTANCE_OF)
 {
 	/* (instance-of result, object, type) */
-	//uint32_t dst = inst->operands[0].payload.uint32;
-	//uint32_t src = inst->operands[1].payload.uint32;
-	uint32_t dst = _cesk_block_operand_to_regidx(inst->operands + 0);
-	uint32_t src = _cesk_block_operand_to_regidx(inst->operands + 1);
+	const dalvik_instruction_t* inst = code->inst;
+	uint32_t dst = code->args[0];
+	uint32_t src = code->args[1];
 
 	cesk_set_iter_t iter;
 	if(NULL == cesk_set_iter(frame->regs[src],&iter))
@@ -302,10 +502,11 @@ static inline int _cesk_block_handler_instance_of(const dalvik_instruction_t* in
 	LOG_ERROR("invalid operand");
 	return -1;
 }
-static inline int _cesk_block_handler_instance_get(const dalvik_instruction_t* inst, cesk_frame_t* frame)
+__CB_HANDLER(INSTANCE_GET)
 {
-	uint32_t dest = _cesk_block_operand_to_regidx(&inst->operands[0]);
-	uint32_t sour = _cesk_block_operand_to_regidx(&inst->operands[1]);
+	const dalvik_instruction_t* inst = code->inst;
+	uint32_t dest = code->args[0];
+	uint32_t sour = code->args[1];
 	const char* classpath = inst->operands[2].payload.methpath;
 	const char* fieldname = inst->operands[3].payload.methpath;
 	dalvik_type_t* type   = inst->operands[4].payload.type;
@@ -331,6 +532,8 @@ static inline int _cesk_block_handler_instance_get(const dalvik_instruction_t* i
 		return -1;
 	}
 
+	/* the field is resolved once, and the result is cached in the instruction */
+	cesk_object_field_ref_t field = cesk_object_field_resolve_cached(inst, classpath, fieldname);
 	uint32_t addr;
 	if(cesk_frame_register_clear(frame, inst, dest) < 0)
 	{
@@ -350,23 +553,22 @@ static inline int _cesk_block_handler_instance_get(const dalvik_instruction_t* i
 			LOG_WARNING("can not get a class memeber from an non-class type");
 			continue;
 		}
-		const cesk_object_t* object = val_obj->pointer.object;
-
-		uint32_t paddr;
-		if(cesk_object_get_addr(object, classpath, fieldname, &paddr) < 0)
+		const uint32_t* paddr = cesk_object_field(val_obj->pointer.object, classpath, field);
+		if(NULL == paddr)
 		{
 			LOG_ERROR("can not get member %s/%s", classpath, fieldname);
 			continue;
 		}
-		if(paddr == CESK_STORE_ADDR_NULL) continue;
-		cesk_frame_register_append_from_store(frame, inst, dest, paddr);
+		if(*paddr == CESK_STORE_ADDR_NULL) continue;
+		cesk_frame_register_append_from_store(frame, inst, dest, *paddr);
 	}
 	return 0;
 }
-static inline int _cesk_block_handler_instance_put(const dalvik_instruction_t* inst, cesk_frame_t* frame)
+__CB_HANDLER(INSTANCE_PUT)
 {
-	uint32_t sour = _cesk_block_operand_to_regidx(&inst->operands[0]);
-	uint32_t dest = _cesk_block_operand_to_regidx(&inst->operands[1]);
+	const dalvik_instruction_t* inst = code->inst;
+	uint32_t sour = code->args[0];
+	uint32_t dest = code->args[1];
 	const char* classpath = inst->operands[2].payload.methpath;
 	const char* fieldname = inst->operands[3].payload.methpath;
 	dalvik_type_t* type = inst->operands[4].payload.type;
@@ -396,9 +598,10 @@ static inline int _cesk_block_handler_instance_put(const dalvik_instruction_t* i
 	}
 	return 0;
 }
-static inline int _cesk_block_handler_instance_new(const dalvik_instruction_t* inst, cesk_frame_t* frame)
+__CB_HANDLER(INSTANCE_NEW)
 {
-	uint32_t dest = _cesk_block_operand_to_regidx(inst->operands + 0);
+	const dalvik_instruction_t* inst = code->inst;
+	uint32_t dest = code->args[0];
 	const char* classpath = inst->operands[1].payload.methpath;
 	if(NULL == classpath || dest >= frame->size)
 	{
@@ -415,140 +618,358 @@ static inline int _cesk_block_handler_instance_new(const dalvik_instruction_t* i
 	cesk_frame_register_load(frame, inst , dest, objaddr);
 	return 0;
 }
-__CB_HANDLER(INSTANCE)
-{
-	switch(inst->flags)
-	{
-		case DVM_FLAG_INSTANCE_OF:
-			return _cesk_block_handler_instance_of(inst, output);
-		case DVM_FLAG_INSTANCE_GET:
-			return _cesk_block_handler_instance_get(inst, output);
-		case DVM_FLAG_INSTANCE_PUT:
-			return _cesk_block_handler_instance_put(inst, output);
-		case DVM_FLAG_INSTANCE_NEW:
-			return _cesk_block_handler_instance_new(inst, output);
-		case DVM_FLAG_INSTANCE_SPUT:
-		case DVM_FLAG_INSTANCE_SGET:
-			/* TODO */
-			LOG_TRACE("fixme : static variable table & static instruction support");
-			return 0;
-	}
-	LOG_ERROR("unknown instruction flags 0x%x for opcode = INSTANCE", inst->flags);
-	return -1;
+__CB_HANDLER(INSTANCE_STATIC)
+{
+	/* TODO */
+	LOG_TRACE("fixme : static variable table & static instruction support");
+	return 0;
 }
 __CB_HANDLER(ARRAY)
 {
 	LOG_TRACE("fixme: array support");
 	return 0;
 }
-__CB_HANDLER(UNOP)
+/** @brief the common part of the unary operators, op is the arithmetic operator, or -1 for type conversion */
+static inline int _cesk_block_unop(const cesk_block_code_t* code, cesk_frame_t* frame, int op)
 {
-	uint32_t sour_addr = _cesk_block_operand_to_addr(output, inst->operands + 0);
-	uint32_t dest_reg  = _cesk_block_operand_to_regidx(inst->operands + 1);
+	uint32_t sour_addr = _cesk_block_arg_to_addr(frame, code, 1);
+	uint32_t dest_reg  = code->args[0];
 	if(sour_addr == CESK_STORE_ADDR_CONST_PREFIX || sour_addr == CESK_STORE_ADDR_NULL)
 	{
 		LOG_ERROR("can not perforam unop");
 		return -1;
 	}
-	uint32_t res_addr = CESK_STORE_ADDR_CONST_PREFIX;
-	switch(inst->flags)
-	{
-		case DVM_FLAG_UOP_NEG:
-			res_addr = cesk_addr_arithmetic_neg(sour_addr);
-			break;
-		case DVM_FLAG_UOP_NOT:
-			res_addr = cesk_addr_arithmetic_not(sour_addr);
-			break;
-		case DVM_FLAG_UOP_TO:
-			res_addr = sour_addr;
-	}
+	/* the type conversion might change the value, so only the sign is kept */
+	uint32_t res_addr = (op < 0) ? cesk_domain_sign_of(sour_addr) : _cesk_block_domain(code)->unop(op, sour_addr);
 	if(res_addr == CESK_STORE_ADDR_CONST_PREFIX)
 	{
 		LOG_ERROR("invalid result address");
 		return -1;
 	}
-	return cesk_frame_register_load_from_store(output, inst, dest_reg, res_addr);
+	return cesk_frame_register_load(frame, code->inst, dest_reg, res_addr);
+}
+__CB_HANDLER(UNOP_NEG)
+{
+	return _cesk_block_unop(code, frame, CESK_ADDR_ARITHMETIC_NEG);
 }
-__CB_HANDLER(BINOP)
+__CB_HANDLER(UNOP_NOT)
 {
-	uint32_t dest = _cesk_block_operand_to_regidx(inst->operands + 0);
-	uint32_t sour1 = _cesk_block_operand_to_addr(output, inst->operands + 1);
-	uint32_t sour2 = _cesk_block_operand_to_addr(output, inst->operands + 2);
-	uint32_t res = 0;
-	switch(inst->flags)
+	/* not-int and not-long are bitwise operators */
+	return _cesk_block_unop(code, frame, CESK_ADDR_ARITHMETIC_BITWISE_NEG);
+}
+__CB_HANDLER(UNOP_TO)
+{
+	return _cesk_block_unop(code, frame, -1);
+}
+/** @brief the common part of the binary operators, the result is computed by the numeric domain */
+static inline int _cesk_block_binop(const cesk_block_code_t* code, cesk_frame_t* frame, int op)
+{
+	uint32_t sour1 = _cesk_block_arg_to_addr(frame, code, 1);
+	uint32_t sour2 = _cesk_block_arg_to_addr(frame, code, 2);
+	return cesk_frame_register_load(frame, code->inst, code->args[0], _cesk_block_domain(code)->binop(op, sour1, sour2));
+}
+#define __CB_BINOP(name, op) __CB_HANDLER(BINOP_##name) { return _cesk_block_binop(code, frame, CESK_ADDR_ARITHMETIC_##op); }
+__CB_BINOP(ADD,  ADD)
+__CB_BINOP(SUB,  SUB)
+__CB_BINOP(MUL,  MUL)
+__CB_BINOP(DIV,  DIV)
+__CB_BINOP(REM,  REM)
+__CB_BINOP(AND,  BITWISE_AND)
+__CB_BINOP(OR,   BITWISE_OR)
+__CB_BINOP(XOR,  BITWISE_XOR)
+__CB_BINOP(SHR,  SHR)
+__CB_BINOP(SHL,  SHL)
+__CB_BINOP(USHR, USHR)
+__CB_BINOP(RSUB, RSUB)
+#undef __CB_BINOP
+/** @brief trace the instruction going to be interpreted */
+#define __CB_TRACE(code) LOG_DEBUG("current instruction: %s", dalvik_instruction_to_string((code)->inst, NULL, 0))
+/** @brief interpret the code with a switch statement */
+static inline void _cesk_block_interpret_switch(const cesk_block_code_t* code, const cesk_block_code_t* end, cesk_frame_t* frame)
+{
+#define __CB_CASE(name) case _CESK_BLOCK_HANDLER_##name: rc = _cesk_block_interpreter_handler_##name(code, frame); break;
+	for(; code < end; code ++)
 	{
-		case DVM_FLAG_BINOP_ADD:
-			res = cesk_addr_arithmetic_add(sour1, sour2);
-			break;
-		case DVM_FLAG_BINOP_SUB:
-			res = cesk_addr_arithmetic_sub(sour1, sour2);
-			break;
-		case DVM_FLAG_BINOP_MUL:
-			res = cesk_addr_arithmetic_mul(sour1, sour2);
-			break;
-		case DVM_FLAG_BINOP_DIV:
-			res = cesk_addr_arithmetic_div(sour1, sour2);
-			break;
-		case DVM_FLAG_BINOP_REM:
-			res = CESK_STORE_ADDR_POS | CESK_STORE_ADDR_ZERO;   /* here we suppose that result of rem is non-negative */
-			break;
-		case DVM_FLAG_BINOP_AND:
-			res = cesk_addr_arithmetic_bitwise_and(sour1, sour2);
-			break;
-		case DVM_FLAG_BINOP_OR:
-			res = cesk_addr_arithmetic_bitwise_or(sour1, sour2);
-			break;
-		case DVM_FLAG_BINOP_XOR:
-			res = cesk_addr_arithmetic_bitwise_xor(sour1, sour2);
-			break;
-		case DVM_FLAG_BINOP_SHR:
-		case DVM_FLAG_BINOP_SHL:
-		//case DVM_FLAG_BINOP_USHR: TODO
-			res = CESK_STORE_ADDR_ZERO | CESK_STORE_ADDR_NEG | CESK_STORE_ADDR_POS;
-		default:
-			LOG_ERROR("unknown flag, bad instruction");
-			return -1;
+		__CB_TRACE(code);
+		int rc;
+		switch(code->handler)
+		{
+			__CB_HANDLERS(__CB_CASE)
+			default:
+				rc = _cesk_block_interpreter_handler_INVALID(code, frame);
+		}
+		if(rc < 0)
+		{
+			LOG_WARNING("error during interpert this instruction");
+		}
 	}
-	return cesk_frame_register_load(output, inst, dest, res);
+#undef __CB_CASE
 }
+#if CESK_BLOCK_THREADED_DISPATCH
+/** @brief interpret the code with computed goto, each handler jumps to the handler of the next instruction directly */
+static inline void _cesk_block_interpret_threaded(const cesk_block_code_t* code, const cesk_block_code_t* end, cesk_frame_t* frame)
+{
+#define __CB_ADDR(name) &&_CB_##name,
+	static const void* const handlers[] = { __CB_HANDLERS(__CB_ADDR) };
+#undef __CB_ADDR
+	int rc;
+	if(code >= end) return;
+	__CB_TRACE(code);
+	goto *handlers[code->handler];
+#define __CB_LABEL(name) \
+	_CB_##name: \
+	rc = _cesk_block_interpreter_handler_##name(code, frame); \
+	if(rc < 0) LOG_WARNING("error during interpert this instruction"); \
+	if(++ code >= end) return; \
+	__CB_TRACE(code); \
+	goto *handlers[code->handler];
+	__CB_HANDLERS(__CB_LABEL)
+#undef __CB_LABEL
+}
+#endif
 cesk_frame_t* cesk_block_interpret(cesk_block_t* blk)
 {
 	if(NULL == blk)
 		return NULL;
 
     cesk_frame_t* frame = cesk_frame_fork(blk->input);   /* fork a frame for output */
-    const dalvik_block_t* code_block = blk->code_block;
-    int i;
-    for(i = code_block->begin; i < code_block->end; i ++)
+    if(NULL == frame) return NULL;
+    const cesk_block_code_t* code = blk->code;
+    const cesk_block_code_t* end = code + (blk->code_block->end - blk->code_block->begin);
+#if CESK_BLOCK_THREADED_DISPATCH
+    if(CESK_BLOCK_DISPATCH_THREADED == _cesk_block_dispatch)
     {
-        const dalvik_instruction_t* inst = dalvik_instruction_get(i);
-        LOG_DEBUG("current instruction: %s", dalvik_instruction_to_string(inst, NULL, 0));
-        int rc;
-        switch(inst->opcode)
-        {
-               __CB_INST(MOVE);
-			   __CB_INST(NOP);
-			   __CB_INST(CONST);
-			   __CB_INST(MONITOR);
-			   __CB_INST(CHECK_CAST);
-			   __CB_INST(THROW);
-			   __CB_INST(CMP);
-			   __CB_INST(INSTANCE);
-			   __CB_INST(ARRAY);
-			   __CB_INST(UNOP);
-			   __CB_INST(BINOP);
-			   /* TODO: other instructions */
-			default:
-			   LOG_ERROR("unsupported instruction");
-			   rc = -1;
-        }
-        if(rc < 0)
-        {
-            LOG_WARNING("error during interpert this instruction");
-        }
+        _cesk_block_interpret_threaded(code, end, frame);
+        return frame;
     }
-
-	return frame;
+#endif
+    _cesk_block_interpret_switch(code, end, frame);
+    return frame;
+}
+void cesk_block_set_dispatch(int mode)
+{
+	if(CESK_BLOCK_DISPATCH_THREADED == mode && CESK_BLOCK_THREADED_DISPATCH)
+		_cesk_block_dispatch = CESK_BLOCK_DISPATCH_THREADED;
+	else
+		_cesk_block_dispatch = CESK_BLOCK_DISPATCH_SWITCH;
+}
+int cesk_block_get_dispatch()
+{
+	return _cesk_block_dispatch;
 }
+#undef __CB_TRACE
 #undef __CB_HANDLER
-#undef __CB_INST
+#undef __CB_HANDLERS
+/** @brief the flags of a block during the fixpoint iteration */
+enum {
+	_CESK_BLOCK_VISITED = 1,  /*!<the block has been visited by the DFS */
+	_CESK_BLOCK_PENDING = 2,  /*!<the block is in the worklist */
+	_CESK_BLOCK_REACHED = 4   /*!<some frame has been merged into the input of the block */
+};
+/** @brief the DFS stack entry used for computing the reverse post-order */
+typedef struct {
+	cesk_block_t* block;   /*!<the block */
+	int           next;    /*!<the next branch to visit */
+} _cesk_block_dfs_t;
+/** @brief compute the reverse post-order of the graph
+ *  @param entry the entry block
+ *  @param order the buffer for the result
+ *  @param rank  the buffer maps the code block index to the position in the order
+ *  @param flags the flags of each code block index
+ *  @return the number of blocks in the order, < 0 indicates error
+ */
+static inline int _cesk_block_graph_rpo(cesk_block_t* entry, cesk_block_t** order, uint32_t* rank, uint8_t* flags)
+{
+	_cesk_block_dfs_t* stack = (_cesk_block_dfs_t*)malloc(sizeof(_cesk_block_dfs_t) * DALVIK_BLOCK_MAX_KEYS);
+	if(NULL == stack)
+	{
+		LOG_ERROR("can not allocate memory for the DFS stack");
+		return -1;
+	}
+	int sp = 0, npost = 0, i;
+	stack[sp].block = entry;
+	stack[sp++].next = 0;
+	flags[entry->code_block->index] |= _CESK_BLOCK_VISITED;
+	/* the post-order is placed at the end of the buffer, so that we can reverse it in place */
+	while(sp > 0)
+	{
+		_cesk_block_dfs_t* top = stack + sp - 1;
+		cesk_block_t* next = NULL;
+		while(top->next < top->block->code_block->nbranches && NULL == next)
+		{
+			next = top->block->fanout[top->next ++];
+			if(NULL != next && (flags[next->code_block->index] & _CESK_BLOCK_VISITED)) next = NULL;
+		}
+		if(NULL == next)
+		{
+			order[DALVIK_BLOCK_MAX_KEYS - (++npost)] = top->block;
+			sp --;
+			continue;
+		}
+		flags[next->code_block->index] |= _CESK_BLOCK_VISITED;
+		stack[sp].block = next;
+		stack[sp++].next = 0;
+	}
+	free(stack);
+	for(i = 0; i < npost; i ++)
+	{
+		order[i] = order[DALVIK_BLOCK_MAX_KEYS - npost + i];
+		rank[order[i]->code_block->index] = i;
+	}
+	return npost;
+}
+/** @brief the abstract value of an operand of the branch in the output frame of the block
+ *  @return the value, CESK_STORE_ADDR_NULL if the operand is not known to be a numeric value
+ */
+static inline uint32_t _cesk_block_branch_value(const cesk_frame_t* frame, const dalvik_operand_t* operand)
+{
+	const cesk_domain_t* domain = cesk_domain_get();
+	if(NULL == operand) return CESK_STORE_ADDR_NULL;
+	if(operand->header.info.is_const) return cesk_store_const_addr_from_operand(operand);
+	uint32_t reg = _cesk_block_operand_to_regidx(operand);
+	if(reg >= frame->size) return CESK_STORE_ADDR_NULL;
+	cesk_set_iter_t iter;
+	if(NULL == cesk_set_iter(frame->regs[reg], &iter)) return CESK_STORE_ADDR_NULL;
+	uint32_t ret = 0;
+	uint32_t addr;
+	while((addr = cesk_set_iter_next(&iter)) != CESK_STORE_ADDR_NULL)
+	{
+		/* an object reference, we can not tell anything */
+		if(!CESK_STORE_ADDR_IS_CONST(addr)) return CESK_STORE_ADDR_NULL;
+		ret = (0 == ret) ? addr : domain->join(ret, addr);
+	}
+	/* the register is empty or contains the null reference */
+	if(0 == ret || 0 == CESK_ADDR_ARITHMETIC_MASK(ret)) return CESK_STORE_ADDR_NULL;
+	return ret;
+}
+/** @brief the possible results of comparing the left operand of the branch to the right one
+ *  @return the mask of CESK_DOMAIN_LT, CESK_DOMAIN_EQ and CESK_DOMAIN_GT
+ */
+static inline int _cesk_block_branch_compare(const cesk_frame_t* frame, const dalvik_block_branch_t* branch)
+{
+	const cesk_domain_t* domain = cesk_domain_get();
+	uint32_t left = branch->left_inst ? domain->from_int(branch->ileft[0]) : _cesk_block_branch_value(frame, branch->left);
+	uint32_t right = _cesk_block_branch_value(frame, branch->right);
+	if(CESK_STORE_ADDR_NULL == left || CESK_STORE_ADDR_NULL == right)
+		return CESK_DOMAIN_LT | CESK_DOMAIN_EQ | CESK_DOMAIN_GT;
+	return domain->compare(left, right);
+}
+/** @brief the comparison results that enter the branch */
+static inline int _cesk_block_branch_cond(const dalvik_block_branch_t* branch)
+{
+	return (branch->lt ? CESK_DOMAIN_LT : 0) | (branch->eq ? CESK_DOMAIN_EQ : 0) | (branch->gt ? CESK_DOMAIN_GT : 0);
+}
+/** @brief check if the branch might be taken with the output frame of the block.
+ *         A conditional branch is infeasible if the comparison never enters the branch,
+ *         and the default branch is infeasible if some conditional branch is always taken.
+ *  @param blk the block
+ *  @param frame the output frame of the block
+ *  @param i the index of the branch
+ *  @return 0 if the branch is never taken
+ */
+static inline int _cesk_block_branch_feasible(const cesk_block_t* blk, const cesk_frame_t* frame, int i)
+{
+	const dalvik_block_t* code_block = blk->code_block;
+	const dalvik_block_branch_t* branch = code_block->branches + i;
+	if(branch->conditional)
+		return 0 != (_cesk_block_branch_compare(frame, branch) & _cesk_block_branch_cond(branch));
+	int j;
+	for(j = 0; j < code_block->nbranches; j ++)
+	{
+		const dalvik_block_branch_t* cond = code_block->branches + j;
+		if(!cond->conditional || cond->disabled) continue;
+		int res = _cesk_block_branch_compare(frame, cond);
+		if(res && 0 == (res & ~_cesk_block_branch_cond(cond))) return 0;
+	}
+	return 1;
+}
+int cesk_block_graph_fixpoint(cesk_block_t* graph)
+{
+	if(NULL == graph)
+	{
+		LOG_ERROR("invalid argument");
+		return -1;
+	}
+	int ret = -1;
+	cesk_block_t** order = (cesk_block_t**)malloc(sizeof(cesk_block_t*) * DALVIK_BLOCK_MAX_KEYS);
+	uint32_t* rank = (uint32_t*)malloc(sizeof(uint32_t) * DALVIK_BLOCK_MAX_KEYS);
+	uint8_t* flags = (uint8_t*)calloc(DALVIK_BLOCK_MAX_KEYS, sizeof(uint8_t));
+	if(NULL == order || NULL == rank || NULL == flags)
+	{
+		LOG_ERROR("can not allocate memory for the worklist");
+		goto ERR;
+	}
+	int nblocks = _cesk_block_graph_rpo(graph, order, rank, flags);
+	if(nblocks < 0)
+	{
+		LOG_ERROR("can not compute the reverse post-order of the block graph");
+		goto ERR;
+	}
+	LOG_DEBUG("start fixpoint iteration on %d blocks", nblocks);
+	flags[graph->code_block->index] |= _CESK_BLOCK_PENDING | _CESK_BLOCK_REACHED;
+	/* the worklist is the pending blocks, and we always pick the first pending block in reverse post-order,
+	 * so that the predecessors of a block are likely to be analyzed before the block */
+	int count = 0;
+	int cur = 0;
+	for(;;)
+	{
+		for(; cur < nblocks && 0 == (flags[order[cur]->code_block->index] & _CESK_BLOCK_PENDING); cur ++);
+		if(cur >= nblocks) break;
+		cesk_block_t* blk = order[cur];
+		flags[blk->code_block->index] &= ~_CESK_BLOCK_PENDING;
+		LOG_DEBUG("analyzing block %d", blk->code_block->index);
+		cesk_frame_t* output = cesk_block_interpret(blk);
+		count ++;
+		if(NULL == output)
+		{
+			LOG_ERROR("can not interpret block %d", blk->code_block->index);
+			goto ERR;
+		}
+		int next = cur + 1;
+		int i;
+		for(i = 0; i < blk->code_block->nbranches; i ++)
+		{
+			cesk_block_t* succ = blk->fanout[i];
+			if(NULL == succ) continue;
+			uint32_t idx = succ->code_block->index;
+			if(CESK_BLOCK_PRUNE_BRANCHES && !_cesk_block_branch_feasible(blk, output, i))
+			{
+				LOG_DEBUG("the branch from block %d to block %d is infeasible, pruned", blk->code_block->index, idx);
+				continue;
+			}
+			/* keep the old input, so that we can tell if the input has been changed */
+			hashval_t hash = cesk_frame_hashcode(succ->input);
+			cesk_frame_t* old = cesk_frame_fork(succ->input);
+			if(NULL == old)
+			{
+				LOG_ERROR("can not fork the input frame of block %d", idx);
+				cesk_frame_free(output);
+				goto ERR;
+			}
+			if(cesk_frame_merge(succ->input, output) < 0)
+			{
+				LOG_ERROR("can not merge the output of block %d to the input of block %d", blk->code_block->index, idx);
+				cesk_frame_free(old);
+				cesk_frame_free(output);
+				goto ERR;
+			}
+			int changed = 0 == (flags[idx] & _CESK_BLOCK_REACHED) ||
+			              hash != cesk_frame_hashcode(succ->input) ||
+			              0 == cesk_frame_equal(old, succ->input);
+			cesk_frame_free(old);
+			if(!changed) continue;
+			LOG_DEBUG("the input of block %d has been changed", idx);
+			flags[idx] |= _CESK_BLOCK_PENDING | _CESK_BLOCK_REACHED;
+			if(rank[idx] < next) next = rank[idx];
+		}
+		cesk_frame_free(output);
+		cur = next;
+	}
+	LOG_DEBUG("fixpoint found after %d block interpretations", count);
+	ret = count;
+ERR:
+	free(order);
+	free(rank);
+	free(flags);
+	return ret;
+}
@@ -0,0 +1,459 @@
+/**
+ * @file cesk_domain.c
+ * @brief the implementation of the numeric domains
+ *
+ * @details The refined domains fall back to the sign lattice for the operators
+ *          they can not handle precisely, and the result is always intersected
+ *          with the result of the sign lattice, so a refined domain is never
+ *          less precise than the sign lattice.
+ */
+#include <log.h>
+#include <cesk/cesk_domain.h>
+
+#define _SUFFIX_T CESK_STORE_ADDR_CONST_SUFFIX(CESK_STORE_ADDR_TRUE)
+#define _SUFFIX_N CESK_STORE_ADDR_CONST_SUFFIX(CESK_STORE_ADDR_NEG)
+#define _SUFFIX_Z CESK_STORE_ADDR_CONST_SUFFIX(CESK_STORE_ADDR_ZERO)
+#define _SUFFIX_P CESK_STORE_ADDR_CONST_SUFFIX(CESK_STORE_ADDR_POS)
+
+#if CESK_DOMAIN_CONSTSET_MIN > 0 || CESK_DOMAIN_CONSTSET_MIN <= -20
+#	error "the constant set domain must track the constant 0"
+#endif
+#if CESK_DOMAIN_INTERVAL_LIMIT >= 511
+#	error "the bound of the interval domain does not fit in 10 bits"
+#endif
+
+/** @brief the current domain */
+static const cesk_domain_t* _cesk_domain_current = &cesk_domain_sign;
+
+/** @brief the sign mask of an integer */
+static inline uint32_t _cesk_domain_sign_mask(int64_t value)
+{
+	if(value < 0) return _SUFFIX_N;
+	if(value > 0) return _SUFFIX_P;
+	return _SUFFIX_Z;
+}
+/** @brief evaluate the operator on two integers
+ *  @return 1 if the result is in *result, 0 if there's no result (e.g. divided by zero),
+ *          -1 if the result can not be determined without the type of the operands
+ */
+static inline int _cesk_domain_eval(int op, int64_t a, int64_t b, int64_t* result)
+{
+	switch(op)
+	{
+		case CESK_ADDR_ARITHMETIC_ADD: *result = a + b; return 1;
+		case CESK_ADDR_ARITHMETIC_SUB: *result = a - b; return 1;
+		case CESK_ADDR_ARITHMETIC_RSUB: *result = b - a; return 1;
+		case CESK_ADDR_ARITHMETIC_MUL: *result = a * b; return 1;
+		case CESK_ADDR_ARITHMETIC_DIV:
+			if(0 == b) return 0;
+			*result = a / b;
+			return 1;
+		case CESK_ADDR_ARITHMETIC_REM:
+			if(0 == b) return 0;
+			*result = a % b;
+			return 1;
+		case CESK_ADDR_ARITHMETIC_BITWISE_AND: *result = a & b; return 1;
+		case CESK_ADDR_ARITHMETIC_BITWISE_OR: *result = a | b; return 1;
+		case CESK_ADDR_ARITHMETIC_BITWISE_XOR: *result = a ^ b; return 1;
+		/* the distance of a shift is masked by the width of the operand, which is unknown here,
+		 * so we only handle the distance which is valid for both int and long */
+		case CESK_ADDR_ARITHMETIC_SHL:
+			if(b < 0 || b >= 32) return -1;
+			*result = a * ((int64_t)1 << b);
+			return 1;
+		case CESK_ADDR_ARITHMETIC_SHR:
+			if(b < 0 || b >= 32) return -1;
+			*result = a >> b;
+			return 1;
+		case CESK_ADDR_ARITHMETIC_USHR:
+			if(b < 0 || b >= 32 || (a < 0 && b > 0)) return -1;
+			*result = a >> b;
+			return 1;
+	}
+	return -1;
+}
+/** @brief the possible results of comparing two sign masks */
+static inline int _cesk_domain_sign_compare(uint32_t a, uint32_t b)
+{
+	uint32_t sa = CESK_ADDR_ARITHMETIC_MASK(a);
+	uint32_t sb = CESK_ADDR_ARITHMETIC_MASK(b);
+	int ret = 0;
+	if(cesk_addr_arithmetic_binop_table[CESK_ADDR_ARITHMETIC_GT][sb][sa] & _SUFFIX_T) ret |= CESK_DOMAIN_LT;
+	if(cesk_addr_arithmetic_binop_table[CESK_ADDR_ARITHMETIC_EQ][sa][sb] & _SUFFIX_T) ret |= CESK_DOMAIN_EQ;
+	if(cesk_addr_arithmetic_binop_table[CESK_ADDR_ARITHMETIC_GT][sa][sb] & _SUFFIX_T) ret |= CESK_DOMAIN_GT;
+	return ret;
+}
+
+/* the sign lattice */
+static uint32_t _cesk_domain_sign_from_int(int64_t value)
+{
+	return CESK_STORE_ADDR_CONST_PREFIX | _cesk_domain_sign_mask(value);
+}
+static uint32_t _cesk_domain_sign_join(uint32_t a, uint32_t b)
+{
+	return CESK_STORE_ADDR_CONST_PREFIX | CESK_ADDR_ARITHMETIC_MASK(a) | CESK_ADDR_ARITHMETIC_MASK(b);
+}
+const cesk_domain_t cesk_domain_sign = {
+	.name     = "sign",
+	.from_int = _cesk_domain_sign_from_int,
+	.join     = _cesk_domain_sign_join,
+	.unop     = cesk_addr_arithmetic_unop,
+	.binop    = cesk_addr_arithmetic_binop,
+	.compare  = _cesk_domain_sign_compare
+};
+
+/* the small constant set domain */
+/** @brief the number of the values tracked by the constant set domain */
+#define _CESK_DOMAIN_CONSTSET_SIZE 20
+/** @brief make the address from a set of constants, the sign is the sign of the result in the sign lattice */
+static inline uint32_t _cesk_domain_constset_encode(uint32_t set, uint32_t sign)
+{
+	uint32_t mask = 0;
+	int i;
+	for(i = 0; i < _CESK_DOMAIN_CONSTSET_SIZE; i ++)
+		if(set & (1u << i))
+			mask |= _cesk_domain_sign_mask(CESK_DOMAIN_CONSTSET_MIN + i);
+	mask &= sign;
+	/* remove the constants excluded by the sign */
+	for(i = 0; i < _CESK_DOMAIN_CONSTSET_SIZE; i ++)
+		if(0 == (mask & _cesk_domain_sign_mask(CESK_DOMAIN_CONSTSET_MIN + i)))
+			set &= ~(1u << i);
+	/* {0} is exactly ZERO */
+	if(0 == set || _SUFFIX_Z == mask) return CESK_STORE_ADDR_CONST_PREFIX | mask;
+	return CESK_STORE_ADDR_CONST_PREFIX | CESK_DOMAIN_REFINED | (set << 3) | mask;
+}
+/** @brief get the set of constants of the address
+ *  @return 0 if the value is not a finite set of the tracked constants
+ */
+static inline int _cesk_domain_constset_decode(uint32_t addr, uint32_t* set)
+{
+	if(CESK_DOMAIN_IS_REFINED(addr))
+	{
+		*set = (addr & CESK_DOMAIN_REFINE_BITS) >> 3;
+		return 1;
+	}
+	uint32_t mask = CESK_ADDR_ARITHMETIC_MASK(addr);
+	if(0 == mask)
+	{
+		*set = 0;
+		return 1;
+	}
+	if(_SUFFIX_Z == mask)
+	{
+		*set = 1u << (0 - CESK_DOMAIN_CONSTSET_MIN);
+		return 1;
+	}
+	return 0;
+}
+static uint32_t _cesk_domain_constset_from_int(int64_t value)
+{
+	if(value < CESK_DOMAIN_CONSTSET_MIN || value >= CESK_DOMAIN_CONSTSET_MIN + _CESK_DOMAIN_CONSTSET_SIZE)
+		return _cesk_domain_sign_from_int(value);
+	return _cesk_domain_constset_encode(1u << (value - CESK_DOMAIN_CONSTSET_MIN), CESK_DOMAIN_SIGN_BITS);
+}
+static uint32_t _cesk_domain_constset_join(uint32_t a, uint32_t b)
+{
+	uint32_t sa, sb;
+	uint32_t sign = CESK_ADDR_ARITHMETIC_MASK(a) | CESK_ADDR_ARITHMETIC_MASK(b);
+	if(_cesk_domain_constset_decode(a, &sa) && _cesk_domain_constset_decode(b, &sb))
+		return _cesk_domain_constset_encode(sa | sb, sign);
+	return CESK_STORE_ADDR_CONST_PREFIX | sign;
+}
+static uint32_t _cesk_domain_constset_unop(int op, uint32_t a)
+{
+	uint32_t sign = CESK_ADDR_ARITHMETIC_MASK(cesk_addr_arithmetic_unop(op, a));
+	uint32_t sa;
+	if((CESK_ADDR_ARITHMETIC_NEG != op && CESK_ADDR_ARITHMETIC_BITWISE_NEG != op) ||
+	   !_cesk_domain_constset_decode(a, &sa))
+		return CESK_STORE_ADDR_CONST_PREFIX | sign;
+	uint32_t set = 0;
+	int i;
+	for(i = 0; i < _CESK_DOMAIN_CONSTSET_SIZE; i ++)
+	{
+		if(0 == (sa & (1u << i))) continue;
+		int64_t r = -(int64_t)(CESK_DOMAIN_CONSTSET_MIN + i);
+		if(CESK_ADDR_ARITHMETIC_BITWISE_NEG == op) r --;
+		r -= CESK_DOMAIN_CONSTSET_MIN;
+		if(r < 0 || r >= _CESK_DOMAIN_CONSTSET_SIZE) return CESK_STORE_ADDR_CONST_PREFIX | sign;
+		set |= 1u << r;
+	}
+	return _cesk_domain_constset_encode(set, sign);
+}
+static uint32_t _cesk_domain_constset_binop(int op, uint32_t a, uint32_t b)
+{
+	uint32_t sign = CESK_ADDR_ARITHMETIC_MASK(cesk_addr_arithmetic_binop(op, a, b));
+	uint32_t sa, sb;
+	/* the operators produce booleans (the operators after USHR) are handled by the sign lattice */
+	if(op > CESK_ADDR_ARITHMETIC_USHR ||
+	   !_cesk_domain_constset_decode(a, &sa) ||
+	   !_cesk_domain_constset_decode(b, &sb))
+		return CESK_STORE_ADDR_CONST_PREFIX | sign;
+	uint32_t set = 0;
+	int i, j;
+	for(i = 0; i < _CESK_DOMAIN_CONSTSET_SIZE; i ++)
+	{
+		if(0 == (sa & (1u << i))) continue;
+		for(j = 0; j < _CESK_DOMAIN_CONSTSET_SIZE; j ++)
+		{
+			if(0 == (sb & (1u << j))) continue;
+			int64_t r;
+			int rc = _cesk_domain_eval(op, CESK_DOMAIN_CONSTSET_MIN + i, CESK_DOMAIN_CONSTSET_MIN + j, &r);
+			if(0 == rc) continue;
+			r -= CESK_DOMAIN_CONSTSET_MIN;
+			if(rc < 0 || r < 0 || r >= _CESK_DOMAIN_CONSTSET_SIZE) return CESK_STORE_ADDR_CONST_PREFIX | sign;
+			set |= 1u << r;
+		}
+	}
+	return _cesk_domain_constset_encode(set, sign);
+}
+static int _cesk_domain_constset_compare(uint32_t a, uint32_t b)
+{
+	int ret = _cesk_domain_sign_compare(a, b);
+	uint32_t sa, sb;
+	if(!_cesk_domain_constset_decode(a, &sa) || !_cesk_domain_constset_decode(b, &sb)) return ret;
+	int possible = 0;
+	int i, j;
+	for(i = 0; i < _CESK_DOMAIN_CONSTSET_SIZE; i ++)
+	{
+		if(0 == (sa & (1u << i))) continue;
+		for(j = 0; j < _CESK_DOMAIN_CONSTSET_SIZE; j ++)
+		{
+			if(0 == (sb & (1u << j))) continue;
+			if(i < j) possible |= CESK_DOMAIN_LT;
+			else if(i == j) possible |= CESK_DOMAIN_EQ;
+			else possible |= CESK_DOMAIN_GT;
+		}
+	}
+	return ret & possible;
+}
+const cesk_domain_t cesk_domain_constset = {
+	.name     = "constset",
+	.from_int = _cesk_domain_constset_from_int,
+	.join     = _cesk_domain_constset_join,
+	.unop     = _cesk_domain_constset_unop,
+	.binop    = _cesk_domain_constset_binop,
+	.compare  = _cesk_domain_constset_compare
+};
+
+/* the interval domain */
+/** @brief the infinity bound of the interval */
+#define _CESK_DOMAIN_INTERVAL_INF ((int64_t)1 << 62)
+/** @brief the bias of an encoded bound */
+#define _CESK_DOMAIN_INTERVAL_BIAS 512
+/** @brief an interval, an empty interval has lo > hi */
+typedef struct {
+	int64_t lo;   /*!<the lower bound */
+	int64_t hi;   /*!<the upper bound */
+} _cesk_domain_interval_t;
+/** @brief the smallest interval contains all values of the sign mask */
+static inline _cesk_domain_interval_t _cesk_domain_interval_hull(uint32_t mask)
+{
+	_cesk_domain_interval_t ret = {1, 0};
+	if(mask & _SUFFIX_N) ret.lo = -_CESK_DOMAIN_INTERVAL_INF;
+	else if(mask & _SUFFIX_Z) ret.lo = 0;
+	else if(mask & _SUFFIX_P) ret.lo = 1;
+	if(mask & _SUFFIX_P) ret.hi = _CESK_DOMAIN_INTERVAL_INF;
+	else if(mask & _SUFFIX_Z) ret.hi = 0;
+	else if(mask & _SUFFIX_N) ret.hi = -1;
+	return ret;
+}
+/** @brief encode a bound */
+static inline uint32_t _cesk_domain_interval_bound_encode(int64_t value)
+{
+	if(value <= -_CESK_DOMAIN_INTERVAL_INF) return 0;
+	if(value >= _CESK_DOMAIN_INTERVAL_INF) return 2 * _CESK_DOMAIN_INTERVAL_BIAS - 1;
+	return (uint32_t)(value + _CESK_DOMAIN_INTERVAL_BIAS);
+}
+/** @brief decode a bound */
+static inline int64_t _cesk_domain_interval_bound_decode(uint32_t value)
+{
+	if(0 == value) return -_CESK_DOMAIN_INTERVAL_INF;
+	if(2 * _CESK_DOMAIN_INTERVAL_BIAS - 1 == value) return _CESK_DOMAIN_INTERVAL_INF;
+	return (int64_t)value - _CESK_DOMAIN_INTERVAL_BIAS;
+}
+/** @brief make the address from an interval, the sign is the sign of the result in the sign lattice */
+static inline uint32_t _cesk_domain_interval_encode(_cesk_domain_interval_t v, uint32_t sign)
+{
+	/* the bounds beyond the limit are widened */
+	if(v.lo < -CESK_DOMAIN_INTERVAL_LIMIT) v.lo = -_CESK_DOMAIN_INTERVAL_INF;
+	else if(v.lo > CESK_DOMAIN_INTERVAL_LIMIT) v.lo = CESK_DOMAIN_INTERVAL_LIMIT;
+	if(v.hi > CESK_DOMAIN_INTERVAL_LIMIT) v.hi = _CESK_DOMAIN_INTERVAL_INF;
+	else if(v.hi < -CESK_DOMAIN_INTERVAL_LIMIT) v.hi = -CESK_DOMAIN_INTERVAL_LIMIT;
+	/* the reduced product of the sign and the interval */
+	uint32_t mask = 0;
+	if(v.lo < 0) mask |= _SUFFIX_N;
+	if(v.lo <= 0 && v.hi >= 0) mask |= _SUFFIX_Z;
+	if(v.hi > 0) mask |= _SUFFIX_P;
+	if(v.lo > v.hi) mask = 0;
+	mask &= sign;
+	_cesk_domain_interval_t hull = _cesk_domain_interval_hull(mask);
+	if(v.lo < hull.lo) v.lo = hull.lo;
+	if(v.hi > hull.hi) v.hi = hull.hi;
+	/* the interval does not exclude any value of the sign */
+	if(0 == mask || (v.lo == hull.lo && v.hi == hull.hi))
+		return CESK_STORE_ADDR_CONST_PREFIX | mask;
+	return CESK_STORE_ADDR_CONST_PREFIX | CESK_DOMAIN_REFINED | mask |
+		   (_cesk_domain_interval_bound_encode(v.lo) << 3) |
+		   (_cesk_domain_interval_bound_encode(v.hi) << 13);
+}
+/** @brief get the interval of the address */
+static inline _cesk_domain_interval_t _cesk_domain_interval_decode(uint32_t addr)
+{
+	_cesk_domain_interval_t ret = _cesk_domain_interval_hull(CESK_ADDR_ARITHMETIC_MASK(addr));
+	if(CESK_DOMAIN_IS_REFINED(addr))
+	{
+		ret.lo = _cesk_domain_interval_bound_decode((addr >> 3) & 0x3ff);
+		ret.hi = _cesk_domain_interval_bound_decode((addr >> 13) & 0x3ff);
+	}
+	return ret;
+}
+/** @brief the sum of two bounds */
+static inline int64_t _cesk_domain_interval_add(int64_t a, int64_t b)
+{
+	if(a <= -_CESK_DOMAIN_INTERVAL_INF || b <= -_CESK_DOMAIN_INTERVAL_INF) return -_CESK_DOMAIN_INTERVAL_INF;
+	if(a >= _CESK_DOMAIN_INTERVAL_INF || b >= _CESK_DOMAIN_INTERVAL_INF) return _CESK_DOMAIN_INTERVAL_INF;
+	return a + b;
+}
+/** @brief the product of two bounds, the bounds are finite numbers, so 0 * inf = 0 */
+static inline int64_t _cesk_domain_interval_mul(int64_t a, int64_t b)
+{
+	if(0 == a || 0 == b) return 0;
+	if(a <= -_CESK_DOMAIN_INTERVAL_INF || a >= _CESK_DOMAIN_INTERVAL_INF ||
+	   b <= -_CESK_DOMAIN_INTERVAL_INF || b >= _CESK_DOMAIN_INTERVAL_INF)
+		return ((a < 0) == (b < 0)) ? _CESK_DOMAIN_INTERVAL_INF : -_CESK_DOMAIN_INTERVAL_INF;
+	return a * b;
+}
+static uint32_t _cesk_domain_interval_from_int(int64_t value)
+{
+	_cesk_domain_interval_t v = {value, value};
+	return _cesk_domain_interval_encode(v, CESK_DOMAIN_SIGN_BITS);
+}
+static uint32_t _cesk_domain_interval_join(uint32_t a, uint32_t b)
+{
+	uint32_t sign = CESK_ADDR_ARITHMETIC_MASK(a) | CESK_ADDR_ARITHMETIC_MASK(b);
+	_cesk_domain_interval_t va = _cesk_domain_interval_decode(a);
+	_cesk_domain_interval_t vb = _cesk_domain_interval_decode(b);
+	/* the empty interval is the bottom */
+	if(va.lo > va.hi) return _cesk_domain_interval_encode(vb, sign);
+	if(vb.lo > vb.hi) return _cesk_domain_interval_encode(va, sign);
+	_cesk_domain_interval_t ret = {va.lo < vb.lo ? va.lo : vb.lo, va.hi > vb.hi ? va.hi : vb.hi};
+	return _cesk_domain_interval_encode(ret, sign);
+}
+static uint32_t _cesk_domain_interval_unop(int op, uint32_t a)
+{
+	uint32_t sign = CESK_ADDR_ARITHMETIC_MASK(cesk_addr_arithmetic_unop(op, a));
+	_cesk_domain_interval_t va = _cesk_domain_interval_decode(a);
+	_cesk_domain_interval_t ret;
+	switch(op)
+	{
+		case CESK_ADDR_ARITHMETIC_NEG:
+			ret.lo = -va.hi;
+			ret.hi = -va.lo;
+			break;
+		case CESK_ADDR_ARITHMETIC_BITWISE_NEG:
+			ret.lo = _cesk_domain_interval_add(-va.hi, -1);
+			ret.hi = _cesk_domain_interval_add(-va.lo, -1);
+			break;
+		default:
+			return CESK_STORE_ADDR_CONST_PREFIX | sign;
+	}
+	return _cesk_domain_interval_encode(ret, sign);
+}
+static uint32_t _cesk_domain_interval_binop(int op, uint32_t a, uint32_t b)
+{
+	uint32_t sign = CESK_ADDR_ARITHMETIC_MASK(cesk_addr_arithmetic_binop(op, a, b));
+	_cesk_domain_interval_t va = _cesk_domain_interval_decode(a);
+	_cesk_domain_interval_t vb = _cesk_domain_interval_decode(b);
+	if(va.lo > va.hi || vb.lo > vb.hi || op > CESK_ADDR_ARITHMETIC_USHR) return CESK_STORE_ADDR_CONST_PREFIX | sign;
+	_cesk_domain_interval_t ret;
+	int64_t p[4];
+	int i;
+	switch(op)
+	{
+		case CESK_ADDR_ARITHMETIC_RSUB:
+			ret = va;
+			va = vb;
+			vb = ret;
+			/* fall through */
+		case CESK_ADDR_ARITHMETIC_SUB:
+			ret.lo = -vb.hi;
+			vb.hi = -vb.lo;
+			vb.lo = ret.lo;
+			/* fall through */
+		case CESK_ADDR_ARITHMETIC_ADD:
+			ret.lo = _cesk_domain_interval_add(va.lo, vb.lo);
+			ret.hi = _cesk_domain_interval_add(va.hi, vb.hi);
+			break;
+		case CESK_ADDR_ARITHMETIC_MUL:
+			p[0] = _cesk_domain_interval_mul(va.lo, vb.lo);
+			p[1] = _cesk_domain_interval_mul(va.lo, vb.hi);
+			p[2] = _cesk_domain_interval_mul(va.hi, vb.lo);
+			p[3] = _cesk_domain_interval_mul(va.hi, vb.hi);
+			ret.lo = ret.hi = p[0];
+			for(i = 1; i < 4; i ++)
+			{
+				if(p[i] < ret.lo) ret.lo = p[i];
+				if(p[i] > ret.hi) ret.hi = p[i];
+			}
+			break;
+		default:
+			/* other operators are only folded when both operands are known */
+			if(va.lo != va.hi || vb.lo != vb.hi) return CESK_STORE_ADDR_CONST_PREFIX | sign;
+			switch(_cesk_domain_eval(op, va.lo, vb.lo, &ret.lo))
+			{
+				case 0:
+					return CESK_STORE_ADDR_EMPTY;
+				case 1:
+					ret.hi = ret.lo;
+					break;
+				default:
+					return CESK_STORE_ADDR_CONST_PREFIX | sign;
+			}
+	}
+	return _cesk_domain_interval_encode(ret, sign);
+}
+static int _cesk_domain_interval_compare(uint32_t a, uint32_t b)
+{
+	int ret = _cesk_domain_sign_compare(a, b);
+	_cesk_domain_interval_t va = _cesk_domain_interval_decode(a);
+	_cesk_domain_interval_t vb = _cesk_domain_interval_decode(b);
+	int possible = 0;
+	if(va.lo < vb.hi) possible |= CESK_DOMAIN_LT;
+	if(va.hi > vb.lo) possible |= CESK_DOMAIN_GT;
+	if(va.lo <= vb.hi && vb.lo <= va.hi) possible |= CESK_DOMAIN_EQ;
+	return ret & possible;
+}
+const cesk_domain_t cesk_domain_interval = {
+	.name     = "interval",
+	.from_int = _cesk_domain_interval_from_int,
+	.join     = _cesk_domain_interval_join,
+	.unop     = _cesk_domain_interval_unop,
+	.binop    = _cesk_domain_interval_binop,
+	.compare  = _cesk_domain_interval_compare
+};
+
+/** @brief the list of domains */
+static const cesk_domain_t* const _cesk_domain_list[CESK_DOMAIN_NUM_DOMAINS] = {
+	[CESK_DOMAIN_SIGN]     = &cesk_domain_sign,
+	[CESK_DOMAIN_CONSTSET] = &cesk_domain_constset,
+	[CESK_DOMAIN_INTERVAL] = &cesk_domain_interval
+};
+void cesk_domain_init(void)
+{
+	cesk_domain_set(CESK_DOMAIN_DEFAULT);
+}
+int cesk_domain_set(int domain)
+{
+	if(domain < 0 || domain >= CESK_DOMAIN_NUM_DOMAINS)
+	{
+		LOG_ERROR("invalid numeric domain %d", domain);
+		return -1;
+	}
+	_cesk_domain_current = _cesk_domain_list[domain];
+	LOG_DEBUG("the numeric domain is %s", _cesk_domain_current->name);
+	return 0;
+}
+const cesk_domain_t* cesk_domain_get(void)
+{
+	return _cesk_domain_current;
+}
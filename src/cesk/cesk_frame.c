@@ -1,3 +1,5 @@
+#include <time.h>
+
 #include <log.h>
 #include <cesk/cesk_frame.h>
 #include <cesk/cesk_store.h>
@@ -86,6 +88,53 @@ cesk_frame_t* cesk_frame_fork(const cesk_frame_t* frame)
     ret->store = cesk_store_fork(frame->store);
     return ret;
 }
+int cesk_frame_merge(cesk_frame_t* dest, const cesk_frame_t* sour)
+{
+	if(NULL == dest || NULL == sour)
+	{
+		LOG_ERROR("invalid argument");
+		return -1;
+	}
+	if(dest->size != sour->size)
+	{
+		LOG_ERROR("can not merge two frame with different number of registers");
+		return -1;
+	}
+	/* merge the store first, so that we know where the source objects are placed */
+	cesk_reloc_table_t* rtab = NULL;
+	if(cesk_store_merge_reloc(&dest->store, sour->store, &rtab) < 0)
+	{
+		LOG_ERROR("can not merge the store of two frame");
+		return -1;
+	}
+	int i;
+	for(i = 0; i < sour->size; i ++)
+	{
+		cesk_set_iter_t iter;
+		if(NULL == cesk_set_iter(sour->regs[i], &iter))
+		{
+			LOG_ERROR("can not aquire iterator for register %d", i);
+			goto ERR;
+		}
+		uint32_t addr;
+		while(CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(&iter)))
+		{
+			if(!CESK_STORE_ADDR_IS_CONST(addr))
+				addr = cesk_reloc_table_look_for(rtab, addr);
+			/* the push function keeps the refcnt for us */
+			if(cesk_frame_register_push(dest, NULL, i, addr) < 0)
+			{
+				LOG_ERROR("can not push @%x to register %d", addr, i);
+				goto ERR;
+			}
+		}
+	}
+	cesk_reloc_table_free(rtab);
+	return 0;
+ERR:
+	cesk_reloc_table_free(rtab);
+	return -1;
+}
 
 void cesk_frame_free(cesk_frame_t* frame)
 {
@@ -115,80 +164,328 @@ int cesk_frame_equal(const cesk_frame_t* first, const cesk_frame_t* second)
     }
     return cesk_store_equal(first->store, second->store);
 }
-/** @brief depth first search the store, and figure out what is unreachable from the register */
-static inline void _cesk_frame_store_dfs(uint32_t addr,cesk_store_t* store, uint8_t* f)
-{
-#define BITAT(f,n) (((f)[n/8]&(1<<(n%8))) != 0)
-	if(CESK_STORE_ADDR_NULL == addr) return;
-	/* constants do not need to collect */
-	if(CESK_STORE_ADDR_IS_CONST(addr)) return;
-    if(1 == BITAT(f, addr)) return;
-    /* set the flag */
-    f[addr/8] |= (1<<(addr%8));
-    cesk_value_const_t* val = cesk_store_get_ro(store, addr);
-    if(NULL == val) return;
-    cesk_set_iter_t iter_buf;
-    cesk_set_iter_t* iter;
-    uint32_t next_addr;
-    const cesk_object_struct_t* this;
-    const cesk_object_t* obj;
-    int i;
-    switch(val->type)
-    {
-        case CESK_TYPE_SET:
-            for(iter = cesk_set_iter(val->pointer.set, &iter_buf);
-                CESK_STORE_ADDR_NULL != (next_addr = cesk_set_iter_next(iter));)
-                _cesk_frame_store_dfs(next_addr, store, f);
-            break;
-        case CESK_TYPE_OBJECT:
-            obj = val->pointer.object;
-            this = obj->members;
-            for(i = 0; i < obj->depth; i ++)
-            {
-                int j;
-                for(j = 0; j < this->num_members; j ++)
-                {
-                    next_addr = this->valuelist[j];
-                    _cesk_frame_store_dfs(next_addr, store, f);
-                }
+/* The garbage collector.
+ *
+ * Because a value is swiped out once its refcnt goes to zero, the only garbage in the store is the
+ * values in reference cycles and the values that no one has ever referred. And the store records the
+ * addresses that might become such garbage in its remembered set (see cesk_store_get_remset), so the 
+ * incremental collection only traces the objects reachable from the remembered set, and figures out 
+ * the garbage by trial deletion:
+ *
+ * 	1. For each traced object, subtract the references from other traced objects from its refcnt;
+ * 	2. The objects with positive remaining counts are referred by registers or untraced objects, 
+ * 	   so they and the objects reachable from them are alive;
+ * 	3. Other traced objects are garbage.
+ *
+ * If the remembered set overflowed, a full collection marks all objects reachable from the registers
+ * and swipes out all unmarked objects.
+ *
+ * Both use an explicit stack instead of recursion, so a deep object graph does not overflow the C stack.
+ */
+/** @brief the statistics of the garbage collector, shared by all threads */
+static cesk_frame_gc_stat_t _cesk_frame_gc_stat;
+/** @brief the stack used by the garbage collector */
+typedef struct {
+	uint32_t  size;        /*!<the number of addresses in the stack */
+	uint32_t  capacity;    /*!<the capacity of the stack */
+	uint32_t* addrs;       /*!<the addresses */
+} _cesk_frame_gc_stack_t;
+/** @brief a traced object in the incremental collection */
+typedef struct {
+	uint32_t addr;         /*!<the address, CESK_STORE_ADDR_NULL means an empty entry */
+	int32_t  count;        /*!<the refcnt minus the references from other traced objects */
+	uint32_t alive;        /*!<if the object is known to be alive */
+} _cesk_frame_gc_node_t;
+/** @brief the set of traced objects, it's an open addressing hash table */
+typedef struct {
+	uint32_t size;                   /*!<the number of objects */
+	uint32_t capacity;               /*!<the number of entries, a power of 2 */
+	_cesk_frame_gc_node_t* nodes;    /*!<the entries */
+} _cesk_frame_gc_map_t;
+static inline int _cesk_frame_gc_push(_cesk_frame_gc_stack_t* stack, uint32_t addr)
+{
+	if(stack->size == stack->capacity)
+	{
+		uint32_t capacity = stack->capacity ? stack->capacity * 2 : 64;
+		uint32_t* addrs = (uint32_t*)realloc(stack->addrs, sizeof(uint32_t) * capacity);
+		if(NULL == addrs)
+		{
+			LOG_ERROR("can not grow the stack of garbage collector");
+			return -1;
+		}
+		stack->addrs = addrs;
+		stack->capacity = capacity;
+	}
+	stack->addrs[stack->size ++] = addr;
+	return 0;
+}
+/** @brief push all addresses the value refers to the stack, an address is pushed once for each reference */
+static inline int _cesk_frame_gc_push_children(_cesk_frame_gc_stack_t* stack, cesk_value_const_t* val)
+{
+	cesk_set_iter_t iter;
+	uint32_t addr;
+	const cesk_object_struct_t* this;
+	const cesk_object_t* obj;
+	int i, j;
+	switch(val->type)
+	{
+		case CESK_TYPE_SET:
+			if(NULL == cesk_set_iter(val->pointer.set, &iter))
+			{
+				LOG_ERROR("can not aquire iterator for the set");
+				return -1;
+			}
+			while(CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(&iter)))
+				if(!CESK_STORE_ADDR_IS_CONST(addr) && _cesk_frame_gc_push(stack, addr) < 0)
+					return -1;
+			break;
+		case CESK_TYPE_OBJECT:
+			obj = val->pointer.object;
+			this = obj->members;
+			for(i = 0; i < obj->depth; i ++)
+			{
+				for(j = 0; j < this->num_members; j ++)
+				{
+					addr = this->valuelist[j];
+					if(CESK_STORE_ADDR_NULL != addr && !CESK_STORE_ADDR_IS_CONST(addr) && _cesk_frame_gc_push(stack, addr) < 0)
+						return -1;
+				}
 				CESK_OBJECT_STRUCT_ADVANCE(this);
-            }
-            break;
-        case CESK_TYPE_ARRAY:
-            LOG_INFO("fixme : array support");
-    }
+			}
+			break;
+		case CESK_TYPE_ARRAY:
+			LOG_INFO("fixme : array support");
+	}
+	return 0;
 }
-int cesk_frame_gc(cesk_frame_t* frame)
+/** @brief find the traced object at the address, insert one if create is set and it's not found */
+static inline _cesk_frame_gc_node_t* _cesk_frame_gc_map_find(_cesk_frame_gc_map_t* map, uint32_t addr, int create)
 {
-	LOG_DEBUG("start run gc on frame@%p", frame);
-    cesk_store_t* store = frame->store;
-    size_t nslot = store->nblocks * CESK_STORE_BLOCK_NSLOTS;
-    uint8_t *fb = (uint8_t*)malloc(nslot / 8 + 1);     /* the flag bits */
-    memset(fb, 0, nslot / 8 + 1);
-    int i;
-    for(i = 0; i < frame->size; i ++)
-    {
-        cesk_set_iter_t iter;
-        if(NULL == cesk_set_iter(frame->regs[i], &iter))
-        {
-            LOG_WARNING("can not aquire iterator for a register %d", i);
-            continue;
-        }
-        uint32_t addr;
-        while(CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(&iter)))
-            _cesk_frame_store_dfs(addr, store, fb);
-    }
-	uint32_t addr = 0;
-    for(addr = 0; addr < nslot; addr ++)
-    {
-        if(BITAT(fb,addr) == 0 && cesk_store_get_ro(store, addr) != NULL)
+	uint32_t i;
+	if(create && 2 * (map->size + 1) > map->capacity)
+	{
+		uint32_t capacity = map->capacity ? map->capacity * 2 : 64;
+		_cesk_frame_gc_node_t* nodes = (_cesk_frame_gc_node_t*)malloc(sizeof(_cesk_frame_gc_node_t) * capacity);
+		if(NULL == nodes)
 		{
-            cesk_store_attach(store,addr,NULL);
-			cesk_store_clear_refcnt(store, addr);
+			LOG_ERROR("can not allocate memory for the traced objects");
+			return NULL;
 		}
-    }
+		for(i = 0; i < capacity; i ++)
+			nodes[i].addr = CESK_STORE_ADDR_NULL;
+		for(i = 0; i < map->capacity; i ++)
+		{
+			if(CESK_STORE_ADDR_NULL == map->nodes[i].addr) continue;
+			uint32_t j;
+			for(j = (map->nodes[i].addr * MH_MULTIPLY) & (capacity - 1); 
+			    CESK_STORE_ADDR_NULL != nodes[j].addr; 
+				j = (j + 1) & (capacity - 1));
+			nodes[j] = map->nodes[i];
+		}
+		free(map->nodes);
+		map->nodes = nodes;
+		map->capacity = capacity;
+	}
+	if(0 == map->capacity) return NULL;
+	for(i = (addr * MH_MULTIPLY) & (map->capacity - 1); 
+		CESK_STORE_ADDR_NULL != map->nodes[i].addr; 
+		i = (i + 1) & (map->capacity - 1))
+		if(map->nodes[i].addr == addr) return map->nodes + i;
+	if(!create) return NULL;
+	map->nodes[i].addr = addr;
+	map->nodes[i].count = 0;
+	map->nodes[i].alive = 0;
+	map->size ++;
+	return map->nodes + i;
+}
+/** @brief swipe out a garbage value, the values it refers might be swiped out as well */
+static inline void _cesk_frame_gc_reclaim(cesk_store_t* store, uint32_t addr)
+{
+	/* the value might be swiped out already, because one of its referrer is swiped out before */
+	if(NULL == cesk_store_get_ro(store, addr)) return;
+	cesk_store_attach(store, addr, NULL);
+	cesk_store_clear_refcnt(store, addr);
+}
+/** @brief update the statistics */
+static inline void _cesk_frame_gc_update_stat(int major, uint32_t visited, uint32_t reclaimed, const struct timespec* begin)
+{
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	uint64_t pause = (end.tv_sec - begin->tv_sec) * 1000000000ull + end.tv_nsec - begin->tv_nsec;
+	__atomic_add_fetch(major ? &_cesk_frame_gc_stat.major : &_cesk_frame_gc_stat.minor, 1, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&_cesk_frame_gc_stat.visited, visited, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&_cesk_frame_gc_stat.reclaimed, reclaimed, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&_cesk_frame_gc_stat.pause_ns, pause, __ATOMIC_RELAXED);
+	uint64_t max = __atomic_load_n(&_cesk_frame_gc_stat.max_pause_ns, __ATOMIC_RELAXED);
+	while(max < pause && !__atomic_compare_exchange_n(&_cesk_frame_gc_stat.max_pause_ns, &max, pause, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+int cesk_frame_gc_full(cesk_frame_t* frame)
+{
+	if(NULL == frame)
+	{
+		LOG_ERROR("invalid argument");
+		return -1;
+	}
+	LOG_DEBUG("start run full gc on frame@%p", frame);
+	struct timespec begin;
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	cesk_store_t* store = frame->store;
+	size_t nslot = store->nblocks * store->nslots;
+	uint32_t* fb = (uint32_t*)calloc(nslot / 32 + 1, sizeof(uint32_t));     /* the flag bits */
+	_cesk_frame_gc_stack_t stack = {};
+	uint32_t visited = 0, reclaimed, num_ent = store->num_ent;
+	int i;
+	if(NULL == fb)
+	{
+		LOG_ERROR("can not allocate memory for the flag bits");
+		return -1;
+	}
+	/* mark all objects reachable from the registers */
+	for(i = 0; i < frame->size; i ++)
+	{
+		cesk_set_iter_t iter;
+		if(NULL == cesk_set_iter(frame->regs[i], &iter))
+		{
+			LOG_WARNING("can not aquire iterator for a register %d", i);
+			continue;
+		}
+		uint32_t addr;
+		while(CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(&iter)))
+			if(!CESK_STORE_ADDR_IS_CONST(addr) && _cesk_frame_gc_push(&stack, addr) < 0)
+				goto ERR;
+	}
+	while(stack.size > 0)
+	{
+		uint32_t addr = stack.addrs[-- stack.size];
+		if(addr >= nslot || (fb[addr / 32] & (1u << (addr % 32)))) continue;
+		fb[addr / 32] |= 1u << (addr % 32);
+		cesk_value_const_t* val = cesk_store_get_ro(store, addr);
+		if(NULL == val) continue;
+		visited ++;
+		if(_cesk_frame_gc_push_children(&stack, val) < 0) goto ERR;
+	}
+	/* swipe out all unmarked objects, the empty blocks are skipped */
+	uint32_t b, ofs;
+	for(b = 0; b < store->nblocks; b ++)
+	{
+		for(ofs = 0; ofs < store->nslots && cesk_store_get_block(store, b)->num_ent > 0; ofs ++)
+		{
+			uint32_t addr = b * store->nslots + ofs;
+			if(fb[addr / 32] & (1u << (addr % 32))) continue;
+			_cesk_frame_gc_reclaim(store, addr);
+		}
+	}
+	cesk_store_clear_remset(store);
+	reclaimed = num_ent - store->num_ent;
+	free(stack.addrs);
+	free(fb);
+	_cesk_frame_gc_update_stat(1, visited, reclaimed, &begin);
+	LOG_DEBUG("full gc on frame@%p: %u objects visited, %u objects reclaimed", frame, visited, reclaimed);
+	return 0;
+ERR:
+	free(stack.addrs);
 	free(fb);
-    return 0;
+	return -1;
+}
+int cesk_frame_gc(cesk_frame_t* frame)
+{
+	if(NULL == frame)
+	{
+		LOG_ERROR("invalid argument");
+		return -1;
+	}
+	cesk_store_t* store = frame->store;
+	const uint32_t* cands;
+	int ncands = cesk_store_get_remset(store, &cands);
+	if(ncands < 0) return cesk_frame_gc_full(frame);
+	LOG_DEBUG("start run gc on frame@%p with %d candidates", frame, ncands);
+	struct timespec begin;
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	_cesk_frame_gc_stack_t stack = {};
+	_cesk_frame_gc_map_t map = {};
+	_cesk_frame_gc_node_t* node;
+	uint32_t reclaimed, num_ent = store->num_ent, i;
+	/* trace from the candidates, and subtract the internal references from the refcnts.
+	 * The stack contains the references that are not processed yet */
+	for(i = 0; i < ncands; i ++)
+	{
+		cesk_value_const_t* val = cesk_store_get_ro(store, cands[i]);
+		if(NULL == val || NULL != _cesk_frame_gc_map_find(&map, cands[i], 0)) continue;
+		if(NULL == (node = _cesk_frame_gc_map_find(&map, cands[i], 1))) goto ERR;
+		node->count = cesk_store_get_refcnt(store, cands[i]);
+		if(_cesk_frame_gc_push_children(&stack, val) < 0) goto ERR;
+		while(stack.size > 0)
+		{
+			uint32_t addr = stack.addrs[-- stack.size];
+			if(NULL == (node = _cesk_frame_gc_map_find(&map, addr, 0)))
+			{
+				/* a reference to an empty slot, ignore it */
+				if(NULL == (val = cesk_store_get_ro(store, addr))) continue;
+				if(NULL == (node = _cesk_frame_gc_map_find(&map, addr, 1))) goto ERR;
+				node->count = cesk_store_get_refcnt(store, addr);
+				if(_cesk_frame_gc_push_children(&stack, val) < 0) goto ERR;
+			}
+			node->count --;
+		}
+	}
+	/* the objects with positive counts are referred from outside, mark them and their descendants alive */
+	for(i = 0; i < map.capacity; i ++)
+	{
+		if(CESK_STORE_ADDR_NULL == map.nodes[i].addr || map.nodes[i].alive || map.nodes[i].count <= 0) continue;
+		map.nodes[i].alive = 1;
+		if(_cesk_frame_gc_push(&stack, map.nodes[i].addr) < 0) goto ERR;
+		while(stack.size > 0)
+		{
+			uint32_t addr = stack.addrs[-- stack.size];
+			uint32_t top = stack.size;
+			if(_cesk_frame_gc_push_children(&stack, cesk_store_get_ro(store, addr)) < 0) goto ERR;
+			/* only keep the children that are not marked */
+			uint32_t j, k;
+			for(j = k = top; j < stack.size; j ++)
+			{
+				node = _cesk_frame_gc_map_find(&map, stack.addrs[j], 0);
+				if(NULL == node || node->alive) continue;
+				node->alive = 1;
+				stack.addrs[k ++] = stack.addrs[j];
+			}
+			stack.size = k;
+		}
+	}
+	/* the rest of traced objects are garbage */
+	for(i = 0; i < map.capacity; i ++)
+		if(CESK_STORE_ADDR_NULL != map.nodes[i].addr && !map.nodes[i].alive)
+			_cesk_frame_gc_reclaim(store, map.nodes[i].addr);
+	cesk_store_clear_remset(store);
+	reclaimed = num_ent - store->num_ent;
+	_cesk_frame_gc_update_stat(0, map.size, reclaimed, &begin);
+	LOG_DEBUG("gc on frame@%p: %u objects traced, %u objects reclaimed", frame, map.size, reclaimed);
+	free(stack.addrs);
+	free(map.nodes);
+	return 0;
+ERR:
+	free(stack.addrs);
+	free(map.nodes);
+	return -1;
+}
+void cesk_frame_gc_get_stat(cesk_frame_gc_stat_t* stat)
+{
+	if(NULL == stat) return;
+	stat->minor = __atomic_load_n(&_cesk_frame_gc_stat.minor, __ATOMIC_RELAXED);
+	stat->major = __atomic_load_n(&_cesk_frame_gc_stat.major, __ATOMIC_RELAXED);
+	stat->visited = __atomic_load_n(&_cesk_frame_gc_stat.visited, __ATOMIC_RELAXED);
+	stat->reclaimed = __atomic_load_n(&_cesk_frame_gc_stat.reclaimed, __ATOMIC_RELAXED);
+	stat->pause_ns = __atomic_load_n(&_cesk_frame_gc_stat.pause_ns, __ATOMIC_RELAXED);
+	stat->max_pause_ns = __atomic_load_n(&_cesk_frame_gc_stat.max_pause_ns, __ATOMIC_RELAXED);
+}
+void cesk_frame_gc_reset_stat()
+{
+	/* the counters are updated by other threads atomically */
+	__atomic_store_n(&_cesk_frame_gc_stat.minor, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&_cesk_frame_gc_stat.major, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&_cesk_frame_gc_stat.visited, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&_cesk_frame_gc_stat.reclaimed, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&_cesk_frame_gc_stat.pause_ns, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&_cesk_frame_gc_stat.max_pause_ns, 0, __ATOMIC_RELAXED);
 }
 hashval_t cesk_frame_hashcode(const cesk_frame_t* frame)
 {
@@ -246,6 +543,8 @@ int cesk_frame_register_move(cesk_frame_t* frame, const dalvik_instruction_t* in
 		LOG_WARNING("invalid instruction, invalid register reference");
 		return -1;
 	}
+	/* nothing to do, and freeing the destination register frees the source register as well */
+	if(dst_reg == src_reg) return 0;
 	/* as once we write one register, the previous infomation store in the register is lost */
 	if(_cesk_frame_free_reg(frame, dst_reg) < 0)
 	{
@@ -254,6 +553,16 @@ int cesk_frame_register_move(cesk_frame_t* frame, const dalvik_instruction_t* in
 	}
 	/* and then we just fork the vlaue of source */
 	frame->regs[dst_reg] = cesk_set_fork(frame->regs[src_reg]);
+	/* the destination register refers the values as well */
+	cesk_set_iter_t iter;
+	if(NULL == cesk_set_iter(frame->regs[dst_reg], &iter))
+	{
+		LOG_ERROR("can not aquire iterator for register %d", dst_reg);
+		return -1;
+	}
+	uint32_t addr;
+	while(CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(&iter)))
+		cesk_store_incref(frame->store, addr);
 	return 0;
 }
 int cesk_frame_register_load(cesk_frame_t* frame, const dalvik_instruction_t* inst ,uint32_t dst_reg, uint32_t addr)
@@ -264,22 +573,26 @@ int cesk_frame_register_load(cesk_frame_t* frame, const dalvik_instruction_t* in
 		return -1;
 	}
 
-	/* clear the register first */
-	if(cesk_frame_register_clear(frame, inst, dst_reg) < 0)
+	/* incref first, because the register might hold the same address, and clearing the register
+	 * will make the value dead */
+	if(cesk_store_incref(frame->store, addr) < 0)
 	{
-		LOG_ERROR("can not clear the value in register %d", dst_reg);
+		LOG_ERROR("can not incref for the cell @%x", addr);
 		return -1;
 	}
 
-	if(cesk_set_push(frame->regs[dst_reg], addr) < 0)
+	/* clear the register */
+	if(cesk_frame_register_clear(frame, inst, dst_reg) < 0)
 	{
-		LOG_ERROR("can not push address @%x to register %d", addr, dst_reg);
+		LOG_ERROR("can not clear the value in register %d", dst_reg);
+		cesk_store_decref(frame->store, addr);
 		return -1;
 	}
 
-	if(cesk_store_incref(frame->store, addr) < 0)
+	if(cesk_set_push(frame->regs[dst_reg], addr) < 0)
 	{
-		LOG_ERROR("can not decref for the cell @%x", addr);
+		LOG_ERROR("can not push address @%x to register %d", addr, dst_reg);
+		cesk_store_decref(frame->store, addr);
 		return -1;
 	}
 
@@ -465,12 +778,13 @@ int cesk_frame_store_object_get(cesk_frame_t* frame,
 
 	const cesk_object_t* object = value->pointer.object;
 
-	uint32_t addr;
-	if(cesk_object_get_addr(object, classpath, field, &addr) < 0)
+	const uint32_t* paddr = cesk_object_field(object, classpath, cesk_object_field_resolve_cached(inst, classpath, field));
+	if(NULL == paddr)
 	{
 		LOG_ERROR("can not find the field %s/%s", classpath, field);
 		return -1;
 	}
+	uint32_t addr = *paddr;
 	/* load the value */
 
 	//return cesk_frame_register_load(frame, inst ,dst_reg, *paddr);
@@ -508,7 +822,7 @@ int cesk_frame_store_object_put(cesk_frame_t* frame,
 	
 	cesk_object_t* object = value->pointer.object;
 
-	uint32_t* paddr = cesk_object_get(object, classpath, field);
+	uint32_t* paddr = cesk_object_field(object, classpath, cesk_object_field_resolve_cached(inst, classpath, field));
 
 	if(NULL == paddr)
 	{
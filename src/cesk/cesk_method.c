@@ -0,0 +1,243 @@
+/**
+ * @file cesk_method.c
+ * @brief implementation of the method analyzer
+ */
+#include <pthread.h>
+#include <string.h>
+#include <log.h>
+#include <dalvik/dalvik_block.h>
+#include <cesk/cesk_block.h>
+#include <cesk/cesk_method.h>
+
+/* the range of tasks owned by a worker, the owner takes tasks from the head,
+ * and the thieves take the second half of the range */
+typedef struct {
+    pthread_mutex_t mutex;     /* the lock for this range */
+    int             head;      /* the next task to analyze */
+    int             tail;      /* the end of the range */
+} _cesk_method_range_t;
+
+/* the thread pool */
+typedef struct {
+    cesk_method_task_t*   tasks;      /* the tasks */
+    _cesk_method_range_t* ranges;     /* the range of each worker */
+    int                   nthreads;   /* the number of workers */
+} _cesk_method_pool_t;
+
+/* the argument passed to a worker */
+typedef struct {
+    _cesk_method_pool_t* pool;        /* the thread pool */
+    int                  id;          /* the index of the worker */
+} _cesk_method_worker_t;
+
+static int _cesk_method_nthreads = CESK_METHOD_NTHREADS;
+
+#if CESK_METHOD_ADAPTIVE_BLOCK
+/* count the instructions in the code blocks reachable from the block, the graph is walked with an
+ * explicit stack like the DFS of the fixpoint, and each block is pushed at most once */
+static uint32_t _cesk_method_count_inst(const dalvik_block_t* entry, uint8_t* visited, const dalvik_block_t** stack)
+{
+    uint32_t ret = 0;
+    int sp = 0, i;
+    if(NULL == entry) return 0;
+    visited[entry->index] = 1;
+    stack[sp ++] = entry;
+    while(sp > 0)
+    {
+        const dalvik_block_t* block = stack[-- sp];
+        ret += block->end - block->begin;
+        for(i = 0; i < block->nbranches; i ++)
+        {
+            const dalvik_block_t* next = block->branches[i].block;
+            if(block->branches[i].disabled || NULL == next || visited[next->index]) continue;
+            visited[next->index] = 1;
+            stack[sp ++] = next;
+        }
+    }
+    return ret;
+}
+/* make the stores of a small method small, so that forking a store does not copy a large block */
+static inline void _cesk_method_set_block_size(const dalvik_block_t* code, size_t max_size)
+{
+    static __thread uint8_t visited[DALVIK_BLOCK_MAX_KEYS];
+    static __thread const dalvik_block_t* stack[DALVIK_BLOCK_MAX_KEYS];
+    memset(visited, 0, sizeof(visited));
+    uint32_t nslots = _cesk_method_count_inst(code, visited, stack) * CESK_METHOD_SLOTS_PER_INST;
+    if(nslots < CESK_STORE_BLOCK_MIN_SLOTS) nslots = CESK_STORE_BLOCK_MIN_SLOTS;
+    size_t size = CESK_STORE_BLOCK_BYTES(nslots);
+    if(size > max_size) size = max_size;
+    LOG_DEBUG("use %zu bytes store blocks for a method of %u slots", size, nslots);
+    cesk_store_set_block_size(size);
+}
+#endif
+/* build the block graph of the method and run the analysis */
+static inline int _cesk_method_analyze(cesk_method_task_t* task, dalvik_block_t* code)
+{
+    task->graph = cesk_block_graph_new(code);
+    if(NULL == task->graph)
+    {
+        LOG_ERROR("can not build the block graph for method %s.%s", task->classpath, task->methodname);
+        return -1;
+    }
+    task->rc = cesk_block_graph_fixpoint(task->graph);
+    if(task->rc < 0)
+    {
+        LOG_ERROR("can not analyze method %s.%s", task->classpath, task->methodname);
+        return -1;
+    }
+    return 0;
+}
+int cesk_method_analyze(cesk_method_task_t* task)
+{
+    if(NULL == task)
+    {
+        LOG_ERROR("invalid argument");
+        return -1;
+    }
+    task->graph = NULL;
+    task->rc = -1;
+    dalvik_block_t* code = dalvik_block_from_method(task->classpath, task->methodname, task->typelist);
+    if(NULL == code)
+    {
+        LOG_ERROR("can not build the code blocks for method %s.%s", task->classpath, task->methodname);
+        return -1;
+    }
+#if CESK_METHOD_ADAPTIVE_BLOCK
+    size_t block_size = cesk_store_get_block_size();
+    _cesk_method_set_block_size(code, block_size);
+    int rc = _cesk_method_analyze(task, code);
+    cesk_store_set_block_size(block_size);
+    return rc;
+#else
+    return _cesk_method_analyze(task, code);
+#endif
+}
+/* take the next task from the range of the worker, return -1 if the range is empty */
+static inline int _cesk_method_take(_cesk_method_range_t* range)
+{
+    int ret = -1;
+    pthread_mutex_lock(&range->mutex);
+    if(range->head < range->tail)
+        ret = range->head ++;
+    pthread_mutex_unlock(&range->mutex);
+    return ret;
+}
+/* steal half of the remaining tasks from other workers, and put them in the range of this worker.
+ * return 0 if there is nothing to steal */
+static inline int _cesk_method_steal(_cesk_method_pool_t* pool, int id)
+{
+    int i;
+    for(i = 1; i < pool->nthreads; i ++)
+    {
+        _cesk_method_range_t* victim = pool->ranges + (id + i) % pool->nthreads;
+        int begin, end;
+        pthread_mutex_lock(&victim->mutex);
+        end = victim->tail;
+        /* the victim keeps the first half, because it is working on the head */
+        begin = victim->head + (victim->tail - victim->head) / 2;
+        victim->tail = begin;
+        pthread_mutex_unlock(&victim->mutex);
+        if(begin < end)
+        {
+            _cesk_method_range_t* self = pool->ranges + id;
+            LOG_DEBUG("worker %d steals task %d to %d from worker %d", id, begin, end, (id + i) % pool->nthreads);
+            pthread_mutex_lock(&self->mutex);
+            self->head = begin;
+            self->tail = end;
+            pthread_mutex_unlock(&self->mutex);
+            return 1;
+        }
+    }
+    return 0;
+}
+/* the analyzer thread */
+static void* _cesk_method_worker(void* data)
+{
+    _cesk_method_worker_t* worker = (_cesk_method_worker_t*)data;
+    _cesk_method_pool_t* pool = worker->pool;
+    for(;;)
+    {
+        int next = _cesk_method_take(pool->ranges + worker->id);
+        if(next < 0)
+        {
+            /* nothing to do for this worker, and nothing to steal, so all tasks are taken */
+            if(0 == _cesk_method_steal(pool, worker->id)) break;
+            continue;
+        }
+        cesk_method_analyze(pool->tasks + next);
+    }
+    return NULL;
+}
+/* analyze the tasks with a work-stealing thread pool */
+static inline int _cesk_method_analyze_parallel(cesk_method_task_t* tasks, int ntasks, int nthreads)
+{
+    pthread_t threads[CESK_METHOD_MAX_THREADS];
+    _cesk_method_range_t ranges[CESK_METHOD_MAX_THREADS];
+    _cesk_method_worker_t workers[CESK_METHOD_MAX_THREADS];
+    _cesk_method_pool_t pool = {
+        .tasks    = tasks,
+        .ranges   = ranges,
+        .nthreads = nthreads
+    };
+    int i, nstarted;
+    /* initially, the tasks are evenly distributed */
+    for(i = 0; i < nthreads; i ++)
+    {
+        pthread_mutex_init(&ranges[i].mutex, NULL);
+        ranges[i].head = (int)((int64_t)ntasks * i / nthreads);
+        ranges[i].tail = (int)((int64_t)ntasks * (i + 1) / nthreads);
+        workers[i].pool = &pool;
+        workers[i].id = i;
+    }
+    for(nstarted = 0; nstarted < nthreads; nstarted ++)
+    {
+        if(pthread_create(threads + nstarted, NULL, _cesk_method_worker, workers + nstarted) != 0)
+        {
+            LOG_WARNING("can not create analyzer thread, only %d threads are running", nstarted);
+            break;
+        }
+    }
+    /* if no thread is running, do it in this thread. Otherwise the running threads
+     * will steal the tasks of the workers which are not started */
+    if(0 == nstarted)
+        _cesk_method_worker(workers);
+    for(i = 0; i < nstarted; i ++)
+        pthread_join(threads[i], NULL);
+    for(i = 0; i < nthreads; i ++)
+        pthread_mutex_destroy(&ranges[i].mutex);
+    return 0;
+}
+void cesk_method_set_nthreads(int nthreads)
+{
+    if(nthreads < 1) nthreads = 1;
+    if(nthreads > CESK_METHOD_MAX_THREADS) nthreads = CESK_METHOD_MAX_THREADS;
+    _cesk_method_nthreads = nthreads;
+}
+int cesk_method_get_nthreads()
+{
+    return _cesk_method_nthreads;
+}
+int cesk_method_analyze_all(cesk_method_task_t* tasks, int ntasks)
+{
+    if(NULL == tasks || ntasks < 0)
+    {
+        LOG_ERROR("invalid argument");
+        return -1;
+    }
+    int i, nfailed = 0;
+    if(_cesk_method_nthreads > 1 && ntasks > 1)
+    {
+        int nthreads = _cesk_method_nthreads;
+        if(nthreads > ntasks) nthreads = ntasks;
+        LOG_DEBUG("analyzing %d methods with %d threads", ntasks, nthreads);
+        _cesk_method_analyze_parallel(tasks, ntasks, nthreads);
+    }
+    else
+    {
+        for(i = 0; i < ntasks; i ++)
+            cesk_method_analyze(tasks + i);
+    }
+    for(i = 0; i < ntasks; i ++)
+        if(tasks[i].rc < 0) nfailed ++;
+    return nfailed;
+}
@@ -1,4 +1,5 @@
 #include <string.h>
+#include <pthread.h>
 
 #include <log.h>
 
@@ -9,72 +10,188 @@
 
 #include <cesk/cesk_set.h>
 #include <cesk/cesk_object.h>
-cesk_object_t* cesk_object_new(const char* classpath)
+/** @brief the hash table of the object layouts, a slot is only modified with the lock held,
+ *         but it can be read without the lock */
+static cesk_object_layout_t* _cesk_object_layout_table[CESK_OBJECT_LAYOUT_HASH_SIZE];
+static pthread_mutex_t _cesk_object_layout_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static inline hashval_t _cesk_object_layout_hash(const char* classpath)
+{
+	return (((uintptr_t)classpath) * MH_MULTIPLY) % CESK_OBJECT_LAYOUT_HASH_SIZE;
+}
+/** @brief find the layout in the slot */
+static inline cesk_object_layout_t* _cesk_object_layout_find(cesk_object_layout_t** slot, const char* classpath)
+{
+	cesk_object_layout_t* layout;
+	for(layout = __atomic_load_n(slot, __ATOMIC_ACQUIRE); NULL != layout; layout = layout->next)
+		if(layout->classpath == classpath) return layout;
+	return NULL;
+}
+/** @brief compute the layout of the class, walk through the inherence chain and build the prototype */
+static inline cesk_object_layout_t* _cesk_object_layout_build(const char* classpath)
 {
-    int field_count = 0;
-    int class_count = 0;
-    dalvik_class_t* classes[1024]; 
+	int field_count = 0;
+	int class_count = 0;
+	dalvik_class_t* classes[1024]; 
+	const char* path = classpath;
 	/* find classes inhernt relationship, and determin the memory layout */
-    for(;;)
-    {
-        LOG_NOTICE("try to find class %s", classpath);
-        dalvik_class_t* target_class = dalvik_memberdict_get_class(classpath);
-        if(NULL == target_class)
-        {
-            /* TODO: handle the built-in classes */
-            LOG_WARNING("can not find class %s", classpath);
+	for(;;)
+	{
+		LOG_NOTICE("try to find class %s", path);
+		dalvik_class_t* target_class = dalvik_memberdict_get_class(path);
+		if(NULL == target_class)
+		{
+			/* TODO: handle the built-in classes */
+			LOG_WARNING("can not find class %s", path);
 			LOG_NOTICE("fixme: here we should handle the built-in classes");
-            break;
-        }
-        int i;
-        for(i = 0; target_class->members[i]; i ++)
-            field_count ++;
-        classes[class_count ++] = target_class;
+			break;
+		}
+		int i;
+		for(i = 0; target_class->members[i]; i ++)
+			field_count ++;
+		classes[class_count ++] = target_class;
 		if(class_count >= 1024)
 		{
 			LOG_ERROR("a class with inherent from more than 1024 classes? are you kidding me?");
 			return NULL;
 		}
-        LOG_INFO("found class %s at %p", classpath, target_class);
-        classpath = target_class->super;
-    }
-    /* compute the size required for this instance */
+		LOG_INFO("found class %s at %p", path, target_class);
+		path = target_class->super;
+	}
+	if(0 == class_count) return NULL;
+	/* compute the size required for this instance */
 	size_t size = sizeof(cesk_object_t) +                   	   /* header */
-                  sizeof(cesk_object_struct_t) * class_count +     /* class header */
-                  sizeof(cesk_set_t*) * field_count;   			   /* fields */
-	/* okay, create the new object */
-    cesk_object_t* object = (cesk_object_t*)malloc(size);
-    cesk_object_struct_t* base = object->members; 
-    if(NULL == object)
-    {
-        LOG_ERROR("can not allocate memory for new object %s", classes[0]->path);
-        return NULL;
-    }
-    int i;
-    for(i = 0; i < class_count; i ++)
-    {
-        int j;
-        for(j = 0; classes[i]->members[j]; j ++)
-        {
-            dalvik_field_t* field = dalvik_memberdict_get_field(classes[i]->path, classes[i]->members[j]);   /* because only function can overload */
-            if(NULL == field)
-            {
-                LOG_WARNING("Can not find field %s/%s, skip", classes[i]->path, classes[i]->members[j]);
-                continue;
-            }
-            base->valuelist[field->offset] = CESK_STORE_ADDR_NULL;  
-            LOG_DEBUG("Create new filed %s/%s for class %s at offset %d", classes[i]->path, 
-                                                                         classes[i]->members[j], 
-                                                                         classes[0]->path, 
-                                                                         field->offset);
-        }
-        base->class = classes[i];
-        base->num_members = j;
+	              sizeof(cesk_object_struct_t) * class_count +     /* class header */
+	              sizeof(uint32_t) * field_count;   			   /* fields */
+	cesk_object_layout_t* layout = (cesk_object_layout_t*)malloc(sizeof(cesk_object_layout_t));
+	cesk_object_t* object = (cesk_object_t*)malloc(size);
+	if(NULL == layout || NULL == object)
+	{
+		LOG_ERROR("can not allocate memory for the layout of class %s", classpath);
+		if(NULL != layout) free(layout);
+		if(NULL != object) free(object);
+		return NULL;
+	}
+	cesk_object_struct_t* base = object->members; 
+	int i;
+	for(i = 0; i < class_count; i ++)
+	{
+		int j;
+		for(j = 0; classes[i]->members[j]; j ++)
+		{
+			base->valuelist[j] = CESK_STORE_ADDR_NULL;  
+			LOG_DEBUG("Create new filed %s/%s for class %s at offset %d", classes[i]->path, 
+			                                                             classes[i]->members[j], 
+			                                                             classpath, j);
+		}
+		base->class = classes[i];
+		base->num_members = j;
 		CESK_OBJECT_STRUCT_ADVANCE(base);
-    }
-    object->depth = class_count;
+	}
+	object->depth = class_count;
 	object->size = size;
-    return object;
+
+	layout->classpath = classpath;
+	layout->depth = class_count;
+	layout->size = size;
+	layout->num_fields = field_count;
+	layout->prototype = object;
+	layout->next = NULL;
+	return layout;
+}
+void cesk_object_init()
+{
+	memset(_cesk_object_layout_table, 0, sizeof(_cesk_object_layout_table));
+}
+void cesk_object_finalize()
+{
+	int i;
+	for(i = 0; i < CESK_OBJECT_LAYOUT_HASH_SIZE; i ++)
+	{
+		cesk_object_layout_t* layout;
+		for(layout = _cesk_object_layout_table[i]; NULL != layout;)
+		{
+			cesk_object_layout_t* old = layout;
+			layout = layout->next;
+			free(old->prototype);
+			free(old);
+		}
+		_cesk_object_layout_table[i] = NULL;
+	}
+}
+const cesk_object_layout_t* cesk_object_layout(const char* classpath)
+{
+	if(NULL == classpath) return NULL;
+	cesk_object_layout_t** slot = _cesk_object_layout_table + _cesk_object_layout_hash(classpath);
+	cesk_object_layout_t* layout = _cesk_object_layout_find(slot, classpath);
+	if(NULL != layout) return layout;
+	/* not found, build the layout, and check again with the lock held, because another thread may have built it */
+	pthread_mutex_lock(&_cesk_object_layout_lock);
+	if(NULL == (layout = _cesk_object_layout_find(slot, classpath)) &&
+	   NULL != (layout = _cesk_object_layout_build(classpath)))
+	{
+		layout->next = *slot;
+		__atomic_store_n(slot, layout, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&_cesk_object_layout_lock);
+	return layout;
+}
+cesk_object_field_ref_t cesk_object_field_resolve(const char* classpath, const char* field_name)
+{
+	const cesk_object_layout_t* layout = cesk_object_layout(classpath);
+	if(NULL == layout)
+	{
+		LOG_WARNING("can not find the layout of class %s", classpath);
+		return CESK_OBJECT_FIELD_REF_NULL;
+	}
+	dalvik_field_t* field = dalvik_memberdict_get_field(classpath, field_name);
+	if(NULL == field || (field->attrs & DALVIK_ATTRS_STATIC))
+	{
+		LOG_WARNING("No field named %s/%s", classpath, field_name);
+		return CESK_OBJECT_FIELD_REF_NULL;
+	}
+	/* the struct of the class is followed by the structs of its superclasses in every instance */
+	uint64_t tail = layout->size - sizeof(cesk_object_t);
+	return (tail << 32) | field->offset;
+}
+cesk_object_field_ref_t cesk_object_field_resolve_cached(const dalvik_instruction_t* inst, const char* classpath, const char* field_name)
+{
+	uint64_t* slot;
+	if(NULL == inst ||
+	   DVM_INSTANCE != inst->opcode ||
+	   (DVM_FLAG_INSTANCE_GET != inst->flags && DVM_FLAG_INSTANCE_PUT != inst->flags) ||
+	   inst->operands[2].payload.methpath != classpath ||
+	   inst->operands[3].payload.methpath != field_name ||
+	   NULL == (slot = dalvik_instruction_cache_slot(inst)))
+		return cesk_object_field_resolve(classpath, field_name);
+	/* the result is the same in all threads, so it's fine that two threads resolve the field at the same time */
+	cesk_object_field_ref_t ref = __atomic_load_n(slot, __ATOMIC_RELAXED);
+	if(CESK_OBJECT_FIELD_REF_NULL == ref)
+	{
+		ref = cesk_object_field_resolve(classpath, field_name);
+		__atomic_store_n(slot, ref, __ATOMIC_RELAXED);
+	}
+	return ref;
+}
+cesk_object_t* cesk_object_new(const char* classpath)
+{
+	const cesk_object_layout_t* layout = cesk_object_layout(classpath);
+	size_t size = (NULL == layout) ? sizeof(cesk_object_t) : layout->size;
+	cesk_object_t* object = (cesk_object_t*)malloc(size);
+	if(NULL == object)
+	{
+		LOG_ERROR("can not allocate memory for new object %s", classpath);
+		return NULL;
+	}
+	if(NULL == layout)
+	{
+		/* the class is not found, so the object contains nothing */
+		object->depth = 0;
+		object->size = size;
+	}
+	else
+		memcpy(object, layout->prototype, size);
+	return object;
 }
 uint32_t* cesk_object_get(cesk_object_t* object, const char* classpath, const char* field_name)
 {
@@ -85,18 +202,8 @@ uint32_t* cesk_object_get(cesk_object_t* object, const char* classpath, const ch
 		LOG_ERROR("invalid arguments");
         return NULL;
 	}
-    int i;
-    cesk_object_struct_t* this = object->members;
-    for(i = 0; i < object->depth; i ++)
-    {
-        if(this->class->path == classpath) 
-        {
-            break;
-        }
-		/* move to next object struct */
-		CESK_OBJECT_STRUCT_ADVANCE(this);
-    }
-    if(object->depth == i)
+	uint32_t* ret = cesk_object_field(object, classpath, cesk_object_field_resolve(classpath, field_name));
+    if(NULL == ret)
     {
         LOG_WARNING("I can't find field named %s/%s in instance object of %s", 
                     classpath, 
@@ -104,14 +211,7 @@ uint32_t* cesk_object_get(cesk_object_t* object, const char* classpath, const ch
                     cesk_object_classpath(object));
         return NULL;
     }
-    
-    dalvik_field_t* field = dalvik_memberdict_get_field(classpath, field_name);
-    if(NULL == field)
-    {
-        LOG_WARNING("No field named %s/%s", classpath, field_name);
-        return NULL;
-    }
-    return this->valuelist + field->offset;
+    return ret;
 }
 void cesk_object_free(cesk_object_t* object)
 {
@@ -201,13 +301,13 @@ int cesk_object_equal(const cesk_object_t* first, const cesk_object_t* second)
 }
 const char* cesk_object_to_string(const cesk_object_t* object, char* buf, size_t sz)
 {
-    static char _buf[1024];
+    static __thread char _buf[1024];
     if(NULL == buf)
     {
         buf = _buf;
         sz = sizeof(_buf);
     }
-    char* p = _buf;
+    char* p = buf;
 #define __PR(fmt, args...) do{p += snprintf(p, buf + sz - p, fmt, ##args);}while(0)
     const cesk_object_struct_t* this = object->members;
     int i;
@@ -1,29 +1,102 @@
+#include <pthread.h>
 #include <cesk/cesk_reloc.h>
 #include <dalvik/dalvik_instruction.h>
 /** 
  * @file cesk_reloc.c
  * @brief implementation of relocation table
- * @todo  how to reduce the memory allocation cost
- * @todo  if the conflict is really rear, try to use a bloom filter to optimize this
- * @todo test it
+ * @details The conflicts are rare, so most lookups should miss. The table has a bloom filter
+ *          over the source addresses, so that a miss does not touch the hash table at all.
+ *          The entries are stored in an open addressing hash table which grows with the number
+ *          of conflicts, and the freed tables are kept in a pool, so that building a relocation 
+ *          table for a merge usually does not allocate any memory.
  */
 /**
- * @brief the relocate table node 
+ * @brief the relocate table entry
  */
-typedef struct _cesk_reloc_table_node_t {
-	uint32_t from;   /*!<from this address*/
+typedef struct {
+	uint32_t from;   /*!<from this address, CESK_STORE_ADDR_NULL means an empty entry */
 	uint32_t to;	 /*!<map to this address*/
-	struct _cesk_reloc_table_node_t* next;  /*!<used for hashing*/
-} cesk_reloc_table_node_t;
+} cesk_reloc_table_entry_t;
 struct _cesk_reloc_table_t {
-	cesk_reloc_table_node_t* htab[CESK_RELOC_TABLE_SIZE];
+	uint32_t bloom[CESK_RELOC_BLOOM_BITS / 32];   /*!<the bloom filter of the source addresses */
+	uint32_t size;                               /*!<the number of entries */
+	uint32_t capacity;                           /*!<the capacity of the hash table, a power of 2 */
+	cesk_reloc_table_entry_t* entries;           /*!<the hash table */
+	cesk_reloc_table_t* next;                    /*!<the next table in the pool */
 };
+/** @brief the pool of freed tables */
+static cesk_reloc_table_t* _cesk_reloc_table_pool = NULL;
+/** @brief the number of tables in the pool */
+static int _cesk_reloc_table_pool_size = 0;
+/** @brief the lock of the pool */
+static pthread_mutex_t _cesk_reloc_table_pool_lock = PTHREAD_MUTEX_INITIALIZER;
 /**
  * @brief the hash code for the relocate table 
  **/
 static inline hashval_t _cesk_reloc_table_entry_hashcode(uint32_t fromaddr)
 {
-	return fromaddr;
+	return fromaddr * MH_MULTIPLY;
+}
+/** @brief the two bits of the address in the bloom filter */
+#define _CESK_RELOC_BLOOM_BIT0(h) ((h) % CESK_RELOC_BLOOM_BITS)
+#define _CESK_RELOC_BLOOM_BIT1(h) (((h) >> 16) % CESK_RELOC_BLOOM_BITS)
+/** @brief check if the address might be in the table */
+static inline int _cesk_reloc_table_bloom_test(const cesk_reloc_table_t* table, hashval_t h)
+{
+	uint32_t b0 = _CESK_RELOC_BLOOM_BIT0(h), b1 = _CESK_RELOC_BLOOM_BIT1(h);
+	return ((table->bloom[b0 / 32] >> (b0 % 32)) & (table->bloom[b1 / 32] >> (b1 % 32)) & 1);
+}
+/** @brief get an empty table from the pool, or make a new one */
+static inline cesk_reloc_table_t* _cesk_reloc_table_new()
+{
+	pthread_mutex_lock(&_cesk_reloc_table_pool_lock);
+	cesk_reloc_table_t* ret = _cesk_reloc_table_pool;
+	if(NULL != ret)
+	{
+		_cesk_reloc_table_pool = ret->next;
+		_cesk_reloc_table_pool_size --;
+	}
+	pthread_mutex_unlock(&_cesk_reloc_table_pool_lock);
+	if(NULL != ret) return ret;
+	ret = (cesk_reloc_table_t*)malloc(sizeof(cesk_reloc_table_t));
+	if(NULL == ret)
+	{
+		LOG_ERROR("can not allocate memory for the relocation table");
+		return NULL;
+	}
+	memset(ret, 0, sizeof(cesk_reloc_table_t));
+	return ret;
+}
+/** @brief find the entry of the address in the hash table, or the empty entry where it should be */
+static inline cesk_reloc_table_entry_t* _cesk_reloc_table_find(const cesk_reloc_table_t* table, uint32_t fromaddr, hashval_t h)
+{
+	uint32_t i;
+	for(i = h & (table->capacity - 1);
+		CESK_STORE_ADDR_NULL != table->entries[i].from && fromaddr != table->entries[i].from;
+		i = (i + 1) & (table->capacity - 1));
+	return table->entries + i;
+}
+/** @brief resize the hash table, so that it can hold n entries */
+static inline int _cesk_reloc_table_resize(cesk_reloc_table_t* table, uint32_t n)
+{
+	uint32_t capacity = CESK_RELOC_TABLE_INIT_SIZE;
+	while(capacity < 2 * n) capacity *= 2;
+	cesk_reloc_table_entry_t* entries = (cesk_reloc_table_entry_t*)malloc(sizeof(cesk_reloc_table_entry_t) * capacity);
+	if(NULL == entries)
+	{
+		LOG_ERROR("can not allocate memory for the relocation table");
+		return -1;
+	}
+	memset(entries, 0xff, sizeof(cesk_reloc_table_entry_t) * capacity);   /* CESK_STORE_ADDR_NULL */
+	cesk_reloc_table_entry_t* old = table->entries;
+	uint32_t old_capacity = table->capacity, i;
+	table->entries = entries;
+	table->capacity = capacity;
+	for(i = 0; i < old_capacity; i ++)
+		if(CESK_STORE_ADDR_NULL != old[i].from)
+			*_cesk_reloc_table_find(table, old[i].from, _cesk_reloc_table_entry_hashcode(old[i].from)) = old[i];
+	free(old);
+	return 0;
 }
 /** 
  * @brief insert an entry to the relocation table
@@ -32,20 +105,17 @@ static inline hashval_t _cesk_reloc_table_entry_hashcode(uint32_t fromaddr)
  **/
 static inline int _cesk_reloc_table_insert(cesk_reloc_table_t* table, uint32_t fromaddr, uint32_t toaddr)
 {
-	hashval_t h = _cesk_reloc_table_entry_hashcode(fromaddr) % CESK_RELOC_TABLE_SIZE;
-	cesk_reloc_table_node_t* ptr;
-	for(ptr = table->htab[h]; NULL != ptr; ptr = ptr->next)
+	hashval_t h = _cesk_reloc_table_entry_hashcode(fromaddr);
+	if(2 * (table->size + 1) > table->capacity && _cesk_reloc_table_resize(table, table->size + 1) < 0)
 	{
-		if(ptr->from == fromaddr)
-		{
-			LOG_DEBUG("find duplicated relocate table entry");
-			break;
-		}
+		LOG_ERROR("can not allocate memory for relocate table");
+		return -1;
 	}
+	cesk_reloc_table_entry_t* entry = _cesk_reloc_table_find(table, fromaddr, h);
 	/* if we find some entry that is already there */
-	if(NULL != ptr)
+	if(CESK_STORE_ADDR_NULL != entry->from)
 	{
-		if(ptr->to != toaddr)
+		if(entry->to != toaddr)
 		{
 			LOG_WARNING("ooops, there's different entries in the same key. does anything goes wrong?");
 			return -1;
@@ -53,36 +123,51 @@ static inline int _cesk_reloc_table_insert(cesk_reloc_table_t* table, uint32_t f
 		LOG_DEBUG("there's an entry already there");
 		return 0;
 	}
-	/* if we didn't find anything, then create a new node for this */
-	cesk_reloc_table_node_t* newnode = (cesk_reloc_table_node_t*)malloc(sizeof(cesk_reloc_table_node_t));
-	if(NULL == newnode)
-	{
-		LOG_ERROR("can not allocate memory for relocate table");
-		return -1;
-	}
-	newnode->from = fromaddr;
-	newnode->to = toaddr;
-	newnode->next = table->htab[h];
-	table->htab[h] = newnode;
+	entry->from = fromaddr;
+	entry->to = toaddr;
+	table->size ++;
+	uint32_t b0 = _CESK_RELOC_BLOOM_BIT0(h), b1 = _CESK_RELOC_BLOOM_BIT1(h);
+	table->bloom[b0 / 32] |= 1u << (b0 % 32);
+	table->bloom[b1 / 32] |= 1u << (b1 % 32);
 	LOG_DEBUG("relocating address @0x%x to @0x%x", fromaddr, toaddr);
 	return 0;
 }
 void cesk_reloc_table_free(cesk_reloc_table_t* table)
 {
 	if(NULL == table) return;
-	int i;
-	for(i = 0; i < CESK_RELOC_TABLE_SIZE; i ++)
+	/* clear the table and put it back to the pool, the hash table is kept for the next user */
+	if(table->size > 0)
 	{
-		cesk_reloc_table_node_t* ptr;
-		for(ptr = table->htab[i]; NULL == ptr;)
-		{
-			cesk_reloc_table_node_t* old = ptr;
-			ptr = ptr->next;
-			free(old);
-		}
+		memset(table->bloom, 0, sizeof(table->bloom));
+		memset(table->entries, 0xff, sizeof(cesk_reloc_table_entry_t) * table->capacity);
+		table->size = 0;
+	}
+	pthread_mutex_lock(&_cesk_reloc_table_pool_lock);
+	if(_cesk_reloc_table_pool_size < CESK_RELOC_TABLE_POOL_SIZE)
+	{
+		table->next = _cesk_reloc_table_pool;
+		_cesk_reloc_table_pool = table;
+		_cesk_reloc_table_pool_size ++;
+		table = NULL;
 	}
+	pthread_mutex_unlock(&_cesk_reloc_table_pool_lock);
+	if(NULL == table) return;
+	free(table->entries);
 	free(table);
 }
+void cesk_reloc_finalize()
+{
+	pthread_mutex_lock(&_cesk_reloc_table_pool_lock);
+	while(NULL != _cesk_reloc_table_pool)
+	{
+		cesk_reloc_table_t* table = _cesk_reloc_table_pool;
+		_cesk_reloc_table_pool = table->next;
+		free(table->entries);
+		free(table);
+	}
+	_cesk_reloc_table_pool_size = 0;
+	pthread_mutex_unlock(&_cesk_reloc_table_pool_lock);
+}
 cesk_reloc_table_t* cesk_reloc_table_from_store(cesk_store_t** p_dest, const cesk_store_t* sour)
 {
 	cesk_reloc_table_t*  ret = NULL;
@@ -93,13 +178,12 @@ cesk_reloc_table_t* cesk_reloc_table_from_store(cesk_store_t** p_dest, const ces
 	}
 	cesk_store_t* dest = *p_dest;
 
-	ret = (cesk_reloc_table_t*)malloc(sizeof(cesk_reloc_table_t));
+	ret = _cesk_reloc_table_new();
 	if(NULL == ret)
 	{
 		LOG_WARNING("can not allocate memory for the relocation table");
 		goto ERROR;
 	}
-	memset(ret, 0, sizeof(cesk_reloc_table_t));
 	/* because we do not delete any block in the block list, so the first part in each store should 
 	 * definately be couterparts
 	 */
@@ -112,46 +196,52 @@ cesk_reloc_table_t* cesk_reloc_table_from_store(cesk_store_t** p_dest, const ces
 	int i;
 	for(i = 0; i < npages; i ++)
 	{
-		if(sour->blocks[i] == dest->blocks[i])
+		const cesk_store_block_t* sour_block = cesk_store_get_block(sour, i);
+		if(sour_block == cesk_store_get_block(dest, i))
 		{
 			/* two block are actually the same, there's nothing different at all */
 			continue;
 		}
-		int j;
-		for(j = 0; j < CESK_STORE_BLOCK_NSLOTS; j ++)
+		/* only the slots written since the blocks split can be conflict */
+		uint32_t diff[CESK_STORE_BITMAP_WORDS(sour->nslots)];
+		cesk_store_block_diff(sour_block, cesk_store_get_block(dest, i), diff);
+		uint32_t j;
+		for(j = cesk_store_bitmap_next(diff, sour->nslots, 0); j < sour->nslots; j = cesk_store_bitmap_next(diff, sour->nslots, j + 1))
 		{
-			if(sour->blocks[i]->slots[j].value == NULL ||
-			   dest->blocks[i]->slots[j].value == NULL) 
+			/* the allocation below might fork the destination block, so look it up again */
+			const cesk_store_block_t* dest_block = cesk_store_get_block(dest, i);
+			if(CESK_STORE_BLOCK_VALUE(sour_block, j) == NULL ||
+			   CESK_STORE_BLOCK_VALUE(dest_block, j) == NULL) 
 				continue;
 
-			if(sour->blocks[i]->slots[j].value == dest->blocks[i]->slots[j].value)
+			if(CESK_STORE_BLOCK_VALUE(sour_block, j) == CESK_STORE_BLOCK_VALUE(dest_block, j))
 			{
 				/* the value are actually the same one */
 				continue;
 			}
-			if(sour->blocks[i]->slots[j].idx == dest->blocks[i]->slots[j].idx &&
-			   sour->blocks[i]->slots[j].parent == dest->blocks[i]->slots[j].parent &&
-			   sour->blocks[i]->slots[j].field == dest->blocks[i]->slots[j].field)
+			if(CESK_STORE_BLOCK_SLOT(sour_block, j)->idx == CESK_STORE_BLOCK_SLOT(dest_block, j)->idx &&
+			   CESK_STORE_BLOCK_SLOT(sour_block, j)->parent == CESK_STORE_BLOCK_SLOT(dest_block, j)->parent &&
+			   CESK_STORE_BLOCK_SLOT(sour_block, j)->field == CESK_STORE_BLOCK_SLOT(dest_block, j)->field)
 			{
 				/* if they should be together */
 				continue;
 			}
 			/* ignore the set form the source store */
-			if(sour->blocks[i]->slots[j].value->type == CESK_TYPE_SET)
+			if(CESK_STORE_BLOCK_VALUE(sour_block, j)->type == CESK_TYPE_SET)
 			{
 				continue;
 			}
 			/* the remaining is the address should not be same but actually they does */
-			const dalvik_instruction_t* inst = dalvik_instruction_get(sour->blocks[i]->slots[j].idx);
+			const dalvik_instruction_t* inst = dalvik_instruction_get(CESK_STORE_BLOCK_SLOT(sour_block, j)->idx);
 			if(NULL == inst)
 			{
-				LOG_WARNING("can not get instruction which id = %d, ignore this one", sour->blocks[i]->slots[j].idx);
+				LOG_WARNING("can not get instruction which id = %d, ignore this one", CESK_STORE_BLOCK_SLOT(sour_block, j)->idx);
 				continue;
 			}
 			/* we need to get the new address in the store */
 			uint32_t new_addr = cesk_store_allocate(p_dest, inst, 
-													sour->blocks[i]->slots[j].parent,
-													sour->blocks[i]->slots[j].field);
+													CESK_STORE_BLOCK_SLOT(sour_block, j)->parent,
+													CESK_STORE_BLOCK_SLOT(sour_block, j)->field);
 			if(CESK_STORE_ADDR_NULL == new_addr)
 			{
 				LOG_WARNING("can not allocate new address for the conflict object");
@@ -161,7 +251,7 @@ cesk_reloc_table_t* cesk_reloc_table_from_store(cesk_store_t** p_dest, const ces
 			/* because the p_dest might change, so we must update the value of dest now */
 			dest = *p_dest;
 			/* okay, build an actually relocation rule */
-			uint32_t old_addr = i * CESK_STORE_BLOCK_NSLOTS + j;
+			uint32_t old_addr = i * sour->nslots + j;
 			LOG_DEBUG("find relocation plan: @0x%x --> @0x%x", old_addr, new_addr);
 			/* now we insert the entry to the table */
 			if(_cesk_reloc_table_insert(ret, old_addr, new_addr) < 0)
@@ -169,8 +259,10 @@ cesk_reloc_table_t* cesk_reloc_table_from_store(cesk_store_t** p_dest, const ces
 				LOG_WARNING("can not build relocation rule from @0x%x to @0x%x", old_addr, new_addr);
 				continue;
 			}
+			/* the address is occupied by the object allocated by the same instruction already */
+			if(cesk_store_get_ro(dest, new_addr) != NULL) continue;
 			/* then we put an empty object in that place, so that we can merge the source object later */
-			cesk_value_t* newval = cesk_value_from_classpath(cesk_object_classpath(sour->blocks[i]->slots[j].value->pointer.object));
+			cesk_value_t* newval = cesk_value_from_classpath(cesk_object_classpath(CESK_STORE_BLOCK_VALUE(sour_block, j)->pointer.object));
 			if(NULL == newval)
 			{
 				LOG_ERROR("can not create new val for the relocated object");
@@ -195,15 +287,17 @@ ERROR:
 
 uint32_t cesk_reloc_table_look_for(const cesk_reloc_table_t* table, uint32_t addr)
 {
-	if(NULL == table || CESK_STORE_ADDR_IS_CONST(addr))
+	if(NULL == table)
 	{
 		LOG_ERROR("invalid argument");
 		return CESK_STORE_ADDR_NULL;
 	}
-	hashval_t h = _cesk_reloc_table_entry_hashcode(addr) % CESK_RELOC_TABLE_SIZE;
-	cesk_reloc_table_node_t* ptr;
-	for(ptr = table->htab[h]; NULL != ptr; ptr = ptr->next)
-		if(ptr->from == addr) return ptr->to;
+	/* the constants are never relocated */
+	if(0 == table->size || CESK_STORE_ADDR_IS_CONST(addr)) return addr;
+	hashval_t h = _cesk_reloc_table_entry_hashcode(addr);
+	if(!_cesk_reloc_table_bloom_test(table, h)) return addr;
+	const cesk_reloc_table_entry_t* entry = _cesk_reloc_table_find(table, addr, h);
+	if(CESK_STORE_ADDR_NULL != entry->from) return entry->to;
 	/* not found */
 	return addr;
 }
@@ -2,423 +2,520 @@
  *  @brief implementation of CESK address set
  */
 #include <string.h>
+#include <pthread.h>
 #include <log.h>
 #include <cesk/cesk_set.h>
-/** @brief invalid set id */
-#define CESK_SET_INVALID (~0u)
-/* We do not maintain a hash table for each set, because
- * most set contains a few element. 
- * Instead of maintaining a hash table for each set,
- * we maintain a large hash table use <set_idx, address>
- * as key. 
+/* Most set contains only a few elements, so the elements of a set
+ * are stored in a single memory block which is owned by the set.
+ *
+ * A small set is a sorted array, so the membership test is a binary
+ * search and the iteration is a linear scan of the array. When the set
+ * grows larger than CESK_SET_ARRAY_MAX, the block is converted to an
+ * open addressing hash table (the empty slot is CESK_STORE_ADDR_NULL,
+ * which never appears in a set).
+ *
+ * The memory block is shared by the forks of the set, and it's
+ * copy-on-write. A block is only modified by the thread that owns the
+ * only reference of it, but the empty block can be forked by any thread,
+ * so we need atomic operations on the reference counter.
+ *
+ * If hash-consing is enabled, after a set is modified, its block is
+ * interned in a global table by content. If there's a block with the
+ * same content, the set uses the existing block instead. So two
+ * interned sets are equal iff they share the same block. An interned
+ * block can be shared by many threads, so it's unlinked from the table
+ * before modified, and it's only modified by the owner of the only
+ * reference. The table is protected by lock stripes.
  */
-/** @brief the structure holds a address set */
-struct _cesk_set_t {
-    uint32_t set_idx;    /*!<the set index */
-};
-/**@brief data that the some set holds */
+/** @brief the memory block holds the elements of a set */
 typedef struct {
-    cesk_set_node_t *next;  /*!<next pointer*/
-} cesk_set_data_entry_t;
-/**@brief the entry that holds metadata of a set */
-typedef struct {
-    uint32_t size;          /*!<how many element in the set */
     uint32_t refcnt;        /*!<the reference count of this, indicates how many cesk_set_t for this set are returned */
+    uint32_t size;          /*!<how many element in the set */
+    uint32_t capacity;      /*!<the number of slots */
+    uint32_t hashed;        /*!<if this block is a hash table, otherwise it's a sorted array */
+    uint32_t interned;      /*!<if this block is in the hash-consing table */
     hashval_t hashcode;     /*!<the hash code of the set */
-    cesk_set_node_t* first; /*!<first element of the set */
-} cesk_set_info_entry_t;
-
-/**@brief the node in the hash table*/
-struct _cesk_set_node_t {
-    uint32_t set_idx;       /*!<the set index */
-    uint32_t addr;          /*!<the address this data entry refer to */
-    /* this pointer is for the hash table */
-    cesk_set_node_t *next;  /*!<next element in hash slot */
-    cesk_set_node_t *prev;  /*!<previous element in hash slot */
-    /* the following space is for the actuall data */
-    char data_section[0]; /*!<the data section of this node */
-    cesk_set_data_entry_t data_entry[0];   /*!<this is valid for a data entry node */
-    cesk_set_info_entry_t info_entry[0];   /*!<this is valid for an info entry node */
+    void* next;             /*!<the next block in the same slot of hash-consing table */
+    uint32_t slots[0];      /*!<the slots */
+} cesk_set_data_t;
+/** @brief the structure holds a address set */
+struct _cesk_set_t {
+    cesk_set_data_t* data;  /*!<the elements */
 };
 
-static cesk_set_node_t* _cesk_set_hash[CESK_SET_HASH_SIZE];
+static cesk_set_data_t _cesk_set_empty_data;  /* the data of the constant empty set */
+
+static cesk_set_data_t* _cesk_set_hashcons_table[CESK_SET_HASHCONS_SIZE];
 
-#define DATA_ENTRY 0
-#define INFO_ENTRY 1
+static pthread_mutex_t _cesk_set_hashcons_lock[CESK_SET_HASHCONS_LOCKS];
 
-#define INFO_ADDR CESK_STORE_ADDR_NULL  /* this is a dumb address to distingush between data_entry and info_entry */
+static int _cesk_set_hashcons_enabled = CESK_SET_HASHCONS;
 
-static inline cesk_set_node_t* _cesk_set_node_alloc(int type)
+/** @brief lock the slot of hash-consing table */
+#define _CESK_SET_LOCK(h) pthread_mutex_lock(_cesk_set_hashcons_lock + (h) % CESK_SET_HASHCONS_LOCKS)
+/** @brief unlock the slot of hash-consing table */
+#define _CESK_SET_UNLOCK(h) pthread_mutex_unlock(_cesk_set_hashcons_lock + (h) % CESK_SET_HASHCONS_LOCKS)
+
+static cesk_set_t _cesk_empty_set = {
+    .data = &_cesk_set_empty_data
+};
+
+static inline cesk_set_data_t* _cesk_set_data_alloc(uint32_t capacity, uint32_t hashed)
 {
-    size_t size = sizeof(cesk_set_node_t);
-    switch(type)
-    {
-        case DATA_ENTRY:
-            size += sizeof(cesk_set_data_entry_t);
-            break;
-        case INFO_ENTRY:
-            size += sizeof(cesk_set_info_entry_t);
-            break;
-        default:
-            LOG_ERROR("unknown type %d", type);
-            return NULL;
-    }
-    cesk_set_node_t* ret = (cesk_set_node_t*)malloc(size);
+    cesk_set_data_t* ret = (cesk_set_data_t*)malloc(sizeof(cesk_set_data_t) + sizeof(uint32_t) * capacity);
     if(NULL == ret)
     {
-        LOG_ERROR("can not allocate memory for node");
+        LOG_ERROR("can not allocate memory for set data");
         return NULL;
     }
-    memset(ret, 0, size);
+    ret->refcnt = 1;
+    ret->size = 0;
+    ret->capacity = capacity;
+    ret->hashed = hashed;
+    ret->interned = 0;
+    ret->hashcode = CESK_SET_EMPTY_HASH;
+    ret->next = NULL;
+    if(hashed)
+        memset(ret->slots, 0xff, sizeof(uint32_t) * capacity);   /* CESK_STORE_ADDR_NULL */
     return ret;
 }
-
-static inline uint32_t _cesk_set_idx_hashcode(uint32_t hashidx, uint32_t addr)
+/* the first slot to probe in a hash table */
+static inline uint32_t _cesk_set_data_slot(const cesk_set_data_t* data, uint32_t addr)
 {
-    return (hashidx * MH_MULTIPLY) ^ ((addr & 0xffff) * MH_MULTIPLY) ^ (addr >> 16);
+    return (addr * MH_MULTIPLY) & (data->capacity - 1);
 }
-/* the function will insert a node in the hash table regardless if it's duplicated
- * The return value of the function is the header address of data section
- */
-static inline void* _cesk_set_hash_insert(uint32_t setidx, uint32_t addr)
+/* look for the addr in the block, return the slot contains the addr, or the slot where the
+ * addr should be inserted */
+static inline uint32_t _cesk_set_data_find(const cesk_set_data_t* data, uint32_t addr, int* found)
 {
-    /* if addr == CESK_STORE_ADDR_NULL, the node is a info node */
-    uint32_t h = _cesk_set_idx_hashcode(setidx, addr) % CESK_SET_HASH_SIZE;
-    int type = DATA_ENTRY;
-    if(addr == CESK_STORE_ADDR_NULL) type = INFO_ENTRY;
-    cesk_set_node_t* ret = _cesk_set_node_alloc(type);
-    if(NULL == ret) return NULL;
-    ret->prev = NULL;
-    ret->next = _cesk_set_hash[h];
-    ret->set_idx = setidx;
-    ret->addr = addr;
-    if(_cesk_set_hash[h]) _cesk_set_hash[h]->prev = ret;
-    _cesk_set_hash[h] = ret;
-    return ret->data_section;
+    if(data->hashed)
+    {
+        uint32_t i;
+        for(i = _cesk_set_data_slot(data, addr);
+            CESK_STORE_ADDR_NULL != data->slots[i];
+            i = (i + 1) & (data->capacity - 1))
+        {
+            if(data->slots[i] == addr)
+            {
+                *found = 1;
+                return i;
+            }
+        }
+        *found = 0;
+        return i;
+    }
+    else
+    {
+        uint32_t l = 0, r = data->size;
+        while(l < r)
+        {
+            uint32_t m = (l + r) / 2;
+            if(data->slots[m] < addr) l = m + 1;
+            else r = m;
+        }
+        *found = (l < data->size && data->slots[l] == addr);
+        return l;
+    }
 }
-/* look for a value in the hash table, return the address of data section */
-static inline void* _cesk_set_hash_find(uint32_t setidx, uint32_t addr)
+/* put an addr in the hash table without duplication check, the table must have free slots */
+static inline void _cesk_set_data_hash_put(cesk_set_data_t* data, uint32_t addr)
 {
-    uint32_t h = _cesk_set_idx_hashcode(setidx, addr) % CESK_SET_HASH_SIZE;
-    cesk_set_node_t *p;
-    for(p = _cesk_set_hash[h]; p != NULL; p = p->next)
+    uint32_t i;
+    for(i = _cesk_set_data_slot(data, addr);
+        CESK_STORE_ADDR_NULL != data->slots[i];
+        i = (i + 1) & (data->capacity - 1));
+    data->slots[i] = addr;
+}
+/* compare the content of two blocks */
+static inline int _cesk_set_data_equal(const cesk_set_data_t* a, const cesk_set_data_t* b)
+{
+    if(a == b) return 1;
+    if(a->hashcode != b->hashcode) return 0;
+    if(a->size != b->size) return 0;
+    /* two sorted arrays */
+    if(!a->hashed && !b->hashed)
+        return 0 == memcmp(a->slots, b->slots, sizeof(uint32_t) * a->size);
+    uint32_t i;
+    int found;
+    for(i = 0; i < (a->hashed ? a->capacity : a->size); i ++)
     {
-        if(p->set_idx == setidx &&
-           p->addr    == addr)
-         {
-             return p->data_section;
-         }
+        if(CESK_STORE_ADDR_NULL == a->slots[i]) continue;
+        _cesk_set_data_find(b, a->slots[i], &found);
+        if(!found) return 0;
     }
-    LOG_TRACE("can not find the set hash entry (%d, @%x)", setidx, addr);
-    return NULL;
+    return 1;
 }
-/* allocate a fresh set index, and append the info entry to hash table */
-static inline uint32_t _cesk_set_idx_alloc(cesk_set_info_entry_t** p_entry)
+/* remove an interned block from the hash-consing table, the caller must hold the lock */
+static inline void _cesk_set_hashcons_unlink(cesk_set_data_t* data)
 {
-    static uint32_t next_idx = 0;
-    cesk_set_info_entry_t* entry = (cesk_set_info_entry_t*)_cesk_set_hash_insert(next_idx, CESK_STORE_ADDR_NULL);
-    if(NULL == entry)
+    cesk_set_data_t** p;
+    for(p = _cesk_set_hashcons_table + data->hashcode % CESK_SET_HASHCONS_SIZE;
+        NULL != *p && *p != data;
+        p = (cesk_set_data_t**)&(*p)->next);
+    if(NULL != *p) *p = (cesk_set_data_t*)data->next;
+    data->next = NULL;
+    data->interned = 0;
+}
+/* drop a reference to the block */
+static inline void _cesk_set_data_release(cesk_set_data_t* data)
+{
+    if(data->interned)
     {
-        LOG_ERROR("can not insert the set info to hash table");
-        return CESK_SET_INVALID;
+        /* nobody can find this block in the table while we are removing it */
+        uint32_t h = data->hashcode % CESK_SET_HASHCONS_SIZE;
+        _CESK_SET_LOCK(h);
+        if(0 == __atomic_sub_fetch(&data->refcnt, 1, __ATOMIC_ACQ_REL))
+        {
+            _cesk_set_hashcons_unlink(data);
+            free(data);
+        }
+        _CESK_SET_UNLOCK(h);
     }
-    entry->size = 0;
-    entry->refcnt = 0;
-    entry->first = NULL;
-    entry->hashcode = CESK_SET_EMPTY_HASH;  /* any magic number */
-    *(p_entry) = entry;
-    return next_idx ++;
+    else if(0 == __atomic_sub_fetch(&data->refcnt, 1, __ATOMIC_ACQ_REL))
+        free(data);
 }
-static cesk_set_t* _cesk_empty_set;   /* this is the only empty set in the table */
-void cesk_set_init()
+/* intern the block of the set, if there's a block with same content, use that block */
+static inline void _cesk_set_intern(cesk_set_t* set)
+{
+    cesk_set_data_t* data = set->data;
+    if(!_cesk_set_hashcons_enabled || data->interned) return;
+    uint32_t h = data->hashcode % CESK_SET_HASHCONS_SIZE;
+    cesk_set_data_t* p;
+    _CESK_SET_LOCK(h);
+    for(p = _cesk_set_hashcons_table[h]; NULL != p; p = (cesk_set_data_t*)p->next)
+    {
+        if(_cesk_set_data_equal(p, data))
+        {
+            __atomic_add_fetch(&p->refcnt, 1, __ATOMIC_RELAXED);
+            _CESK_SET_UNLOCK(h);
+            _cesk_set_data_release(data);
+            set->data = p;
+            return;
+        }
+    }
+    data->next = _cesk_set_hashcons_table[h];
+    data->interned = 1;
+    _cesk_set_hashcons_table[h] = data;
+    _CESK_SET_UNLOCK(h);
+}
+/* copy the elements in the block to a new block which can hold at least n elements */
+static inline cesk_set_data_t* _cesk_set_data_resize(const cesk_set_data_t* data, uint32_t n)
 {
-    /* make the constant empty set */
-    _cesk_empty_set = (cesk_set_t*)malloc(sizeof(cesk_set_t));
-    if(NULL == _cesk_empty_set)
+    cesk_set_data_t* ret;
+    if(n <= CESK_SET_ARRAY_MAX && !data->hashed)
+    {
+        /* a sorted array */
+        uint32_t capacity = CESK_SET_INIT_CAPACITY;
+        while(capacity < n) capacity *= 2;
+        if(capacity > CESK_SET_ARRAY_MAX) capacity = CESK_SET_ARRAY_MAX;
+        if(NULL == (ret = _cesk_set_data_alloc(capacity, 0))) return NULL;
+        memcpy(ret->slots, data->slots, sizeof(uint32_t) * data->size);
+    }
+    else
     {
-        LOG_FATAL("can not allocate memory for the constant set {}");
-        return;
+        /* a hash table, which is at most half full */
+        uint32_t capacity = CESK_SET_ARRAY_MAX;
+        while(capacity < 2 * n) capacity *= 2;
+        if(NULL == (ret = _cesk_set_data_alloc(capacity, 1))) return NULL;
+        uint32_t i;
+        for(i = 0; i < (data->hashed ? data->capacity : data->size); i ++)
+            if(CESK_STORE_ADDR_NULL != data->slots[i])
+                _cesk_set_data_hash_put(ret, data->slots[i]);
     }
-    cesk_set_info_entry_t* entry = NULL;
-    _cesk_empty_set->set_idx = _cesk_set_idx_alloc(&entry);
-    if(NULL == entry)
+    ret->size = data->size;
+    ret->hashcode = data->hashcode;
+    return ret;
+}
+/* make sure the data is owned by this set only, and there is room for n more elements */
+static inline cesk_set_data_t* _cesk_set_data_prepare_write(cesk_set_t* set, uint32_t n)
+{
+    cesk_set_data_t* data = set->data;
+    uint32_t need = data->size + n;
+    if(data->interned)
     {
-        LOG_FATAL("invalid hash info entry");
-        return;
+        /* if we are the only owner, take it out of the table, so nobody can share it */
+        uint32_t h = data->hashcode % CESK_SET_HASHCONS_SIZE;
+        _CESK_SET_LOCK(h);
+        if(1 == __atomic_load_n(&data->refcnt, __ATOMIC_ACQUIRE))
+            _cesk_set_hashcons_unlink(data);
+        _CESK_SET_UNLOCK(h);
     }
-    entry->refcnt ++;
+    int shared = (__atomic_load_n(&data->refcnt, __ATOMIC_ACQUIRE) > 1);
+    int full = data->hashed ? (2 * need > data->capacity) : (need > data->capacity);
+    if(!shared && !full) return data;
+    if(shared)
+    {
+        LOG_DEBUG("set data %p is refered by %d set objects, duplicate before writing", data, data->refcnt);
+    }
+    cesk_set_data_t* new = _cesk_set_data_resize(data, need);
+    if(NULL == new)
+    {
+        LOG_ERROR("can not duplicate the set");
+        return NULL;
+    }
+    _cesk_set_data_release(data);
+    set->data = new;
+    return new;
+}
+/* insert an element, the data must be writable and must have room for the element */
+static inline void _cesk_set_data_insert(cesk_set_data_t* data, uint32_t addr)
+{
+    int found;
+    uint32_t slot = _cesk_set_data_find(data, addr, &found);
+    if(found) return;
+    if(!data->hashed)
+        memmove(data->slots + slot + 1, data->slots + slot, sizeof(uint32_t) * (data->size - slot));
+    data->slots[slot] = addr;
+    data->hashcode ^= addr * MH_MULTIPLY;   /* update the hash code */
+    data->size ++;
+}
+void cesk_set_init()
+{
+    int i;
+    for(i = 0; i < CESK_SET_HASHCONS_LOCKS; i ++)
+        pthread_mutex_init(_cesk_set_hashcons_lock + i, NULL);
+    _cesk_set_empty_data.refcnt = 1;   /* the constant set itself */
+    _cesk_set_empty_data.size = 0;
+    _cesk_set_empty_data.capacity = 0;
+    _cesk_set_empty_data.hashed = 0;
+    _cesk_set_empty_data.hashcode = CESK_SET_EMPTY_HASH;
+    /* the empty set is always interned, it's never modified */
+    _cesk_set_empty_data.interned = 1;
+    _cesk_set_empty_data.next = NULL;
+    _cesk_set_hashcons_table[CESK_SET_EMPTY_HASH % CESK_SET_HASHCONS_SIZE] = &_cesk_set_empty_data;
 }
 void cesk_set_finalize()
 {
-    /* free all memory in the hash table */
+    /* the blocks are owned by the sets, we only clear the table */
     int i;
-    for(i = 0; i < CESK_SET_HASH_SIZE; i ++)
+    for(i = 0; i < CESK_SET_HASHCONS_SIZE; i ++)
     {
-        cesk_set_node_t *p;
-        for(p = _cesk_set_hash[i]; NULL != p; )
+        cesk_set_data_t* p;
+        for(p = _cesk_set_hashcons_table[i]; NULL != p;)
         {
-            cesk_set_node_t *old = p;
-            p = p->next;
-            free(old);
+            cesk_set_data_t* next = (cesk_set_data_t*)p->next;
+            p->interned = 0;
+            p->next = NULL;
+            p = next;
         }
+        _cesk_set_hashcons_table[i] = NULL;
     }
-    free(_cesk_empty_set);
+    for(i = 0; i < CESK_SET_HASHCONS_LOCKS; i ++)
+        pthread_mutex_destroy(_cesk_set_hashcons_lock + i);
+}
+void cesk_set_hashcons_enable(int enabled)
+{
+    _cesk_set_hashcons_enabled = enabled;
+}
+int cesk_set_hashcons_enabled()
+{
+    return _cesk_set_hashcons_enabled;
 }
 /* fork a set */
 cesk_set_t* cesk_set_fork(const cesk_set_t* sour)
 {
-    if(NULL == sour) return NULL;
-    /* verify if the set exists */
-    cesk_set_info_entry_t* info = (cesk_set_info_entry_t*) _cesk_set_hash_find(sour->set_idx, CESK_STORE_ADDR_NULL);
-    if(NULL == info)
-    {
-        LOG_ERROR("the set does not exist");
-        return NULL;
-    }
+    if(NULL == sour || NULL == sour->data) return NULL;
     cesk_set_t* ret = (cesk_set_t*)malloc(sizeof(cesk_set_t));
     if(NULL == ret) return NULL;
-    /* set the set index */
-    ret->set_idx = sour->set_idx;
+    ret->data = sour->data;
     /* update the reference counter */
-    info->refcnt ++;
+    __atomic_add_fetch(&sour->data->refcnt, 1, __ATOMIC_RELAXED);
     return ret;
 }
 /* make an empty set */
 cesk_set_t* cesk_set_empty_set()
 {
-    return cesk_set_fork(_cesk_empty_set);   /* fork the empty set to user */
+    return cesk_set_fork(&_cesk_empty_set);   /* fork the empty set to user */
 }
 
 size_t cesk_set_size(const cesk_set_t* set)
 {
     if(NULL == set) return 0;
-    cesk_set_info_entry_t* info = (cesk_set_info_entry_t*)_cesk_set_hash_find(set->set_idx, CESK_STORE_ADDR_NULL);
-    if(NULL == info) return 0;
-    return info->size;
+    return set->data->size;
 }
 void cesk_set_free(cesk_set_t* set)
 {
     if(NULL == set) return;
-    cesk_set_info_entry_t* info = (cesk_set_info_entry_t*)_cesk_set_hash_find(set->set_idx, CESK_STORE_ADDR_NULL);
-    if(NULL == info) return;
-	/* the reference counter is reduced to zero, no one is using this */
-    if(0 == --info->refcnt)
-    {
-		/* get the info node of this */
-        cesk_set_node_t* info_node = (cesk_set_node_t*)(((char*)info) - sizeof(cesk_set_node_t));
-        cesk_set_node_t* data_node;
-		/* tranverse all members of this set */
-        for(data_node = info->first; data_node != NULL;)
-        {
-            if(NULL != data_node->prev) 
-                data_node->prev->next = data_node->next;
-            else 
-            {
-                /* first element of the slot */
-                uint32_t h = _cesk_set_idx_hashcode(data_node->set_idx, data_node->addr) % CESK_SET_HASH_SIZE;
-                _cesk_set_hash[h] = data_node->next;
-            }
-            if(NULL != data_node->next) 
-                data_node->next->prev = data_node->prev;
-            cesk_set_node_t* tmp = data_node;
-            data_node = data_node->next;
-            free(tmp);
-        }
-		/* maintain the pointer used in the hash table */
-        if(NULL != info_node->prev)
-            info_node->prev->next = info_node->next;
-        else
-        {
-            uint32_t h = _cesk_set_idx_hashcode(info_node->set_idx, CESK_STORE_ADDR_NULL) % CESK_SET_HASH_SIZE;
-            _cesk_set_hash[h] = info_node->next;
-        }
-        if(NULL != info_node->next)
-            info_node->next->prev = info_node->prev;
-        free(info_node);
-    }
+    _cesk_set_data_release(set->data);
     free(set);
     return;
 }
 
 cesk_set_iter_t* cesk_set_iter(const cesk_set_t* set, cesk_set_iter_t* buf)
 {
-    if(NULL == set || NULL == buf) 
+    if(NULL == set || NULL == buf)
     {
         LOG_ERROR("invalid argument");
         return NULL;
     }
-    cesk_set_info_entry_t* info = (cesk_set_info_entry_t*)_cesk_set_hash_find(set->set_idx, CESK_STORE_ADDR_NULL);
-    if(NULL == info)
-    {
-        LOG_ERROR("can not find the set (id = %d)", set->set_idx);
-        return NULL;
-    }
-    buf->next = info->first;
+    const cesk_set_data_t* data = set->data;
+    buf->next = data->slots;
+    buf->end = data->slots + (data->hashed ? data->capacity : data->size);
     return buf;
 }
 
 uint32_t cesk_set_iter_next(cesk_set_iter_t* iter)
 {
     if(NULL == iter) return CESK_STORE_ADDR_NULL;
-    if(NULL == iter->next) return CESK_STORE_ADDR_NULL;
-    uint32_t ret = iter->next->addr;
-    //iter->next = iter->next->next;
-    iter->next = iter->next->data_entry->next;
-	return ret;
-}
-/* for performance reason, we also maintain reference counter here
- * Because we assume the caller always returns a new set rather than 
- * the old one, if this function is called
- */
-static inline uint32_t _cesk_set_duplicate(cesk_set_info_entry_t* info, cesk_set_info_entry_t** new)
-{
-    if(NULL == info)
-    {
-        LOG_ERROR("invalid arguments");
-        return CESK_SET_INVALID;
-    }
-    
-	cesk_set_info_entry_t* new_info = NULL;
-    uint32_t new_idx = _cesk_set_idx_alloc(&new_info);
-    if(NULL == new_info) 
-    {
-        LOG_ERROR("can not create a new set");
-        return CESK_SET_INVALID;
-    }
-    new_info->size = info->size;
-    new_info->hashcode = info->hashcode;
-
-    new_info->refcnt = 1;
-    info->refcnt --;
-
-    new_info->first = NULL;
-
-    /* duplicate the elements */
-    cesk_set_node_t* ptr;
-    for(ptr = info->first; NULL != ptr; ptr = ptr->data_entry->next)
-    {
-        uint32_t addr = ptr->addr;
-        /* 
-         * we do not need to check if the element is in the set, because the set is 
-         * newly created and must be empty 
-         */
-        cesk_set_node_t* node = (cesk_set_node_t*)(((char*)_cesk_set_hash_insert(new_idx, addr)) - sizeof(cesk_set_node_t));
-        node->data_entry->next = new_info->first;
-        new_info->first = node;
-    }
-
-    if(NULL != new) (*new) = new_info;
-
-    return new_idx;
+    /* skip the empty slots of a hash table */
+    while(iter->next < iter->end && CESK_STORE_ADDR_NULL == *iter->next)
+        iter->next ++;
+    if(iter->next >= iter->end) return CESK_STORE_ADDR_NULL;
+	return *(iter->next ++);
 }
 int cesk_set_push(cesk_set_t* dest, uint32_t addr)
 {
     if(NULL == dest || CESK_STORE_ADDR_NULL == addr)
         return -1;
-    if(CESK_SET_INVALID == dest->set_idx)
-        return -1;
-    cesk_set_info_entry_t *info;
-    info = (cesk_set_info_entry_t*)_cesk_set_hash_find(dest->set_idx, CESK_STORE_ADDR_NULL);
-    if(NULL == info)
+    /* do not duplicate the set if the element is already there */
+    if(cesk_set_contain(dest, addr)) return 0;
+    cesk_set_data_t* data = _cesk_set_data_prepare_write(dest, 1);
+    if(NULL == data)
     {
-        LOG_ERROR("can not find set #%d", dest->set_idx);
+        LOG_ERROR("can not write to the set");
         return -1;
     }
-    if(info->refcnt > 1)
+    _cesk_set_data_insert(data, addr);
+    _cesk_set_intern(dest);
+    return 0;
+}
+/* the union of two sorted arrays, return the size of the result */
+static inline uint32_t _cesk_set_array_union(uint32_t* result, const uint32_t* a, uint32_t na, const uint32_t* b, uint32_t nb)
+{
+    uint32_t i = 0, j = 0, n = 0;
+    while(i < na && j < nb)
     {
-        LOG_DEBUG("set #%d is refered by %d set objects, duplicate before writing", 
-                   dest->set_idx,
-                   info->refcnt);
-        cesk_set_info_entry_t *new;
-        uint32_t idx = _cesk_set_duplicate(info, &new);
-        if(CESK_SET_INVALID == idx)
+        if(a[i] < b[j]) result[n ++] = a[i ++];
+        else if(a[i] > b[j]) result[n ++] = b[j ++];
+        else
         {
-            LOG_ERROR("error during duplicate the set");
-            return -1;
+            result[n ++] = a[i ++];
+            j ++;
         }
-        dest->set_idx = idx;
-        info = new;
-    }
-    /* here we need to check the duplicate element, because 
-     * the set is not empty and might contains the same element
-     * already
-     */
-    if(NULL == _cesk_set_hash_find(dest->set_idx, addr))
-    {
-        /* if this is not a duplicate */
-        cesk_set_node_t* node = (cesk_set_node_t*)(((char*)_cesk_set_hash_insert(dest->set_idx, addr)) - sizeof(cesk_set_node_t));
-        node->data_entry->next = info->first;
-        info->first = node;
-        info->hashcode ^= addr * MH_MULTIPLY;   /* update the hash code */
-        info->size ++;
     }
-    return 0;
+    while(i < na) result[n ++] = a[i ++];
+    while(j < nb) result[n ++] = b[j ++];
+    return n;
 }
-/**
- * @brief prepair for merging two sets 
- **/
-static inline int _cesk_set_prepair_merge(
-		cesk_set_t* dest, 
-		const cesk_set_t* sour, 
-		cesk_set_info_entry_t** p_info_dst,
-		cesk_set_info_entry_t** p_info_src)
+/* merge sorted arrays, the destination is only written once */
+static inline int _cesk_set_merge_arrays(cesk_set_t* dest, const cesk_set_data_t* const* srcs, int n, uint32_t upper)
 {
-
-    if(NULL == sour || NULL == dest) return -1;
-    if(CESK_SET_INVALID == dest->set_idx ||
-       CESK_SET_INVALID == sour->set_idx)
-        return -1;
-    *p_info_dst = (cesk_set_info_entry_t*)_cesk_set_hash_find(dest->set_idx, CESK_STORE_ADDR_NULL);
-    if(NULL == *p_info_dst) 
+    uint32_t local[CESK_SET_ARRAY_MAX * 4];
+    uint32_t* buf = local;
+    if(2 * upper > sizeof(local) / sizeof(local[0]))
     {
-        LOG_ERROR("can not find set #%d", dest->set_idx);
-        return -1;
+        buf = (uint32_t*)malloc(sizeof(uint32_t) * 2 * upper);
+        if(NULL == buf)
+        {
+            LOG_ERROR("can not allocate memory for merging");
+            return -1;
+        }
     }
-    *p_info_src = (cesk_set_info_entry_t*)_cesk_set_hash_find(sour->set_idx, CESK_STORE_ADDR_NULL);
-    if(NULL == *p_info_src)
+    /* the union is computed in the two halves of the buffer alternately */
+    const uint32_t* cur = dest->data->slots;
+    uint32_t size = dest->data->size;
+    uint32_t* next = buf;
+    int i;
+    for(i = 0; i < n; i ++)
     {
-        LOG_ERROR("can not find set #%d", sour->set_idx);
-        return -1;
+        size = _cesk_set_array_union(next, cur, size, srcs[i]->slots, srcs[i]->size);
+        cur = next;
+        next = (next == buf) ? buf + upper : buf;
     }
-    if((*p_info_dst)->refcnt > 1)
+    int ret = 0;
+    /* nothing new, so we do not need to write the set */
+    if(size != dest->data->size)
     {
-        LOG_DEBUG("set #%d is refered by %d set objects, duplicate it before merging", dest->set_idx, (*p_info_dst)->refcnt);
-        cesk_set_info_entry_t *new;
-        uint32_t idx = _cesk_set_duplicate(*p_info_dst, &new);
-        if(CESK_SET_INVALID == idx)
+        cesk_set_data_t* data = _cesk_set_data_prepare_write(dest, size - dest->data->size);
+        if(NULL == data)
         {
-            LOG_ERROR("error during duplicate the set");
-            return -1;
+            LOG_ERROR("failed to prepair for merging");
+            ret = -1;
+        }
+        else if(!data->hashed)
+        {
+            hashval_t h = CESK_SET_EMPTY_HASH;
+            uint32_t k;
+            for(k = 0; k < size; k ++)
+                h ^= cur[k] * MH_MULTIPLY;
+            memcpy(data->slots, cur, sizeof(uint32_t) * size);
+            data->size = size;
+            data->hashcode = h;
+        }
+        else
+        {
+            uint32_t k;
+            for(k = 0; k < size; k ++)
+                _cesk_set_data_insert(data, cur[k]);
         }
-        dest->set_idx = idx;
-        *p_info_dst = new;
     }
-	return 0;
+    if(buf != local) free(buf);
+    return ret;
 }
-int cesk_set_merge(cesk_set_t* dest, const cesk_set_t* sour)
+int cesk_set_merge_n(cesk_set_t* dest, const cesk_set_t* const* sours, int n)
 {
-	cesk_set_info_entry_t* info_src = NULL;
-	cesk_set_info_entry_t* info_dst = NULL;
-	if(_cesk_set_prepair_merge(dest, sour, &info_dst, &info_src) < 0)
-	{
-		LOG_ERROR("failed to prepair for merging");
-		return -1;
-	}
-    cesk_set_node_t* ptr;
-    for(ptr = info_src->first; NULL != ptr; ptr = ptr->data_entry->next)
+    if(NULL == dest || (NULL == sours && n > 0) || n < 0) return -1;
+    const cesk_set_data_t* local[16];
+    const cesk_set_data_t** srcs = local;
+    if(n > sizeof(local) / sizeof(local[0]))
     {
-        uint32_t addr = ptr->addr;
-        if(NULL == _cesk_set_hash_find(dest->set_idx, addr))
+        srcs = (const cesk_set_data_t**)malloc(sizeof(cesk_set_data_t*) * n);
+        if(NULL == srcs)
         {
-            /* if this is not a duplicate */
-            cesk_set_node_t* node = (cesk_set_node_t*)(((char*)_cesk_set_hash_insert(dest->set_idx, addr)) - sizeof(cesk_set_node_t));
-            node->data_entry->next = info_dst->first;
-            info_dst->first = node;
-            info_dst->hashcode ^= addr * MH_MULTIPLY;
-            info_dst->size ++;
+            LOG_ERROR("can not allocate memory for merging");
+            return -1;
         }
     }
-    return 0;
+    /* collect the sources which can change the destination */
+    int i, m = 0, arrays = !dest->data->hashed;
+    uint32_t upper = dest->data->size;
+    for(i = 0; i < n; i ++)
+    {
+        if(NULL == sours[i])
+        {
+            LOG_ERROR("invalid source set");
+            if(srcs != local) free(srcs);
+            return -1;
+        }
+        const cesk_set_data_t* src = sours[i]->data;
+        /* empty set, or a fork of the destination */
+        if(0 == src->size || dest->data == src) continue;
+        if(src->hashed) arrays = 0;
+        upper += src->size;
+        srcs[m ++] = src;
+    }
+    int ret = 0;
+    if(0 == m)
+        ret = 0;
+    else if(arrays)
+        ret = _cesk_set_merge_arrays(dest, srcs, m, upper);
+    else
+    {
+        /* allocate the block for the result only once */
+        cesk_set_data_t* data = _cesk_set_data_prepare_write(dest, upper - dest->data->size);
+        if(NULL == data)
+        {
+            LOG_ERROR("failed to prepair for merging");
+            ret = -1;
+        }
+        else
+        {
+            for(i = 0; i < m; i ++)
+            {
+                uint32_t k;
+                for(k = 0; k < (srcs[i]->hashed ? srcs[i]->capacity : srcs[i]->size); k ++)
+                    if(CESK_STORE_ADDR_NULL != srcs[i]->slots[k])
+                        _cesk_set_data_insert(data, srcs[i]->slots[k]);
+            }
+        }
+    }
+    if(srcs != local) free(srcs);
+    if(0 == ret) _cesk_set_intern(dest);
+    return ret;
+}
+int cesk_set_merge(cesk_set_t* dest, const cesk_set_t* sour)
+{
+    return cesk_set_merge_n(dest, &sour, 1);
 }
 int cesk_set_merge_reloc(cesk_set_t* dest, const cesk_set_t* sour, const cesk_reloc_table_t* reloc_table)
 {
@@ -427,62 +524,56 @@ int cesk_set_merge_reloc(cesk_set_t* dest, const cesk_set_t* sour, const cesk_re
 		LOG_ERROR("reloc table should not be NULL");
 		return -1;
 	}
-	cesk_set_info_entry_t* info_src = NULL;
-	cesk_set_info_entry_t* info_dst = NULL;
-	if(_cesk_set_prepair_merge(dest, sour, &info_dst, &info_src) < 0)
-	{
-		LOG_ERROR("failed to prepair for merging");
-		return -1;
-	}
-    cesk_set_node_t* ptr;
-    for(ptr = info_src->first; NULL != ptr; ptr = ptr->data_entry->next)
+    if(NULL == dest || NULL == sour) return -1;
+    /* take a reference of the source, so that the destination is duplicated
+     * if they share the same data, and the source is not changed during merging */
+    cesk_set_data_t* src = sour->data;
+    __atomic_add_fetch(&src->refcnt, 1, __ATOMIC_RELAXED);
+    cesk_set_data_t* data = _cesk_set_data_prepare_write(dest, src->size);
+    if(NULL == data)
     {
-        uint32_t addr = cesk_reloc_table_look_for(reloc_table, ptr->addr);
-        if(NULL == _cesk_set_hash_find(dest->set_idx, addr))
-        {
-            /* if this is not a duplicate */
-            cesk_set_node_t* node = (cesk_set_node_t*)(((char*)_cesk_set_hash_insert(dest->set_idx, addr)) - sizeof(cesk_set_node_t));
-            node->data_entry->next = info_dst->first;
-            info_dst->first = node;
-            info_dst->hashcode ^= addr * MH_MULTIPLY;
-            info_dst->size ++;
-        }
+        LOG_ERROR("failed to prepair for merging");
+        _cesk_set_data_release(src);
+        return -1;
     }
+    uint32_t i;
+    for(i = 0; i < (src->hashed ? src->capacity : src->size); i ++)
+    {
+        if(CESK_STORE_ADDR_NULL == src->slots[i]) continue;
+        _cesk_set_data_insert(data, cesk_reloc_table_look_for(reloc_table, src->slots[i]));
+    }
+    _cesk_set_data_release(src);
+    _cesk_set_intern(dest);
 	return 0;
 }
 int cesk_set_contain(const cesk_set_t* set, uint32_t addr)
 {
     if(NULL == set) return 0;
     if(addr == CESK_STORE_ADDR_NULL) return 0;
-    return (NULL != _cesk_set_hash_find(set->set_idx, addr));
+    int found;
+    _cesk_set_data_find(set->data, addr, &found);
+    return found;
 }
 int cesk_set_equal(const cesk_set_t* first, const cesk_set_t* second)
 {
     if(NULL == first || NULL == second) return first == second;
-    if(cesk_set_hashcode(first) != cesk_set_hashcode(second)) return 0;
-    if(cesk_set_size(first) != cesk_set_size(second)) return 0;
-    cesk_set_iter_t iter_buf;
-    cesk_set_iter_t *iter;
-    uint32_t addr;
-    for(iter = cesk_set_iter(first, &iter_buf); 
-        iter != NULL &&
-        CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(iter));)
-        if(cesk_set_contain(second, addr) == 0) return 0;
-    return 1;
+    const cesk_set_data_t* a = first->data;
+    const cesk_set_data_t* b = second->data;
+    /* the interned blocks are canonical */
+    if(a->interned && b->interned) return a == b;
+    return _cesk_set_data_equal(a, b);
 }
 hashval_t cesk_set_hashcode(const cesk_set_t* set)
 {
-    cesk_set_info_entry_t* info = (cesk_set_info_entry_t*)_cesk_set_hash_find(set->set_idx, CESK_STORE_ADDR_NULL);
-    if(NULL == info) 
-        return 0;
-    return info->hashcode;
+    if(NULL == set) return 0;
+    return set->data->hashcode;
 }
 hashval_t cesk_set_compute_hashcode(const cesk_set_t* set)
 {
 	cesk_set_iter_t iter;
 	if(NULL == cesk_set_iter(set, &iter))
 	{
-		LOG_ERROR("can not aquire iterator for set %d", set->set_idx);
+		LOG_ERROR("can not aquire iterator for set %p", set);
 		return 0;
 	}
 	uint32_t ret = CESK_SET_EMPTY_HASH;
@@ -1,30 +1,230 @@
 #include <string.h>
+#include <pthread.h>
 
 #include <log.h>
 
 #include <cesk/cesk_store.h>
+#include <cesk/cesk_domain.h>
 
-#define HASH_INC(addr,val) (addr * MH_MULTIPLY + cesk_value_hashcode(val))
-#define HASH_CMP(addr,val) (addr * MH_MULTIPLY + cesk_value_compute_hashcode(val))
+#define HASH_INC(addr,val) ((addr) * MH_MULTIPLY + cesk_value_hashcode(val))
+#define HASH_CMP(addr,val) ((addr) * MH_MULTIPLY + cesk_value_compute_hashcode(val))
+/* The allocator should return the same address for the same (instruction, parent, field),
+ * so the store maintains an index from (instruction, parent, field) to the address. It's 
+ * an open addressing hash table, and it's shared by the forks of the store like the blocks.
+ *
+ * Every occupied slot in the store has an entry in the index, but the entry is not removed
+ * when the slot is freed or reused. So an entry is valid only if the slot it points to is
+ * occupied and allocated by the same (instruction, parent, field). The invalid entries are
+ * dropped when the index is resized.
+ */
+/** @brief an entry of the address index */
+typedef struct {
+	uint32_t idx;      /*!<the instruction index */
+	uint32_t parent;   /*!<the parent address */
+	uint32_t field;    /*!<the field offset */
+	uint32_t addr;     /*!<the address, CESK_STORE_ADDR_NULL means an empty entry */
+} cesk_store_index_entry_t;
+/** @brief the address index */
+struct _cesk_store_index_t {
+	uint32_t refcnt;                          /*!<for copy-on-write */
+	uint32_t size;                            /*!<the number of used entries */
+	uint32_t capacity;                        /*!<the number of entries, a power of 2 */
+	cesk_store_index_entry_t entries[0];      /*!<the entries */
+};
+/* The remembered set records the addresses that might become garbage since the last garbage collection,
+ * so that the collector only traces from them, see cesk_frame_gc. An object is garbage only if it's in a 
+ * reference cycle or it has never been referred, because the value is swiped out once its refcnt goes to
+ * zero. So the candidates are the addresses whose refcnt is decreased but not to zero, and the addresses
+ * attached with a value when the refcnt is zero. It's shared by the forks of the store like the index.
+ * 
+ * The remembered set overflows when there are more than CESK_STORE_REMSET_MAX_SIZE addresses, after that
+ * no address is recorded and a full collection is needed.
+ */
+/** @brief the remembered set */
+struct _cesk_store_remset_t {
+	uint32_t refcnt;                          /*!<for copy-on-write */
+	uint32_t size;                            /*!<the number of addresses */
+	uint32_t capacity;                        /*!<the capacity of the address array */
+	uint32_t overflow;                        /*!<if the remembered set overflowed */
+	uint32_t addrs[0];                        /*!<the addresses */
+};
+/* Each block has a dirty bitmap after the slots, which marks the slots written since the block gets its id.
+ * A block gets a new id when it's copied from another block, or it's written after a copy is made from it,
+ * so that the content of a block id never changes once the block is copied. And the bitmap of a block
+ * tells how the content differs from the content it is copied from. See cesk_store_block_diff */
+/** @brief the memory size of a block with n slots, including the dirty bitmap */
+#define _CESK_STORE_BLOCK_ALLOC_SIZE(n) (CESK_STORE_BLOCK_BYTES(n) + sizeof(uint32_t) * CESK_STORE_BITMAP_WORDS(n))
+/** @brief the dirty bitmap of a block */
+#define _CESK_STORE_BLOCK_DIRTY(block) ((uint32_t*)((char*)(block) + CESK_STORE_BLOCK_BYTES((block)->nslots)))
+/** @brief the last block id */
+static uint64_t _cesk_store_block_last_id = 0;
+/** @brief give a new id to the block, and clear the dirty bitmap */
+static inline void _cesk_store_block_renew(cesk_store_block_t* block, uint64_t base)
+{
+	block->id = __atomic_add_fetch(&_cesk_store_block_last_id, 1, __ATOMIC_RELAXED);
+	block->base = base;
+	block->copied = 0;
+	memset(_CESK_STORE_BLOCK_DIRTY(block), 0, sizeof(uint32_t) * CESK_STORE_BITMAP_WORDS(block->nslots));
+}
 /** @brief make a copy of a store block, but *do not set store-block refcnt* */
 static inline cesk_store_block_t* _cesk_store_block_fork(cesk_store_block_t* block)
 {
     /* copy the store block */
-    cesk_store_block_t* new_block = (cesk_store_block_t*)malloc(CESK_STORE_BLOCK_SIZE);
+    cesk_store_block_t* new_block = (cesk_store_block_t*)malloc(_CESK_STORE_BLOCK_ALLOC_SIZE(block->nslots));
     if(NULL == new_block) 
     {
         LOG_ERROR("can not allocate memory for new block");
         return NULL;
     }
-    memcpy(new_block, block, CESK_STORE_BLOCK_SIZE);
+    memcpy(new_block, block, CESK_STORE_BLOCK_BYTES(block->nslots));
     new_block->refcnt = 0;
+    _cesk_store_block_renew(new_block, block->id);
+    block->copied = 1;
     /* increase the reference counter of the vlaues in the block */
     int i;
-    for(i = 0; i < CESK_STORE_BLOCK_NSLOTS; i ++)
-        if(new_block->slots[i].value != NULL)
-            cesk_value_incref(new_block->slots[i].value);
+    for(i = 0; i < new_block->nslots; i ++)
+        if(CESK_STORE_BLOCK_VALUE(new_block, i) != NULL)
+            cesk_value_incref(CESK_STORE_BLOCK_VALUE(new_block, i));
     return new_block;
 }
+/** @brief decrease the store-block refcnt, and free the block if no one is using it */
+static inline void _cesk_store_block_release(cesk_store_block_t* block)
+{
+    if(block->refcnt > 0)
+        block->refcnt --;
+    if(block->refcnt == 0)
+    {
+        int j;
+        for(j = 0; j < block->nslots; j ++)
+            if(CESK_STORE_BLOCK_VALUE(block, j) != NULL)
+                cesk_value_decref(CESK_STORE_BLOCK_VALUE(block, j));
+        free(block);
+    }
+}
+#if CESK_STORE_PERSISTENT
+/* In the persistent store, the block table is an array mapped trie, the address bits of the block index
+ * select the child at each level. The nodes are copy-on-write objects like the blocks, so forking a store
+ * only increases the refcnt of the root, and a write only copies the nodes that are shared with other 
+ * stores on the path from the root to the block. The addresses are dense, so we do not compress the 
+ * children with a bitmap like a HAMT does. */
+/** @brief make an empty node of the block trie */
+static inline cesk_store_node_t* _cesk_store_node_new()
+{
+	cesk_store_node_t* ret = (cesk_store_node_t*)malloc(sizeof(cesk_store_node_t));
+	if(NULL == ret)
+	{
+		LOG_ERROR("can not allocate memory for the trie node");
+		return NULL;
+	}
+	memset(ret, 0, sizeof(cesk_store_node_t));
+	ret->refcnt = 1;
+	return ret;
+}
+/** @brief make a copy of a shared node at the given level, the children are shared by the copy */
+static inline cesk_store_node_t* _cesk_store_node_fork(const cesk_store_node_t* node, uint32_t level)
+{
+	cesk_store_node_t* ret = (cesk_store_node_t*)malloc(sizeof(cesk_store_node_t));
+	if(NULL == ret)
+	{
+		LOG_ERROR("can not allocate memory for the trie node");
+		return NULL;
+	}
+	memcpy(ret, node, sizeof(cesk_store_node_t));
+	ret->refcnt = 1;
+	int i;
+	for(i = 0; i < CESK_STORE_TRIE_FANOUT; i ++)
+	{
+		if(level > 1 && NULL != ret->child[i].node)
+			ret->child[i].node->refcnt ++;
+		else if(level == 1 && NULL != ret->child[i].block)
+			ret->child[i].block->refcnt ++;
+	}
+	return ret;
+}
+/** @brief decrease the refcnt of a node at the given level, and free the subtree if no one is using it */
+static void _cesk_store_node_release(cesk_store_node_t* node, uint32_t level)
+{
+	if(NULL == node || --node->refcnt > 0) return;
+	int i;
+	for(i = 0; i < CESK_STORE_TRIE_FANOUT; i ++)
+	{
+		if(level > 1)
+			_cesk_store_node_release(node->child[i].node, level - 1);
+		else if(NULL != node->child[i].block)
+			_cesk_store_block_release(node->child[i].block);
+	}
+	free(node);
+}
+#endif
+/** 
+ * @brief get a writable reference to the pointer of a block, the block itself is not forked. 
+ *        In the persistent store, the shared nodes on the path to the block are copied, and 
+ *        the missing nodes are created
+ */
+static inline cesk_store_block_t** _cesk_store_block_ref_rw(cesk_store_t* store, uint32_t b_idx)
+{
+#if CESK_STORE_PERSISTENT
+	cesk_store_node_t** p_node = &store->root;
+	uint32_t level;
+	for(level = store->depth; level > 0; level --)
+	{
+		cesk_store_node_t* node = *p_node;
+		if(NULL == node)
+			node = _cesk_store_node_new();
+		else if(node->refcnt > 1)
+		{
+			node = _cesk_store_node_fork(node, level);
+			if(NULL != node) (*p_node)->refcnt --;
+		}
+		if(NULL == node)
+		{
+			LOG_ERROR("can not make the path to block %d writable", b_idx);
+			return NULL;
+		}
+		*p_node = node;
+		uint32_t k = (b_idx >> ((level - 1) * CESK_STORE_TRIE_BITS)) & (CESK_STORE_TRIE_FANOUT - 1);
+		if(1 == level) return &node->child[k].block;
+		p_node = &node->child[k].node;
+	}
+	LOG_ERROR("the block trie is empty");
+	return NULL;
+#else
+	return store->blocks + b_idx;
+#endif
+}
+/** @brief append a block to the store, the store takes over one refcnt of the block. 
+ *         The store might be reallocated, so the new store is returned via p_store
+ */
+static inline int _cesk_store_append_block(cesk_store_t** p_store, cesk_store_block_t* block)
+{
+	cesk_store_t* store = *p_store;
+#if CESK_STORE_PERSISTENT
+	/* the trie is full, so add a new level on the top of the trie */
+	if(NULL == store->root || 
+	   (store->depth * CESK_STORE_TRIE_BITS < 32 && store->nblocks == (1u << (store->depth * CESK_STORE_TRIE_BITS))))
+	{
+		cesk_store_node_t* root = _cesk_store_node_new();
+		if(NULL == root) return -1;
+		root->child[0].node = store->root;
+		store->root = root;
+		store->depth ++;
+	}
+	cesk_store_block_t** p_block = _cesk_store_block_ref_rw(store, store->nblocks);
+	if(NULL == p_block) return -1;
+#else
+	store = (cesk_store_t*)realloc(store, sizeof(cesk_store_t) + sizeof(cesk_store_block_t*) * (store->nblocks + 1));
+	if(NULL == store)
+	{
+		LOG_ERROR("can not increase the size of store");
+		return -1;
+	}
+	*p_store = store;
+	cesk_store_block_t** p_block = store->blocks + store->nblocks;
+#endif
+	*p_block = block;
+	store->nblocks ++;
+	return 0;
+}
 /** @brief set refcnt befofe actual deletion , intra-store decref all members of the set before free it */
 static inline int _cesk_store_free_set(cesk_store_t* store, cesk_set_t* set)
 {
@@ -71,13 +271,55 @@ static inline int _cesk_store_free_object(cesk_store_t* store, cesk_object_t* ob
 	}
 	return 0;
 }
+/* When a value is swiped out, the values it refers might be dead as well. Instead of swiping them out 
+ * recursively, which overflows the C stack for a long chain of values, the dead addresses found during
+ * swiping are pushed to a list, and swiped out after the outermost swiping is done */
+static inline cesk_store_block_t* _cesk_store_getblock_rw(cesk_store_t* store, uint32_t addr);
+/** @brief the depth of swiping in this thread */
+static __thread uint32_t _cesk_store_swipe_depth = 0;
+/** @brief the dead addresses that are not swiped out yet */
+static __thread uint32_t* _cesk_store_dead_addrs = NULL;
+/** @brief the number of dead addresses */
+static __thread uint32_t _cesk_store_dead_size = 0;
+/** @brief the capacity of the dead address list */
+static __thread uint32_t _cesk_store_dead_capacity = 0;
+/** @brief the key used to free the dead address list when the thread exits */
+static pthread_key_t _cesk_store_thread_key;
+static pthread_once_t _cesk_store_thread_key_once = PTHREAD_ONCE_INIT;
+static void _cesk_store_thread_key_init()
+{
+	if(pthread_key_create(&_cesk_store_thread_key, free) != 0)
+		LOG_WARNING("can not create the thread key, the dead address lists of exited threads are lost");
+}
+/** @brief push a dead address to the list, return -1 if the address should be swiped out immediately */
+static inline int _cesk_store_dead_push(uint32_t addr)
+{
+	if(0 == _cesk_store_swipe_depth) return -1;
+	if(_cesk_store_dead_size == _cesk_store_dead_capacity)
+	{
+		uint32_t capacity = _cesk_store_dead_capacity ? 2 * _cesk_store_dead_capacity : 64;
+		uint32_t* addrs = (uint32_t*)realloc(_cesk_store_dead_addrs, sizeof(uint32_t) * capacity);
+		if(NULL == addrs) 
+		{
+			LOG_WARNING("can not grow the dead address list, swipe out the value recursively");
+			return -1;
+		}
+		_cesk_store_dead_addrs = addrs;
+		_cesk_store_dead_capacity = capacity;
+		/* the list is freed when the thread exits */
+		pthread_once(&_cesk_store_thread_key_once, _cesk_store_thread_key_init);
+		pthread_setspecific(_cesk_store_thread_key, addrs);
+	}
+	_cesk_store_dead_addrs[_cesk_store_dead_size ++] = addr;
+	return 0;
+}
 /* make an address empty, but do not affect the intra-frame refcnt */
-static inline int _cesk_store_swipe(cesk_store_t* store, cesk_store_block_t* block, uint32_t addr)
+static inline int _cesk_store_swipe_value(cesk_store_t* store, cesk_store_block_t* block, uint32_t addr)
 {
-    uint32_t ofs = addr % CESK_STORE_BLOCK_NSLOTS;
-	cesk_value_t* value = block->slots[ofs].value;
+    uint32_t ofs = addr % store->nslots;
+	cesk_value_t* value = CESK_STORE_BLOCK_VALUE(block, ofs);
 	/* release the address */
-	block->slots[ofs].value = NULL; 
+	CESK_STORE_BLOCK_VALUE(block, ofs) = NULL; 
 	
 	/* update the hashcode */
 	store->hashcode ^= HASH_INC(addr, value);
@@ -103,6 +345,30 @@ static inline int _cesk_store_swipe(cesk_store_t* store, cesk_store_block_t* blo
 	cesk_value_decref(value);
 	return 0;
 }
+/* make an address empty, and swipe out all values that are dead because of this */
+static inline int _cesk_store_swipe(cesk_store_t* store, cesk_store_block_t* block, uint32_t addr)
+{
+	_cesk_store_swipe_depth ++;
+	_cesk_store_swipe_value(store, block, addr);
+	_cesk_store_swipe_depth --;
+	if(_cesk_store_swipe_depth > 0) return 0;
+	/* this is the outermost swiping, so swipe out the dead values */
+	_cesk_store_swipe_depth ++;
+	while(_cesk_store_dead_size > 0)
+	{
+		addr = _cesk_store_dead_addrs[-- _cesk_store_dead_size];
+		uint32_t ofs = addr % store->nslots;
+		block = _cesk_store_getblock_rw(store, addr);
+		/* the address might be pushed twice */
+		if(NULL == block || NULL == CESK_STORE_BLOCK_VALUE(block, ofs) || CESK_STORE_BLOCK_SLOT(block, ofs)->refcnt > 0) continue;
+		_cesk_store_swipe_value(store, block, addr);
+		block->num_ent --;
+		store->num_ent --;
+	}
+	/* the list is kept for the next swiping, and released by cesk_store_finalize or when the thread exits */
+	_cesk_store_swipe_depth --;
+	return 0;
+}
 /** @brief addressing hash code */
 static inline hashval_t _cesk_store_address_hashcode(const dalvik_instruction_t* inst, uint32_t parent, uint32_t field_ofs)
 {
@@ -121,6 +387,185 @@ static inline hashval_t _cesk_store_address_hashcode(const dalvik_instruction_t*
 	return (idx * idx * MH_MULTIPLY + parent * 100007 * MH_MULTIPLY + (field_ofs * MH_MULTIPLY * MH_MULTIPLY));
 
 }
+/** @brief the first entry to probe in the address index */
+static inline uint32_t _cesk_store_index_slot(const cesk_store_index_t* index, uint32_t idx, uint32_t parent, uint32_t field)
+{
+	return (idx * MH_MULTIPLY + parent * 100007 * MH_MULTIPLY + field * MH_MULTIPLY * MH_MULTIPLY) & (index->capacity - 1);
+}
+/** @brief check if the slot at the address is occupied by the object allocated by (idx, parent, field) */
+static inline int _cesk_store_index_verify(const cesk_store_t* store, uint32_t addr, uint32_t idx, uint32_t parent, uint32_t field)
+{
+	uint32_t block = addr / store->nslots;
+	uint32_t offset = addr % store->nslots;
+	if(block >= store->nblocks) return 0;
+	const cesk_store_block_t* blk = cesk_store_get_block(store, block);
+	const cesk_store_slot_t* slot = CESK_STORE_BLOCK_SLOT(blk, offset);
+	return NULL != CESK_STORE_BLOCK_VALUE(blk, offset) && slot->idx == idx && slot->parent == parent && slot->field == field;
+}
+/** @brief look for the address of (idx, parent, field), return CESK_STORE_ADDR_NULL if not found */
+static inline uint32_t _cesk_store_index_find(const cesk_store_t* store, uint32_t idx, uint32_t parent, uint32_t field)
+{
+	const cesk_store_index_t* index = store->index;
+	if(NULL == index) return CESK_STORE_ADDR_NULL;
+	uint32_t i;
+	for(i = _cesk_store_index_slot(index, idx, parent, field);
+		CESK_STORE_ADDR_NULL != index->entries[i].addr;
+		i = (i + 1) & (index->capacity - 1))
+	{
+		const cesk_store_index_entry_t* entry = index->entries + i;
+		if(entry->idx == idx && entry->parent == parent && entry->field == field)
+		{
+			if(_cesk_store_index_verify(store, entry->addr, idx, parent, field))
+				return entry->addr;
+			return CESK_STORE_ADDR_NULL;
+		}
+	}
+	return CESK_STORE_ADDR_NULL;
+}
+/** @brief make a new index which can hold n entries, and copy all valid entries from the old index */
+static inline cesk_store_index_t* _cesk_store_index_resize(const cesk_store_t* store, uint32_t n)
+{
+	const cesk_store_index_t* old = store->index;
+	uint32_t capacity = CESK_STORE_INDEX_INIT_SIZE;
+	while(capacity < 2 * n) capacity *= 2;
+	cesk_store_index_t* ret = (cesk_store_index_t*)malloc(sizeof(cesk_store_index_t) + sizeof(cesk_store_index_entry_t) * capacity);
+	if(NULL == ret)
+	{
+		LOG_ERROR("can not allocate memory for the address index");
+		return NULL;
+	}
+	ret->refcnt = 1;
+	ret->size = 0;
+	ret->capacity = capacity;
+	uint32_t i;
+	for(i = 0; i < capacity; i ++)
+		ret->entries[i].addr = CESK_STORE_ADDR_NULL;
+	if(NULL == old) return ret;
+	for(i = 0; i < old->capacity; i ++)
+	{
+		const cesk_store_index_entry_t* entry = old->entries + i;
+		if(CESK_STORE_ADDR_NULL == entry->addr) continue;
+		/* only the valid entries are copied */
+		if(!_cesk_store_index_verify(store, entry->addr, entry->idx, entry->parent, entry->field)) continue;
+		uint32_t j;
+		for(j = _cesk_store_index_slot(ret, entry->idx, entry->parent, entry->field);
+			CESK_STORE_ADDR_NULL != ret->entries[j].addr;
+			j = (j + 1) & (capacity - 1));
+		ret->entries[j] = *entry;
+		ret->size ++;
+	}
+	return ret;
+}
+/** @brief decrease the refcnt of the index, and free it if no one is using it */
+static inline void _cesk_store_index_release(cesk_store_index_t* index)
+{
+	if(NULL != index && 0 == --index->refcnt) free(index);
+}
+/** @brief add (idx, parent, field) -> addr to the index of the store */
+static inline int _cesk_store_index_insert(cesk_store_t* store, uint32_t idx, uint32_t parent, uint32_t field, uint32_t addr)
+{
+	cesk_store_index_t* index = store->index;
+	if(NULL == index || index->refcnt > 1 || 2 * (index->size + 1) > index->capacity)
+	{
+		/* the index is shared with other stores or it's full */
+		cesk_store_index_t* new_index = _cesk_store_index_resize(store, (NULL == index) ? 1 : index->size + 1);
+		if(NULL == new_index) return -1;
+		_cesk_store_index_release(index);
+		store->index = index = new_index;
+	}
+	uint32_t i;
+	for(i = _cesk_store_index_slot(index, idx, parent, field);
+		CESK_STORE_ADDR_NULL != index->entries[i].addr;
+		i = (i + 1) & (index->capacity - 1))
+	{
+		cesk_store_index_entry_t* entry = index->entries + i;
+		if(entry->idx == idx && entry->parent == parent && entry->field == field)
+		{
+			entry->addr = addr;
+			return 0;
+		}
+	}
+	index->entries[i].idx = idx;
+	index->entries[i].parent = parent;
+	index->entries[i].field = field;
+	index->entries[i].addr = addr;
+	index->size ++;
+	return 0;
+}
+/** @brief decrease the refcnt of the remembered set, and free it if no one is using it */
+static inline void _cesk_store_remset_release(cesk_store_remset_t* remset)
+{
+	if(NULL != remset && 0 == --remset->refcnt) free(remset);
+}
+/** @brief make a new remembered set with the given capacity, and copy the addresses in the old one */
+static inline cesk_store_remset_t* _cesk_store_remset_resize(const cesk_store_remset_t* old, uint32_t capacity)
+{
+	cesk_store_remset_t* ret = (cesk_store_remset_t*)malloc(sizeof(cesk_store_remset_t) + sizeof(uint32_t) * capacity);
+	if(NULL == ret)
+	{
+		LOG_ERROR("can not allocate memory for the remembered set");
+		return NULL;
+	}
+	ret->refcnt = 1;
+	ret->capacity = capacity;
+	ret->size = 0;
+	ret->overflow = 0;
+	if(NULL != old)
+	{
+		ret->size = old->size;
+		ret->overflow = old->overflow;
+		memcpy(ret->addrs, old->addrs, sizeof(uint32_t) * old->size);
+	}
+	return ret;
+}
+/** @brief mark the remembered set overflowed */
+static inline void _cesk_store_remset_overflow(cesk_store_t* store)
+{
+	cesk_store_remset_t* remset = store->remset;
+	if(NULL != remset && remset->overflow) return;
+	if(NULL == remset || remset->refcnt > 1)
+	{
+		/* the addresses are useless after overflow, so do not copy them */
+		cesk_store_remset_t* new_remset = _cesk_store_remset_resize(NULL, 0);
+		/* if we can not make a new one, the remembered set is still valid, but it might miss some garbage */
+		if(NULL == new_remset) return;
+		_cesk_store_remset_release(remset);
+		store->remset = remset = new_remset;
+	}
+	remset->overflow = 1;
+	remset->size = 0;
+}
+/** @brief add an address to the remembered set */
+static inline void _cesk_store_remset_add(cesk_store_t* store, uint32_t addr)
+{
+	cesk_store_remset_t* remset = store->remset;
+	if(NULL != remset)
+	{
+		if(remset->overflow) return;
+		/* the same address is usually added repeatedly */
+		if(remset->size > 0 && remset->addrs[remset->size - 1] == addr) return;
+	}
+	if(NULL == remset || remset->refcnt > 1 || remset->size == remset->capacity)
+	{
+		uint32_t capacity = (NULL == remset) ? CESK_STORE_REMSET_INIT_SIZE : remset->capacity;
+		if(NULL != remset && remset->size == capacity) capacity *= 2;
+		if(capacity > CESK_STORE_REMSET_MAX_SIZE)
+		{
+			LOG_DEBUG("the remembered set of store %p overflowed", store);
+			_cesk_store_remset_overflow(store);
+			return;
+		}
+		cesk_store_remset_t* new_remset = _cesk_store_remset_resize(remset, capacity);
+		if(NULL == new_remset)
+		{
+			_cesk_store_remset_overflow(store);
+			return;
+		}
+		_cesk_store_remset_release(remset);
+		store->remset = remset = new_remset;
+	}
+	remset->addrs[remset->size ++] = addr;
+}
 /** @brief get a block in a store and prepare to write */
 static inline cesk_store_block_t* _cesk_store_getblock_rw(cesk_store_t* store, uint32_t addr)
 {
@@ -129,13 +574,19 @@ static inline cesk_store_block_t* _cesk_store_getblock_rw(cesk_store_t* store, u
         LOG_ERROR("invailid argument");
         return NULL;
     }
-    uint32_t b_idx = addr / CESK_STORE_BLOCK_NSLOTS;
+    uint32_t b_idx = addr / store->nslots;
     if(b_idx >= store->nblocks)
     {
         LOG_ERROR("out of memory");
         return NULL;
     }
-    cesk_store_block_t* block = store->blocks[b_idx];
+    cesk_store_block_t** p_block = _cesk_store_block_ref_rw(store, b_idx);
+    if(NULL == p_block)
+    {
+        LOG_ERROR("can not aquire writable reference to the block");
+        return NULL;
+    }
+    cesk_store_block_t* block = *p_block;
 	/* if the block is used by more than one store, the block is not writable, so make a copy of 
 	 * the block and replace the old block with new  copy */
     if(block->refcnt > 1)
@@ -149,11 +600,77 @@ static inline cesk_store_block_t* _cesk_store_getblock_rw(cesk_store_t* store, u
         }
         newblock->refcnt = 1;
         block->refcnt --;   /* this is block-store ref count */
-        store->blocks[b_idx] = newblock;
+        *p_block = newblock;
         block = newblock;
     }
+    /* the block is going to be written after a copy is made from it, so the content of the id changes */
+    else if(block->copied)
+        _cesk_store_block_renew(block, block->id);
+    uint32_t ofs = addr % store->nslots;
+    _CESK_STORE_BLOCK_DIRTY(block)[ofs / 32] |= 1u << (ofs % 32);
     return block;
 }
+void cesk_store_block_diff(const cesk_store_block_t* first, const cesk_store_block_t* second, uint32_t* diff)
+{
+	uint32_t nwords = CESK_STORE_BITMAP_WORDS(first->nslots);
+	const uint32_t* first_dirty = _CESK_STORE_BLOCK_DIRTY(first);
+	const uint32_t* second_dirty = _CESK_STORE_BLOCK_DIRTY(second);
+	uint32_t i;
+	if(first == second)
+		memset(diff, 0, sizeof(uint32_t) * nwords);
+	/* the second block is copied from the first one */
+	else if(second->base == first->id)
+		memcpy(diff, second_dirty, sizeof(uint32_t) * nwords);
+	/* the first block is copied from the second one */
+	else if(first->base == second->id)
+		memcpy(diff, first_dirty, sizeof(uint32_t) * nwords);
+	/* both blocks are copied from the same one */
+	else if(0 != first->base && first->base == second->base)
+	{
+		for(i = 0; i < nwords; i ++)
+			diff[i] = first_dirty[i] | second_dirty[i];
+	}
+	else
+		memset(diff, 0xff, sizeof(uint32_t) * nwords);
+}
+/** @brief the number of slots in a block of the stores made in this thread, 0 means CESK_STORE_BLOCK_SIZE */
+static __thread uint32_t _cesk_store_nslots = 0;
+/** @brief the number of slots in a block of the given size */
+static inline uint32_t _cesk_store_nslots_from_size(size_t size)
+{
+	if(size < CESK_STORE_BLOCK_BYTES(0)) return 0;
+	return (size - CESK_STORE_BLOCK_BYTES(0)) / (CESK_STORE_BLOCK_BYTES(1) - CESK_STORE_BLOCK_BYTES(0));
+}
+void cesk_store_finalize(void)
+{
+	if(NULL == _cesk_store_dead_addrs) return;
+	pthread_setspecific(_cesk_store_thread_key, NULL);
+	free(_cesk_store_dead_addrs);
+	_cesk_store_dead_addrs = NULL;
+	_cesk_store_dead_size = 0;
+	_cesk_store_dead_capacity = 0;
+}
+int cesk_store_set_block_size(size_t size)
+{
+	if(0 == size)
+	{
+		_cesk_store_nslots = 0;
+		return 0;
+	}
+	uint32_t nslots = _cesk_store_nslots_from_size(size);
+	if(nslots < CESK_STORE_BLOCK_MIN_SLOTS)
+	{
+		LOG_ERROR("the block size %zu is too small, at least %d slots are required", size, CESK_STORE_BLOCK_MIN_SLOTS);
+		return -1;
+	}
+	_cesk_store_nslots = nslots;
+	return 0;
+}
+size_t cesk_store_get_block_size()
+{
+	if(0 == _cesk_store_nslots) return CESK_STORE_BLOCK_SIZE;
+	return CESK_STORE_BLOCK_BYTES(_cesk_store_nslots);
+}
 cesk_store_t* cesk_store_empty_store()
 {
    cesk_store_t* ret = (cesk_store_t*)malloc(sizeof(cesk_store_t));
@@ -163,15 +680,26 @@ cesk_store_t* cesk_store_empty_store()
        return NULL;
    }
    ret->nblocks = 0;
+   ret->nslots = _cesk_store_nslots ? _cesk_store_nslots : _cesk_store_nslots_from_size(CESK_STORE_BLOCK_SIZE);
    ret->num_ent = 0;
    ret->hashcode = CESK_STORE_EMPTY_HASH;
+   ret->index = NULL;
+   ret->remset = NULL;
+#if CESK_STORE_PERSISTENT
+   ret->depth = 0;
+   ret->root = NULL;
+#endif
    return ret;
 }
 
 cesk_store_t* cesk_store_fork(const cesk_store_t* store)
 {
+#if CESK_STORE_PERSISTENT
+    size_t size = sizeof(cesk_store_t);
+#else
     int i;
     size_t size = sizeof(cesk_store_t) + sizeof(cesk_store_block_t*) * store->nblocks;
+#endif
     cesk_store_t* ret = (cesk_store_t*)malloc(size);
     if(NULL == ret)
     {
@@ -180,50 +708,57 @@ cesk_store_t* cesk_store_fork(const cesk_store_t* store)
     }
 	/* what we should do is just duplicating the block table in the block */
     memcpy(ret, store, size);
+#if CESK_STORE_PERSISTENT
+    /* the trie is shared, so increase the refrence counter of the root */
+    if(NULL != ret->root) ret->root->refcnt ++;
+#else
     /* increase refrence counter of all blocks */
     for(i = 0; i < ret->nblocks; i ++)
         ret->blocks[i]->refcnt++;
+#endif
+    if(NULL != ret->index) ret->index->refcnt ++;
+    if(NULL != ret->remset) ret->remset->refcnt ++;
     LOG_DEBUG("a store of %d entities is being forked, %zu bytes copied", ret->num_ent, size);
     return ret;
 }
 cesk_value_const_t* cesk_store_get_ro(const cesk_store_t* store, uint32_t addr)
 {
-    uint32_t block_idx = addr / CESK_STORE_BLOCK_NSLOTS;
-    uint32_t offset    = addr % CESK_STORE_BLOCK_NSLOTS;
+    uint32_t block_idx = addr / store->nslots;
+    uint32_t offset    = addr % store->nslots;
     if(block_idx >= store->nblocks) 
     {
         LOG_ERROR("invalid address out of space");
         return NULL;
     }
-    const cesk_store_block_t* block = store->blocks[block_idx];
+    const cesk_store_block_t* block = cesk_store_get_block(store, block_idx);
     if(NULL == block)
     {
         LOG_ERROR("opps, it should not happen");
         return NULL;
     }
-    return (cesk_value_const_t*)block->slots[offset].value;
+    return (cesk_value_const_t*)CESK_STORE_BLOCK_VALUE(block, offset);
 }
 int cesk_store_is_reuse(const cesk_store_t* store, uint32_t addr)
 {
-	uint32_t block_idx = addr / CESK_STORE_BLOCK_NSLOTS;
-	uint32_t offset    = addr % CESK_STORE_BLOCK_NSLOTS;
+	uint32_t block_idx = addr / store->nslots;
+	uint32_t offset    = addr % store->nslots;
 	if(block_idx >= store->nblocks)
 	{
 		LOG_ERROR("out of memory");
 		return -1;
 	}
-	const cesk_store_block_t* block = store->blocks[block_idx];
+	const cesk_store_block_t* block = cesk_store_get_block(store, block_idx);
 	if(NULL == block)
 	{
 		LOG_ERROR("ooops, this should not happen");
 		return -1;
 	}
-	return block->slots[offset].reuse;
+	return CESK_STORE_BLOCK_SLOT(block, offset)->reuse;
 }
 int cesk_store_set_reuse(cesk_store_t* store, uint32_t addr)
 {
-	uint32_t block_idx = addr / CESK_STORE_BLOCK_NSLOTS;
-	uint32_t offset = addr / CESK_STORE_BLOCK_NSLOTS;
+	uint32_t block_idx = addr / store->nslots;
+	uint32_t offset = addr % store->nslots;
 	if(block_idx >= store->nblocks)
 	{
 		LOG_ERROR("out of memory");
@@ -235,14 +770,14 @@ int cesk_store_set_reuse(cesk_store_t* store, uint32_t addr)
 		LOG_ERROR("what's wrong?");
 		return -1;
 	}
-	block->slots[offset].reuse = 1;
+	CESK_STORE_BLOCK_SLOT(block, offset)->reuse = 1;
 	return 0;
 }
 cesk_value_t* cesk_store_get_rw(cesk_store_t* store, uint32_t addr)
 {
-    uint32_t offset    = addr % CESK_STORE_BLOCK_NSLOTS;
+    uint32_t offset    = addr % store->nslots;
 	cesk_store_block_t* block = _cesk_store_getblock_rw(store, addr);
-	cesk_value_t* val = block->slots[offset].value;
+	cesk_value_t* val = CESK_STORE_BLOCK_VALUE(block, offset);
     if(val->refcnt > 1)
     {
         LOG_DEBUG("this value is refered by other frame block, so fork it first");
@@ -253,7 +788,7 @@ cesk_value_t* cesk_store_get_rw(cesk_store_t* store, uint32_t addr)
             return NULL;
         }
 
-        block->slots[offset].value = newval;
+        CESK_STORE_BLOCK_VALUE(block, offset) = newval;
 
 		/* maintain the value-block ref count */
         cesk_value_decref(val);
@@ -271,8 +806,8 @@ cesk_value_t* cesk_store_get_rw(cesk_store_t* store, uint32_t addr)
 }
 void cesk_store_release_rw(cesk_store_t* store, uint32_t addr)
 {
-    uint32_t block_idx = addr / CESK_STORE_BLOCK_NSLOTS;
-    uint32_t offset    = addr % CESK_STORE_BLOCK_NSLOTS;
+    uint32_t block_idx = addr / store->nslots;
+    uint32_t offset    = addr % store->nslots;
     if(block_idx >= store->nblocks) 
     {
         LOG_ERROR("invalid address out of space");
@@ -284,7 +819,7 @@ void cesk_store_release_rw(cesk_store_t* store, uint32_t addr)
         LOG_ERROR("opps, it should not happen");
         return;
     }
-    cesk_value_t* val = block->slots[offset].value;
+    cesk_value_t* val = CESK_STORE_BLOCK_VALUE(block, offset);
     if(val->write_status == 0)
     {
         LOG_WARNING("there's no writable pointer accociated to this status");
@@ -301,12 +836,13 @@ hashval_t cesk_store_compute_hashcode(const cesk_store_t* store)
 	int i,j;
 	for(i = 0; i < store->nblocks; i ++)
 	{
-		for(j = 0; j < CESK_STORE_BLOCK_NSLOTS; j ++)
+		const cesk_store_block_t* block = cesk_store_get_block(store, i);
+		for(j = 0; j < store->nslots; j ++)
 		{
-			if(NULL != store->blocks[i]->slots[j].value && store->blocks[i]->slots[j].value->write_status == 0)
+			if(NULL != CESK_STORE_BLOCK_VALUE(block, j) && CESK_STORE_BLOCK_VALUE(block, j)->write_status == 0)
 			{
-				uint32_t addr = i * CESK_STORE_BLOCK_NSLOTS + j;
-				ret ^= HASH_CMP(addr, store->blocks[i]->slots[j].value);
+				uint32_t addr = i * store->nslots + j;
+				ret ^= HASH_CMP(addr, CESK_STORE_BLOCK_VALUE(block, j));
 			}
 		}
 	}
@@ -317,95 +853,119 @@ uint32_t cesk_store_allocate(cesk_store_t** p_store, const dalvik_instruction_t*
     cesk_store_t* store = *p_store;
     uint32_t idx;
 	idx = dalvik_instruction_get_index(inst);
-    uint32_t  init_slot = _cesk_store_address_hashcode(inst, parent, field_ofs)  % CESK_STORE_BLOCK_NSLOTS;
+	/* if there's an object allocated by the same instruction, reuse the address */
+	uint32_t equal_addr = _cesk_store_index_find(store, idx, parent, field_ofs);
+	if(CESK_STORE_ADDR_NULL != equal_addr)
+	{
+        LOG_DEBUG("reuse %x for instruction %d", equal_addr, idx);
+		cesk_store_block_t* block = _cesk_store_getblock_rw(store, equal_addr);
+		if(NULL == block)
+		{
+			LOG_ERROR("can not aquire writable pointer to block");
+			return CESK_STORE_ADDR_NULL;
+		}
+        CESK_STORE_BLOCK_SLOT(block, equal_addr % store->nslots)->reuse = 1;
+		return equal_addr;
+	}
+    uint32_t  init_slot = _cesk_store_address_hashcode(inst, parent, field_ofs)  % store->nslots;
     uint32_t  slot = init_slot;
-    /* here we perform a quadratic probing inside each block
-     * But we do not jump more than 5 times in one block
-     * After tried 5 jumps, the allocator should allocate a 
-     * new store block anyway.
+    /* here we perform a quadratic probing inside each block to look for an empty slot
+     * But we do not jump more than 5 times in one block. A merge may leave the same
+     * object in two slots while the index only remembers one of them, so a slot of the
+     * same object found by the probing is still reused.
      */
     int empty_block = -1;
     int empty_offset = -1;
     int equal_block = -1;
     int equal_offset = -1;
     int attempt;
-    for(attempt = 0; attempt < CESK_STORE_ALLOC_ATTEMPT; attempt ++)
+    for(attempt = 0; attempt < CESK_STORE_ALLOC_ATTEMPT && equal_offset == -1; attempt ++)
     {
         int block;
         LOG_DEBUG("attempt #%d : slot @%d for instruction %d", attempt, slot, idx);
         for(block = 0; block < store->nblocks; block ++)
         {
-            if(store->blocks[block]->slots[slot].value == NULL && empty_offset == -1)
+            const cesk_store_block_t* blk = cesk_store_get_block(store, block);
+            if(CESK_STORE_BLOCK_VALUE(blk, slot) == NULL)
             {
-                LOG_DEBUG("find an empty slot @(block = %d, offset = %d)", block, slot);
-                empty_block = block;
-                empty_offset = slot;
+                if(empty_offset == -1)
+                {
+                    LOG_DEBUG("find an empty slot @(block = %d, offset = %d)", block, slot);
+                    empty_block = block;
+                    empty_offset = slot;
+                }
+                continue;
             }
-            if(store->blocks[block]->slots[slot].value != NULL && 
-               store->blocks[block]->slots[slot].idx == idx && 
-			   store->blocks[block]->slots[slot].parent == parent &&
-			   store->blocks[block]->slots[slot].field == field_ofs)
+            const cesk_store_slot_t* probe = CESK_STORE_BLOCK_SLOT(blk, slot);
+            if(probe->idx == idx && probe->parent == parent && probe->field == field_ofs)
             {
                 LOG_DEBUG("find the equal slot @(block = %d, offset = %d)", block, slot);
                 equal_block = block;
                 equal_offset = slot;
+                break;
             }
-            if(equal_offset != -1) break;
         }
-        if(equal_offset != -1) break;
-        slot = (slot * slot * MH_MULTIPLY + 100007 * slot + 634567) % CESK_STORE_BLOCK_NSLOTS;
+        slot = (slot * slot * MH_MULTIPLY + 100007 * slot + 634567) % store->nslots;
     }
-    /* After look for empty slot / equal slot */
-    if(empty_offset == -1 && equal_offset == -1)
+    if(equal_offset != -1)
     {
-        /* no empty slot, no equal slot, allocate a new block */
-        LOG_DEBUG("can not allocate a store entry for this object, allocate a new block. current_size = %d, num_ent = %d", 
-                   store->nblocks, store->num_ent);
-        store = realloc(store, sizeof(cesk_store_t) + sizeof(cesk_store_block_t*) * (store->nblocks + 1));
-        if(NULL == store)
-        {
-            LOG_ERROR("can not increase the size of store");
-            return CESK_STORE_ADDR_NULL;
-        }
-        (*p_store) = store;
-        store->blocks[store->nblocks] = (cesk_store_block_t*)malloc(CESK_STORE_BLOCK_SIZE);
-        if(NULL ==  store->blocks[store->nblocks])
+        equal_addr = equal_block * store->nslots + equal_offset;
+        LOG_DEBUG("reuse %x for instruction %d", equal_addr, idx);
+        cesk_store_block_t* block = _cesk_store_getblock_rw(store, equal_addr);
+        if(NULL == block)
         {
-            LOG_ERROR("can not allocate a new page for the block");
+            LOG_ERROR("can not aquire writable pointer to block");
             return CESK_STORE_ADDR_NULL;
         }
-        memset(store->blocks[store->nblocks], 0, CESK_STORE_BLOCK_SIZE);
-        store->blocks[store->nblocks]->refcnt ++;
-        empty_block = store->nblocks ++;
-        empty_offset = init_slot;   /* use the init_slot, so that we can locate it faster */
+        CESK_STORE_BLOCK_SLOT(block, equal_offset)->reuse = 1;
+        /* let the index point to this slot, so that we can find it faster next time */
+        if(_cesk_store_index_insert(store, idx, parent, field_ofs, equal_addr) < 0)
+            LOG_WARNING("can not update the address index");
+        return equal_addr;
     }
-	/* if there's no equal entry */
-    if(equal_offset == -1)
+    /* no empty slot, allocate a new block */
+    if(empty_offset == -1)
     {
-        if(empty_offset != -1)
+        LOG_DEBUG("can not allocate a store entry for this object, allocate a new block. current_size = %d, num_ent = %d", 
+                   store->nblocks, store->num_ent);
+        cesk_store_block_t* new_block = (cesk_store_block_t*)malloc(_CESK_STORE_BLOCK_ALLOC_SIZE(store->nslots));
+        if(NULL == new_block)
         {
-            LOG_DEBUG("allocate %lu (block=%d, offset = %d) for instruction %d", 
-                       empty_block * CESK_STORE_BLOCK_NSLOTS + empty_offset, empty_block, empty_offset, idx);
-            store->blocks[empty_block]->slots[empty_offset].idx = idx;
-			store->blocks[empty_block]->slots[empty_offset].parent = parent;
-			store->blocks[empty_block]->slots[empty_offset].field = field_ofs;
-			store->blocks[empty_block]->slots[empty_offset].reuse = 0;
-            return empty_block * CESK_STORE_BLOCK_NSLOTS + empty_offset;
+            LOG_ERROR("can not allocate a new page for the block");
+            return CESK_STORE_ADDR_NULL;
         }
-        else
+        memset(new_block, 0, CESK_STORE_BLOCK_BYTES(store->nslots));
+        new_block->refcnt ++;
+        new_block->nslots = store->nslots;
+        _cesk_store_block_renew(new_block, 0);
+        if(_cesk_store_append_block(p_store, new_block) < 0)
         {
-            LOG_ERROR("neither empty slot or equal entry has been found in the store, allocation failed");
+            LOG_ERROR("can not increase the size of store");
+            free(new_block);
             return CESK_STORE_ADDR_NULL;
         }
+        store = *p_store;
+        empty_block = store->nblocks - 1;
+        empty_offset = init_slot;   /* use the init_slot, so that we can locate it faster */
     }
-    else
-    {
-        /* some equal entry */
-        LOG_DEBUG("reuse %lu (block = %d, offset = %d for instruction %d",
-                   equal_block * CESK_STORE_BLOCK_NSLOTS + equal_offset, equal_block, equal_offset, idx);
-        store->blocks[equal_block]->slots[equal_offset].reuse = 1;   
-        return equal_block * CESK_STORE_BLOCK_NSLOTS  + equal_offset;
-    }
+	uint32_t addr = empty_block * store->nslots + empty_offset;
+	LOG_DEBUG("allocate %x (block=%d, offset = %d) for instruction %d", addr, empty_block, empty_offset, idx);
+	cesk_store_block_t* block = _cesk_store_getblock_rw(store, addr);
+	if(NULL == block)
+	{
+		LOG_ERROR("can not aquire writable pointer to block");
+		return CESK_STORE_ADDR_NULL;
+	}
+	CESK_STORE_BLOCK_SLOT(block, empty_offset)->idx = idx;
+	CESK_STORE_BLOCK_SLOT(block, empty_offset)->parent = parent;
+	CESK_STORE_BLOCK_SLOT(block, empty_offset)->field = field_ofs;
+	CESK_STORE_BLOCK_SLOT(block, empty_offset)->reuse = 0;
+	if(_cesk_store_index_insert(store, idx, parent, field_ofs, addr) < 0)
+	{
+		LOG_ERROR("can not update the address index");
+		return CESK_STORE_ADDR_NULL;
+	}
+	return addr;
 }
 int cesk_store_attach(cesk_store_t* store, uint32_t addr, cesk_value_t* value)
 {
@@ -414,14 +974,14 @@ int cesk_store_attach(cesk_store_t* store, uint32_t addr, cesk_value_t* value)
         LOG_ERROR("invalid arguments");
         return -1;
     }
-    uint32_t block = addr / CESK_STORE_BLOCK_NSLOTS;
-    uint32_t offset = addr % CESK_STORE_BLOCK_NSLOTS;
+    uint32_t block = addr / store->nslots;
+    uint32_t offset = addr % store->nslots;
     if(block >= store->nblocks)
     {
         LOG_ERROR("out of memory");
         return -1;
     }
-    if(value == store->blocks[block]->slots[offset].value)
+    if(value == CESK_STORE_BLOCK_VALUE(cesk_store_get_block(store, block), offset))
     {
         LOG_TRACE("value is already attached to this address");
         return 0;
@@ -429,51 +989,49 @@ int cesk_store_attach(cesk_store_t* store, uint32_t addr, cesk_value_t* value)
 	/* just aquire a writable pointer of this block */
 	cesk_store_block_t* block_rw = _cesk_store_getblock_rw(store, addr);
 	/* Assign an empty slot to a non-empty value means we add some new value to store */
-    if(block_rw->slots[offset].value == NULL && value != NULL) 
+    if(CESK_STORE_BLOCK_VALUE(block_rw, offset) == NULL && value != NULL) 
     {
         block_rw->num_ent ++;
         store->num_ent ++;
     }
 	/* On the other hand, if we assign a non-empty slot with a empty value, that means we want to
 	 * clean the value */
-    else if(block_rw->slots[offset].value != NULL && value == NULL)
+    else if(CESK_STORE_BLOCK_VALUE(block_rw, offset) != NULL && value == NULL)
     {
         block_rw->num_ent --;
         store->num_ent --;
     }
 	/* And we should swipe the old value out, but we can not affect the ref count, because
 	 * No matter what the slot contains, the ref count does not depends on the value */
-    if(NULL != block_rw->slots[offset].value)
+    if(NULL != CESK_STORE_BLOCK_VALUE(block_rw, offset))
 		_cesk_store_swipe(store, block_rw, addr);
     if(value)
     {
+        /* no one refers the value yet, it's garbage if no one refers it before the next collection */
+        if(0 == CESK_STORE_BLOCK_SLOT(block_rw, offset)->refcnt)
+            _cesk_store_remset_add(store, addr);
         /* reference to new value */
         cesk_value_incref(value);
 		value->write_status = 1;
 		/* we do not update new hash code here, that means we should use cesk_store_release_rw function
 		 * After we finish modifiying the store */
     }
-	block_rw->slots[offset].value = value;
-	block_rw->slots[offset].reuse = 0;  /* attach to a object, all previous object is lost */
+	CESK_STORE_BLOCK_VALUE(block_rw, offset) = value;
+	CESK_STORE_BLOCK_SLOT(block_rw, offset)->reuse = 0;  /* attach to a object, all previous object is lost */
     return 0;
 }
 void cesk_store_free(cesk_store_t* store)
 {
-    int i;
     if(NULL == store) return;
+#if CESK_STORE_PERSISTENT
+    _cesk_store_node_release(store->root, store->depth);
+#else
+    int i;
     for(i = 0; i < store->nblocks; i ++)
-    {
-        if(store->blocks[i]->refcnt > 0)
-            store->blocks[i]->refcnt --;
-        if(store->blocks[i]->refcnt == 0)
-        {
-            int j;
-            for(j = 0; j < CESK_STORE_BLOCK_NSLOTS; j ++)
-                if(store->blocks[i]->slots[j].value != NULL)
-                    cesk_value_decref(store->blocks[i]->slots[j].value);
-            free(store->blocks[i]);
-        }
-    }
+        _cesk_store_block_release(store->blocks[i]);
+#endif
+    _cesk_store_index_release(store->index);
+    _cesk_store_remset_release(store->remset);
     free(store);
 }
 
@@ -483,13 +1041,13 @@ int cesk_store_incref(cesk_store_t* store, uint32_t addr)
 	{
 		return 0;
 	}
-    uint32_t b_ofs = addr % CESK_STORE_BLOCK_NSLOTS;
+    uint32_t b_ofs = addr % store->nslots;
     cesk_store_block_t* block = _cesk_store_getblock_rw(store, addr);
     if(NULL == block)
         return -1;
-    if(block->slots[b_ofs].value != NULL)
+    if(CESK_STORE_BLOCK_VALUE(block, b_ofs) != NULL)
     {
-        return ++block->slots[b_ofs].refcnt;
+        return ++CESK_STORE_BLOCK_SLOT(block, b_ofs)->refcnt;
     }
     else
     {
@@ -503,7 +1061,7 @@ int cesk_store_decref(cesk_store_t* store, uint32_t addr)
 	{
 		return 0;
 	}
-    uint32_t ofs = addr % CESK_STORE_BLOCK_NSLOTS;
+    uint32_t ofs = addr % store->nslots;
     cesk_store_block_t* block = _cesk_store_getblock_rw(store, addr);
     if(NULL == block)
 	{
@@ -511,26 +1069,31 @@ int cesk_store_decref(cesk_store_t* store, uint32_t addr)
         return -1;
 	}
 
-    if(block->slots[ofs].value == NULL)
+    if(CESK_STORE_BLOCK_VALUE(block, ofs) == NULL)
     {
 		LOG_DEBUG("the value is empty");
         return 0;
     }
 
     /* decrease the counter */
-    if(block->slots[ofs].refcnt > 0) 
-        block->slots[ofs].refcnt --;
+    if(CESK_STORE_BLOCK_SLOT(block, ofs)->refcnt > 0) 
+        CESK_STORE_BLOCK_SLOT(block, ofs)->refcnt --;
 	else
 		LOG_WARNING("found an living object with 0 refcnt at address %x", addr);
 
-    if(0 == block->slots[ofs].refcnt)
+    if(0 == CESK_STORE_BLOCK_SLOT(block, ofs)->refcnt)
     {
         LOG_TRACE("value @0x%x is dead, swipe it out", addr);
+		/* if we are swiping out another value, it will be swiped out later */
+		if(0 == _cesk_store_dead_push(addr)) return 0;
 		_cesk_store_swipe(store, block, addr);
         block->num_ent --;
         store->num_ent --;
     }
-    return block->slots[ofs].refcnt;
+	else
+		/* the value might be in a garbage cycle now */
+		_cesk_store_remset_add(store, addr);
+    return CESK_STORE_BLOCK_SLOT(block, ofs)->refcnt;
 }
 
 
@@ -538,13 +1101,20 @@ int cesk_store_equal(const cesk_store_t* first, const cesk_store_t* second)
 {
     if(NULL == first || NULL == second) return first != second;
     if(first->nblocks != second->nblocks) return 0;   /* because there must be an occupied address that another store does not have */
+    if(first->nslots != second->nslots) return 0;     /* the addresses do not mean the same */
     if(cesk_store_hashcode(first) != cesk_store_hashcode(second)) return 0;
     int i;
     for(i = 0; i < first->nblocks; i ++)
     {
-        int j;
-        for(j = 0; j < CESK_STORE_BLOCK_NSLOTS; j ++)
-            if(cesk_value_equal(first->blocks[i]->slots[j].value, second->blocks[i]->slots[j].value) == 0)
+        const cesk_store_block_t* first_block = cesk_store_get_block(first, i);
+        const cesk_store_block_t* second_block = cesk_store_get_block(second, i);
+        /* the block is shared by two stores */
+        if(first_block == second_block) continue;
+        uint32_t diff[CESK_STORE_BITMAP_WORDS(first->nslots)];
+        cesk_store_block_diff(first_block, second_block, diff);
+        uint32_t j;
+        for(j = cesk_store_bitmap_next(diff, first->nslots, 0); j < first->nslots; j = cesk_store_bitmap_next(diff, first->nslots, j + 1))
+            if(cesk_value_equal(CESK_STORE_BLOCK_VALUE(first_block, j), CESK_STORE_BLOCK_VALUE(second_block, j)) == 0)
                 return 0;
     }
     return 1;
@@ -557,7 +1127,7 @@ uint32_t cesk_store_const_addr_from_operand(const dalvik_operand_t* operand)
         LOG_ERROR("can not create a value from a non-constant operand");
         return CESK_STORE_ADDR_NULL;
     }
-    int intval = 0;
+    int64_t intval = 0;
     switch(operand->header.info.type)
     {
         case DVM_OPERAND_TYPE_LONG:
@@ -572,31 +1142,25 @@ uint32_t cesk_store_const_addr_from_operand(const dalvik_operand_t* operand)
         case DVM_OPERAND_TYPE_BYTE:
             intval = operand->payload.int8;
             goto num;
+        /* the real numbers are only abstracted by their signs */
         case DVM_OPERAND_TYPE_DOUBLE:
             if(operand->payload.real64 < -1e-20)
-                intval = -1;
+                return CESK_STORE_ADDR_NEG;
             else if(operand->payload.real64 > 1e-20)
-                intval = 1;
+                return CESK_STORE_ADDR_POS;
             else 
-                intval = 0;
-            goto num;
+                return CESK_STORE_ADDR_ZERO;
         case DVM_OPERAND_TYPE_FLOAT:
             if(operand->payload.real32 < -1e-20)
-                intval = -1;
+                return CESK_STORE_ADDR_NEG;
             else if(operand->payload.real32 > 1e-20)
-                intval = 1;
+                return CESK_STORE_ADDR_POS;
             else 
-                intval = 0;
-            goto num;
+                return CESK_STORE_ADDR_ZERO;
         case DVM_OPERAND_TYPE_CHAR:
             intval = operand->payload.int8;
 num:
-            if(intval > 0)
-                return CESK_STORE_ADDR_POS;
-            else if(intval < 0)
-                return CESK_STORE_ADDR_NEG;
-            else 
-                return CESK_STORE_ADDR_ZERO;
+            return cesk_domain_get()->from_int(intval);
         case DALVIK_TYPECODE_BOOLEAN:
             if(operand->payload.uint8)
                 return CESK_STORE_ADDR_TRUE;
@@ -611,22 +1175,41 @@ num:
 }
 uint32_t cesk_store_get_refcnt(const cesk_store_t* store, uint32_t addr)
 {
-    uint32_t idx = addr / CESK_STORE_BLOCK_NSLOTS;
-    uint32_t ofs = addr % CESK_STORE_BLOCK_NSLOTS;
-	return store->blocks[idx]->slots[ofs].refcnt;
+    uint32_t idx = addr / store->nslots;
+    uint32_t ofs = addr % store->nslots;
+	return CESK_STORE_BLOCK_SLOT(cesk_store_get_block(store, idx), ofs)->refcnt;
 }
 int cesk_store_clear_refcnt(cesk_store_t* store, uint32_t addr)
 {
-    uint32_t ofs = addr % CESK_STORE_BLOCK_NSLOTS;
+    uint32_t ofs = addr % store->nslots;
 	cesk_store_block_t* block = _cesk_store_getblock_rw(store, addr);
 	if(NULL == block)
 	{
 		LOG_ERROR("can not get a writable pointer to the block");
 		return -1;
 	}
-	block->slots[ofs].refcnt = 0;
+	CESK_STORE_BLOCK_SLOT(block, ofs)->refcnt = 0;
 	return 0;
 }
+int cesk_store_get_remset(const cesk_store_t* store, const uint32_t** p_addrs)
+{
+	if(NULL == store || NULL == p_addrs)
+	{
+		LOG_ERROR("invalid argument");
+		return -1;
+	}
+	*p_addrs = NULL;
+	if(NULL == store->remset) return 0;
+	if(store->remset->overflow) return -1;
+	*p_addrs = store->remset->addrs;
+	return store->remset->size;
+}
+void cesk_store_clear_remset(cesk_store_t* store)
+{
+	if(NULL == store) return;
+	_cesk_store_remset_release(store->remset);
+	store->remset = NULL;
+}
 /**
  * @brief get the instruction that allocate this address 
  **/
@@ -636,13 +1219,13 @@ static inline const dalvik_instruction_t* _cesk_store_get_instruction(const cesk
 	{
 		return NULL;
 	}
-	uint32_t block = addr / CESK_STORE_BLOCK_NSLOTS;
-	uint32_t offset = addr % CESK_STORE_BLOCK_NSLOTS;
-	if(block > store->nblocks)
+	uint32_t block = addr / store->nslots;
+	uint32_t offset = addr % store->nslots;
+	if(block >= store->nblocks)
 	{
 		return NULL;
 	}
-	return dalvik_instruction_get(store->blocks[block]->slots[offset].idx);
+	return dalvik_instruction_get(CESK_STORE_BLOCK_SLOT(cesk_store_get_block(store, block), offset)->idx);
 }
 /** 
  * @brief adjust the structure of the destination , because the slot number of
@@ -664,21 +1247,32 @@ static inline cesk_store_t* _cesk_store_merge_adjust(cesk_store_t* dest, const c
 	{
 		LOG_DEBUG("address space of source store is larger than that of destination store, so create new blocks in destination store");
 		int prev_nblocks = dest->nblocks;
-		dest->nblocks = sour->nblocks;
-		/* reallocate the destination store, so that the size can fit the source store */
-		dest = (cesk_store_t*)realloc(dest, sizeof(cesk_store_t) + sour->nblocks * sizeof(cesk_store_block_t*));
-		if(NULL == dest)
-		{
-			LOG_ERROR("can not realloc");
-			return NULL;
-		}
 		int i;
 		/* add those block to the desination store first */
 		for(i = prev_nblocks; i < sour->nblocks; i ++)
 		{
-			dest->blocks[i] = sour->blocks[i];
+			cesk_store_block_t* block = (cesk_store_block_t*)cesk_store_get_block(sour, i);
 			/* of course, the refcnt increased */
-			sour->blocks[i]->refcnt ++;
+			block->refcnt ++;
+			if(_cesk_store_append_block(&dest, block) < 0)
+			{
+				LOG_ERROR("can not add the block to the destination store");
+				block->refcnt --;
+				return NULL;
+			}
+			/* and the values in the block are now in the destination store */
+			dest->num_ent += block->num_ent;
+			int j;
+			for(j = 0; j < dest->nslots; j ++)
+			{
+				const cesk_store_slot_t* slot = CESK_STORE_BLOCK_SLOT(block, j);
+				const cesk_value_t* value = CESK_STORE_BLOCK_VALUE(block, j);
+				if(NULL == value) continue;
+				dest->hashcode ^= HASH_INC(i * dest->nslots + j, value);
+				/* the objects in the block can be found by the allocator */
+				if(_cesk_store_index_insert(dest, slot->idx, slot->parent, slot->field, i * dest->nslots + j) < 0)
+					LOG_WARNING("can not update the address index");
+			}
 		}
 		LOG_DEBUG("destination store has been resized from %d blocks to %d blocks", prev_nblocks, dest->nblocks);
 	}
@@ -781,6 +1375,8 @@ static inline int _cesk_store_merge_object(
 			/* if the dest set has not been set up yet. In fact there's one possible value: null pointer */
 			if(CESK_STORE_ADDR_NULL == dest_set_addr)
 			{
+				/* both fields are uninitialized, nothing to merge */
+				if(CESK_STORE_ADDR_NULL == sour_set_addr) continue;
 				/* allocate a new address for the value set */
 				dest_set_addr = cesk_store_allocate(&dest, inst, dest_addr, CESK_OBJECT_FIELD_OFS(dest_obj, dest_struct->valuelist + j));
 				if(CESK_STORE_ADDR_NULL == dest_set_addr)
@@ -788,30 +1384,52 @@ static inline int _cesk_store_merge_object(
 					LOG_ERROR("can not allocate memory for new field");
 					goto ERROR;
 				}
-				setval = cesk_value_empty_set();
-				if(NULL == setval)
+				/* the address is used by the same field already, so just use the value set */
+				if(NULL != cesk_store_get_ro(dest, dest_set_addr))
 				{
-					LOG_ERROR("can not create an empty set for the new field");
-					goto ERROR;
+					setval = cesk_store_get_rw(dest, dest_set_addr);
+					if(NULL == setval)
+					{
+						LOG_ERROR("can not aquire writable pointer to the destination set");
+						goto ERROR;
+					}
 				}
-				
+				else
+				{
+					setval = cesk_value_empty_set();
+					if(NULL == setval)
+					{
+						LOG_ERROR("can not create an empty set for the new field");
+						goto ERROR;
+					}
+					/* fianlly attach it */
+					if(cesk_store_attach(dest, dest_set_addr, setval) < 0)
+					{
+						LOG_ERROR("can not attach the value set the value address");
+						goto ERROR;
+					}
+				}
+
 				/* put default ZERO */
 				/* TODO (Q) why we need default ZERO? */
 				/* (A) because if the value of the field is unintialized, the set is empty,
 				 * But in fact, we want to this value equals to zero. That is why we need
 				 * a default zero to represent the possibility of unintialized values here */
-				if(cesk_set_push(setval->pointer.set, CESK_STORE_ADDR_ZERO) < 0)
+				if(CESK_TYPE_SET == setval->type && cesk_set_push(setval->pointer.set, CESK_STORE_ADDR_ZERO) < 0)
 				{
 					LOG_ERROR("can not push default 0 to the field");
+					cesk_store_release_rw(dest, dest_set_addr);
 					goto ERROR;
 				}
 				
-				/* fianlly attach it */
-				if(cesk_store_attach(dest, dest_set_addr, setval) < 0)
+				/* the object refers the new set */
+				if(cesk_store_incref(dest, dest_set_addr) < 0)
 				{
-					LOG_ERROR("can not attach the value set the value address");
+					LOG_ERROR("can not incref to the new field set @0x%x", dest_set_addr);
+					cesk_store_release_rw(dest, dest_set_addr);
 					goto ERROR;
 				}
+				dest_struct->valuelist[j] = dest_set_addr;
 			}
 			/* otehrwise, there's an value set for this field, aquire it directly */
 			else
@@ -859,12 +1477,31 @@ static inline int _cesk_store_merge_object(
 					cesk_store_release_rw(dest, dest_set_addr);
 					goto ERROR;
 				}
-				if(cesk_set_merge_reloc(set, src_set, reloc) < 0)
+				/* we do not use cesk_set_merge_reloc here, because the refcnt of each new address
+				 * in the destination set should be increased */
+				cesk_set_iter_t iter_buf;
+				cesk_set_iter_t* iter = cesk_set_iter(src_set, &iter_buf);
+				if(NULL == iter)
 				{
-					LOG_ERROR("can not merge the field set");
+					LOG_ERROR("can not aquire iterator for the source set");
 					cesk_store_release_rw(dest, dest_set_addr);
 					goto ERROR;
 				}
+				uint32_t addr;
+				while(CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(iter)))
+				{
+					if(!CESK_STORE_ADDR_IS_CONST(addr))
+						addr = cesk_reloc_table_look_for(reloc, addr);
+					if(cesk_set_contain(set, addr) == 1) continue;
+					if(cesk_set_push(set, addr) < 0)
+					{
+						LOG_ERROR("can not push value to the destination set");
+						cesk_store_release_rw(dest, dest_set_addr);
+						goto ERROR;
+					}
+					if(cesk_store_incref(dest, addr) < 0)
+						LOG_WARNING("can not incref at address @%x", addr);
+				}
 			}
 
 			/* After everthing is done, we simply release the pointer */
@@ -873,6 +1510,7 @@ static inline int _cesk_store_merge_object(
 		CESK_OBJECT_STRUCT_ADVANCE(sour_struct);
 		CESK_OBJECT_STRUCT_ADVANCE(dest_struct);
 	}
+	cesk_store_release_rw(dest, dest_addr);
 	*p_dest = dest;
 	return 0;
 ERROR:
@@ -882,13 +1520,18 @@ ERROR:
 	return -1;
 }
 
-int cesk_store_merge(cesk_store_t** p_dest, const cesk_store_t* sour)
+int cesk_store_merge_reloc(cesk_store_t** p_dest, const cesk_store_t* sour, cesk_reloc_table_t** p_reloc)
 {
 	if(NULL == p_dest || NULL == *p_dest || NULL == sour)
 	{
 		LOG_ERROR("invalid argument");
 		return -1;
 	}
+	if((*p_dest)->nslots != sour->nslots)
+	{
+		LOG_ERROR("can not merge two stores with different block size");
+		return -1;
+	}
 	cesk_store_t* adjusted_dest = _cesk_store_merge_adjust(*p_dest, sour);
 	if(NULL == adjusted_dest)
 	{
@@ -908,58 +1551,79 @@ int cesk_store_merge(cesk_store_t** p_dest, const cesk_store_t* sour)
 		return -1;
 	}
 
-	int i = 0;
-	uint32_t sour_addr = 0;
+	int i;
+	uint32_t j, sour_addr;
+	/* the slots might be different in the source block and the destination block */
+	uint32_t* diff = (uint32_t*)malloc(sizeof(uint32_t) * CESK_STORE_BITMAP_WORDS(sour->nslots));
+	if(NULL == diff)
+	{
+		LOG_ERROR("can not allocate memory for the block diff");
+		cesk_reloc_table_free(rtab);
+		return -1;
+	}
+	/* first, place all objects in the destination store, because an object might refer
+	 * another object that has not been merged yet, and _cesk_store_merge_object assumes all 
+	 * objects are placed already */
 	for(i = 0; i < sour->nblocks; i ++)
 	{
-		int j;
-		if(sour->blocks[i] == dest->blocks[i])
-		{
-			sour_addr += CESK_STORE_BLOCK_NSLOTS;
-			continue;
-		}
-		for(j = 0; j < CESK_STORE_BLOCK_NSLOTS; j ++, sour_addr ++)
+		const cesk_store_block_t* sour_block = cesk_store_get_block(sour, i);
+		cesk_store_block_diff(sour_block, cesk_store_get_block(dest, i), diff);
+		for(j = cesk_store_bitmap_next(diff, sour->nslots, 0); j < sour->nslots; j = cesk_store_bitmap_next(diff, sour->nslots, j + 1))
 		{
-			/* if this address in the source store is empty, skip */
-			if(sour->blocks[i]->slots[j].value == NULL) continue;
-			/* if this address do not contain any objet */
-			if(sour->blocks[i]->slots[j].value->type != CESK_TYPE_OBJECT)
-				continue;
+			sour_addr = i * sour->nslots + j;
+			const cesk_value_t* sour_val = CESK_STORE_BLOCK_VALUE(sour_block, j);
+			if(NULL == sour_val || sour_val->type != CESK_TYPE_OBJECT) continue;
 			uint32_t dest_addr = cesk_reloc_table_look_for(rtab, sour_addr);
 			if(CESK_STORE_ADDR_NULL == dest_addr)
 			{
 				LOG_WARNING("failed to query the relocation table");
 				continue;
 			}
-			uint32_t bid = dest_addr / CESK_STORE_BLOCK_NSLOTS;
-			uint32_t ofs = dest_addr % CESK_STORE_BLOCK_NSLOTS;
-			/* if two object is actually the same one */
-			if(sour->blocks[i]->slots[j].value->pointer._void == 
-			   dest->blocks[bid]->slots[ofs].value->pointer._void)
+			/* if this slot in the destination store is empty, just make a new object for the slot */
+			if(cesk_store_get_ro(dest, dest_addr) != NULL) continue;
+			const char* classpath = cesk_object_classpath(sour_val->pointer.object);
+			if(NULL == classpath)
+			{
+				LOG_WARNING("can not get the class path of the object");
 				continue;
-			/* if this  destination store is empty, just make a new object for the slot */
-			if(dest->blocks[bid]->slots[ofs].value->pointer._void == NULL)
+			}
+			cesk_value_t* newval = cesk_value_from_classpath(classpath);
+			if(NULL == newval)
 			{
-				const char* classpath = cesk_object_classpath(sour->blocks[i]->slots[j].value->pointer.object);
-				if(NULL == classpath)
-				{
-					LOG_WARNING("can not get the class path of the object");
-					continue;
-				}
-				cesk_value_t* newval = cesk_value_from_classpath(classpath);
-				if(NULL == newval)
-				{
-					LOG_WARNING("can not build a new object for the relocated object");
-					continue;
-				}
-				if(cesk_store_attach(dest, dest_addr ,newval) < 0)
-				{
-					LOG_WARNING("can not attach the new object to the destination store");
-					continue;
-				}
-				cesk_store_release_rw(dest, dest_addr);
+				LOG_WARNING("can not build a new object for the source object");
+				continue;
+			}
+			if(cesk_store_attach(dest, dest_addr ,newval) < 0)
+			{
+				LOG_WARNING("can not attach the new object to the destination store");
+				continue;
 			}
-			/* okay, now the destination store is assigned to an object, now start to merge */
+			/* the slot is allocated by the same instruction in the source store */
+			cesk_store_block_t* block = _cesk_store_getblock_rw(dest, dest_addr);
+			uint32_t ofs = dest_addr % sour->nslots;
+			CESK_STORE_BLOCK_SLOT(block, ofs)->idx = CESK_STORE_BLOCK_SLOT(sour_block, j)->idx;
+			CESK_STORE_BLOCK_SLOT(block, ofs)->parent = CESK_STORE_BLOCK_SLOT(sour_block, j)->parent;
+			CESK_STORE_BLOCK_SLOT(block, ofs)->field = CESK_STORE_BLOCK_SLOT(sour_block, j)->field;
+			if(_cesk_store_index_insert(dest, CESK_STORE_BLOCK_SLOT(block, ofs)->idx, CESK_STORE_BLOCK_SLOT(block, ofs)->parent, CESK_STORE_BLOCK_SLOT(block, ofs)->field, dest_addr) < 0)
+				LOG_WARNING("can not update the address index");
+			cesk_store_release_rw(dest, dest_addr);
+		}
+	}
+	/* then merge the objects */
+	for(i = 0; i < sour->nblocks; i ++)
+	{
+		const cesk_store_block_t* sour_block = cesk_store_get_block(sour, i);
+		cesk_store_block_diff(sour_block, cesk_store_get_block(dest, i), diff);
+		for(j = cesk_store_bitmap_next(diff, sour->nslots, 0); j < sour->nslots; j = cesk_store_bitmap_next(diff, sour->nslots, j + 1))
+		{
+			sour_addr = i * sour->nslots + j;
+			const cesk_value_t* sour_val = CESK_STORE_BLOCK_VALUE(sour_block, j);
+			if(NULL == sour_val || sour_val->type != CESK_TYPE_OBJECT) continue;
+			uint32_t dest_addr = cesk_reloc_table_look_for(rtab, sour_addr);
+			if(CESK_STORE_ADDR_NULL == dest_addr) continue;
+			cesk_value_const_t* dest_val = cesk_store_get_ro(dest, dest_addr);
+			/* if two object is actually the same one */
+			if(NULL == dest_val || sour_val->pointer._void == dest_val->pointer._void) continue;
 			if(_cesk_store_merge_object(p_dest, dest_addr, sour, sour_addr, rtab) < 0)
 			{
 				LOG_WARNING("can not merge two object");
@@ -969,5 +1633,30 @@ int cesk_store_merge(cesk_store_t** p_dest, const cesk_store_t* sour)
 		}
 	}
 
+	/* the garbage candidates of the source store are now in the destination store */
+	if(NULL != sour->remset)
+	{
+		if(sour->remset->overflow)
+			_cesk_store_remset_overflow(dest);
+		else
+		{
+			for(j = 0; j < sour->remset->size; j ++)
+			{
+				uint32_t dest_addr = cesk_reloc_table_look_for(rtab, sour->remset->addrs[j]);
+				if(CESK_STORE_ADDR_NULL != dest_addr)
+					_cesk_store_remset_add(dest, dest_addr);
+			}
+		}
+	}
+
+	if(NULL != p_reloc) 
+		*p_reloc = rtab;
+	else
+		cesk_reloc_table_free(rtab);
+	free(diff);
 	return 0;
 }
+int cesk_store_merge(cesk_store_t** p_dest, const cesk_store_t* sour)
+{
+	return cesk_store_merge_reloc(p_dest, sour, NULL);
+}
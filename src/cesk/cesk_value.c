@@ -1,67 +1,167 @@
 /** 
  * @file cesk_value.c
  * @brief the implementation of abstract value */
+#include <pthread.h>
 #include <log.h>
 #include <cesk/cesk_value.h>
 #include <dalvik/dalvik_instruction.h>
 
-/** @brief the value list actuall record all values, and deallocate 
- *         the memory when exiting 
+/* The values are allocated from slabs of CESK_VALUE_SLAB_SIZE values. Each thread has its own
+ * free list, so allocating and freeing a value does not need any lock. A value freed by a thread 
+ * goes to the free list of that thread, no matter which thread allocated it. The global slab list
+ * is only touched when a new slab is made, and all slabs are released at once in cesk_value_finalize.
+ *
+ * When a thread exits, its free list is moved to the orphan list, and other threads take the orphan
+ * values before they make a new slab.
  */
-static cesk_value_t*  _cesk_value_list = NULL;
+/** @brief the type code of a value in the free list, the next free value is stored in value->pointer._void */
+#define _CESK_VALUE_TYPE_FREE 0x7f
+/** @brief a slab of values */
+typedef struct _cesk_value_slab_t _cesk_value_slab_t;
+struct _cesk_value_slab_t {
+	_cesk_value_slab_t* next;                     /*!<the next slab */
+	cesk_value_t values[CESK_VALUE_SLAB_SIZE];    /*!<the values */
+};
+/** @brief a list of free values */
+typedef struct {
+	cesk_value_t* head;   /*!<the first value */
+	cesk_value_t* tail;   /*!<the last value */
+} _cesk_value_free_list_t;
+/** @brief all slabs */
+static _cesk_value_slab_t* _cesk_value_slabs = NULL;
+/** @brief the free values of the exited threads */
+static _cesk_value_free_list_t _cesk_value_orphans;
+/** @brief the lock for the slab list and the orphan list */
+static pthread_mutex_t _cesk_value_slab_lock = PTHREAD_MUTEX_INITIALIZER;
+/** @brief the free list of this thread */
+static __thread _cesk_value_free_list_t _cesk_value_free_list;
+/** @brief the key used to move the free list to the orphan list when the thread exits */
+static pthread_key_t _cesk_value_thread_key;
+static pthread_once_t _cesk_value_thread_key_once = PTHREAD_ONCE_INIT;
+/** @brief if the free list of this thread will be moved to the orphan list when the thread exits */
+static __thread int _cesk_value_thread_registered = 0;
 
+/** @brief append a free list to another */
+static inline void _cesk_value_free_list_splice(_cesk_value_free_list_t* dest, _cesk_value_free_list_t* sour)
+{
+	if(NULL == sour->head) return;
+	if(NULL == dest->head) 
+		dest->head = sour->head;
+	else
+		dest->tail->pointer._void = sour->head;
+	dest->tail = sour->tail;
+	sour->head = sour->tail = NULL;
+}
+/** @brief called when a thread exits */
+static void _cesk_value_thread_exit(void* data)
+{
+	pthread_mutex_lock(&_cesk_value_slab_lock);
+	_cesk_value_free_list_splice(&_cesk_value_orphans, (_cesk_value_free_list_t*)data);
+	pthread_mutex_unlock(&_cesk_value_slab_lock);
+}
+static void _cesk_value_thread_key_init()
+{
+	if(pthread_key_create(&_cesk_value_thread_key, _cesk_value_thread_exit) != 0)
+		LOG_WARNING("can not create the thread key, the free values of exited threads are lost");
+}
+/** @brief make sure the free list of this thread is moved to the orphan list when the thread exits */
+static inline void _cesk_value_thread_register()
+{
+	if(_cesk_value_thread_registered) return;
+	pthread_once(&_cesk_value_thread_key_once, _cesk_value_thread_key_init);
+	pthread_setspecific(_cesk_value_thread_key, &_cesk_value_free_list);
+	_cesk_value_thread_registered = 1;
+}
+/** @brief fill the free list of this thread with the orphan values or a new slab */
+static inline int _cesk_value_refill()
+{
+	_cesk_value_thread_register();
+	pthread_mutex_lock(&_cesk_value_slab_lock);
+	_cesk_value_free_list_splice(&_cesk_value_free_list, &_cesk_value_orphans);
+	pthread_mutex_unlock(&_cesk_value_slab_lock);
+	if(NULL != _cesk_value_free_list.head) return 0;
+
+	_cesk_value_slab_t* slab = (_cesk_value_slab_t*)malloc(sizeof(_cesk_value_slab_t));
+	if(NULL == slab)
+	{
+		LOG_ERROR("can not allocate memory for a new value slab");
+		return -1;
+	}
+	int i;
+	for(i = 0; i < CESK_VALUE_SLAB_SIZE; i ++)
+	{
+		slab->values[i].type = _CESK_VALUE_TYPE_FREE;
+		slab->values[i].pointer._void = (i + 1 < CESK_VALUE_SLAB_SIZE) ? slab->values + i + 1 : NULL;
+	}
+	_cesk_value_free_list.head = slab->values;
+	_cesk_value_free_list.tail = slab->values + CESK_VALUE_SLAB_SIZE - 1;
+	pthread_mutex_lock(&_cesk_value_slab_lock);
+	slab->next = _cesk_value_slabs;
+	_cesk_value_slabs = slab;
+	pthread_mutex_unlock(&_cesk_value_slab_lock);
+	LOG_DEBUG("a new value slab is allocated");
+	return 0;
+}
 /** @brief allocator */
 static inline cesk_value_t* _cesk_value_alloc(uint32_t type)
 {
-    cesk_value_t* ret = (cesk_value_t*)malloc(sizeof(cesk_value_t));
-    if(NULL == ret) return NULL;
+	if(NULL == _cesk_value_free_list.head && _cesk_value_refill() < 0) return NULL;
+	cesk_value_t* ret = _cesk_value_free_list.head;
+	_cesk_value_free_list.head = (cesk_value_t*)ret->pointer._void;
+	if(NULL == _cesk_value_free_list.head) _cesk_value_free_list.tail = NULL;
     ret->type = type;
     ret->refcnt = 0;
-    ret->next = _cesk_value_list;
-    ret->prev = NULL;
-    if(_cesk_value_list) 
-        _cesk_value_list->prev = ret;
-    _cesk_value_list = ret;
 	ret->pointer._void = NULL;
     return ret;
 }
 void cesk_value_init()
 {
-    _cesk_value_list = NULL;
 }
-/** @brief deallocate the memory for the value */
-static void _cesk_value_free(cesk_value_t* val)
+/** @brief free the data of a value */
+static inline void _cesk_value_free_data(cesk_value_t* val)
 {
-    if(val->prev) val->prev->next = val->next;
-    if(val->next) val->next->prev = val->prev;
-    if(_cesk_value_list == val) _cesk_value_list = val->next;
-    if(NULL == val->pointer._void)
+	if(NULL == val->pointer._void) return;
+	/* for each type, we use defferent way to deallocate the object */
+	switch(val->type)
 	{
-		/* for each type, we use defferent way to deallocate the object */
-		switch(val->type)
-		{
-			case CESK_TYPE_OBJECT:
-					cesk_object_free(val->pointer.object);
-				break;
-			case CESK_TYPE_SET:
-				cesk_set_free(val->pointer.set);
-				break;
-			default:
-				LOG_WARNING("unknown type %d, do not know how to free", val->type);
-		}
+		case CESK_TYPE_OBJECT:
+			cesk_object_free(val->pointer.object);
+			break;
+		case CESK_TYPE_SET:
+			cesk_set_free(val->pointer.set);
+			break;
+		default:
+			LOG_WARNING("unknown type %d, do not know how to free", val->type);
 	}
-    free(val);
+}
+/** @brief deallocate the memory for the value */
+static void _cesk_value_free(cesk_value_t* val)
+{
+	_cesk_value_free_data(val);
+	_cesk_value_thread_register();
+	val->type = _CESK_VALUE_TYPE_FREE;
+	val->pointer._void = _cesk_value_free_list.head;
+	if(NULL == _cesk_value_free_list.head) _cesk_value_free_list.tail = val;
+	_cesk_value_free_list.head = val;
 	LOG_DEBUG("a value is deleted"); 
 }
 void cesk_value_finalize()
 {
-    cesk_value_t *ptr;
-    for(ptr = _cesk_value_list; NULL != ptr; )
-    {
-        cesk_value_t* old = ptr;
-        ptr = ptr->next;
-        _cesk_value_free(old);
-    }
+	/* all other threads that use values should have exited */
+	pthread_mutex_lock(&_cesk_value_slab_lock);
+	while(NULL != _cesk_value_slabs)
+	{
+		_cesk_value_slab_t* slab = _cesk_value_slabs;
+		_cesk_value_slabs = slab->next;
+		int i;
+		for(i = 0; i < CESK_VALUE_SLAB_SIZE; i ++)
+			if(_CESK_VALUE_TYPE_FREE != slab->values[i].type)
+				_cesk_value_free_data(slab->values + i);
+		free(slab);
+	}
+	_cesk_value_orphans.head = _cesk_value_orphans.tail = NULL;
+	_cesk_value_free_list.head = _cesk_value_free_list.tail = NULL;
+	pthread_mutex_unlock(&_cesk_value_slab_lock);
 }
 
 void cesk_value_incref(cesk_value_t* value)
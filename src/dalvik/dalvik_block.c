@@ -4,6 +4,7 @@
 #include <string.h>
 #include <assert.h>
 #include <inttypes.h>
+#include <pthread.h>
 
 #include <log.h>
 #include <vector.h>
@@ -30,6 +31,9 @@ typedef struct _dalvik_block_cache_node_t{
 
 static dalvik_block_cache_node_t* _dalvik_block_cache[DALVIK_BLOCK_CACHE_SIZE];
 
+/** @brief the lock for the block cache, because the analyzer might request block graphs from different threads */
+static pthread_mutex_t _dalvik_block_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /** @brief allocate a node refer to the block */
 static inline dalvik_block_cache_node_t* _dalvik_block_cache_node_alloc(
         const char* class, 
@@ -342,10 +346,12 @@ static inline dalvik_block_t* _dalvik_block_setup_keyinst_if(const dalvik_instru
        inst->flags == DVM_FLAG_IF_GE)
         block->branches[0].eq = 1;
     if(inst->flags == DVM_FLAG_IF_LE ||
-       inst->flags == DVM_FLAG_IF_LT)
+       inst->flags == DVM_FLAG_IF_LT ||
+       inst->flags == DVM_FLAG_IF_NE)
         block->branches[0].lt = 1;
     if(inst->flags == DVM_FLAG_IF_GE ||
-       inst->flags == DVM_FLAG_IF_GT)
+       inst->flags == DVM_FLAG_IF_GT ||
+       inst->flags == DVM_FLAG_IF_NE)
         block->branches[0].gt = 1;
     
     LOG_DEBUG("possible path block %d --> %"PRIu64,  index, block->branches[0].block_id[0]);
@@ -419,7 +425,7 @@ static inline dalvik_block_t* _dalvik_block_setup_keyinst_switch(const dalvik_in
                 /* conditionlal branch */
                 block->branches[j].left_inst = 1;
                 block->branches[j].ileft[0] = branch->cond;
-                block->branches[j].right    = inst->operands + 1;
+                block->branches[j].right    = inst->operands + 0;
                 block->branches[j].eq       = 1;
             }
             LOG_DEBUG("possible path block %d --> %"PRIu64, index, block->branches[j].block_id[0]);
@@ -530,7 +536,8 @@ static void inline _dalvik_block_graph_dfs(const dalvik_block_t * block, uint32_
         if(!block->branches[i].disabled)
             _dalvik_block_graph_dfs(block->branches[i].block, visit_status);  
 }
-dalvik_block_t* dalvik_block_from_method(const char* classpath, const char* methodname, const dalvik_type_t * const * typelist)
+/** @brief the implementation of dalvik_block_from_method, the caller should hold the lock */
+static inline dalvik_block_t* _dalvik_block_from_method(const char* classpath, const char* methodname, const dalvik_type_t * const * typelist)
 {
     if(NULL == classpath || NULL == methodname)
     {
@@ -627,4 +634,12 @@ dalvik_block_t* dalvik_block_from_method(const char* classpath, const char* meth
                dalvik_type_list_to_string(typelist,NULL, 0));
     return blocks[0];
 }
+dalvik_block_t* dalvik_block_from_method(const char* classpath, const char* methodname, const dalvik_type_t * const * typelist)
+{
+    /* the graph is built at most once, so we simply hold the lock during the construction */
+    pthread_mutex_lock(&_dalvik_block_cache_lock);
+    dalvik_block_t* ret = _dalvik_block_from_method(classpath, methodname, typelist);
+    pthread_mutex_unlock(&_dalvik_block_cache_lock);
+    return ret;
+}
 
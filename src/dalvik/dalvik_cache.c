@@ -0,0 +1,948 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <dalvik/dalvik_cache.h>
+#include <dalvik/dalvik_instruction.h>
+#include <dalvik/dalvik_label.h>
+#include <dalvik/dalvik_exception.h>
+#include <dalvik/dalvik_memberdict.h>
+#include <stringpool.h>
+#include <debug.h>
+
+#ifdef PARSER_COUNT
+extern int dalvik_method_count;
+extern int dalvik_instruction_count;
+extern int dalvik_label_count;
+extern int dalvik_field_count;
+extern int dalvik_class_count;
+#endif
+
+/* the layout of a cache file:
+ *
+ * header | labels | instructions | members | counters
+ *
+ * All pooled strings, exception handlers and handler sets are written inline
+ * at the first place they are referenced, after that they are referenced by id */
+
+/** @brief the magic number of a cache file */
+static const char _dalvik_cache_magic[8] = "ADAMDVMC";
+
+/* reference code for an object that is defined right after the reference */
+#define _DALVIK_CACHE_REF_DEF 0xfffffffful
+/* reference code for a NULL pointer */
+#define _DALVIK_CACHE_REF_NULL 0
+/* code for a NULL type */
+#define _DALVIK_CACHE_TYPE_NULL 0xfffffffful
+
+typedef struct {
+    char        magic[8];    /* the magic number */
+    uint32_t    version;     /* the version of the format */
+    uint32_t    inst_size;   /* sizeof(dalvik_instruction_t), the cache is not portable */
+    uint32_t    opr_size;    /* sizeof(dalvik_operand_t) */
+    uint32_t    ptr_size;    /* sizeof(void*) */
+    uint64_t    key;         /* the key of input files */
+    uint64_t    size;        /* the size of the payload */
+    uint64_t    checksum;    /* the checksum of the payload */
+} _dalvik_cache_header_t;
+
+/* the buffer we are writing the cache to */
+typedef struct {
+    char*        buf;       /* the buffer */
+    size_t       size;      /* used size */
+    size_t       capacity;  /* capacity of the buffer */
+    const void** keys;      /* the pointer map, which maps an object to its id */
+    uint32_t*    vals;      /* the value of the pointer map */
+    uint32_t     map_cap;   /* the capacity of the map, always power of 2 */
+    uint32_t     map_size;  /* how many items in the map */
+    uint32_t     nstrings;  /* number of strings have been written */
+    uint32_t     nhandlers; /* number of exception handlers */
+    uint32_t     nsets;     /* number of handler sets */
+} _dalvik_cache_writer_t;
+
+/* the state when we are reading the cache */
+typedef struct {
+    const char*  ptr;       /* the current position */
+    const char*  end;       /* the end of the payload */
+    const char** strings;   /* the strings that has been read */
+    uint32_t     nstrings;
+    uint32_t     cap_strings;
+    dalvik_exception_handler_t** handlers;   /* the handlers that has been read */
+    uint32_t     nhandlers;
+    uint32_t     cap_handlers;
+    dalvik_exception_handler_set_t** sets;   /* the handler sets that has been read */
+    uint32_t     nsets;
+    uint32_t     cap_sets;
+} _dalvik_cache_reader_t;
+
+uint64_t dalvik_cache_hash(const void* data, size_t size, uint64_t seed)
+{
+    const uint8_t* ptr = (const uint8_t*)data;
+    uint64_t h = seed ^ (size * DALVIK_CACHE_HASH_M);
+    for(; size >= 8; size -= 8, ptr += 8)
+    {
+        uint64_t k;
+        memcpy(&k, ptr, 8);
+        k *= DALVIK_CACHE_HASH_M;
+        k ^= k >> DALVIK_CACHE_HASH_R;
+        k *= DALVIK_CACHE_HASH_M;
+        h ^= k;
+        h *= DALVIK_CACHE_HASH_M;
+    }
+    if(size > 0)
+    {
+        uint64_t k = 0;
+        memcpy(&k, ptr, size);
+        h ^= k;
+        h *= DALVIK_CACHE_HASH_M;
+    }
+    h ^= h >> DALVIK_CACHE_HASH_R;
+    h *= DALVIK_CACHE_HASH_M;
+    h ^= h >> DALVIK_CACHE_HASH_R;
+    return h;
+}
+
+/* write functions */
+static inline int _dalvik_cache_write(_dalvik_cache_writer_t* w, const void* data, size_t size)
+{
+    if(w->size + size > w->capacity)
+    {
+        size_t newcap = w->capacity ? w->capacity : 4096;
+        while(newcap < w->size + size) newcap *= 2;
+        char* newbuf = (char*)realloc(w->buf, newcap);
+        if(NULL == newbuf)
+        {
+            LOG_ERROR("can not allocate memory for the cache buffer");
+            return -1;
+        }
+        w->buf = newbuf;
+        w->capacity = newcap;
+    }
+    memcpy(w->buf + w->size, data, size);
+    w->size += size;
+    return 0;
+}
+static inline int _dalvik_cache_write_u32(_dalvik_cache_writer_t* w, uint32_t value)
+{
+    return _dalvik_cache_write(w, &value, sizeof(value));
+}
+static inline hashval_t _dalvik_cache_ptr_hash(const void* ptr)
+{
+    uintptr_t val = (uintptr_t)ptr;
+    return (hashval_t)((val >> 3) * MH_MULTIPLY) ^ (hashval_t)(val >> 32);
+}
+/* find the id of an object, returns the id + 1, 0 means not found */
+static inline uint32_t _dalvik_cache_ptr_find(const _dalvik_cache_writer_t* w, const void* ptr)
+{
+    if(0 == w->map_cap) return 0;
+    uint32_t idx = _dalvik_cache_ptr_hash(ptr) & (w->map_cap - 1);
+    for(; NULL != w->keys[idx]; idx = (idx + 1) & (w->map_cap - 1))
+        if(w->keys[idx] == ptr) return w->vals[idx] + 1;
+    return 0;
+}
+static inline int _dalvik_cache_ptr_insert(_dalvik_cache_writer_t* w, const void* ptr, uint32_t id)
+{
+    if((w->map_size + 1) * 2 > w->map_cap)
+    {
+        uint32_t newcap = w->map_cap ? w->map_cap * 2 : 1024;
+        const void** newkeys = (const void**)calloc(newcap, sizeof(const void*));
+        uint32_t* newvals = (uint32_t*)malloc(sizeof(uint32_t) * newcap);
+        if(NULL == newkeys || NULL == newvals)
+        {
+            LOG_ERROR("can not allocate memory for the pointer map");
+            if(newkeys) free(newkeys);
+            if(newvals) free(newvals);
+            return -1;
+        }
+        uint32_t i;
+        for(i = 0; i < w->map_cap; i ++)
+        {
+            if(NULL == w->keys[i]) continue;
+            uint32_t idx = _dalvik_cache_ptr_hash(w->keys[i]) & (newcap - 1);
+            for(; NULL != newkeys[idx]; idx = (idx + 1) & (newcap - 1));
+            newkeys[idx] = w->keys[i];
+            newvals[idx] = w->vals[i];
+        }
+        if(w->keys) free(w->keys);
+        if(w->vals) free(w->vals);
+        w->keys = newkeys;
+        w->vals = newvals;
+        w->map_cap = newcap;
+    }
+    uint32_t idx = _dalvik_cache_ptr_hash(ptr) & (w->map_cap - 1);
+    for(; NULL != w->keys[idx]; idx = (idx + 1) & (w->map_cap - 1));
+    w->keys[idx] = ptr;
+    w->vals[idx] = id;
+    w->map_size ++;
+    return 0;
+}
+/* write a reference to an object, returns 1 if the object should be defined right after the reference */
+static inline int _dalvik_cache_write_ref(_dalvik_cache_writer_t* w, const void* ptr, uint32_t* counter)
+{
+    if(NULL == ptr) return _dalvik_cache_write_u32(w, _DALVIK_CACHE_REF_NULL);
+    uint32_t ref = _dalvik_cache_ptr_find(w, ptr);
+    if(ref > 0) return _dalvik_cache_write_u32(w, ref);
+    if(_dalvik_cache_ptr_insert(w, ptr, (*counter) ++) < 0) return -1;
+    if(_dalvik_cache_write_u32(w, _DALVIK_CACHE_REF_DEF) < 0) return -1;
+    return 1;
+}
+static inline int _dalvik_cache_write_string(_dalvik_cache_writer_t* w, const char* str)
+{
+    int rc = _dalvik_cache_write_ref(w, str, &w->nstrings);
+    if(rc <= 0) return rc;
+    uint32_t len = strlen(str);
+    if(_dalvik_cache_write_u32(w, len) < 0) return -1;
+    return _dalvik_cache_write(w, str, len + 1);
+}
+static inline int _dalvik_cache_write_type(_dalvik_cache_writer_t* w, const dalvik_type_t* type)
+{
+    if(NULL == type) return _dalvik_cache_write_u32(w, _DALVIK_CACHE_TYPE_NULL);
+    if(_dalvik_cache_write_u32(w, type->typecode) < 0) return -1;
+    switch(type->typecode)
+    {
+        case DALVIK_TYPECODE_OBJECT:
+            return _dalvik_cache_write_string(w, type->data.object.path);
+        case DALVIK_TYPECODE_ARRAY:
+            return _dalvik_cache_write_type(w, type->data.array.elem_type);
+    }
+    return 0;
+}
+static inline int _dalvik_cache_write_typelist(_dalvik_cache_writer_t* w, const dalvik_type_t* const* list)
+{
+    uint32_t n = 0, i;
+    for(; list[n]; n ++);
+    if(_dalvik_cache_write_u32(w, n) < 0) return -1;
+    for(i = 0; i < n; i ++)
+        if(_dalvik_cache_write_type(w, list[i]) < 0) return -1;
+    return 0;
+}
+static inline int _dalvik_cache_write_handler(_dalvik_cache_writer_t* w, const dalvik_exception_handler_t* handler)
+{
+    int rc = _dalvik_cache_write_ref(w, handler, &w->nhandlers);
+    if(rc <= 0) return rc;
+    if(_dalvik_cache_write_string(w, handler->exception) < 0) return -1;
+    return _dalvik_cache_write_u32(w, handler->handler_label);
+}
+static inline int _dalvik_cache_write_handler_set(_dalvik_cache_writer_t* w, const dalvik_exception_handler_set_t* set)
+{
+    int rc = _dalvik_cache_write_ref(w, set, &w->nsets);
+    if(rc <= 0) return rc;
+    uint32_t n = 0;
+    const dalvik_exception_handler_set_t* ptr;
+    for(ptr = set; ptr; ptr = ptr->next) n ++;
+    if(_dalvik_cache_write_u32(w, n) < 0) return -1;
+    for(ptr = set; ptr; ptr = ptr->next)
+        if(_dalvik_cache_write_handler(w, ptr->handler) < 0) return -1;
+    return 0;
+}
+/* check if the operand carries a pointer */
+static inline int _dalvik_cache_operand_is_pointer(const dalvik_operand_t* opr)
+{
+    if(!opr->header.info.is_const) return 0;
+    switch(opr->header.info.type)
+    {
+        case DVM_OPERAND_TYPE_CLASS:
+        case DVM_OPERAND_TYPE_STRING:
+        case DVM_OPERAND_TYPE_FIELD:
+        case DVM_OPERAND_TYPE_TYPEDESC:
+        case DVM_OPERAND_TYPE_TYPELIST:
+        case DVM_OPERAND_TYPE_LABELVECTOR:
+        case DVM_OPERAND_TYPE_SPARSE:
+            return 1;
+    }
+    return 0;
+}
+/* the number of operand slots we save, one more slot for the annotation */
+static inline uint32_t _dalvik_cache_instruction_nslots(const dalvik_instruction_t* inst)
+{
+    uint32_t n = inst->num_operands + 1;
+    if(n > sizeof(inst->operands) / sizeof(inst->operands[0]))
+        n = sizeof(inst->operands) / sizeof(inst->operands[0]);
+    return n;
+}
+static inline int _dalvik_cache_write_instruction(_dalvik_cache_writer_t* w, const dalvik_instruction_t* inst)
+{
+    uint8_t head[4] = {inst->opcode, inst->num_operands, inst->flags, 0};
+    uint32_t nslots = _dalvik_cache_instruction_nslots(inst);
+    uint32_t i;
+    if(_dalvik_cache_write(w, head, sizeof(head)) < 0) return -1;
+    if(_dalvik_cache_write_u32(w, inst->line) < 0) return -1;
+    if(_dalvik_cache_write_u32(w, inst->next) < 0) return -1;
+    if(_dalvik_cache_write_handler_set(w, inst->handler_set) < 0) return -1;
+    if(_dalvik_cache_write(w, inst->operands, sizeof(dalvik_operand_t) * nslots) < 0) return -1;
+    for(i = 0; i < inst->num_operands; i ++)
+    {
+        const dalvik_operand_t* opr = inst->operands + i;
+        if(!_dalvik_cache_operand_is_pointer(opr)) continue;
+        vector_t* vec;
+        size_t j;
+        switch(opr->header.info.type)
+        {
+            case DVM_OPERAND_TYPE_CLASS:
+            case DVM_OPERAND_TYPE_STRING:
+            case DVM_OPERAND_TYPE_FIELD:
+                if(_dalvik_cache_write_string(w, opr->payload.string) < 0) return -1;
+                break;
+            case DVM_OPERAND_TYPE_TYPEDESC:
+                if(_dalvik_cache_write_type(w, opr->payload.type) < 0) return -1;
+                break;
+            case DVM_OPERAND_TYPE_TYPELIST:
+                if(_dalvik_cache_write_typelist(w, opr->payload.typelist) < 0) return -1;
+                break;
+            case DVM_OPERAND_TYPE_LABELVECTOR:
+            case DVM_OPERAND_TYPE_SPARSE:
+                vec = opr->payload.branches;
+                if(_dalvik_cache_write_u32(w, vector_size(vec)) < 0) return -1;
+                for(j = 0; j < vector_size(vec); j ++)
+                    if(_dalvik_cache_write(w, vector_get(vec, j), vec->elem_size) < 0) return -1;
+                break;
+        }
+    }
+    return 0;
+}
+static int _dalvik_cache_write_member(int type, void* object, void* data)
+{
+    _dalvik_cache_writer_t* w = (_dalvik_cache_writer_t*)data;
+    const dalvik_method_t* method;
+    const dalvik_field_t*  field;
+    const dalvik_class_t*  class;
+    uint32_t i, n;
+    if(_dalvik_cache_write_u32(w, type) < 0) return -1;
+    switch(type)
+    {
+        case DALVIK_MEMBERDICT_TYPE_METHOD:
+            method = (const dalvik_method_t*)object;
+            if(_dalvik_cache_write_string(w, method->name) < 0 ||
+               _dalvik_cache_write_string(w, method->path) < 0 ||
+               _dalvik_cache_write_string(w, method->file) < 0 ||
+               _dalvik_cache_write_u32(w, method->flags) < 0 ||
+               _dalvik_cache_write_type(w, method->return_type) < 0 ||
+               _dalvik_cache_write_u32(w, method->num_args) < 0 ||
+               _dalvik_cache_write_u32(w, method->num_regs) < 0 ||
+               _dalvik_cache_write_u32(w, method->entry) < 0)
+                return -1;
+            for(i = 0; i < method->num_args; i ++)
+                if(_dalvik_cache_write_type(w, method->args_type[i]) < 0) return -1;
+            break;
+        case DALVIK_MEMBERDICT_TYPE_FIELD:
+            field = (const dalvik_field_t*)object;
+            if(_dalvik_cache_write_string(w, field->name) < 0 ||
+               _dalvik_cache_write_string(w, field->path) < 0 ||
+               _dalvik_cache_write_string(w, field->file) < 0 ||
+               _dalvik_cache_write_type(w, field->type) < 0 ||
+               _dalvik_cache_write_u32(w, field->attrs) < 0 ||
+               _dalvik_cache_write_u32(w, field->offset) < 0)
+                return -1;
+            break;
+        case DALVIK_MEMBERDICT_TYPE_CLASS:
+            class = (const dalvik_class_t*)object;
+            if(_dalvik_cache_write_string(w, class->path) < 0 ||
+               _dalvik_cache_write_string(w, class->super) < 0 ||
+               _dalvik_cache_write_u32(w, class->attrs) < 0 ||
+               _dalvik_cache_write_u32(w, class->is_interface) < 0)
+                return -1;
+            for(n = 0; class->implements[n]; n ++);
+            if(_dalvik_cache_write_u32(w, n) < 0) return -1;
+            for(i = 0; i < n; i ++)
+                if(_dalvik_cache_write_string(w, class->implements[i]) < 0) return -1;
+            for(n = 0; class->members[n]; n ++);
+            if(_dalvik_cache_write_u32(w, n) < 0) return -1;
+            for(i = 0; i < n; i ++)
+                if(_dalvik_cache_write_string(w, class->members[i]) < 0) return -1;
+            break;
+        default:
+            LOG_ERROR("unknown member type %d", type);
+            return -1;
+    }
+    return 0;
+}
+static inline int _dalvik_cache_write_program(_dalvik_cache_writer_t* w)
+{
+    uint32_t i;
+    /* labels */
+    int nlabels = dalvik_label_get_count();
+    const char** names = NULL;
+    if(nlabels > 0)
+    {
+        names = (const char**)malloc(sizeof(const char*) * nlabels);
+        if(NULL == names)
+        {
+            LOG_ERROR("can not allocate memory for label names");
+            return -1;
+        }
+        if(dalvik_label_get_names(names, nlabels) < 0) goto ERR;
+    }
+    if(_dalvik_cache_write_u32(w, nlabels) < 0) goto ERR;
+    for(i = 0; i < nlabels; i ++)
+        if(_dalvik_cache_write_string(w, names[i]) < 0) goto ERR;
+    if(_dalvik_cache_write(w, dalvik_label_jump_table, sizeof(uint32_t) * nlabels) < 0) goto ERR;
+    if(names) free(names);
+    names = NULL;
+
+    /* instructions */
+    uint32_t ninsts = dalvik_instruction_pool_size();
+    if(_dalvik_cache_write_u32(w, ninsts) < 0) return -1;
+    for(i = 0; i < ninsts; i ++)
+        if(_dalvik_cache_write_instruction(w, dalvik_instruction_get(i)) < 0) return -1;
+
+    /* members, the member list ends with a -1 */
+    if(dalvik_memberdict_foreach(_dalvik_cache_write_member, w) < 0) return -1;
+    if(_dalvik_cache_write_u32(w, 0xfffffffful) < 0) return -1;
+
+    /* counters */
+    int32_t counters[5] = {};
+#ifdef PARSER_COUNT
+    counters[0] = dalvik_class_count;
+    counters[1] = dalvik_method_count;
+    counters[2] = dalvik_field_count;
+    counters[3] = dalvik_label_count;
+    counters[4] = dalvik_instruction_count;
+#endif
+    if(_dalvik_cache_write(w, counters, sizeof(counters)) < 0) return -1;
+    return 0;
+ERR:
+    if(names) free(names);
+    return -1;
+}
+int dalvik_cache_save(const char* filename, uint64_t key)
+{
+    _dalvik_cache_writer_t writer;
+    _dalvik_cache_header_t header;
+    char tmpname[1024];
+    FILE* fp = NULL;
+    memset(&writer, 0, sizeof(writer));
+    if(NULL == filename)
+    {
+        LOG_ERROR("invalid file name");
+        return -1;
+    }
+    if(_dalvik_cache_write_program(&writer) < 0)
+    {
+        LOG_ERROR("can not serialize the program");
+        goto ERR;
+    }
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, _dalvik_cache_magic, sizeof(header.magic));
+    header.version = DALVIK_CACHE_VERSION;
+    header.inst_size = sizeof(dalvik_instruction_t);
+    header.opr_size = sizeof(dalvik_operand_t);
+    header.ptr_size = sizeof(void*);
+    header.key = key;
+    header.size = writer.size;
+    header.checksum = dalvik_cache_hash(writer.buf, writer.size, DALVIK_CACHE_VERSION);
+
+    /* write to a temporary file first, so that the cache file is always complete */
+    snprintf(tmpname, sizeof(tmpname), "%s.%d.tmp", filename, (int)getpid());
+    if(NULL == (fp = fopen(tmpname, "wb")))
+    {
+        LOG_ERROR("can not open file %s", tmpname);
+        goto ERR;
+    }
+    if(fwrite(&header, sizeof(header), 1, fp) != 1 ||
+       fwrite(writer.buf, 1, writer.size, fp) != writer.size)
+    {
+        LOG_ERROR("can not write the cache file %s", tmpname);
+        goto ERR;
+    }
+    if(fclose(fp) != 0)
+    {
+        fp = NULL;
+        LOG_ERROR("can not write the cache file %s", tmpname);
+        goto ERR;
+    }
+    fp = NULL;
+    if(rename(tmpname, filename) < 0)
+    {
+        LOG_ERROR("can not rename %s to %s", tmpname, filename);
+        goto ERR;
+    }
+    LOG_DEBUG("program is saved to %s, %zu bytes, %u strings", filename, writer.size, writer.nstrings);
+    free(writer.buf);
+    if(writer.keys) free(writer.keys);
+    if(writer.vals) free(writer.vals);
+    return 0;
+ERR:
+    if(NULL != fp)
+    {
+        fclose(fp);
+        unlink(tmpname);
+    }
+    if(writer.buf) free(writer.buf);
+    if(writer.keys) free(writer.keys);
+    if(writer.vals) free(writer.vals);
+    return -1;
+}
+
+/* read functions */
+static inline int _dalvik_cache_read(_dalvik_cache_reader_t* r, void* buf, size_t size)
+{
+    if(r->ptr + size > r->end)
+    {
+        LOG_ERROR("unexpected end of cache file");
+        return -1;
+    }
+    memcpy(buf, r->ptr, size);
+    r->ptr += size;
+    return 0;
+}
+static inline int _dalvik_cache_read_u32(_dalvik_cache_reader_t* r, uint32_t* value)
+{
+    return _dalvik_cache_read(r, value, sizeof(uint32_t));
+}
+/* append an object to a table in the reader */
+static inline int _dalvik_cache_table_append(void*** table, uint32_t* size, uint32_t* cap, void* obj)
+{
+    if(*size >= *cap)
+    {
+        uint32_t newcap = (*cap) ? (*cap) * 2 : 1024;
+        void** newtable = (void**)realloc(*table, sizeof(void*) * newcap);
+        if(NULL == newtable)
+        {
+            LOG_ERROR("can not allocate memory for the object table");
+            return -1;
+        }
+        *table = newtable;
+        *cap = newcap;
+    }
+    (*table)[(*size) ++] = obj;
+    return 0;
+}
+/* read a reference, returns 1 if the object is defined right after the reference, and 0 if the object is in the table */
+static inline int _dalvik_cache_read_ref(_dalvik_cache_reader_t* r, void** table, uint32_t size, void** result)
+{
+    uint32_t ref;
+    if(_dalvik_cache_read_u32(r, &ref) < 0) return -1;
+    if(_DALVIK_CACHE_REF_NULL == ref)
+    {
+        *result = NULL;
+        return 0;
+    }
+    if(_DALVIK_CACHE_REF_DEF == ref) return 1;
+    if(ref > size)
+    {
+        LOG_ERROR("invalid object reference %u", ref);
+        return -1;
+    }
+    *result = table[ref - 1];
+    return 0;
+}
+static inline int _dalvik_cache_read_string(_dalvik_cache_reader_t* r, const char** result)
+{
+    int rc = _dalvik_cache_read_ref(r, (void**)r->strings, r->nstrings, (void**)result);
+    if(rc <= 0) return rc;
+    uint32_t len;
+    if(_dalvik_cache_read_u32(r, &len) < 0) return -1;
+    if(r->ptr + len + 1 > r->end || r->ptr[len] != 0)
+    {
+        LOG_ERROR("invalid string in cache file");
+        return -1;
+    }
+    /* the string is in the mapped memory, pool it */
+    if(NULL == (*result = stringpool_query(r->ptr))) return -1;
+    r->ptr += len + 1;
+    return _dalvik_cache_table_append((void***)&r->strings, &r->nstrings, &r->cap_strings, (void*)*result);
+}
+static inline int _dalvik_cache_read_type(_dalvik_cache_reader_t* r, dalvik_type_t** result)
+{
+    uint32_t typecode;
+    *result = NULL;
+    if(_dalvik_cache_read_u32(r, &typecode) < 0) return -1;
+    if(_DALVIK_CACHE_TYPE_NULL == typecode) return 0;
+    if(DALVIK_TYPE_IS_ATOM(typecode))
+    {
+        if(typecode >= DALVIK_TYPECODE_NUM_ATOM)
+        {
+            LOG_ERROR("invalid type code %u", typecode);
+            return -1;
+        }
+        *result = dalvik_type_atom[typecode];
+        return 0;
+    }
+    if(typecode != DALVIK_TYPECODE_OBJECT && typecode != DALVIK_TYPECODE_ARRAY)
+    {
+        LOG_ERROR("invalid type code %u", typecode);
+        return -1;
+    }
+    dalvik_type_t* ret = (dalvik_type_t*)malloc(sizeof(dalvik_type_t));
+    if(NULL == ret)
+    {
+        LOG_ERROR("can not allocate memory for type");
+        return -1;
+    }
+    memset(ret, 0, sizeof(dalvik_type_t));
+    ret->typecode = typecode;
+    if(DALVIK_TYPECODE_OBJECT == typecode)
+    {
+        if(_dalvik_cache_read_string(r, &ret->data.object.path) < 0) goto ERR;
+    }
+    else
+    {
+        if(_dalvik_cache_read_type(r, &ret->data.array.elem_type) < 0) goto ERR;
+    }
+    *result = ret;
+    return 0;
+ERR:
+    dalvik_type_free(ret);
+    return -1;
+}
+static inline int _dalvik_cache_read_typelist(_dalvik_cache_reader_t* r, const dalvik_type_t*** result)
+{
+    uint32_t n, i;
+    if(_dalvik_cache_read_u32(r, &n) < 0) return -1;
+    if(r->ptr + n * sizeof(uint32_t) > r->end)
+    {
+        LOG_ERROR("unexpected end of cache file");
+        return -1;
+    }
+    const dalvik_type_t** list = (const dalvik_type_t**)calloc(n + 1, sizeof(dalvik_type_t*));
+    if(NULL == list)
+    {
+        LOG_ERROR("can not allocate memory for type list");
+        return -1;
+    }
+    for(i = 0; i < n; i ++)
+    {
+        dalvik_type_t* type;
+        if(_dalvik_cache_read_type(r, &type) < 0) goto ERR;
+        list[i] = type;
+    }
+    *result = list;
+    return 0;
+ERR:
+    for(i = 0; list[i]; i ++) dalvik_type_free((dalvik_type_t*)list[i]);
+    free(list);
+    return -1;
+}
+static inline int _dalvik_cache_read_handler(_dalvik_cache_reader_t* r, dalvik_exception_handler_t** result)
+{
+    int rc = _dalvik_cache_read_ref(r, (void**)r->handlers, r->nhandlers, (void**)result);
+    if(rc <= 0) return rc;
+    const char* exception;
+    uint32_t label;
+    if(_dalvik_cache_read_string(r, &exception) < 0) return -1;
+    if(_dalvik_cache_read_u32(r, &label) < 0) return -1;
+    if(NULL == (*result = dalvik_exception_new_handler(exception, label))) return -1;
+    return _dalvik_cache_table_append((void***)&r->handlers, &r->nhandlers, &r->cap_handlers, *result);
+}
+static inline int _dalvik_cache_read_handler_set(_dalvik_cache_reader_t* r, dalvik_exception_handler_set_t** result)
+{
+    int rc = _dalvik_cache_read_ref(r, (void**)r->sets, r->nsets, (void**)result);
+    if(rc <= 0) return rc;
+    uint32_t n, i;
+    dalvik_exception_handler_t* handlers[DALVIK_MAX_CATCH_BLOCK];
+    if(_dalvik_cache_read_u32(r, &n) < 0) return -1;
+    if(n > DALVIK_MAX_CATCH_BLOCK)
+    {
+        LOG_ERROR("too many exception handlers in a handler set");
+        return -1;
+    }
+    for(i = 0; i < n; i ++)
+        if(_dalvik_cache_read_handler(r, handlers + i) < 0) return -1;
+    *result = dalvik_exception_new_handler_set(n, handlers);
+    return _dalvik_cache_table_append((void***)&r->sets, &r->nsets, &r->cap_sets, *result);
+}
+static inline int _dalvik_cache_read_vector(_dalvik_cache_reader_t* r, size_t elem_size, vector_t** result)
+{
+    uint32_t n, i;
+    char buf[sizeof(dalvik_sparse_switch_branch_t) + sizeof(uint32_t)];
+    if(_dalvik_cache_read_u32(r, &n) < 0) return -1;
+    if(NULL == (*result = vector_new(elem_size))) return -1;
+    for(i = 0; i < n; i ++)
+    {
+        if(_dalvik_cache_read(r, buf, elem_size) < 0 ||
+           vector_pushback(*result, buf) < 0)
+        {
+            vector_free(*result);
+            *result = NULL;
+            return -1;
+        }
+    }
+    return 0;
+}
+static inline int _dalvik_cache_read_instruction(_dalvik_cache_reader_t* r)
+{
+    uint8_t head[4];
+    uint32_t line, next, nslots, i = 0;
+    dalvik_instruction_t* inst = dalvik_instruction_new();
+    if(NULL == inst) return -1;
+    if(_dalvik_cache_read(r, head, sizeof(head)) < 0) return -1;
+    inst->opcode = head[0];
+    inst->num_operands = head[1];
+    inst->flags = head[2];
+    nslots = _dalvik_cache_instruction_nslots(inst);
+    if(_dalvik_cache_read_u32(r, &line) < 0 ||
+       _dalvik_cache_read_u32(r, &next) < 0 ||
+       _dalvik_cache_read_handler_set(r, &inst->handler_set) < 0 ||
+       _dalvik_cache_read(r, inst->operands, sizeof(dalvik_operand_t) * nslots) < 0)
+        goto ERR;
+    inst->line = line;
+    inst->next = next;
+    /* the pointers in the raw data are not valid, clear them first, so that we can free the instruction safely */
+    for(i = 0; i < inst->num_operands; i ++)
+        if(_dalvik_cache_operand_is_pointer(inst->operands + i))
+            inst->operands[i].payload.uint64 = 0;
+    for(i = 0; i < inst->num_operands; i ++)
+    {
+        dalvik_operand_t* opr = inst->operands + i;
+        if(!_dalvik_cache_operand_is_pointer(opr)) continue;
+        int rc = 0;
+        switch(opr->header.info.type)
+        {
+            case DVM_OPERAND_TYPE_CLASS:
+            case DVM_OPERAND_TYPE_STRING:
+            case DVM_OPERAND_TYPE_FIELD:
+                rc = _dalvik_cache_read_string(r, &opr->payload.string);
+                break;
+            case DVM_OPERAND_TYPE_TYPEDESC:
+                rc = _dalvik_cache_read_type(r, &opr->payload.type);
+                break;
+            case DVM_OPERAND_TYPE_TYPELIST:
+                rc = _dalvik_cache_read_typelist(r, (const dalvik_type_t***)&opr->payload.typelist);
+                break;
+            case DVM_OPERAND_TYPE_LABELVECTOR:
+                rc = _dalvik_cache_read_vector(r, sizeof(uint32_t), &opr->payload.branches);
+                break;
+            case DVM_OPERAND_TYPE_SPARSE:
+                rc = _dalvik_cache_read_vector(r, sizeof(dalvik_sparse_switch_branch_t), &opr->payload.sparse);
+                break;
+        }
+        if(rc < 0) goto ERR;
+    }
+    return 0;
+ERR:
+    /* the first i operands are completely read, release their payloads, and the instruction
+     * is still in the pool, so make it a valid empty one */
+    inst->num_operands = i;
+    dalvik_instruction_free(inst);
+    inst->num_operands = 0;
+    return -1;
+}
+static inline int _dalvik_cache_read_member(_dalvik_cache_reader_t* r, uint32_t type)
+{
+    uint32_t i, n, value, num_regs;
+    dalvik_method_t* method = NULL;
+    dalvik_field_t*  field = NULL;
+    dalvik_class_t*  class = NULL;
+    const char *name, *path, *file;
+    dalvik_type_t* ret_type;
+    switch(type)
+    {
+        case DALVIK_MEMBERDICT_TYPE_METHOD:
+            if(_dalvik_cache_read_string(r, &name) < 0 ||
+               _dalvik_cache_read_string(r, &path) < 0 ||
+               _dalvik_cache_read_string(r, &file) < 0 ||
+               _dalvik_cache_read_u32(r, &value) < 0 ||
+               _dalvik_cache_read_type(r, &ret_type) < 0)
+                return -1;
+            if(_dalvik_cache_read_u32(r, &n) < 0 ||
+               r->ptr + n * sizeof(uint32_t) > r->end ||
+               NULL == (method = (dalvik_method_t*)malloc(sizeof(dalvik_method_t) + sizeof(dalvik_type_t*) * (n + 1))))
+            {
+                LOG_ERROR("can not create method");
+                dalvik_type_free(ret_type);
+                return -1;
+            }
+            memset(method->args_type, 0, sizeof(dalvik_type_t*) * (n + 1));
+            method->name = name;
+            method->path = path;
+            method->file = file;
+            method->flags = value;
+            method->return_type = ret_type;
+            method->num_args = n;
+            if(_dalvik_cache_read_u32(r, &num_regs) < 0 ||
+               _dalvik_cache_read_u32(r, &method->entry) < 0)
+                goto ERR;
+            method->num_regs = num_regs;
+            for(i = 0; i < n; i ++)
+            {
+                dalvik_type_t* arg;
+                if(_dalvik_cache_read_type(r, &arg) < 0) goto ERR;
+                method->args_type[i] = arg;
+            }
+            if(dalvik_memberdict_register_method(method->path, method) < 0) goto ERR;
+            return 0;
+        case DALVIK_MEMBERDICT_TYPE_FIELD:
+            if(NULL == (field = (dalvik_field_t*)malloc(sizeof(dalvik_field_t))))
+            {
+                LOG_ERROR("can not allocate memory for field");
+                return -1;
+            }
+            memset(field, 0, sizeof(dalvik_field_t));
+            if(_dalvik_cache_read_string(r, &field->name) < 0 ||
+               _dalvik_cache_read_string(r, &field->path) < 0 ||
+               _dalvik_cache_read_string(r, &field->file) < 0 ||
+               _dalvik_cache_read_type(r, &field->type) < 0 ||
+               _dalvik_cache_read_u32(r, &value) < 0)
+                goto ERR;
+            field->attrs = value;
+            if(_dalvik_cache_read_u32(r, &value) < 0) goto ERR;
+            field->offset = value;
+            if(dalvik_memberdict_register_field(field->path, field) < 0) goto ERR;
+            return 0;
+        case DALVIK_MEMBERDICT_TYPE_CLASS:
+            if(_dalvik_cache_read_string(r, &path) < 0 ||
+               _dalvik_cache_read_string(r, &name) < 0)
+                return -1;
+            {
+                uint32_t attrs, is_interface, nimpl;
+                const char* implements[128];
+                if(_dalvik_cache_read_u32(r, &attrs) < 0 ||
+                   _dalvik_cache_read_u32(r, &is_interface) < 0 ||
+                   _dalvik_cache_read_u32(r, &nimpl) < 0)
+                    return -1;
+                if(nimpl >= 128)
+                {
+                    LOG_ERROR("invalid number of interfaces");
+                    return -1;
+                }
+                for(i = 0; i < nimpl; i ++)
+                    if(_dalvik_cache_read_string(r, implements + i) < 0) return -1;
+                if(_dalvik_cache_read_u32(r, &n) < 0 ||
+                   r->ptr + n * sizeof(uint32_t) > r->end ||
+                   NULL == (class = (dalvik_class_t*)malloc(sizeof(dalvik_class_t) + sizeof(const char*) * (n + 1))))
+                {
+                    LOG_ERROR("can not create class");
+                    return -1;
+                }
+                memset(class, 0, sizeof(dalvik_class_t) + sizeof(const char*) * (n + 1));
+                class->path = path;
+                class->super = name;
+                class->attrs = attrs;
+                class->is_interface = is_interface;
+                for(i = 0; i < nimpl; i ++) class->implements[i] = implements[i];
+                for(i = 0; i < n; i ++)
+                    if(_dalvik_cache_read_string(r, class->members + i) < 0) goto ERR;
+            }
+            if(dalvik_memberdict_register_class(class->path, class) < 0) goto ERR;
+            return 0;
+    }
+    LOG_ERROR("unknown member type %u", type);
+    return -1;
+ERR:
+    if(method) dalvik_method_free(method);
+    if(field)  dalvik_field_free(field);
+    if(class)  free(class);
+    return -1;
+}
+static inline int _dalvik_cache_read_program(_dalvik_cache_reader_t* r)
+{
+    uint32_t nlabels, ninsts, type, i;
+    /* labels, because the label pool is empty, the label ids are same as the ids in cache */
+    if(_dalvik_cache_read_u32(r, &nlabels) < 0) return -1;
+    for(i = 0; i < nlabels; i ++)
+    {
+        const char* name;
+        if(_dalvik_cache_read_string(r, &name) < 0) return -1;
+        if(dalvik_label_get_label_id(name) != i)
+        {
+            LOG_ERROR("label id mismatch, is the label pool empty?");
+            return -1;
+        }
+    }
+    if(_dalvik_cache_read(r, dalvik_label_jump_table, sizeof(uint32_t) * nlabels) < 0) return -1;
+    /* instructions */
+    if(_dalvik_cache_read_u32(r, &ninsts) < 0) return -1;
+    for(i = 0; i < ninsts; i ++)
+        if(_dalvik_cache_read_instruction(r) < 0) return -1;
+    /* members */
+    for(;;)
+    {
+        if(_dalvik_cache_read_u32(r, &type) < 0) return -1;
+        if(0xfffffffful == type) break;
+        if(_dalvik_cache_read_member(r, type) < 0) return -1;
+    }
+    /* counters */
+    int32_t counters[5];
+    if(_dalvik_cache_read(r, counters, sizeof(counters)) < 0) return -1;
+#ifdef PARSER_COUNT
+    /* the label counter is increased when the labels are created */
+    dalvik_class_count += counters[0];
+    dalvik_method_count += counters[1];
+    dalvik_field_count += counters[2];
+    dalvik_instruction_count += counters[4];
+#endif
+    return 0;
+}
+int dalvik_cache_load(const char* filename, uint64_t key)
+{
+    int fd = -1;
+    struct stat st;
+    const char* mem = MAP_FAILED;
+    int ret = 1;
+    _dalvik_cache_reader_t reader;
+    _dalvik_cache_header_t header;
+    memset(&reader, 0, sizeof(reader));
+    if(NULL == filename)
+    {
+        LOG_ERROR("invalid file name");
+        return -1;
+    }
+    if(dalvik_instruction_pool_size() > 0 || dalvik_label_get_count() > 0)
+    {
+        LOG_WARNING("a program has been loaded already, the cache can not be used");
+        return 1;
+    }
+    if((fd = open(filename, O_RDONLY)) < 0)
+    {
+        LOG_DEBUG("cache file %s is not available", filename);
+        return 1;
+    }
+    if(fstat(fd, &st) < 0 || st.st_size < sizeof(_dalvik_cache_header_t))
+    {
+        LOG_WARNING("invalid cache file %s", filename);
+        goto DONE;
+    }
+    mem = (const char*)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(MAP_FAILED == mem)
+    {
+        LOG_WARNING("can not map the cache file %s", filename);
+        goto DONE;
+    }
+    memcpy(&header, mem, sizeof(header));
+    if(memcmp(header.magic, _dalvik_cache_magic, sizeof(header.magic)) != 0 ||
+       header.version != DALVIK_CACHE_VERSION ||
+       header.inst_size != sizeof(dalvik_instruction_t) ||
+       header.opr_size != sizeof(dalvik_operand_t) ||
+       header.ptr_size != sizeof(void*))
+    {
+        LOG_NOTICE("cache file %s is not compatible", filename);
+        goto DONE;
+    }
+    if(header.key != key)
+    {
+        LOG_NOTICE("cache file %s is stale", filename);
+        goto DONE;
+    }
+    reader.ptr = mem + sizeof(header);
+    reader.end = mem + st.st_size;
+    if(header.size != reader.end - reader.ptr ||
+       header.checksum != dalvik_cache_hash(reader.ptr, header.size, DALVIK_CACHE_VERSION))
+    {
+        LOG_WARNING("cache file %s is corrupted", filename);
+        goto DONE;
+    }
+    if(_dalvik_cache_read_program(&reader) < 0)
+    {
+        LOG_ERROR("can not load program from cache file %s", filename);
+        ret = -1;
+        goto DONE;
+    }
+    if(reader.ptr != reader.end)
+    {
+        LOG_ERROR("unexpected data at the end of cache file %s", filename);
+        ret = -1;
+        goto DONE;
+    }
+    LOG_DEBUG("program is loaded from cache file %s", filename);
+    ret = 0;
+DONE:
+    if(MAP_FAILED != mem) munmap((void*)mem, st.st_size);
+    if(fd >= 0) close(fd);
+    if(reader.strings) free(reader.strings);
+    if(reader.handlers) free(reader.handlers);
+    if(reader.sets) free(reader.sets);
+    return ret;
+}
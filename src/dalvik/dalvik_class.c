@@ -74,9 +74,10 @@ dalvik_class_t* dalvik_class_from_sexp(const sexpression_t* sexp)
     }
 
     class->path = class_path;
+    class->super = NULL;
     class->attrs = attrs;
     class->is_interface = is_interface;
-    memset(class->members, 0, sizeof(const char*) * length);
+    memset(class->members, 0, sizeof(const char*) * (length + 1));
 
     const char* source = "(undefined)";
 	class->implements[0] = NULL;
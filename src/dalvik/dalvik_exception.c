@@ -71,6 +71,10 @@ static inline dalvik_exception_handler_set_t* _dalvik_exception_handler_set_allo
     return ret;   /* Because we do not push the new allocated object into the vecotr,
                      So we should do it by callee */
 }
+dalvik_exception_handler_t* dalvik_exception_new_handler(const char* exception, int handler_label)
+{
+    return _dalvik_exception_handler_alloc(exception, handler_label);
+}
 dalvik_exception_handler_t* dalvik_exception_handler_from_sexp(const sexpression_t* sexp, int* from, int* to)   /* 2 Cases */
 {
     if(SEXP_NIL == sexp ||
@@ -190,6 +194,7 @@ dalvik_exception_handler_set_t* dalvik_exception_new_handler_set(size_t count, d
             LOG_ERROR("can not allocate memory");
             goto ERR;
         }
+        this->handler = set[i];
         this->next = ret;
         ret = this;
     }
@@ -81,9 +81,15 @@ int dalvik_instruction_finalize( void )
 			dalvik_instruction_free(dalvik_instruction_pool + i);
 
     	free(dalvik_instruction_pool);
+		dalvik_instruction_pool = NULL;
 	}
+    _dalvik_instruction_pool_size = 0;
     return 0;
 }
+size_t dalvik_instruction_pool_size( void )
+{
+    return _dalvik_instruction_pool_size;
+}
 
 dalvik_instruction_t* dalvik_instruction_new( void )
 {
@@ -1536,7 +1542,7 @@ static inline int _dalvik_instruction_operand_to_string(const dalvik_operand_t*
 #define __CI(_name) name = #_name; break
 const char* dalvik_instruction_to_string(const dalvik_instruction_t* inst, char* buf, size_t sz)
 {
-    static char default_buf[1024];
+    static __thread char default_buf[1024];
     if(NULL == buf)
     {
         buf = default_buf;
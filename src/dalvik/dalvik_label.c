@@ -38,6 +38,26 @@ void dalvik_label_finalize(void)
         }
     }
 }
+int dalvik_label_get_count(void)
+{
+    return _dalvik_label_count;
+}
+int dalvik_label_get_names(const char** names, int count)
+{
+    int i;
+    if(count < _dalvik_label_count)
+    {
+        LOG_ERROR("the buffer is too small for %d labels", _dalvik_label_count);
+        return -1;
+    }
+    for(i = 0; i < DAVLIK_LABEL_POOL_SIZE; i ++)
+    {
+        dalvik_label_map_t* ptr;
+        for(ptr = _dalvik_label_map_table[i]; ptr; ptr = ptr->next)
+            names[ptr->idx] = ptr->label;
+    }
+    return _dalvik_label_count;
+}
 int dalvik_label_get_label_id(const char* label)
 {
     int idx = ((uintptr_t)label * MH_MULTIPLY)%DAVLIK_LABEL_POOL_SIZE;
@@ -2,9 +2,16 @@
 #include <unistd.h>
 #include <dirent.h>
 #include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <dalvik/dalvik_loader.h>
 #include <dalvik/dalvik_class.h>
+#include <dalvik/dalvik_cache.h>
+#include <dalvik/dalvik_instruction.h>
+#include <dalvik/dalvik_label.h>
 #include <debug.h>
 #ifdef PARSER_COUNT
 extern int dalvik_method_count;
@@ -13,102 +20,392 @@ extern int dalvik_label_count;
 extern int dalvik_field_count;
 extern int dalvik_class_count;
 #endif
+/* a file to be loaded, the parser fills the S-Expressions, and then the loader builds classes from them */
+typedef struct {
+    char*            path;      /* the path to the file */
+    sexp_arena_t*    arena;     /* the memory for the S-Expressions */
+    sexpression_t**  sexps;     /* the S-Expressions parsed from this file */
+    int              nsexps;    /* how many S-Expressions are there */
+    int              status;    /* 0: not parsed yet, 1: parsed, -1: error, written by the parser and read by the builder atomically */
+} _dalvik_loader_file_t;
+
+/* the shared state of a parallel loader */
+typedef struct {
+    _dalvik_loader_file_t* files;   /* all files, in the same order as the serial loader */
+    int               nfiles;       /* number of files */
+    int               next;         /* the next file to parse */
+    int               done;         /* the number of files that has been built */
+    pthread_mutex_t   mutex;        /* the lock for this state */
+    pthread_cond_t    parsed;       /* signaled when a file is parsed */
+    pthread_cond_t    consumed;     /* signaled when a file is built */
+} _dalvik_loader_queue_t;
+
+static int _dalvik_loader_nthreads = DALVIK_LOADER_NTHREADS;
+
 int _dalvik_loader_filter(const struct dirent* ent)
 {
     if(ent->d_name[0] == '.') return 0;
     return 1;
 }
-int dalvik_loader_from_directory(const char* path)
+/* append all files under path to the file list, the order is the order we visit the files in the serial loader */
+static inline int _dalvik_loader_scan(const char* path, _dalvik_loader_file_t** p_files, int* p_nfiles, int* p_cap)
 {
     int num_dirent;
     struct dirent **result = NULL;
-    char *buf = NULL;
-
+    int i;
     num_dirent = scandir(path, &result, _dalvik_loader_filter, alphasort);
 
     LOG_DEBUG("Scanning file under %s", path);
 
-    int i;
-
-    if(num_dirent < 0) goto ERR;
-    
-    size_t bufsize = 1024;
-    buf = (char*)malloc(bufsize);
-
+    if(num_dirent < 0)
+    {
+        LOG_ERROR("can not scan directory %s", path);
+        return -1;
+    }
     for(i = 0; i < num_dirent; i ++)
     {
+        char filename[1024];
+        snprintf(filename, sizeof(filename), "%s/%s", path, result[i]->d_name);
         if(result[i]->d_type == DT_DIR)
         {
-            char filename[1024];
-            sprintf(filename, "%s/%s", path, result[i]->d_name);
-            if(dalvik_loader_from_directory(filename) < 0) goto ERR;
+            if(_dalvik_loader_scan(filename, p_files, p_nfiles, p_cap) < 0) goto ERR;
         }
-        else 
+        else
         {
-            LOG_DEBUG("Scanning file %s/%s", path, result[i]->d_name);
-            sprintf(buf, "%s/%s", path, result[i]->d_name);
-            FILE* fp = fopen(buf, "r");
-            fseek(fp, 0, SEEK_END);
-            int len = ftell(fp) + 1;
-            while(len > bufsize)
-            {
-                bufsize *= 2;
-                buf = (char*)realloc(buf, bufsize);
-            }
-            if(NULL == fp)
-            {
-                LOG_ERROR("Can't open file %s", buf);
-                goto ERR;
-            }
-            fseek(fp, 0, SEEK_SET);
-            int nbytes;
-            if((nbytes = fread(buf, 1, bufsize, fp)) < 0)
-            {
-                LOG_ERROR("Can't read file");
-                goto ERR;
-            }
-            buf[nbytes] = 0;
-            fclose(fp);
-            const char *ptr;
-            for(ptr = buf; ptr != NULL && ptr[0] != 0;)
+            if(*p_nfiles >= *p_cap)
             {
-                sexpression_t* sexp;
-                if(NULL == (ptr = sexp_parse(ptr, &sexp)))
+                int newcap = (*p_cap) ? (*p_cap) * 2 : 64;
+                _dalvik_loader_file_t* newfiles = (_dalvik_loader_file_t*)realloc(*p_files, sizeof(_dalvik_loader_file_t) * newcap);
+                if(NULL == newfiles)
                 {
-                    sexp_free(sexp);
-                    LOG_ERROR("Can't parse S-Expression");
+                    LOG_ERROR("can not allocate memory for the file list");
                     goto ERR;
                 }
-                if(SEXP_NIL == sexp) continue;
-                if(NULL == dalvik_class_from_sexp(sexp))
-                {
-                    sexp_free(sexp);
-                    LOG_ERROR("Can't parse class definitions");
-                    goto ERR;
-                }
-                sexp_free(sexp);
-                
+                *p_files = newfiles;
+                *p_cap = newcap;
             }
+            _dalvik_loader_file_t* file = (*p_files) + (*p_nfiles);
+            memset(file, 0, sizeof(_dalvik_loader_file_t));
+            if(NULL == (file->path = strdup(filename)))
+            {
+                LOG_ERROR("can not allocate memory for the file path");
+                goto ERR;
+            }
+            (*p_nfiles) ++;
         }
     }
-    if(buf) free(buf);
     for(i = 0; i < num_dirent; i ++)
         free(result[i]);
-    if(result) free(result);
+    free(result);
     return 0;
 ERR:
-    if(buf) free(buf);
     for(i = 0; i < num_dirent; i ++)
         free(result[i]);
-    if(result) free(result);
-    LOG_ERROR("dalvik loader is returninng a failure");
+    free(result);
     return -1;
 }
+/* release the S-Expressions of a file */
+static inline void _dalvik_loader_file_clean(_dalvik_loader_file_t* file)
+{
+    if(file->arena) sexp_arena_free(file->arena);
+    file->arena = NULL;
+    if(file->sexps) free(file->sexps);
+    file->sexps = NULL;
+    file->nsexps = 0;
+}
+/* map a file to memory, the content is followed by at least one zero byte, so the parser can use it as a string */
+static inline const char* _dalvik_loader_map(const char* path, size_t* p_size)
+{
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    char* ret = MAP_FAILED;
+    if(fd < 0)
+    {
+        LOG_ERROR("Can't open file %s", path);
+        return NULL;
+    }
+    if(fstat(fd, &st) < 0)
+    {
+        LOG_ERROR("Can't stat file %s", path);
+        goto ERR;
+    }
+    /* reserve one more byte with zero pages, and then map the file over it, 
+     * so even if the file size is a multiple of page size, there's a zero after the content */
+    *p_size = st.st_size + 1;
+    ret = (char*)mmap(NULL, *p_size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(MAP_FAILED == ret)
+    {
+        LOG_ERROR("Can't reserve address space for file %s", path);
+        goto ERR;
+    }
+    if(st.st_size > 0 && 
+       MAP_FAILED == mmap(ret, st.st_size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0))
+    {
+        LOG_ERROR("Can't map file %s", path);
+        goto ERR;
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise(ret, *p_size, MADV_SEQUENTIAL);
+#endif
+    close(fd);
+    return ret;
+ERR:
+    if(MAP_FAILED != ret) munmap(ret, *p_size);
+    close(fd);
+    return NULL;
+}
+/* read a file and parse all S-Expressions in the file, this function do not touch anything but stringpool */
+static inline int _dalvik_loader_parse(_dalvik_loader_file_t* file)
+{
+    const char* buf = NULL;
+    size_t size = 0;
+    int cap = 0;
+    LOG_DEBUG("Scanning file %s", file->path);
+    if(NULL == (buf = _dalvik_loader_map(file->path, &size))) goto ERR;
+    if(NULL == (file->arena = sexp_arena_new())) goto ERR;
+    const char *ptr;
+    for(ptr = buf; ptr != NULL && ptr[0] != 0;)
+    {
+        sexpression_t* sexp;
+        if(NULL == (ptr = sexp_parse_arena(file->arena, ptr, &sexp)))
+        {
+            LOG_ERROR("Can't parse S-Expression");
+            goto ERR;
+        }
+        if(SEXP_NIL == sexp) continue;
+        if(file->nsexps >= cap)
+        {
+            int newcap = cap ? cap * 2 : 4;
+            sexpression_t** newsexps = (sexpression_t**)realloc(file->sexps, sizeof(sexpression_t*) * newcap);
+            if(NULL == newsexps)
+            {
+                LOG_ERROR("Can't allocate memory for S-Expression list");
+                goto ERR;
+            }
+            file->sexps = newsexps;
+            cap = newcap;
+        }
+        file->sexps[file->nsexps ++] = sexp;
+    }
+    munmap((void*)buf, size);
+    /* publish the S-Expressions to the builder */
+    __atomic_store_n(&file->status, 1, __ATOMIC_RELEASE);
+    return 0;
+ERR:
+    if(NULL != buf) munmap((void*)buf, size);
+    _dalvik_loader_file_clean(file);
+    __atomic_store_n(&file->status, -1, __ATOMIC_RELEASE);
+    return -1;
+}
+/* build classes from a parsed file, must be called in the loading order */
+static inline int _dalvik_loader_build(_dalvik_loader_file_t* file)
+{
+    int i;
+    int ret = 0;
+    if(__atomic_load_n(&file->status, __ATOMIC_ACQUIRE) < 0) return -1;
+    for(i = 0; i < file->nsexps; i ++)
+    {
+        if(NULL == dalvik_class_from_sexp(file->sexps[i]))
+        {
+            LOG_ERROR("Can't parse class definitions in file %s", file->path);
+            ret = -1;
+            break;
+        }
+    }
+    _dalvik_loader_file_clean(file);
+    return ret;
+}
+/* the parser thread, take a file from the queue and parse it */
+static void* _dalvik_loader_worker(void* data)
+{
+    _dalvik_loader_queue_t* queue = (_dalvik_loader_queue_t*)data;
+    for(;;)
+    {
+        pthread_mutex_lock(&queue->mutex);
+        /* do not run too far ahead of the builder, otherwise we keep too many trees in memory */
+        while(queue->next < queue->nfiles && queue->next - queue->done >= DALVIK_LOADER_QUEUE_SIZE)
+            pthread_cond_wait(&queue->consumed, &queue->mutex);
+        if(queue->next >= queue->nfiles)
+        {
+            pthread_mutex_unlock(&queue->mutex);
+            break;
+        }
+        _dalvik_loader_file_t* file = queue->files + (queue->next ++);
+        pthread_mutex_unlock(&queue->mutex);
+
+        _dalvik_loader_parse(file);
+
+        pthread_mutex_lock(&queue->mutex);
+        pthread_cond_broadcast(&queue->parsed);
+        pthread_mutex_unlock(&queue->mutex);
+    }
+    return NULL;
+}
+/* parse the files in a worker pool, and build the classes in order */
+static inline int _dalvik_loader_load_parallel(_dalvik_loader_file_t* files, int nfiles, int nthreads)
+{
+    _dalvik_loader_queue_t queue;
+    pthread_t threads[DALVIK_LOADER_MAX_THREADS];
+    int nstarted = 0;
+    int i;
+    int ret = 0;
+    queue.files = files;
+    queue.nfiles = nfiles;
+    queue.next = 0;
+    queue.done = 0;
+    pthread_mutex_init(&queue.mutex, NULL);
+    pthread_cond_init(&queue.parsed, NULL);
+    pthread_cond_init(&queue.consumed, NULL);
+    for(nstarted = 0; nstarted < nthreads; nstarted ++)
+    {
+        if(pthread_create(threads + nstarted, NULL, _dalvik_loader_worker, &queue) != 0)
+        {
+            LOG_WARNING("can not start loader thread #%d", nstarted);
+            break;
+        }
+    }
+    if(0 == nstarted)
+    {
+        LOG_ERROR("no loader thread is running");
+        ret = -1;
+    }
+    for(i = 0; ret == 0 && i < nfiles; i ++)
+    {
+        pthread_mutex_lock(&queue.mutex);
+        while(__atomic_load_n(&files[i].status, __ATOMIC_ACQUIRE) == 0)
+            pthread_cond_wait(&queue.parsed, &queue.mutex);
+        pthread_mutex_unlock(&queue.mutex);
+
+        if(_dalvik_loader_build(files + i) < 0) ret = -1;
+
+        pthread_mutex_lock(&queue.mutex);
+        queue.done = i + 1;
+        pthread_cond_broadcast(&queue.consumed);
+        pthread_mutex_unlock(&queue.mutex);
+    }
+    /* stop the workers, there's no need to parse the remaining files */
+    pthread_mutex_lock(&queue.mutex);
+    queue.next = nfiles;
+    pthread_cond_broadcast(&queue.consumed);
+    pthread_mutex_unlock(&queue.mutex);
+    for(i = 0; i < nstarted; i ++)
+        pthread_join(threads[i], NULL);
+    pthread_mutex_destroy(&queue.mutex);
+    pthread_cond_destroy(&queue.parsed);
+    pthread_cond_destroy(&queue.consumed);
+    return ret;
+}
+void dalvik_loader_set_nthreads(int nthreads)
+{
+    if(nthreads < 1) nthreads = 1;
+    if(nthreads > DALVIK_LOADER_MAX_THREADS) nthreads = DALVIK_LOADER_MAX_THREADS;
+    _dalvik_loader_nthreads = nthreads;
+}
+int dalvik_loader_get_nthreads()
+{
+    return _dalvik_loader_nthreads;
+}
+/* load all scanned files */
+static inline int _dalvik_loader_load(_dalvik_loader_file_t* files, int nfiles)
+{
+    int i;
+    if(_dalvik_loader_nthreads > 1 && nfiles > 1)
+    {
+        int nthreads = _dalvik_loader_nthreads;
+        if(nthreads > nfiles) nthreads = nfiles;
+        LOG_DEBUG("loading %d files with %d threads", nfiles, nthreads);
+        return _dalvik_loader_load_parallel(files, nfiles, nthreads);
+    }
+    for(i = 0; i < nfiles; i ++)
+    {
+        if(_dalvik_loader_parse(files + i) < 0 ||
+           _dalvik_loader_build(files + i) < 0)
+            return -1;
+    }
+    return 0;
+}
+/* compute the key of the files under the directory, the key covers the relative path and the content of each file */
+static inline int _dalvik_loader_key(const char* path, const _dalvik_loader_file_t* files, int nfiles, uint64_t* p_key)
+{
+    int i;
+    size_t prefix = strlen(path);
+    uint64_t key = dalvik_cache_hash(&nfiles, sizeof(nfiles), DALVIK_CACHE_VERSION);
+    for(i = 0; i < nfiles; i ++)
+    {
+        const char* relpath = files[i].path;
+        size_t size;
+        if(strncmp(relpath, path, prefix) == 0) relpath += prefix;
+        const char* content = _dalvik_loader_map(files[i].path, &size);
+        if(NULL == content) return -1;
+        key = dalvik_cache_hash(relpath, strlen(relpath) + 1, key);
+        /* the size includes the trailing zero, so the boundary of files is also hashed */
+        key = dalvik_cache_hash(content, size, key);
+        munmap((void*)content, size);
+    }
+    *p_key = key;
+    return 0;
+}
+static inline void _dalvik_loader_files_free(_dalvik_loader_file_t* files, int nfiles)
+{
+    int i;
+    for(i = 0; i < nfiles; i ++)
+    {
+        _dalvik_loader_file_clean(files + i);
+        free(files[i].path);
+    }
+    if(files) free(files);
+}
+int dalvik_loader_from_directory(const char* path)
+{
+    _dalvik_loader_file_t* files = NULL;
+    int nfiles = 0, cap = 0;
+    int ret = 0;
+
+    if(_dalvik_loader_scan(path, &files, &nfiles, &cap) < 0)
+        ret = -1;
+    else
+        ret = _dalvik_loader_load(files, nfiles);
+
+    _dalvik_loader_files_free(files, nfiles);
+    if(ret < 0) LOG_ERROR("dalvik loader is returninng a failure");
+    return ret;
+}
+int dalvik_loader_from_directory_cached(const char* path, const char* cache_file)
+{
+    _dalvik_loader_file_t* files = NULL;
+    int nfiles = 0, cap = 0;
+    int ret = 0;
+    uint64_t key;
+    /* we can only use the cache when nothing is loaded */
+    int empty = (dalvik_instruction_pool_size() == 0 && dalvik_label_get_count() == 0);
+
+    if(NULL == cache_file) return dalvik_loader_from_directory(path);
+
+    if(_dalvik_loader_scan(path, &files, &nfiles, &cap) < 0 ||
+       _dalvik_loader_key(path, files, nfiles, &key) < 0)
+    {
+        ret = -1;
+        goto DONE;
+    }
+    if(empty)
+    {
+        ret = dalvik_cache_load(cache_file, key);
+        if(ret <= 0) goto DONE;
+        LOG_DEBUG("cache file %s is not usable, load from %s", cache_file, path);
+    }
+    ret = _dalvik_loader_load(files, nfiles);
+    if(ret >= 0 && empty && dalvik_cache_save(cache_file, key) < 0)
+        LOG_WARNING("can not save the program to cache file %s", cache_file);
+DONE:
+    _dalvik_loader_files_free(files, nfiles);
+    if(ret < 0) LOG_ERROR("dalvik loader is returninng a failure");
+    return ret;
+}
 #ifdef PARSER_COUNT
 void dalvik_loader_summary()
 {
 
-    LOG_TRACE("%d classes, %d methods, %d fields, %d labels, %d instructions", 
+    LOG_TRACE("%d classes, %d methods, %d fields, %d labels, %d instructions",
               dalvik_class_count,
               dalvik_method_count,
               dalvik_field_count,
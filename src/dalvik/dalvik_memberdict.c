@@ -7,9 +7,9 @@
 #include <dalvik/dalvik_field.h>
 #include <debug.h>
 
-#define _TYPE_METHOD 0
-#define _TYPE_FIELD 1
-#define _TYPE_CLASS 2
+#define _TYPE_METHOD DALVIK_MEMBERDICT_TYPE_METHOD
+#define _TYPE_FIELD DALVIK_MEMBERDICT_TYPE_FIELD
+#define _TYPE_CLASS DALVIK_MEMBERDICT_TYPE_CLASS
 typedef struct _dalvik_memberdict_node_t {
     const char* class_path;             /* the class path */
     const char* member_name;            /* the name of the member */
@@ -146,3 +146,17 @@ dalvik_class_t* dalvik_memberdict_get_class(const char* class_path)
 {
     return (dalvik_class_t*)_dalvik_memberdict_find_object(class_path, NULL, NULL, _TYPE_CLASS);
 }
+int dalvik_memberdict_foreach(int (*visitor)(int type, void* object, void* data), void* data)
+{
+    int i;
+    for(i = 0; i < DALVIK_MEMBERDICT_SIZE; i ++)
+    {
+        dalvik_memberdict_node_t* ptr;
+        for(ptr = _dalvik_memberdict_hash_table[i]; NULL != ptr; ptr = ptr->next)
+        {
+            int rc = visitor(ptr->type, ptr->object, data);
+            if(rc < 0) return rc;
+        }
+    }
+    return 0;
+}
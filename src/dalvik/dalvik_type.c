@@ -227,7 +227,7 @@ static inline int _dalvik_type_to_string_imp(const dalvik_type_t* type, char* bu
 }
 const char* dalvik_type_to_string(const dalvik_type_t* type, char* buf, size_t sz)
 {
-    static char _buf[1024];
+    static __thread char _buf[1024];
     if(NULL == buf)
     {
         buf = _buf;
@@ -238,7 +238,7 @@ const char* dalvik_type_to_string(const dalvik_type_t* type, char* buf, size_t s
 }
 const char* dalvik_type_list_to_string(const dalvik_type_t * const * list, char* buf, size_t sz)
 {
-    static char _buf[1024];
+    static __thread char _buf[1024];
     if(NULL == buf)
     {
         buf = _buf;
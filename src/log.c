@@ -4,8 +4,124 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <pthread.h>
 static char _log_path[8][128] = {};
 static FILE* _log_fp[8] = {};
+
+/* the runtime levels */
+typedef struct {
+    char prefix[64];    /* the prefix of the module names */
+    int  level;         /* the level of the modules */
+} _log_rule_t;
+static _log_rule_t _log_rules[LOG_MAX_RULES];
+static int _log_nrules = 0;
+static int _log_default_level = DEBUG;
+/* the modules, module 0 is used when there are too many modules */
+static char _log_modules[LOG_MAX_MODULES][64] = {"<default>"};
+static int _log_nmodules = 1;
+uint8_t log_module_mask[LOG_MAX_MODULES];
+/* the levels whose output is /dev/null, all levels are disabled before the log is initialized */
+static uint8_t _log_null_mask = 0x7f;
+static int _log_backend = LOG_BACKEND_FILE;
+/* protects the rules and the modules, only used when the settings are changed or a module is registered */
+static pthread_mutex_t _log_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* the ring buffer of a thread, only the owner thread writes the buffer */
+typedef struct _log_ring_t {
+    struct _log_ring_t* next;     /* the next ring in the list of all rings */
+    uint32_t            head;     /* the number of logs has been written */
+    struct {
+        int  level;
+        char text[LOG_RING_RECORD_SIZE];
+    } records[LOG_RING_SIZE];
+} _log_ring_t;
+/* the rings of the living threads, the list is protected by _log_lock */
+static _log_ring_t* _log_rings = NULL;
+static __thread _log_ring_t* _log_ring = NULL;
+/* the key used to flush and release the ring when the thread exits */
+static pthread_key_t _log_ring_key;
+static pthread_once_t _log_ring_key_once = PTHREAD_ONCE_INIT;
+/* write the logs in the ring to fp, or the output file of the level if fp is NULL */
+static inline int _log_ring_write(const _log_ring_t* ring, FILE* fp)
+{
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t begin = head > LOG_RING_SIZE ? head - LOG_RING_SIZE : 0;
+    uint32_t i;
+    for(i = begin; i < head; i ++)
+    {
+        FILE* out = (NULL != fp) ? fp : _log_fp[ring->records[i % LOG_RING_SIZE].level];
+        if(NULL != out) fprintf(out, "%s\n", ring->records[i % LOG_RING_SIZE].text);
+    }
+    return head - begin;
+}
+/* remove the ring from the list, flush and release it */
+static inline void _log_ring_release(_log_ring_t* ring)
+{
+    _log_ring_t** p;
+    pthread_mutex_lock(&_log_lock);
+    for(p = &_log_rings; NULL != *p && ring != *p; p = &(*p)->next);
+    if(NULL != *p) *p = ring->next;
+    pthread_mutex_unlock(&_log_lock);
+    _log_ring_write(ring, NULL);
+    free(ring);
+}
+/* called when a thread exits */
+static void _log_ring_thread_exit(void* data)
+{
+    _log_ring_release((_log_ring_t*)data);
+    _log_ring = NULL;
+}
+static void _log_ring_key_init()
+{
+    if(pthread_key_create(&_log_ring_key, _log_ring_thread_exit) != 0)
+        fprintf(stderr, "can not create the thread key, the ring buffers of exited threads are not released\n");
+}
+
+/* the level of the module, the longest matching rule wins */
+static inline int _log_module_level(const char* name)
+{
+    int i, ret = _log_default_level;
+    size_t best = 0;
+    for(i = 0; i < _log_nrules; i ++)
+    {
+        size_t len = strlen(_log_rules[i].prefix);
+        if(len >= best && strncmp(name, _log_rules[i].prefix, len) == 0)
+        {
+            best = len;
+            ret = _log_rules[i].level;
+        }
+    }
+    return ret;
+}
+/* compute the mask of the module, must be called with the lock held */
+static inline void _log_update_mask(int module)
+{
+    int level = _log_module_level(_log_modules[module]);
+    uint8_t mask = (level < 0) ? 0 : (uint8_t)((1u << (level + 1)) - 1);
+    /* the logs written to /dev/null are disabled, but the ring backend keeps all logs */
+    if(LOG_BACKEND_FILE == _log_backend) mask &= ~_log_null_mask;
+    __atomic_store_n(log_module_mask + module, mask, __ATOMIC_RELAXED);
+}
+static inline void _log_update_masks()
+{
+    int i;
+    for(i = 0; i < _log_nmodules; i ++)
+        _log_update_mask(i);
+}
+static inline int _log_level_from_name(const char* name)
+{
+#define     _STR_TO_ID(lv) if(strcmp(name, #lv) == 0) return lv
+    _STR_TO_ID(DEBUG);
+    _STR_TO_ID(TRACE);
+    _STR_TO_ID(INFO);
+    _STR_TO_ID(NOTICE);
+    _STR_TO_ID(WARNING);
+    _STR_TO_ID(ERROR);
+    _STR_TO_ID(FATAL);
+#undef      _STR_TO_ID
+    if(strcmp(name, "NONE") == 0) return -1;
+    return -2;
+}
 void log_init()
 {
     FILE* default_fp = stderr;
@@ -40,27 +156,32 @@ void log_init()
             *end = 0;
             int rc = sscanf(begin, "%s%s%s", type, path, mode);
             if(rc < 2) continue;
-            if(rc == 2) 
+            /* level <module|default> <LEVEL> */
+            if(strcmp(type, "level") == 0)
+            {
+                int level;
+                if(rc == 3 && (level = _log_level_from_name(mode)) > -2)
+                    log_set_level(strcmp(path, "default") == 0 ? NULL : path, level);
+                continue;
+            }
+            /* backend <file|ring> */
+            if(strcmp(type, "backend") == 0)
+            {
+                log_set_backend(strcmp(path, "ring") == 0 ? LOG_BACKEND_RING : LOG_BACKEND_FILE);
+                continue;
+            }
+            if(rc == 2)
             {
                 mode[0] = 'w';
                 mode[1] = '0';
             }
             int level;
-#define     _STR_TO_ID(name) else if(strcmp(type, #name) == 0) level = name
-            if(0);
-            _STR_TO_ID(DEBUG);
-            _STR_TO_ID(TRACE);
-            _STR_TO_ID(INFO);
-            _STR_TO_ID(NOTICE);
-            _STR_TO_ID(WARNING);
-            _STR_TO_ID(ERROR);
-            _STR_TO_ID(FATAL);
-            else if(strcmp(type, "default") == 0)
+            if(strcmp(type, "default") == 0)
                 level = 7;
-            else continue;
-#undef      _STR_TO_ID
+            else if((level = _log_level_from_name(type)) < 0)
+                continue;
 
-            FILE* outfile = NULL; 
+            FILE* outfile = NULL;
             if(strcmp(path, "<stdin>") == 0) outfile = stdin;
             else if(strcmp(path, "<stdout>") == 0) outfile = stdout;
             else if(strcmp(path, "<stderr>") == 0) outfile = stderr;
@@ -81,7 +202,7 @@ void log_init()
             if(_log_fp[level] != NULL)
             {
                 int i;
-                /* more than one log file, override */ 
+                /* more than one log file, override */
                 FILE* unused = _log_fp[level];
                 for(i = 0; i < 8; i ++)
                     if(_log_fp[i] == unused && i != level)
@@ -94,16 +215,41 @@ void log_init()
             strcpy(_log_path[level], path);
         }
         if(_log_fp[7] != NULL) default_fp = _log_fp[7];
+        fclose(fp);
     }
     int i;
+    uint8_t null_mask = 0;
     for(i = 0; i < 7; i ++)
+    {
         if(_log_fp[i] == NULL)
+        {
             _log_fp[i] = default_fp;
-	fclose(fp);
+            strcpy(_log_path[i], _log_path[7]);
+        }
+        if(strcmp(_log_path[i], "/dev/null") == 0)
+            null_mask |= (1 << i);
+    }
+    pthread_mutex_lock(&_log_lock);
+    _log_null_mask = null_mask;
+    _log_update_masks();
+    pthread_mutex_unlock(&_log_lock);
 }
 void log_finalize()
 {
     int i, j;
+    /* the rings of the exited threads are released already, and the rings of the living threads
+     * are still in use, so only the ring of this thread is flushed and released */
+    if(NULL != _log_ring)
+    {
+        pthread_setspecific(_log_ring_key, NULL);
+        _log_ring_release(_log_ring);
+        _log_ring = NULL;
+    }
+    log_flush();
+    pthread_mutex_lock(&_log_lock);
+    _log_null_mask = 0x7f;
+    _log_update_masks();
+    pthread_mutex_unlock(&_log_lock);
     for(i = 0; i < 8; i ++)
         if(_log_fp[i] != NULL &&
            _log_fp[i] != stdin &&
@@ -116,16 +262,133 @@ void log_finalize()
                     _log_fp[j] = NULL;
             fclose(unused);
         }
+    memset(_log_fp, 0, sizeof(_log_fp));
+    memset(_log_path, 0, sizeof(_log_path));
+}
+void log_set_backend(int backend)
+{
+    pthread_mutex_lock(&_log_lock);
+    _log_backend = backend;
+    _log_update_masks();
+    pthread_mutex_unlock(&_log_lock);
+}
+int log_set_level(const char* module, int level)
+{
+    int i, ret = 0;
+    pthread_mutex_lock(&_log_lock);
+    if(NULL == module)
+        _log_default_level = level;
+    else
+    {
+        for(i = 0; i < _log_nrules && strcmp(_log_rules[i].prefix, module) != 0; i ++);
+        if(i == _log_nrules && _log_nrules < LOG_MAX_RULES)
+        {
+            snprintf(_log_rules[i].prefix, sizeof(_log_rules[i].prefix), "%s", module);
+            _log_nrules ++;
+        }
+        if(i < _log_nrules)
+            _log_rules[i].level = level;
+        else
+            ret = -1;
+    }
+    _log_update_masks();
+    pthread_mutex_unlock(&_log_lock);
+    return ret;
+}
+int log_module_register(const char* file)
+{
+    /* the module name is the file name without directory and extension */
+    const char* name = strrchr(file, '/');
+    name = (NULL == name) ? file : name + 1;
+    size_t len = strcspn(name, ".");
+    if(len >= sizeof(_log_modules[0])) len = sizeof(_log_modules[0]) - 1;
+    int i;
+    pthread_mutex_lock(&_log_lock);
+    for(i = 1; i < _log_nmodules; i ++)
+        if(strncmp(_log_modules[i], name, len) == 0 && _log_modules[i][len] == 0)
+            break;
+    if(i == _log_nmodules)
+    {
+        if(_log_nmodules < LOG_MAX_MODULES)
+        {
+            memcpy(_log_modules[i], name, len);
+            _log_modules[i][len] = 0;
+            _log_nmodules ++;
+            _log_update_mask(i);
+        }
+        else
+            i = 0;
+    }
+    pthread_mutex_unlock(&_log_lock);
+    return i;
+}
+/* get the ring buffer of this thread, the new buffer is released when the thread exits */
+static inline _log_ring_t* _log_get_ring()
+{
+    if(NULL != _log_ring) return _log_ring;
+    _log_ring_t* ring = (_log_ring_t*)calloc(1, sizeof(_log_ring_t));
+    if(NULL == ring) return NULL;
+    pthread_once(&_log_ring_key_once, _log_ring_key_init);
+    pthread_setspecific(_log_ring_key, ring);
+    pthread_mutex_lock(&_log_lock);
+    ring->next = _log_rings;
+    _log_rings = ring;
+    pthread_mutex_unlock(&_log_lock);
+    return _log_ring = ring;
 }
 void log_write(int level, const char* file, const char* function, int line, const char* fmt, ...)
 {
     static const char LevelChar[] = "FEWNITD";
-    FILE* fp = _log_fp[level];
     va_list ap;
+    if(LOG_BACKEND_RING == _log_backend)
+    {
+        _log_ring_t* ring = _log_get_ring();
+        if(NULL == ring) return;
+        uint32_t idx = ring->head % LOG_RING_SIZE;
+        char* text = ring->records[idx].text;
+        int n = snprintf(text, LOG_RING_RECORD_SIZE, "%c[%s@%s:%3d] ", LevelChar[level], function, file, line);
+        if(n >= 0 && n < LOG_RING_RECORD_SIZE)
+        {
+            va_start(ap, fmt);
+            vsnprintf(text + n, LOG_RING_RECORD_SIZE - n, fmt, ap);
+            va_end(ap);
+        }
+        ring->records[idx].level = level;
+        __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+        return;
+    }
+    FILE* fp = _log_fp[level];
+    /* keep the lines from different threads from interleaving */
+    flockfile(fp);
     fprintf(fp,"%c[%s@%s:%3d] ",LevelChar[level],function,file,line);
     va_start(ap,fmt);
     vfprintf(fp, fmt, ap);
     va_end(ap);
     fprintf(fp, "\n");
     fflush(fp);
+    funlockfile(fp);
+}
+int log_ring_dump(FILE* fp)
+{
+    int ret = 0;
+    const _log_ring_t* ring;
+    if(NULL == fp) return 0;
+    pthread_mutex_lock(&_log_lock);
+    for(ring = _log_rings; NULL != ring; ring = ring->next)
+        ret += _log_ring_write(ring, fp);
+    pthread_mutex_unlock(&_log_lock);
+    fflush(fp);
+    return ret;
+}
+void log_flush()
+{
+    int i;
+    /* only the owner thread writes the ring, so it's the only one can clear it */
+    if(NULL != _log_ring)
+    {
+        _log_ring_write(_log_ring, NULL);
+        __atomic_store_n(&_log_ring->head, 0, __ATOMIC_RELEASE);
+    }
+    for(i = 0; i < 7; i ++)
+        if(NULL != _log_fp[i]) fflush(_log_fp[i]);
 }
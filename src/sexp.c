@@ -5,7 +5,74 @@
 #include <string.h>
 #include <debug.h>
 
-static inline sexpression_t* _sexp_alloc(int type)
+/* a page of the S-Expression arena */
+typedef struct _sexp_arena_page_t {
+    struct _sexp_arena_page_t* next;   /* the previous page */
+    size_t used;                        /* how many bytes are used */
+    size_t size;                        /* the size of data section */
+    uintptr_t data[0];                  /* the memory, aligned to pointer size */
+} _sexp_arena_page_t;
+struct _sexp_arena_t {
+    _sexp_arena_page_t* page;  /* current page, the pages are linked from newest to oldest */
+};
+sexp_arena_t* sexp_arena_new(void)
+{
+    sexp_arena_t* ret = (sexp_arena_t*)malloc(sizeof(sexp_arena_t));
+    if(NULL == ret) 
+    {
+        LOG_ERROR("can not allocate memory for S-Expression arena");
+        return NULL;
+    }
+    ret->page = NULL;
+    return ret;
+}
+/* free all pages except the last one in the page list, return the last page */
+static inline _sexp_arena_page_t* _sexp_arena_release_pages(_sexp_arena_page_t* page)
+{
+    while(page && page->next)
+    {
+        _sexp_arena_page_t* next = page->next;
+        free(page);
+        page = next;
+    }
+    return page;
+}
+void sexp_arena_reset(sexp_arena_t* arena)
+{
+    if(NULL == arena) return;
+    /* keep the first page, so that we do not need to allocate again */
+    arena->page = _sexp_arena_release_pages(arena->page);
+    if(arena->page) arena->page->used = 0;
+}
+void sexp_arena_free(sexp_arena_t* arena)
+{
+    if(NULL == arena) return;
+    _sexp_arena_page_t* page = _sexp_arena_release_pages(arena->page);
+    if(page) free(page);
+    free(arena);
+}
+/* allocate memory from the arena */
+static inline void* _sexp_arena_alloc(sexp_arena_t* arena, size_t size)
+{
+    size = (size + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1);
+    _sexp_arena_page_t* page = arena->page;
+    if(NULL == page || page->used + size > page->size)
+    {
+        size_t page_size = SEXP_ARENA_PAGE_SIZE - sizeof(_sexp_arena_page_t);
+        if(page_size < size) page_size = size;
+        page = (_sexp_arena_page_t*)malloc(sizeof(_sexp_arena_page_t) + page_size);
+        if(NULL == page) return NULL;
+        page->used = 0;
+        page->size = page_size;
+        page->next = arena->page;
+        arena->page = page;
+    }
+    void* ret = ((char*)page->data) + page->used;
+    page->used += size;
+    return ret;
+}
+/* allocate a S-Expression, if arena is NULL, use malloc */
+static inline sexpression_t* _sexp_alloc(sexp_arena_t* arena, int type)
 {
     size_t size = sizeof(sexpression_t);
     switch(type)
@@ -22,23 +89,64 @@ static inline sexpression_t* _sexp_alloc(int type)
         default:
             return NULL;
     }
-    sexpression_t* ret = (sexpression_t*) malloc(size);
+    sexpression_t* ret;
+    if(NULL == arena) 
+        ret = (sexpression_t*) malloc(size);
+    else
+        ret = (sexpression_t*) _sexp_arena_alloc(arena, size);
     if(NULL != ret) ret->type = type;
     return ret;
 }
 void sexp_free(sexpression_t* buf)
 {
     sexp_cons_t* cons_data;
-    if(SEXP_NIL == buf)  return; /* A empty S-Expression */
-    switch(buf->type)
+    /* the rests of the lists that are not freed yet, so a deep S-Expression does not overflow the C stack */
+    sexpression_t*  init_stack[SEXP_PARSE_STACK_INIT];
+    sexpression_t** stack = init_stack;
+    uint32_t depth = 0, capacity = SEXP_PARSE_STACK_INIT;
+    for(;;)
     {
-        case SEXP_TYPE_CONS:     /* A Cons S-Expression, free the memory recursively */
+        if(SEXP_NIL == buf)
+        {
+            if(0 == depth) break;
+            buf = stack[-- depth];
+            continue;
+        }
+        sexpression_t* next = SEXP_NIL;
+        if(SEXP_TYPE_CONS == buf->type)
+        {
             cons_data = (sexp_cons_t*) buf->data;
-            sexp_free(cons_data->first);
-            sexp_free(cons_data->second);
-        default:
-            free(buf);
+            next = cons_data->second;
+            /* free the nested list first, and remember the rest of this list */
+            if(SEXP_NIL != cons_data->first && SEXP_NIL != next)
+            {
+                if(depth >= capacity)
+                {
+                    uint32_t newcap = capacity * 2;
+                    sexpression_t** newstack;
+                    if(stack == init_stack)
+                    {
+                        newstack = (sexpression_t**)malloc(sizeof(sexpression_t*) * newcap);
+                        if(NULL != newstack) memcpy(newstack, stack, sizeof(sexpression_t*) * depth);
+                    }
+                    else
+                        newstack = (sexpression_t**)realloc(stack, sizeof(sexpression_t*) * newcap);
+                    if(NULL == newstack)
+                    {
+                        LOG_ERROR("can not allocate memory for the stack, the S-Expression is leaked");
+                        break;
+                    }
+                    stack = newstack;
+                    capacity = newcap;
+                }
+                stack[depth ++] = next;
+            }
+            if(SEXP_NIL != cons_data->first) next = cons_data->first;
+        }
+        free(buf);
+        buf = next;
     }
+    if(stack != init_stack) free(stack);
 }
 /* strip the white space, return value if the function eated a space */
 static inline int _sexp_parse_ws(const char** p) 
@@ -55,48 +163,20 @@ static inline int _sexp_parse_ws(const char** p)
           (*p) ++) ret = 1;
     return ret;
 }
-void _sexp_parse_comment(const char** str)
+/* strip the white spaces and comments */
+static inline void _sexp_parse_comment(const char** str)
 {
-    if(**str == ';')
+    _sexp_parse_ws(str);
+    while(**str == ';')
     {
         (*str) ++;
         while(**str && **str != '\n')
             (*str) ++;
         _sexp_parse_ws(str);
-        _sexp_parse_comment(str);
     }
 }
-/* parse the list from str  .... ), the first '(' is already eatten */
-static inline const char* _sexp_parse_list(const char* str, sexpression_t** buf)
-{
-    /* strip the leading white spaces */
-    _sexp_parse_ws(&str);
-    _sexp_parse_comment(&str);
-    /* If it's an empty list, then return NIL */
-    if(*str == ')' || *str == ']' || *str == '}') 
-    {
-        *buf = SEXP_NIL;
-        return str + 1;
-    }
-    else
-    {
-        /* The list has at least one element */
-        *buf = _sexp_alloc(SEXP_TYPE_CONS);
-        sexp_cons_t* data = (sexp_cons_t*)((*buf)->data);
-        if(NULL == *buf) goto ERR;
-        str = sexp_parse(str, &data->first);
-        if(NULL == str) goto ERR;
-        data->seperator = *str;
-        str = _sexp_parse_list(str, &data->second);
-        if(NULL == str) goto ERR;
-        return str;
-    }
-ERR:
-    sexp_free(*buf);
-    return NULL;
-}
-/* parse a string */
-static inline const char* _sexp_parse_string(const char* str, sexpression_t** buf)
+/* parse a string, the leading quote is already eatten */
+static inline const char* _sexp_parse_string(const char* str, const char** result)
 {
     int escape = 0;
     stringpool_accumulator_t accumulator;
@@ -107,10 +187,7 @@ static inline const char* _sexp_parse_string(const char* str, sexpression_t** bu
         {
             if(*str == '"') 
             {
-                *buf = _sexp_alloc(SEXP_TYPE_STR);
-                if(NULL == *buf) return NULL;
-                sexp_str_t* data = (sexp_str_t*)((*buf)->data);
-                (*data) = stringpool_accumulator_query(&accumulator);
+                if(NULL == ((*result) = stringpool_accumulator_query(&accumulator))) return NULL;
                 return str + 1;
             }
             else if(*str != '\\')
@@ -124,15 +201,13 @@ static inline const char* _sexp_parse_string(const char* str, sexpression_t** bu
             stringpool_accumulator_next(&accumulator, *str);
         }
     }
+    LOG_ERROR("unterminated string");
     return NULL;
 }
-/* parse char */
-static inline const char* _sexp_parse_char(const char* str, sexpression_t** buf)
+/* parse char, the leading # is already eatten */
+static inline const char* _sexp_parse_char(const char* str, const char** result)
 {
     char tmp[3] = {};
-    *buf = _sexp_alloc(SEXP_TYPE_STR);
-    if(NULL == *buf) return NULL;
-    sexp_str_t* data = (sexp_str_t*)((*buf)->data);
     if(str[0] == '\\')
     {
         tmp[0] = str[1];
@@ -144,12 +219,12 @@ static inline const char* _sexp_parse_char(const char* str, sexpression_t** buf)
         tmp[0] = str[0];
         str ++;
     }
-    *data = stringpool_query(tmp);
+    if(NULL == ((*result) = stringpool_query(tmp))) return NULL;
     return str;
 }
 /* parse a literal */
 #define RANGE(l,r,v) (((l) <= (v)) && ((v) <= (r)))
-static inline const char* _sexpr_parse_literal(const char* str, sexpression_t** buf)
+static inline const char* _sexpr_parse_literal(const char* str, const char** result)
 {
     stringpool_accumulator_t accumulator;
     stringpool_accumulator_init(&accumulator, str);
@@ -169,27 +244,191 @@ static inline const char* _sexpr_parse_literal(const char* str, sexpression_t**
           *str != '}'  &&
           *str != 0; str++)
         stringpool_accumulator_next(&accumulator, *str);
-    *buf = _sexp_alloc(SEXP_TYPE_LIT);
-    if(*buf == NULL) return NULL;
-    sexp_lit_t* data;
-    data = (sexp_lit_t*)((*buf)->data);
-    *data = stringpool_accumulator_query(&accumulator);
+    if(NULL == ((*result) = stringpool_accumulator_query(&accumulator))) return NULL;
     return str;
 }
-const char* sexp_parse(const char* str, sexpression_t** buf)
+/* the parser, we use a depth counter rather than recursion, the consumer keeps its own stack if it needs */
+static inline const char* _sexp_parse_events(const char* str, const sexp_event_handler_t* handler, void* context)
 {
+    uint32_t depth = 0;
     if(NULL == str) return NULL;
-    _sexp_parse_ws(&str);
-    _sexp_parse_comment(&str);
-    if(*str == 0)
+    for(;;)
+    {
+        _sexp_parse_comment(&str);
+        if(*str == 0)
+        {
+            if(depth > 0) 
+            {
+                LOG_ERROR("unexpected end of input, %u list(s) are not closed", depth);
+                return NULL;
+            }
+            /* nothing to parse, the result is NIL */
+            return str;
+        }
+        else if(depth > 0 && (*str == ')' || *str == ']' || *str == '}'))
+        {
+            str ++;
+            depth --;
+            if(handler->end_list && handler->end_list(context, *str) < 0) return NULL;
+        }
+        else if(*str == '(' || *str == '[' || *str == '{')
+        {
+            str ++;
+            depth ++;
+            if(handler->begin_list && handler->begin_list(context) < 0) return NULL;
+            continue;
+        }
+        else
+        {
+            const char* value;
+            int type;
+            if(*str == '"')
+            {
+                type = SEXP_TYPE_STR;
+                str = _sexp_parse_string(str + 1, &value);
+            }
+            else if(*str == '#')
+            {
+                type = SEXP_TYPE_STR;
+                str = _sexp_parse_char(str + 1, &value);
+            }
+            else
+            {
+                type = SEXP_TYPE_LIT;
+                str = _sexpr_parse_literal(str, &value);
+            }
+            if(NULL == str) return NULL;
+            if(handler->atom && handler->atom(context, type, value, *str) < 0) return NULL;
+        }
+        /* an element is finished, if it's the top level one, we are done */
+        if(0 == depth) return str;
+    }
+}
+const char* sexp_parse_events(const char* str, const sexp_event_handler_t* handler, void* context)
+{
+    if(NULL == handler)
+    {
+        LOG_ERROR("invalid event handler");
+        return NULL;
+    }
+    return _sexp_parse_events(str, handler, context);
+}
+/* a list that is being built by the tree builder */
+typedef struct {
+    sexpression_t** tail;     /* where the next cons of the list should be placed */
+    sexp_cons_t*    current;  /* the cons holding the element we are parsing */
+} _sexp_builder_frame_t;
+/* the state of the tree builder */
+typedef struct {
+    sexp_arena_t*          arena;     /* the arena, NULL means malloc */
+    sexpression_t*         result;    /* the root of the tree */
+    _sexp_builder_frame_t* stack;     /* the stack of open lists */
+    uint32_t               depth;     /* number of open lists */
+    uint32_t               capacity;  /* the capacity of the stack */
+    _sexp_builder_frame_t  init_stack[SEXP_PARSE_STACK_INIT];  /* the initial stack, avoid malloc in most cases */
+} _sexp_builder_t;
+/* put a new element to the tree, return the slot for the element */
+static inline sexpression_t** _sexp_builder_slot(_sexp_builder_t* builder)
+{
+    if(0 == builder->depth) return &builder->result;
+    _sexp_builder_frame_t* top = builder->stack + builder->depth - 1;
+    sexpression_t* cons = _sexp_alloc(builder->arena, SEXP_TYPE_CONS);
+    if(NULL == cons) return NULL;
+    sexp_cons_t* data = (sexp_cons_t*)cons->data;
+    data->first = data->second = SEXP_NIL;
+    data->seperator = 0;
+    *top->tail = cons;
+    top->tail = &data->second;
+    top->current = data;
+    return &data->first;
+}
+static int _sexp_builder_begin_list(void* context)
+{
+    _sexp_builder_t* builder = (_sexp_builder_t*)context;
+    sexpression_t** slot = _sexp_builder_slot(builder);
+    if(NULL == slot) return -1;
+    if(builder->depth >= builder->capacity)
+    {
+        uint32_t newcap = builder->capacity * 2;
+        _sexp_builder_frame_t* newstack;
+        if(builder->stack == builder->init_stack)
+        {
+            newstack = (_sexp_builder_frame_t*)malloc(sizeof(_sexp_builder_frame_t) * newcap);
+            if(NULL != newstack) memcpy(newstack, builder->stack, sizeof(_sexp_builder_frame_t) * builder->depth);
+        }
+        else
+            newstack = (_sexp_builder_frame_t*)realloc(builder->stack, sizeof(_sexp_builder_frame_t) * newcap);
+        if(NULL == newstack)
+        {
+            LOG_ERROR("can not allocate memory for the parser stack");
+            return -1;
+        }
+        builder->stack = newstack;
+        builder->capacity = newcap;
+    }
+    builder->stack[builder->depth].tail = slot;
+    builder->stack[builder->depth].current = NULL;
+    builder->depth ++;
+    return 0;
+}
+static int _sexp_builder_end_list(void* context, char seperator)
+{
+    _sexp_builder_t* builder = (_sexp_builder_t*)context;
+    builder->depth --;
+    if(builder->depth > 0)
+        builder->stack[builder->depth - 1].current->seperator = seperator;
+    return 0;
+}
+static int _sexp_builder_atom(void* context, int type, const char* value, char seperator)
+{
+    _sexp_builder_t* builder = (_sexp_builder_t*)context;
+    sexpression_t** slot = _sexp_builder_slot(builder);
+    if(NULL == slot) return -1;
+    sexpression_t* atom = _sexp_alloc(builder->arena, type);
+    if(NULL == atom) return -1;
+    *(const char**)atom->data = value;
+    *slot = atom;
+    if(builder->depth > 0) 
+        builder->stack[builder->depth - 1].current->seperator = seperator;
+    return 0;
+}
+static const sexp_event_handler_t _sexp_builder_handler = {
+    .begin_list = _sexp_builder_begin_list,
+    .end_list   = _sexp_builder_end_list,
+    .atom       = _sexp_builder_atom
+};
+static inline const char* _sexp_parse(sexp_arena_t* arena, const char* str, sexpression_t** buf)
+{
+    _sexp_builder_t builder;
+    builder.arena = arena;
+    builder.result = SEXP_NIL;
+    builder.stack = builder.init_stack;
+    builder.depth = 0;
+    builder.capacity = SEXP_PARSE_STACK_INIT;
+    str = _sexp_parse_events(str, &_sexp_builder_handler, &builder);
+    if(builder.stack != builder.init_stack) free(builder.stack);
+    if(NULL == str)
+    {
+        /* the partial tree is always well formed, so we can free it */
+        if(NULL == arena) sexp_free(builder.result);
+        *buf = SEXP_NIL;
+        return NULL;
+    }
+    *buf = builder.result;
+    return str;
+}
+const char* sexp_parse(const char* str, sexpression_t** buf)
+{
+    return _sexp_parse(NULL, str, buf);
+}
+const char* sexp_parse_arena(sexp_arena_t* arena, const char* str, sexpression_t** buf)
+{
+    if(NULL == arena) 
     {
-        (*buf) = SEXP_NIL;
-        return str;
+        LOG_ERROR("invalid arena");
+        return NULL;
     }
-    else if(*str == '(' || *str == '[' || *str == '{') return _sexp_parse_list(str + 1, buf);
-    else if(*str == '"') return _sexp_parse_string(str + 1, buf);
-    else if(*str == '#') return _sexp_parse_char(str + 1, buf);
-    else return _sexpr_parse_literal(str, buf);
+    return _sexp_parse(arena, str, buf);
 }
 static inline int _sexp_match_one(const sexpression_t* sexpr, char tc, char sc, const void** this_arg)
 {
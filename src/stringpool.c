@@ -2,258 +2,327 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdint.h>
-#include <malloc.h>
+#include <stdlib.h>
+#include <pthread.h>
 #include <log.h>
 #include <debug.h>
 
-typedef struct _stringpool_hashnode_t{
-    uint32_t h[4];
-    char* str;
-    struct _stringpool_hashnode_t* next;
-} stringpool_hashnode_t;
-stringpool_hashnode_t **_stringpool_hash;
-size_t  _stringpool_size;
-/* compute the hash function of the string, store the output of hash functions to h */
-static inline int _stringpool_hash_func(const char* str, uint32_t* h)
-{
-	const unsigned char* data = (unsigned char*) str;
-	h[0] = STRINGPOOL_MURMUR_SEED;//Murmur3
-	h[1] = 0;					//sum
-	h[2] = STRINGPOOL_MULTIPLY_SEED;   	    //muliply
-	h[3] = 0;					//ELF Hash
-	int i = 0;
-	for(i = 0; str[i]; i ++)
-	{
-		if((i&3) == 0 && i != 0)
-		{
-			uint32_t k = *(uint32_t*)(data + i - 4);
-            k *= STRINGPOOL_MURMUR_C1;
-            k  = (k << STRINGPOOL_MURMUR_R1) | (k >> (32 - STRINGPOOL_MURMUR_R1));
-            k *= STRINGPOOL_MURMUR_C2;
+/* The pool is safe to query from many threads.
+ *
+ * A lookup never takes a lock. It loads the current table and probes it, each slot is a
+ * single pointer to a pooled string, and the length and the hash code are stored right before
+ * the string bytes, so the slot and the header are published by one atomic store.
+ *
+ * An insertion locks one of the stripes chosen by the hash code, so two threads inserting
+ * the same string are serialized and the string is pooled only once. Threads inserting
+ * different strings claim empty slots with compare-and-swap. Each stripe owns its own slab
+ * pages, so the allocation needs no other lock.
+ *
+ * Growing the table locks all stripes. The old table is kept until the pool is finalized,
+ * because lookups may still be reading it. A lookup which misses in an old table falls
+ * back to the insertion path, which checks the current table again under the lock.
+ */
+
+/* the hash table */
+typedef struct _stringpool_table_t {
+    struct _stringpool_table_t* retired;  /* the list of tables that has been replaced */
+    size_t                      capacity; /* the number of slots, always a power of 2 */
+    const char*                 slots[0]; /* the pooled strings, NULL means an empty slot */
+} stringpool_table_t;
+
+/* a page of the slab which holds the string bytes */
+typedef struct _stringpool_page_t {
+    struct _stringpool_page_t* next;   /* the next page */
+    size_t                     used;   /* how many bytes are used */
+    size_t                     size;   /* the size of the data section */
+    uint64_t                   data[0];/* the strings, each string is prefixed by its length and hash code */
+} stringpool_page_t;
+
+/* a lock stripe */
+typedef struct {
+    pthread_mutex_t     mutex;  /* the lock */
+    stringpool_page_t*  pages;  /* the slab pages owned by this stripe, the first one is the current page */
+} __attribute__((aligned(64))) stringpool_stripe_t;
 
-			h[0] ^= k;
-			h[0] *= (h[0] << STRINGPOOL_MURMUR_R2) | (h[0] >> (32 - STRINGPOOL_MURMUR_R2));
-			h[0] ^= h[0] * STRINGPOOL_MURMUR_M + STRINGPOOL_MURMUR_N;
-		}
-		h[1] = (h[1] + data[i] + (data[i]<<STRINGPOOL_SUM_R1) + (data[i]>>STRINGPOOL_SUM_R2))%STRINGPOOL_SUM_M;
-		h[2] = (h[2] + data[i] * data[i]);
-		h[3] = (h[3] << 4) + data[i];
-		uint32_t g = h[3] & STRINGPOOL_ELF_MSK;
-		if(g) h[3]^=g>>24;
-		h[3] &= ~g;
-	}
-    /* process the unprocessed input, and swap endian order */
-    uint32_t remaining = 0;
-	if(i > 0)
+static stringpool_table_t* _stringpool_table;   /* the current hash table */
+static size_t              _stringpool_count;   /* the number of strings in the pool */
+static stringpool_stripe_t _stringpool_stripes[STRINGPOOL_LOCK_STRIPES];
+
+/* the hash code of a pooled string */
+#define _STRINGPOOL_HASH(str) (((const uint64_t*)(str))[-1])
+/* the length of a pooled string */
+#define _STRINGPOOL_LEN(str) (((const uint64_t*)(str))[-2])
+
+/* multiply two 64 bit integer and fold the 128 bit result */
+static inline uint64_t _stringpool_mix(uint64_t a, uint64_t b)
+{
+#ifdef __SIZEOF_INT128__
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+#else
+    /* no 128 bit integer on 32 bit targets, compute the same product from the 32 bit halves */
+    uint64_t al = (uint32_t)a, ah = a >> 32;
+    uint64_t bl = (uint32_t)b, bh = b >> 32;
+    uint64_t ll = al * bl, lh = al * bh, hl = ah * bl, hh = ah * bh;
+    uint64_t mid = (ll >> 32) + (uint32_t)lh + (uint32_t)hl;
+    uint64_t lo = (mid << 32) | (uint32_t)ll;
+    uint64_t hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    return lo ^ hi;
+#endif
+}
+static inline uint64_t _stringpool_read64(const uint8_t* p)
+{
+    uint64_t ret;
+    memcpy(&ret, p, sizeof(ret));
+    return ret;
+}
+/* compute the hash function of the string, the string is consumed 16 bytes per round */
+static inline uint64_t _stringpool_hash_func(const char* str, size_t len)
+{
+    const uint8_t* data = (const uint8_t*)str;
+    uint64_t h = _stringpool_mix(STRINGPOOL_HASH_SEED ^ len, STRINGPOOL_HASH_P0);
+    size_t n = len;
+    for(; n > 16; n -= 16, data += 16)
+        h = _stringpool_mix(_stringpool_read64(data) ^ STRINGPOOL_HASH_P1,
+                            _stringpool_read64(data + 8) ^ h);
+    /* the last 0 to 16 bytes */
+    uint8_t tail[16] = {};
+    memcpy(tail, data, n);
+    h = _stringpool_mix(_stringpool_read64(tail) ^ STRINGPOOL_HASH_P1,
+                        _stringpool_read64(tail + 8) ^ h);
+    return _stringpool_mix(h ^ STRINGPOOL_HASH_P2, len ^ STRINGPOOL_HASH_P3);
+}
+/* allocate memory for a string from the slab of a stripe, the size includes the hash code */
+static inline uint64_t* _stringpool_alloc(stringpool_stripe_t* stripe, size_t size)
+{
+    stringpool_page_t* page = stripe->pages;
+    size = (size + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+    if(NULL == page || page->used + size > page->size)
     {
-        switch(i&3)
+        size_t pagesize = STRINGPOOL_PAGE_SIZE - sizeof(stringpool_page_t);
+        if(pagesize < size) pagesize = size;
+        page = (stringpool_page_t*)malloc(sizeof(stringpool_page_t) + pagesize);
+        if(NULL == page) return NULL;
+        page->used = 0;
+        page->size = pagesize;
+        /* a large string should not waste the current page */
+        if(NULL != stripe->pages && pagesize == size)
         {
-            /* following code assume big endian, for little endian, this is not needed */
-            case 0:
-                remaining |= data[i-4] << 24;
-            case 3:
-                remaining |= data[i-3] << 16;
-            case 2:
-                remaining |= data[i-2] << 8;
-            case 1: 
-                remaining |= data[i-1];
+            page->next = stripe->pages->next;
+            stripe->pages->next = page;
+        }
+        else
+        {
+            page->next = stripe->pages;
+            stripe->pages = page;
         }
-        remaining *= STRINGPOOL_MURMUR_C1;
-        remaining  = (remaining << STRINGPOOL_MURMUR_R1) | (remaining >> (32 - STRINGPOOL_MURMUR_R1));
-        remaining *= STRINGPOOL_MURMUR_C2; 
-        h[0] ^= remaining;
     }
-    /* we are finishing */
-    h[0] ^= i;
-    h[0] ^= h[0] >> 16;
-	h[0] *= 0x85ebca6b;
-	h[0] ^= h[0]>>13;
-	h[0] *= 0xc2b2ae35;
-	h[0] ^= h[0]>>16;
-
-    /* finally return the length */
-
-    return i;
+    uint64_t* ret = page->data + page->used / sizeof(uint64_t);
+    page->used += size;
+    return ret;
+}
+static inline stringpool_table_t* _stringpool_table_new(size_t capacity)
+{
+    stringpool_table_t* ret = (stringpool_table_t*)calloc(1, sizeof(stringpool_table_t) + sizeof(const char*) * capacity);
+    if(NULL == ret)
+    {
+        LOG_ERROR("can not allocate memory for the string pool");
+        return NULL;
+    }
+    ret->capacity = capacity;
+    return ret;
+}
+/* find a string in the table, the function is lock free */
+static inline const char* _stringpool_lookup(const stringpool_table_t* table, uint64_t h, size_t len, const char* str)
+{
+    size_t mask = table->capacity - 1;
+    size_t idx;
+    const char* cur;
+    for(idx = h & mask; NULL != (cur = __atomic_load_n(table->slots + idx, __ATOMIC_ACQUIRE)); idx = (idx + 1) & mask)
+    {
+        /* compare the lengths first, so that memcmp never reads past the end of the pooled string */
+        if(_STRINGPOOL_HASH(cur) == h &&
+           _STRINGPOOL_LEN(cur) == len &&
+           memcmp(cur, str, len) == 0)
+            return cur;
+    }
+    return NULL;
+}
+/* put a pooled string to an empty slot */
+static inline void _stringpool_place(stringpool_table_t* table, const char* str)
+{
+    size_t mask = table->capacity - 1;
+    size_t idx;
+    for(idx = _STRINGPOOL_HASH(str) & mask;; idx = (idx + 1) & mask)
+    {
+        const char* expected = NULL;
+        if(__atomic_compare_exchange_n(table->slots + idx, &expected, str, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            return;
+    }
+}
+/* double the size of the hash table, the strings are not moved, so the pooled addresses are still valid.
+ * The caller should not hold any stripe */
+static inline int _stringpool_grow(const stringpool_table_t* old)
+{
+    int i, ret = 0;
+    for(i = 0; i < STRINGPOOL_LOCK_STRIPES; i ++)
+        pthread_mutex_lock(&_stringpool_stripes[i].mutex);
+    /* someone else has grown the table */
+    if(old != _stringpool_table) goto DONE;
+    stringpool_table_t* newtable = _stringpool_table_new(old->capacity * 2);
+    if(NULL == newtable)
+    {
+        ret = -1;
+        goto DONE;
+    }
+    size_t j;
+    for(j = 0; j < old->capacity; j ++)
+        if(NULL != old->slots[j]) _stringpool_place(newtable, old->slots[j]);
+    newtable->retired = _stringpool_table;
+    __atomic_store_n(&_stringpool_table, newtable, __ATOMIC_RELEASE);
+    LOG_DEBUG("string pool is resized to %zu slots", newtable->capacity);
+DONE:
+    for(i = STRINGPOOL_LOCK_STRIPES - 1; i >= 0; i --)
+        pthread_mutex_unlock(&_stringpool_stripes[i].mutex);
+    return ret;
 }
-/* Finishing hash computation */
-static inline void _stringpool_accu_hash(stringpool_accumulator_t* acc)
+/* insert a string which is not found in the table */
+static inline const char* _stringpool_insert(uint64_t h, size_t len, const char* str)
 {
-    uint32_t remaining = 0;
-    if(acc->count > 0)
+    stringpool_stripe_t* stripe = _stringpool_stripes + (h >> 32) % STRINGPOOL_LOCK_STRIPES;
+    for(;;)
     {
-        switch(acc->count&3)
+        pthread_mutex_lock(&stripe->mutex);
+        /* the table can not be replaced when we are holding the stripe */
+        stringpool_table_t* table = _stringpool_table;
+        const char* ret = _stringpool_lookup(table, h, len, str);
+        if(NULL != ret)
+        {
+            pthread_mutex_unlock(&stripe->mutex);
+            return ret;
+        }
+        size_t count = __atomic_add_fetch(&_stringpool_count, 1, __ATOMIC_RELAXED);
+        if(count * STRINGPOOL_MAX_LOAD_DEN > table->capacity * STRINGPOOL_MAX_LOAD_NUM)
+        {
+            __atomic_sub_fetch(&_stringpool_count, 1, __ATOMIC_RELAXED);
+            pthread_mutex_unlock(&stripe->mutex);
+            if(_stringpool_grow(table) < 0) return NULL;
+            continue;
+        }
+        uint64_t* mem = _stringpool_alloc(stripe, 2 * sizeof(uint64_t) + len + 1);
+        if(NULL == mem)
         {
-            case 0:
-                remaining |= (acc->last&0x000000fful) << 24;
-            case 3:
-                remaining |= (acc->last&0x0000ff00ul) << 8;
-            case 2:
-                remaining |= (acc->last&0x00ff0000ul) >> 8;
-            case 1:
-                remaining |= (acc->last&0xff000000ul) >> 24;
+            __atomic_sub_fetch(&_stringpool_count, 1, __ATOMIC_RELAXED);
+            pthread_mutex_unlock(&stripe->mutex);
+            LOG_ERROR("can not allocate memory for string");
+            return NULL;
         }
-        remaining *= STRINGPOOL_MURMUR_C1;
-        remaining  = (remaining << STRINGPOOL_MURMUR_R1) | (remaining >> (32 - STRINGPOOL_MURMUR_R1));
-        remaining *= STRINGPOOL_MURMUR_C2;
-        acc->h[0] ^= remaining;
+        mem[0] = len;
+        mem[1] = h;
+        char* buf = (char*)(mem + 2);
+        memcpy(buf, str, len);
+        buf[len] = 0;
+        _stringpool_place(table, buf);
+        pthread_mutex_unlock(&stripe->mutex);
+        return buf;
     }
-
-    acc->h[0] ^= acc->count;
-    acc->h[0] ^= acc->h[0] >> 16;
-    acc->h[0] *= 0x85ebca6b;
-    acc->h[0] ^= acc->h[0] >> 13;
-    acc->h[0] *= 0xc2b2ae35;
-    acc->h[0] ^= acc->h[0] >> 16;
 }
-/* the implementation of query function 
- * h:   hash function array
+/* the implementation of query function
+ * h:   hash code
  * len: length of the string str
  * str: the string we are querying
  * return value: NULL for an error, otherwise, the address of the string in the pool with is same as str
  */
-static inline const char* _stringpool_query_imp(uint32_t* h, int len, const char* str) 
+static inline const char* _stringpool_query_imp(uint64_t h, size_t len, const char* str)
 {
-    int idx = h[0]%_stringpool_size;
-    stringpool_hashnode_t* ptr;
-
-    /* first look up the hash table to find if there's a matched string */
-
-    for(ptr = _stringpool_hash[idx]; NULL != ptr; ptr = ptr->next)
-    {
-        if(ptr->h[0] == h[0] &&
-           ptr->h[1] == h[1] &&
-           ptr->h[2] == h[2] &&
-           ptr->h[3] == h[3] &&
-           strncmp(ptr->str, str, len) == 0 &&
-           ptr->str[len] == 0 ) /* This is safe, because it's reachable only when str is not shorter than len */
-        {
-            //LOG_DEBUG("Find string@0x%x", ptr->str);
-            return ptr->str;
-        }
-    }
-   
-    /* we are reaching this point, means we can not find the previous address for this string */
-
-    ptr = (stringpool_hashnode_t*)malloc(sizeof(stringpool_hashnode_t));
-
-    if(NULL == ptr) goto ERR;
-
-    ptr->next = _stringpool_hash[idx];
-
-    ptr->h[0] = h[0];
-    ptr->h[1] = h[1];
-    ptr->h[2] = h[2];
-    ptr->h[3] = h[3];
-
-    ptr->str = (char*)malloc(len + 1);
-    
-    if(NULL == ptr->str) goto ERR;
-
-    strncpy(ptr->str, str, len);
-
-    ptr->str[len] = 0;
-
-    _stringpool_hash[idx] = ptr;
-
-    return ptr->str;
-
-ERR:
-    LOG_ERROR("can not find address for string");
-    if(NULL != ptr) 
-    {
-        if(NULL != ptr->str)
-            free(ptr->str);
-        free(ptr);
-    }
-    return NULL;
+    const char* ret = _stringpool_lookup(__atomic_load_n(&_stringpool_table, __ATOMIC_ACQUIRE), h, len, str);
+    if(NULL != ret) return ret;
+    return _stringpool_insert(h, len, str);
 }
 const char* stringpool_query(const char* str)
 {
     if(NULL == str) return NULL;
-
-    uint32_t h[4];
-    int len;
-    len = _stringpool_hash_func(str, h);
-    return _stringpool_query_imp(h, len, str);
+    size_t len = strlen(str);
+    return _stringpool_query_imp(_stringpool_hash_func(str, len), len, str);
 }
 
 int stringpool_init(int poolsize)
 {
-    if(_stringpool_hash != NULL)
+    if(_stringpool_table != NULL)
     {
         LOG_WARNING("string pool has been initialized already!");
         return -1;
     }
-    _stringpool_size = poolsize;
-    _stringpool_hash = (stringpool_hashnode_t**)malloc(sizeof(stringpool_hashnode_t*) * poolsize);
-    if(NULL == _stringpool_hash) return -1;
-    memset(_stringpool_hash, 0, sizeof(stringpool_hashnode_t*) * _stringpool_size);
+    size_t capacity;
+    int i;
+    for(capacity = 16; capacity < poolsize; capacity *= 2);
+    if(NULL == (_stringpool_table = _stringpool_table_new(capacity))) return -1;
+    _stringpool_count = 0;
+    for(i = 0; i < STRINGPOOL_LOCK_STRIPES; i ++)
+    {
+        pthread_mutex_init(&_stringpool_stripes[i].mutex, NULL);
+        _stringpool_stripes[i].pages = NULL;
+    }
     LOG_DEBUG("String Pool initialized");
     return 0;
 }
 void stringpool_fianlize(void)
 {
-    int i;
+    if(NULL == _stringpool_table) return;
 #if LOG_LEVEL >= 6
-    int len;
-    int maxlen = 0;
-#endif
-    for(i = 0; i < _stringpool_size; i ++)
+    size_t i, len, maxlen = 0;
+    size_t capacity = _stringpool_table->capacity;
+    for(i = 0; i < capacity; i ++)
     {
-        stringpool_hashnode_t* ptr;
-#if LOG_LEVEL >= 6
-        len = 0;
+        if(NULL == _stringpool_table->slots[i]) continue;
+        size_t home = _STRINGPOOL_HASH(_stringpool_table->slots[i]) & (capacity - 1);
+        len = ((i + capacity - home) & (capacity - 1)) + 1;
+        if(maxlen < len) maxlen = len;
+    }
+    LOG_DEBUG("String pool: %zu strings, %zu slots, max probe length = %zu", _stringpool_count, capacity, maxlen);
 #endif
-        for(ptr = _stringpool_hash[i]; ptr;)
+    int j;
+    for(j = 0; j < STRINGPOOL_LOCK_STRIPES; j ++)
+    {
+        stringpool_page_t* page;
+        for(page = _stringpool_stripes[j].pages; NULL != page;)
         {
-#if LOG_LEVEL >= 6
-            len ++;
-#endif
-            stringpool_hashnode_t* cur = ptr;
-            ptr = ptr->next;
-            if(cur->str)
-            {
-                free(cur->str);
-                free(cur);
-            }
+            stringpool_page_t* cur = page;
+            page = page->next;
+            free(cur);
         }
-#if LOG_LEVEL >= 6
-        if(maxlen < len) maxlen = len;
-#endif
+        _stringpool_stripes[j].pages = NULL;
+        pthread_mutex_destroy(&_stringpool_stripes[j].mutex);
     }
-    free(_stringpool_hash);
-    _stringpool_hash = NULL;
-#if LOG_LEVEL >= 6
-    LOG_DEBUG("String pool max chain length = %d", maxlen);
-#endif
+    stringpool_table_t* table;
+    for(table = _stringpool_table; NULL != table;)
+    {
+        stringpool_table_t* cur = table;
+        table = table->retired;
+        free(cur);
+    }
+    _stringpool_table = NULL;
+    _stringpool_count = 0;
 }
 void stringpool_accumulator_init(stringpool_accumulator_t* buf, const char* begin)
 {
     if(NULL == buf) return;
     buf->begin = begin;
     buf->count = 0;
-	buf->h[0] = STRINGPOOL_MURMUR_SEED;
-	buf->h[1] = 0;
-	buf->h[2] = STRINGPOOL_MULTIPLY_SEED; 
-	buf->h[3] = 0;
 }
 const char* stringpool_accumulator_query(stringpool_accumulator_t* acc)
 {
     if(NULL == acc) return NULL;
-    _stringpool_accu_hash(acc);
-    return _stringpool_query_imp(acc->h, acc->count, acc->begin);
+    return _stringpool_query_imp(_stringpool_hash_func(acc->begin, acc->count), acc->count, acc->begin);
 }
 
-/* only for testing purpose, finishing the computation, and return hashs */
-const uint32_t* stringpool_accumulator_hash(stringpool_accumulator_t* acc)
+/* only for testing purpose, return the hash code of the accumulated string */
+uint64_t stringpool_accumulator_hash(stringpool_accumulator_t* acc)
 {
-    _stringpool_accu_hash(acc);
-    return acc->h;
+    return _stringpool_hash_func(acc->begin, acc->count);
 }
 /* for testing, compute hash function directly */
-const uint32_t* stringpool_hash(const char* str) 
+uint64_t stringpool_hash(const char* str)
 {
-    static uint32_t h[4];
-    _stringpool_hash_func(str,h);
-    return h;
+    return _stringpool_hash_func(str, strlen(str));
 }
@@ -0,0 +1,100 @@
+#include <assert.h>
+#include <stdint.h>
+#include <adam.h>
+#include <cesk/cesk_addr_arithmetic.h>
+/* the samples of each sign, the shift distances are masked, so 32 is also a zero distance */
+static const int32_t samples[] = {INT32_MIN, -33, -32, -7, -2, -1, 0, 1, 2, 7, 31, 32, 33, INT32_MAX};
+#define NSAMPLES (sizeof(samples) / sizeof(samples[0]))
+/* the arithmetic operators are checked without overflow */
+#define SMALL(x) ((x) > -100 && (x) < 100)
+uint32_t sign(int64_t x)
+{
+	if(x < 0) return CESK_STORE_ADDR_NEG;
+	if(x > 0) return CESK_STORE_ADDR_POS;
+	return CESK_STORE_ADDR_ZERO;
+}
+uint32_t boolean(int x)
+{
+	return x ? CESK_STORE_ADDR_TRUE : CESK_STORE_ADDR_FALSE;
+}
+/* evaluate the operator on concrete values, returns 0 if the result is undefined */
+uint32_t eval(int op, int32_t a, int32_t b)
+{
+	switch(op)
+	{
+		case CESK_ADDR_ARITHMETIC_ADD: return SMALL(a) && SMALL(b) ? sign((int64_t)a + b) : 0;
+		case CESK_ADDR_ARITHMETIC_SUB: return SMALL(a) && SMALL(b) ? sign((int64_t)a - b) : 0;
+		case CESK_ADDR_ARITHMETIC_RSUB: return SMALL(a) && SMALL(b) ? sign((int64_t)b - a) : 0;
+		case CESK_ADDR_ARITHMETIC_MUL: return SMALL(a) && SMALL(b) ? sign((int64_t)a * b) : 0;
+		case CESK_ADDR_ARITHMETIC_DIV: return SMALL(a) && b ? sign(a / b) : 0;
+		case CESK_ADDR_ARITHMETIC_REM: return SMALL(a) && b ? sign(a % b) : 0;
+		case CESK_ADDR_ARITHMETIC_BITWISE_AND: return sign(a & b);
+		case CESK_ADDR_ARITHMETIC_BITWISE_OR: return sign(a | b);
+		case CESK_ADDR_ARITHMETIC_BITWISE_XOR: return sign(a ^ b);
+		case CESK_ADDR_ARITHMETIC_SHL: return sign((int32_t)((uint32_t)a << (b & 31)));
+		case CESK_ADDR_ARITHMETIC_SHR: return sign(a >> (b & 31));
+		case CESK_ADDR_ARITHMETIC_USHR: return sign((int32_t)((uint32_t)a >> (b & 31)));
+		case CESK_ADDR_ARITHMETIC_AND: return (a == 0 || a == 1) && (b == 0 || b == 1) ? boolean(a && b) : 0;
+		case CESK_ADDR_ARITHMETIC_OR: return (a == 0 || a == 1) && (b == 0 || b == 1) ? boolean(a || b) : 0;
+		case CESK_ADDR_ARITHMETIC_XOR: return (a == 0 || a == 1) && (b == 0 || b == 1) ? boolean(a != b) : 0;
+		case CESK_ADDR_ARITHMETIC_GT: return boolean(a > b);
+		case CESK_ADDR_ARITHMETIC_GE: return boolean(a >= b);
+		case CESK_ADDR_ARITHMETIC_EQ: return boolean(a == b);
+	}
+	assert(0);
+	return 0;
+}
+int main()
+{
+	adam_init();
+	int op, i, j, a, b;
+	/* the result of a set is the union of the results of the elements */
+	for(op = 0; op < CESK_ADDR_ARITHMETIC_NUM_BINOPS; op ++)
+		for(a = 0; a < 8; a ++)
+			for(b = 0; b < 8; b ++)
+			{
+				uint32_t expected = CESK_STORE_ADDR_CONST_PREFIX;
+				for(i = 1; i < 8; i <<= 1)
+					for(j = 1; j < 8; j <<= 1)
+						if((a & i) && (b & j))
+							expected |= cesk_addr_arithmetic_binop(op, CESK_STORE_ADDR_CONST_PREFIX | i, CESK_STORE_ADDR_CONST_PREFIX | j);
+				assert(expected == cesk_addr_arithmetic_binop(op, CESK_STORE_ADDR_CONST_PREFIX | a, CESK_STORE_ADDR_CONST_PREFIX | b));
+			}
+	/* the result of the concrete values is always in the abstract result */
+	for(op = 0; op < CESK_ADDR_ARITHMETIC_NUM_BINOPS; op ++)
+		for(i = 0; i < NSAMPLES; i ++)
+			for(j = 0; j < NSAMPLES; j ++)
+			{
+				uint32_t res = eval(op, samples[i], samples[j]);
+				if(0 == res) continue;
+				uint32_t abs = cesk_addr_arithmetic_binop(op, sign(samples[i]), sign(samples[j]));
+				assert(res == (abs & res));
+			}
+	for(i = 0; i < NSAMPLES; i ++)
+	{
+		int32_t x = samples[i];
+		if(SMALL(x)) assert(sign(-x) == cesk_addr_arithmetic_neg(sign(x)));
+		assert(CESK_STORE_ADDR_CONST_SUFFIX(sign(~x) & cesk_addr_arithmetic_bitwise_neg(sign(x))));
+		assert(boolean(x < 0) == cesk_addr_arithmetic_sign_bit(sign(x)));
+		assert(CESK_STORE_ADDR_CONST_SUFFIX(sign(x) & cesk_addr_arithmetic_sign_bit_to_numeric(boolean(x < 0))));
+	}
+
+	/* the operators on the sets */
+	assert(CESK_STORE_ADDR_NEG == cesk_addr_arithmetic_neg(CESK_STORE_ADDR_POS));
+	assert(CESK_STORE_ADDR_ZERO == cesk_addr_arithmetic_neg(CESK_STORE_ADDR_ZERO));
+	assert((CESK_STORE_ADDR_NEG | CESK_STORE_ADDR_ZERO) == cesk_addr_arithmetic_neg(CESK_STORE_ADDR_POS | CESK_STORE_ADDR_ZERO));
+	assert(CESK_STORE_ADDR_POS == cesk_addr_arithmetic_sub(CESK_STORE_ADDR_POS, CESK_STORE_ADDR_ZERO));
+	assert((CESK_STORE_ADDR_POS | CESK_STORE_ADDR_ZERO) == cesk_addr_arithmetic_div(CESK_STORE_ADDR_POS, CESK_STORE_ADDR_POS | CESK_STORE_ADDR_ZERO));
+	assert(CESK_STORE_ADDR_EMPTY == cesk_addr_arithmetic_div(CESK_STORE_ADDR_POS, CESK_STORE_ADDR_ZERO));
+	assert(CESK_STORE_ADDR_TRUE == cesk_addr_arithmetic_lt(CESK_STORE_ADDR_NEG, CESK_STORE_ADDR_ZERO));
+	assert(CESK_STORE_ADDR_FALSE == cesk_addr_arithmetic_le(CESK_STORE_ADDR_POS, CESK_STORE_ADDR_ZERO));
+	assert(CESK_STORE_ADDR_TRUE == cesk_addr_arithmetic_neq(CESK_STORE_ADDR_POS, CESK_STORE_ADDR_ZERO));
+	assert((CESK_STORE_ADDR_TRUE | CESK_STORE_ADDR_FALSE) == cesk_addr_arithmetic_eq(CESK_STORE_ADDR_POS, CESK_STORE_ADDR_POS));
+	assert(CESK_STORE_ADDR_FALSE == cesk_addr_arithmetic_not(CESK_STORE_ADDR_TRUE));
+	/* a non-constant address is an empty set */
+	assert(CESK_STORE_ADDR_EMPTY == cesk_addr_arithmetic_add(0x1234, CESK_STORE_ADDR_POS));
+	assert(CESK_STORE_ADDR_EMPTY == cesk_addr_arithmetic_neg(0x1234));
+
+	adam_finalize();
+	return 0;
+}
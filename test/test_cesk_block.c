@@ -10,6 +10,17 @@ void case1()
 	assert(block != NULL);
 	/* setup 'this' pointer */
 	cesk_block_t* ablock = cesk_block_graph_new(block);
+	/* the operands are pre-decoded */
+	const cesk_block_code_t* code = ablock->code;
+	assert(NULL != code);
+	assert(dalvik_instruction_get(block->begin) == code[0].inst);
+	assert(DVM_CONST == code[0].opcode);
+	assert(CESK_FRAME_GENERAL_REG(1) == code[0].args[0]);
+	assert(CESK_BLOCK_CODE_IS_CONST(code, 1) && CESK_STORE_ADDR_POS == code[0].args[1]);
+	assert(DVM_CMP == code[2].opcode);
+	assert(CESK_FRAME_GENERAL_REG(3) == code[2].args[0]);
+	assert(!CESK_BLOCK_CODE_IS_CONST(code + 2, 1) && CESK_FRAME_GENERAL_REG(1) == code[2].args[1]);
+	assert(!CESK_BLOCK_CODE_IS_CONST(code + 2, 2) && CESK_FRAME_GENERAL_REG(2) == code[2].args[2]);
 	uint32_t self = cesk_frame_store_new_object(ablock->input, dalvik_instruction_get(0), stringpool_query("testClass"));
 	assert(self != CESK_STORE_ADDR_NULL);
 	cesk_frame_register_load(ablock->input, dalvik_instruction_get(0),CESK_FRAME_GENERAL_REG(0), self); 
@@ -118,6 +129,106 @@ void case3()
 	cesk_frame_free(output);
 	cesk_block_graph_free(ablock);
 }
+/* find the block which has no successor */
+cesk_block_t* exit_block(cesk_block_t* blk, int depth)
+{
+	if(0 == blk->code_block->nbranches) return blk;
+	if(depth > 10) return NULL;
+	int i;
+	for(i = 0; i < blk->code_block->nbranches; i ++)
+	{
+		cesk_block_t* ret = NULL;
+		if(NULL != blk->fanout[i]) ret = exit_block(blk->fanout[i], depth + 1);
+		if(NULL != ret) return ret;
+	}
+	return NULL;
+}
+void case4()
+{
+	uint32_t result[10];
+	int rc;
+	/* get code blocks */
+	const dalvik_type_t  * const type[] = {NULL};
+	dalvik_block_t* block = dalvik_block_from_method(stringpool_query("testClass"), stringpool_query("case4"), type);
+	assert(block != NULL);
+	/* create a new analyzer graph */
+	cesk_block_t* ablock = cesk_block_graph_new(block);
+	assert(NULL != ablock);
+	/* run */
+	rc = cesk_block_graph_fixpoint(ablock);
+	assert(rc > 0);
+	cesk_block_t* exit = exit_block(ablock, 0);
+	assert(NULL != exit);
+	
+	/* v0 is 0 if the loop is not entered, otherwise 1 */
+	rc = cesk_frame_register_peek(exit->input, CESK_FRAME_GENERAL_REG(0), result, 10);
+	assert(rc > 0);
+	uint32_t sign = 0;
+	int i;
+	for(i = 0; i < rc; i ++) sign |= result[i];
+	assert(CESK_STORE_ADDR_CONST_CONTAIN(sign, ZERO));
+	assert(CESK_STORE_ADDR_CONST_CONTAIN(sign, POS));
+	assert(!CESK_STORE_ADDR_CONST_CONTAIN(sign, NEG));
+
+	/* v2 is the object */
+	rc = cesk_frame_register_peek(exit->input, CESK_FRAME_GENERAL_REG(2), result, 10);
+	assert(rc == 1);
+	assert(!CESK_STORE_ADDR_IS_CONST(result[0]));
+
+	/* the input is a fixpoint, so run it again will do nothing */
+	assert(cesk_block_graph_fixpoint(ablock) > 0);
+	cesk_frame_t* output = cesk_block_interpret(ablock);
+	assert(NULL != output);
+	cesk_frame_t* input = cesk_frame_fork(ablock->fanout[0]->input);
+	assert(0 == cesk_frame_merge(input, output));
+	assert(cesk_frame_equal(input, ablock->fanout[0]->input));
+	cesk_frame_free(input);
+	cesk_frame_free(output);
+
+	cesk_block_graph_free(ablock);
+}
+/* the only value in the register */
+uint32_t register_value(const cesk_frame_t* frame, int reg)
+{
+	uint32_t result[10];
+	int rc = cesk_frame_register_peek(frame, CESK_FRAME_GENERAL_REG(reg), result, 10);
+	assert(rc == 1);
+	return result[0];
+}
+void case5()
+{
+	/* get code blocks */
+	const dalvik_type_t  * const type[] = {NULL};
+	dalvik_block_t* block = dalvik_block_from_method(stringpool_query("testClass"), stringpool_query("case5"), type);
+	assert(block != NULL);
+	cesk_block_t* ablock = cesk_block_graph_new(block);
+	assert(NULL != ablock);
+	/* the destination is the first operand of an unary operator */
+	const cesk_block_code_t* code = ablock->code;
+	assert(DVM_UNOP == code[3].opcode);
+	assert(CESK_FRAME_GENERAL_REG(2) == code[3].args[0]);
+	assert(!CESK_BLOCK_CODE_IS_CONST(code + 3, 1) && CESK_FRAME_GENERAL_REG(0) == code[3].args[1]);
+	/* run */
+	cesk_frame_t* output = cesk_block_interpret(ablock);
+	assert(NULL != output);
+	/* verify the registers */
+	assert(CESK_STORE_ADDR_POS == register_value(output, 0));
+	assert(CESK_STORE_ADDR_NEG == register_value(output, 1));
+	/* neg-int */
+	assert(CESK_STORE_ADDR_NEG == register_value(output, 2));
+	assert(CESK_STORE_ADDR_POS == register_value(output, 3));
+	assert(CESK_STORE_ADDR_POS == register_value(output, 7));
+	/* not-int is the bitwise complement, ~5 = -6 and ~-5 = 4 */
+	assert(CESK_STORE_ADDR_NEG == register_value(output, 4));
+	uint32_t value = register_value(output, 5);
+	assert(CESK_STORE_ADDR_CONST_CONTAIN(value, POS));
+	assert(!CESK_STORE_ADDR_CONST_CONTAIN(value, NEG));
+	/* int-to-long keeps the sign */
+	assert(CESK_STORE_ADDR_NEG == register_value(output, 6));
+
+	cesk_frame_free(output);
+	cesk_block_graph_free(ablock);
+}
 int main()
 {
 	adam_init();
@@ -125,6 +236,8 @@ int main()
 	dalvik_loader_from_directory("test/cases/block_analyzer");
 	case1();
 	case2();
+	case4();
+	case5();
 	adam_finalize();
 	return 0;
 }
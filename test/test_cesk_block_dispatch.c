@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <assert.h>
+#include <sys/time.h>
+#include <adam.h>
+
+/* a micro benchmark for the dispatch modes of the block interpreter, interpret all blocks of the test cases */
+#define NCASES  5
+#define NROUNDS 2000
+
+cesk_block_t* graphs[NCASES];
+cesk_block_t* blocks[NCASES][DALVIK_BLOCK_MAX_KEYS];
+int nblocks[NCASES];
+
+/* collect the blocks in the graph */
+void collect(int c, cesk_block_t* block)
+{
+	int i;
+	for(i = 0; i < nblocks[c]; i ++)
+		if(blocks[c][i] == block) return;
+	blocks[c][nblocks[c] ++] = block;
+	for(i = 0; i < block->code_block->nbranches; i ++)
+		if(NULL != block->fanout[i])
+			collect(c, block->fanout[i]);
+}
+double run(const char* name, int mode, cesk_frame_t** results)
+{
+	struct timeval begin, end;
+	int round, c, i, n = 0;
+	cesk_block_set_dispatch(mode);
+	gettimeofday(&begin, NULL);
+	for(round = 0; round < NROUNDS; round ++)
+		for(c = 0; c < NCASES; c ++)
+			for(i = 0; i < nblocks[c]; i ++)
+			{
+				cesk_frame_t* frame = cesk_block_interpret(blocks[c][i]);
+				assert(NULL != frame);
+				if(0 == round) results[n ++] = frame;
+				else cesk_frame_free(frame);
+			}
+	gettimeofday(&end, NULL);
+	double t = (end.tv_sec - begin.tv_sec) + (end.tv_usec - begin.tv_usec) * 1e-6;
+	printf("%-10s: %.3fs, %.2f K blocks/s\n", name, t, (double)n * NROUNDS / t / 1e3);
+	return t;
+}
+/* the only value in the register */
+uint32_t register_value(const cesk_frame_t* frame, int reg)
+{
+	uint32_t result[10];
+	int rc = cesk_frame_register_peek(frame, CESK_FRAME_GENERAL_REG(reg), result, 10);
+	assert(rc == 1);
+	return result[0];
+}
+/* the handlers of the unary operators (see case5) produce the same values in the dispatch mode */
+void check_unop(int mode)
+{
+	cesk_block_set_dispatch(mode);
+	cesk_block_t* block = graphs[4];
+	int i, handlers = 0;
+	for(i = 0; i < block->code_block->end - block->code_block->begin; i ++)
+		if(DVM_UNOP == block->code[i].opcode)
+			handlers |= 1 << block->code[i].flags;
+	assert(handlers == ((1 << DVM_FLAG_UOP_NEG) | (1 << DVM_FLAG_UOP_NOT) | (1 << DVM_FLAG_UOP_TO)));
+	cesk_frame_t* output = cesk_block_interpret(block);
+	assert(NULL != output);
+	assert(CESK_STORE_ADDR_NEG == register_value(output, 1));
+	/* UNOP_NEG */
+	assert(CESK_STORE_ADDR_NEG == register_value(output, 2));
+	assert(CESK_STORE_ADDR_POS == register_value(output, 3));
+	/* UNOP_NOT */
+	assert(CESK_STORE_ADDR_NEG == register_value(output, 4));
+	assert(!CESK_STORE_ADDR_CONST_CONTAIN(register_value(output, 5), NEG));
+	/* UNOP_TO */
+	assert(CESK_STORE_ADDR_NEG == register_value(output, 6));
+	cesk_frame_free(output);
+}
+int main()
+{
+	static cesk_frame_t* results[2][NCASES * DALVIK_BLOCK_MAX_KEYS];
+	static const char* cases[NCASES] = {"case1", "case2", "case3", "case4", "case5"};
+	const dalvik_type_t * const type[] = {NULL};
+	int c, i, n = 0;
+	adam_init();
+	dalvik_loader_from_directory("test/cases/block_analyzer");
+	int mode = cesk_block_get_dispatch();
+	assert(CESK_BLOCK_DISPATCH_THREADED == mode || !CESK_BLOCK_THREADED_DISPATCH);
+
+	for(c = 0; c < NCASES; c ++)
+	{
+		dalvik_block_t* code = dalvik_block_from_method(stringpool_query("testClass"), stringpool_query(cases[c]), type);
+		assert(NULL != code);
+		graphs[c] = cesk_block_graph_new(code);
+		assert(NULL != graphs[c]);
+		collect(c, graphs[c]);
+		n += nblocks[c];
+	}
+	/* run the analysis, so that the input frames are not empty */
+	for(c = 0; c < NCASES; c ++)
+		assert(cesk_block_graph_fixpoint(graphs[c]) > 0);
+
+	check_unop(CESK_BLOCK_DISPATCH_SWITCH);
+	check_unop(CESK_BLOCK_DISPATCH_THREADED);
+	run("switch", CESK_BLOCK_DISPATCH_SWITCH, results[0]);
+	run("threaded", CESK_BLOCK_DISPATCH_THREADED, results[1]);
+	cesk_block_set_dispatch(mode);
+
+	/* both modes get the same result */
+	for(i = 0; i < n; i ++)
+	{
+		assert(cesk_frame_equal(results[0][i], results[1][i]));
+		assert(cesk_frame_hashcode(results[0][i]) == cesk_frame_hashcode(results[1][i]));
+		cesk_frame_free(results[0][i]);
+		cesk_frame_free(results[1][i]);
+	}
+	for(c = 0; c < NCASES; c ++)
+		cesk_block_graph_free(graphs[c]);
+	adam_finalize();
+	return 0;
+}
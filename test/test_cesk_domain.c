@@ -0,0 +1,172 @@
+#include <adam.h>
+#include <assert.h>
+static const cesk_domain_t* const domains[] = {&cesk_domain_sign, &cesk_domain_constset, &cesk_domain_interval};
+#define NDOMAINS (sizeof(domains) / sizeof(domains[0]))
+/* the samples cover the tracked constants and the values beyond them */
+static const int32_t samples[] = {-100, -40, -33, -5, -4, -3, -1, 0, 1, 2, 3, 7, 15, 16, 31, 32, 33, 40, 100};
+#define NSAMPLES (sizeof(samples) / sizeof(samples[0]))
+/* evaluate the operator on concrete values, returns 0 if the result is undefined */
+int eval(int op, int32_t a, int32_t b, int64_t* r)
+{
+	switch(op)
+	{
+		case CESK_ADDR_ARITHMETIC_ADD: *r = (int64_t)a + b; return 1;
+		case CESK_ADDR_ARITHMETIC_SUB: *r = (int64_t)a - b; return 1;
+		case CESK_ADDR_ARITHMETIC_RSUB: *r = (int64_t)b - a; return 1;
+		case CESK_ADDR_ARITHMETIC_MUL: *r = (int64_t)a * b; return 1;
+		case CESK_ADDR_ARITHMETIC_DIV: if(0 == b) return 0; *r = a / b; return 1;
+		case CESK_ADDR_ARITHMETIC_REM: if(0 == b) return 0; *r = a % b; return 1;
+		case CESK_ADDR_ARITHMETIC_BITWISE_AND: *r = a & b; return 1;
+		case CESK_ADDR_ARITHMETIC_BITWISE_OR: *r = a | b; return 1;
+		case CESK_ADDR_ARITHMETIC_BITWISE_XOR: *r = a ^ b; return 1;
+		/* the shift distances are small, so the result does not overflow */
+		case CESK_ADDR_ARITHMETIC_SHL: if(b < 0 || b > 4) return 0; *r = (int32_t)((uint32_t)a << b); return 1;
+		case CESK_ADDR_ARITHMETIC_SHR: if(b < 0 || b > 4) return 0; *r = a >> b; return 1;
+		case CESK_ADDR_ARITHMETIC_USHR: if(b < 0 || b > 4) return 0; *r = (int32_t)((uint32_t)a >> b); return 1;
+	}
+	return 0;
+}
+/* the abstract value a contains the concrete value x */
+int contains(const cesk_domain_t* d, uint32_t a, int64_t x)
+{
+	return d->join(a, d->from_int(x)) == a;
+}
+int compare(int32_t a, int32_t b)
+{
+	if(a < b) return CESK_DOMAIN_LT;
+	if(a > b) return CESK_DOMAIN_GT;
+	return CESK_DOMAIN_EQ;
+}
+void test_lattice()
+{
+	int k, op, i, j;
+	for(k = 0; k < NDOMAINS; k ++)
+	{
+		const cesk_domain_t* d = domains[k];
+		/* the signs are the same in all domains, and 0 is always ZERO */
+		assert(CESK_STORE_ADDR_ZERO == d->from_int(0));
+		assert(CESK_STORE_ADDR_NEG == cesk_domain_sign_of(d->from_int(-3)));
+		assert(CESK_STORE_ADDR_POS == cesk_domain_sign_of(d->from_int(100)));
+		for(i = 0; i < NSAMPLES; i ++)
+		{
+			uint32_t a = d->from_int(samples[i]);
+			assert(CESK_STORE_ADDR_IS_CONST(a));
+			assert(a == d->join(a, a));
+			assert(a == d->join(a, CESK_STORE_ADDR_EMPTY));
+			for(j = 0; j < NSAMPLES; j ++)
+			{
+				uint32_t b = d->from_int(samples[j]);
+				uint32_t ab = d->join(a, b);
+				assert(ab == d->join(b, a));
+				assert(contains(d, ab, samples[i]) && contains(d, ab, samples[j]));
+				assert(d->compare(a, b) & compare(samples[i], samples[j]));
+				assert(d->compare(ab, b) & compare(samples[i], samples[j]));
+				/* the result of the concrete values is always in the abstract result */
+				for(op = 0; op <= CESK_ADDR_ARITHMETIC_USHR; op ++)
+				{
+					int64_t r;
+					if(!eval(op, samples[i], samples[j], &r)) continue;
+					assert(contains(d, d->binop(op, a, b), r));
+					assert(contains(d, d->binop(op, ab, b), r));
+				}
+			}
+			assert(contains(d, d->unop(CESK_ADDR_ARITHMETIC_NEG, a), -(int64_t)samples[i]));
+			assert(contains(d, d->unop(CESK_ADDR_ARITHMETIC_BITWISE_NEG, a), ~samples[i]));
+		}
+	}
+	/* the refined domains distinguish the small constants */
+	assert(CESK_DOMAIN_GT == cesk_domain_sign.compare(cesk_domain_sign.from_int(1), cesk_domain_sign.from_int(0)));
+	assert((CESK_DOMAIN_LT | CESK_DOMAIN_EQ | CESK_DOMAIN_GT) == cesk_domain_sign.compare(cesk_domain_sign.from_int(2), cesk_domain_sign.from_int(1)));
+	assert(CESK_DOMAIN_GT == cesk_domain_constset.compare(cesk_domain_constset.from_int(2), cesk_domain_constset.from_int(1)));
+	assert(CESK_DOMAIN_GT == cesk_domain_interval.compare(cesk_domain_interval.from_int(2), cesk_domain_interval.from_int(1)));
+	assert(cesk_domain_constset.from_int(3) == cesk_domain_constset.binop(CESK_ADDR_ARITHMETIC_ADD, cesk_domain_constset.from_int(1), cesk_domain_constset.from_int(2)));
+	assert(cesk_domain_interval.from_int(3) == cesk_domain_interval.binop(CESK_ADDR_ARITHMETIC_ADD, cesk_domain_interval.from_int(1), cesk_domain_interval.from_int(2)));
+	assert(CESK_DOMAIN_IS_REFINED(cesk_domain_constset.from_int(3)));
+	assert(CESK_DOMAIN_IS_REFINED(cesk_domain_interval.from_int(3)));
+	/* the values beyond the limit are only abstracted by the sign */
+	assert(CESK_STORE_ADDR_POS == cesk_domain_constset.from_int(100));
+	assert(CESK_STORE_ADDR_POS == cesk_domain_interval.join(cesk_domain_interval.from_int(1), cesk_domain_interval.from_int(100)));
+}
+/* check if the target of branch i of the block is reached by the analysis */
+int reached(cesk_block_t* block, int i)
+{
+	uint32_t result[10];
+	assert(NULL != block->fanout[i]);
+	return 0 < cesk_frame_register_peek(block->fanout[i]->input, CESK_FRAME_GENERAL_REG(0), result, sizeof(result) / sizeof(result[0]));
+}
+cesk_block_t* run(const char* method)
+{
+	const dalvik_type_t  * const type[] = {NULL};
+	dalvik_block_t* block = dalvik_block_from_method(stringpool_query("domainTestClass"), stringpool_query(method), type);
+	assert(block != NULL);
+	cesk_block_t* graph = cesk_block_graph_new(block);
+	assert(NULL != graph);
+	assert(cesk_block_graph_fixpoint(graph) > 0);
+	return graph;
+}
+void test_prune(int domain)
+{
+	/* the branches are only pruned if it's enabled */
+	const int prune = CESK_BLOCK_PRUNE_BRANCHES;
+	const int refined = CESK_BLOCK_PRUNE_BRANCHES && CESK_DOMAIN_SIGN != domain;
+	assert(0 == cesk_domain_set(domain));
+	/* if-nez on zero is never taken */
+	cesk_block_t* graph = run("case1");
+	assert(prune != reached(graph, 0));
+	assert(reached(graph, 1));
+	cesk_block_graph_free(graph);
+	/* 2 == 1 is only decided by the refined domains */
+	graph = run("case2");
+	assert(refined != reached(graph, 0));
+	assert(reached(graph, 1));
+	cesk_block_graph_free(graph);
+	/* the loop terminates, and the counter is never negative */
+	graph = run("case3");
+	cesk_block_t* head = graph->fanout[0];
+	assert(NULL != head && NULL != head->fanout[0]);
+	uint32_t result[64];
+	int rc = cesk_frame_register_peek(head->fanout[0]->input, CESK_FRAME_GENERAL_REG(0), result, sizeof(result) / sizeof(result[0]));
+	assert(rc > 0);
+	int i;
+	for(i = 0; i < rc; i ++)
+	{
+		assert(CESK_STORE_ADDR_IS_CONST(result[i]));
+		assert(!CESK_STORE_ADDR_CONST_CONTAIN(result[i], NEG));
+	}
+	cesk_block_graph_free(graph);
+	/* the path of the concrete execution (taken, then not taken) is kept,
+	 * the default branch of an always taken branch is pruned */
+	graph = run("case4");
+	assert(reached(graph, 0));
+	assert(prune != reached(graph, 1));
+	assert(prune != reached(graph->fanout[0], 0));
+	assert(reached(graph->fanout[0], 1));
+	cesk_block_graph_free(graph);
+	/* sparse switch, the key 0 is always matched, so the key 1 and the default branch are pruned */
+	graph = run("case5");
+	assert(3 == graph->code_block->nbranches);
+	assert(reached(graph, 0));
+	assert(prune != reached(graph, 1));
+	assert(prune != reached(graph, 2));
+	cesk_block_graph_free(graph);
+	/* packed switch, the key 2 is always matched, which is only known by the refined domains */
+	graph = run("case6");
+	assert(3 == graph->code_block->nbranches);
+	assert(refined != reached(graph, 0));
+	assert(reached(graph, 1));
+	assert(refined != reached(graph, 2));
+	cesk_block_graph_free(graph);
+}
+int main()
+{
+	adam_init();
+	dalvik_loader_from_directory("test/cases/domain");
+	test_lattice();
+	assert(cesk_domain_set(CESK_DOMAIN_NUM_DOMAINS) < 0);
+	test_prune(CESK_DOMAIN_SIGN);
+	test_prune(CESK_DOMAIN_CONSTSET);
+	test_prune(CESK_DOMAIN_INTERVAL);
+	cesk_domain_set(CESK_DOMAIN_DEFAULT);
+	adam_finalize();
+	return 0;
+}
@@ -0,0 +1,117 @@
+#include <assert.h>
+#include <adam.h>
+#define NOBJECTS 20000
+const char* classpath;
+const char* field;
+const dalvik_instruction_t* inst;
+uint32_t addrs[NOBJECTS];
+/* make a new object that no one refers, each object has different parent, so they get different addresses */
+uint32_t new_object(cesk_frame_t* frame, uint32_t id)
+{
+	uint32_t addr = cesk_store_allocate(&frame->store, inst, 0x80000000u | id, 0);
+	assert(CESK_STORE_ADDR_NULL != addr);
+	cesk_value_t* val = cesk_value_from_classpath(classpath);
+	assert(NULL != val);
+	assert(0 == cesk_store_attach(frame->store, addr, val));
+	cesk_store_release_rw(frame->store, addr);
+	return addr;
+}
+/* from.value2 = {to} */
+void set_field(cesk_frame_t* frame, uint32_t from, uint32_t to)
+{
+	assert(0 == cesk_frame_register_load(frame, inst, CESK_FRAME_GENERAL_REG(1), to));
+	assert(0 == cesk_frame_store_object_put(frame, inst, from, classpath, field, CESK_FRAME_GENERAL_REG(1)));
+	assert(0 == cesk_frame_register_clear(frame, inst, CESK_FRAME_GENERAL_REG(1)));
+}
+int main()
+{
+	int i;
+	cesk_frame_gc_stat_t stat;
+	adam_init();
+	dalvik_loader_from_directory("test/cases/block_analyzer");
+	classpath = stringpool_query("testClass");
+	field = stringpool_query("value2");
+	inst = dalvik_instruction_get(0);
+	cesk_frame_gc_reset_stat();
+
+	/* a long cycle, obj[0] -> set -> obj[1] -> ... -> obj[n - 1] -> set -> obj[0] */
+	cesk_frame_t* frame = cesk_frame_new(8);
+	assert(NULL != frame);
+	for(i = 0; i < NOBJECTS; i ++)
+		addrs[i] = new_object(frame, i);
+	assert(0 == cesk_frame_register_load(frame, inst, CESK_FRAME_GENERAL_REG(0), addrs[0]));
+	for(i = 0; i < NOBJECTS; i ++)
+		set_field(frame, addrs[i], addrs[(i + 1) % NOBJECTS]);
+	assert(2 * NOBJECTS == frame->store->num_ent);
+	/* too many candidates, so this is a full collection */
+	assert(0 == cesk_frame_gc(frame));
+	cesk_frame_gc_get_stat(&stat);
+	assert(1 == stat.major && 0 == stat.minor);
+	assert(2 * NOBJECTS == stat.visited);
+	assert(0 == stat.reclaimed);
+	assert(2 * NOBJECTS == frame->store->num_ent);
+	assert(cesk_frame_hashcode(frame) == cesk_frame_compute_hashcode(frame));
+
+	/* an object that no one refers, only this object is traced */
+	uint32_t addr = new_object(frame, NOBJECTS);
+	assert(0 == cesk_frame_gc(frame));
+	cesk_frame_gc_get_stat(&stat);
+	assert(1 == stat.minor);
+	assert(2 * NOBJECTS + 1 == stat.visited);
+	assert(1 == stat.reclaimed);
+	assert(NULL == cesk_store_get_ro(frame->store, addr));
+	assert(2 * NOBJECTS == frame->store->num_ent);
+
+	/* the cycle is garbage now */
+	assert(0 == cesk_frame_register_clear(frame, inst, CESK_FRAME_GENERAL_REG(0)));
+	assert(1 == cesk_store_get_refcnt(frame->store, addrs[0]));
+	assert(0 == cesk_frame_gc(frame));
+	cesk_frame_gc_get_stat(&stat);
+	assert(2 == stat.minor && 1 == stat.major);
+	assert(2 * NOBJECTS + 1 == stat.reclaimed);
+	assert(0 == frame->store->num_ent);
+	for(i = 0; i < NOBJECTS; i ++)
+	{
+		assert(NULL == cesk_store_get_ro(frame->store, addrs[i]));
+		assert(0 == cesk_store_get_refcnt(frame->store, addrs[i]));
+	}
+	assert(cesk_frame_hashcode(frame) == cesk_frame_compute_hashcode(frame));
+	assert(stat.pause_ns > 0 && stat.max_pause_ns <= stat.pause_ns);
+	cesk_frame_free(frame);
+
+	/* a cycle referred by a register is alive */
+	frame = cesk_frame_new(8);
+	uint32_t a = new_object(frame, 0);
+	uint32_t b = new_object(frame, 1);
+	assert(0 == cesk_frame_register_load(frame, inst, CESK_FRAME_GENERAL_REG(0), a));
+	set_field(frame, a, b);
+	set_field(frame, b, a);
+	/* a register moved from another refers the object as well */
+	assert(0 == cesk_frame_register_move(frame, inst, CESK_FRAME_GENERAL_REG(2), CESK_FRAME_GENERAL_REG(0)));
+	assert(0 == cesk_frame_register_clear(frame, inst, CESK_FRAME_GENERAL_REG(0)));
+	assert(0 == cesk_frame_gc(frame));
+	assert(4 == frame->store->num_ent);
+
+	/* the fork collects its own garbage */
+	cesk_frame_t* fork = cesk_frame_fork(frame);
+	assert(NULL != fork);
+	assert(0 == cesk_frame_register_clear(fork, inst, CESK_FRAME_GENERAL_REG(2)));
+	assert(0 == cesk_frame_gc(fork));
+	assert(0 == fork->store->num_ent);
+	assert(4 == frame->store->num_ent);
+	assert(NULL != cesk_store_get_ro(frame->store, a));
+	assert(NULL != cesk_store_get_ro(frame->store, b));
+
+	/* the full collection gets the same result */
+	assert(0 == cesk_frame_gc_full(frame));
+	assert(4 == frame->store->num_ent);
+	assert(0 == cesk_frame_register_clear(frame, inst, CESK_FRAME_GENERAL_REG(2)));
+	assert(0 == cesk_frame_gc_full(frame));
+	assert(0 == frame->store->num_ent);
+	assert(cesk_frame_hashcode(frame) == cesk_frame_compute_hashcode(frame));
+
+	cesk_frame_free(fork);
+	cesk_frame_free(frame);
+	adam_finalize();
+	return 0;
+}
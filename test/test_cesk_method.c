@@ -0,0 +1,89 @@
+#include <adam.h>
+#include <assert.h>
+#define NTASKS 64
+static const char* methods[] = {"case1", "case2", "case3", "case4"};
+static const dalvik_type_t * const type[] = {NULL};
+/* the hash code of all input frames in the graph */
+hashval_t graph_hash(cesk_block_t* blk, uint8_t* visited)
+{
+	if(NULL == blk || visited[blk->code_block->index]) return 0;
+	visited[blk->code_block->index] = 1;
+	hashval_t ret = cesk_frame_hashcode(blk->input) * MH_MULTIPLY + blk->code_block->index;
+	int i;
+	for(i = 0; i < blk->code_block->nbranches; i ++)
+		ret ^= graph_hash(blk->fanout[i], visited);
+	return ret;
+}
+void setup(cesk_method_task_t* tasks)
+{
+	int i;
+	for(i = 0; i < NTASKS; i ++)
+	{
+		tasks[i].classpath = stringpool_query("testClass");
+		tasks[i].methodname = stringpool_query(methods[i % 4]);
+		tasks[i].typelist = type;
+		tasks[i].graph = NULL;
+		tasks[i].rc = -1;
+	}
+}
+void collect(cesk_method_task_t* tasks, int* rc, hashval_t* hash)
+{
+	static uint8_t visited[DALVIK_BLOCK_MAX_KEYS];
+	int i;
+	for(i = 0; i < NTASKS; i ++)
+	{
+		assert(NULL != tasks[i].graph);
+		memset(visited, 0, sizeof(visited));
+		rc[i] = tasks[i].rc;
+		hash[i] = graph_hash(tasks[i].graph, visited);
+		cesk_block_graph_free(tasks[i].graph);
+	}
+}
+int main()
+{
+	static cesk_method_task_t tasks[NTASKS];
+	int rc_serial[NTASKS], rc_parallel[NTASKS];
+	hashval_t hash_serial[NTASKS], hash_parallel[NTASKS];
+	int i;
+	adam_init();
+	dalvik_loader_from_directory("test/cases/block_analyzer");
+
+	assert(cesk_method_get_nthreads() == CESK_METHOD_NTHREADS);
+	cesk_method_set_nthreads(0);
+	assert(cesk_method_get_nthreads() == 1);
+	cesk_method_set_nthreads(100000);
+	assert(cesk_method_get_nthreads() == CESK_METHOD_MAX_THREADS);
+
+	/* serial */
+	cesk_method_set_nthreads(1);
+	setup(tasks);
+	assert(0 == cesk_method_analyze_all(tasks, NTASKS));
+	collect(tasks, rc_serial, hash_serial);
+
+	/* parallel, the result must be the same */
+	cesk_method_set_nthreads(4);
+	setup(tasks);
+	assert(0 == cesk_method_analyze_all(tasks, NTASKS));
+	collect(tasks, rc_parallel, hash_parallel);
+
+	for(i = 0; i < NTASKS; i ++)
+	{
+		assert(rc_serial[i] > 0);
+		assert(rc_serial[i] == rc_parallel[i]);
+		assert(hash_serial[i] == hash_parallel[i]);
+		/* the same method has the same result */
+		assert(rc_serial[i] == rc_serial[i % 4]);
+		assert(hash_serial[i] == hash_serial[i % 4]);
+	}
+
+	/* a method does not exist */
+	tasks[0].classpath = stringpool_query("testClass");
+	tasks[0].methodname = stringpool_query("nonexist");
+	tasks[0].typelist = type;
+	assert(1 == cesk_method_analyze_all(tasks, 1));
+	assert(tasks[0].rc < 0);
+	assert(NULL == tasks[0].graph);
+
+	adam_finalize();
+	return 0;
+}
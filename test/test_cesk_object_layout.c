@@ -0,0 +1,86 @@
+#include <assert.h>
+#include <adam.h>
+const char *base, *derived;
+/* find the instance-get/put instruction in the pool */
+const dalvik_instruction_t* find_instruction(int flags)
+{
+	size_t i;
+	for(i = 0; i < dalvik_instruction_pool_size(); i ++)
+	{
+		const dalvik_instruction_t* inst = dalvik_instruction_get(i);
+		if(DVM_INSTANCE == inst->opcode && flags == inst->flags) return inst;
+	}
+	return NULL;
+}
+int main()
+{
+	adam_init();
+	dalvik_loader_from_directory("test/cases/object_layout");
+	base = stringpool_query("baseClass");
+	derived = stringpool_query("derivedClass");
+	const char* value2 = stringpool_query("value2");
+	const char* value5 = stringpool_query("value5");
+
+	/* the layout is computed once, the static field is not a part of the object */
+	const cesk_object_layout_t* layout = cesk_object_layout(base);
+	assert(NULL != layout);
+	assert(layout == cesk_object_layout(base));
+	assert(1 == layout->depth && 3 == layout->num_fields);
+	assert(sizeof(cesk_object_t) + sizeof(cesk_object_struct_t) + 3 * sizeof(uint32_t) == layout->size);
+	const cesk_object_layout_t* dlayout = cesk_object_layout(derived);
+	assert(NULL != dlayout);
+	assert(2 == dlayout->depth && 5 == dlayout->num_fields);
+	assert(layout->size + sizeof(cesk_object_struct_t) + 2 * sizeof(uint32_t) == dlayout->size);
+	assert(NULL == cesk_object_layout(stringpool_query("java/lang/object")));
+
+	/* the new object is a copy of the prototype */
+	cesk_object_t* object = cesk_object_new(derived);
+	assert(NULL != object);
+	assert(2 == object->depth && dlayout->size == object->size);
+	assert(derived == cesk_object_classpath(object));
+	assert(cesk_object_equal(object, dlayout->prototype));
+
+	/* the field of the superclass is in the second struct */
+	cesk_object_field_ref_t ref = cesk_object_field_resolve(base, value2);
+	assert(CESK_OBJECT_FIELD_REF_NULL != ref);
+	uint32_t* paddr = cesk_object_field(object, base, ref);
+	cesk_object_struct_t* this = object->members;
+	CESK_OBJECT_STRUCT_ADVANCE(this);
+	assert(base == this->class->path);
+	assert(this->valuelist + 1 == paddr);
+	assert(paddr == cesk_object_get(object, base, value2));
+	assert(CESK_STORE_ADDR_NULL == *paddr);
+	/* the same reference works for the instance of the base class */
+	cesk_object_t* bobj = cesk_object_new(base);
+	assert(NULL != bobj);
+	assert(bobj->members[0].valuelist + 1 == cesk_object_field(bobj, base, ref));
+	/* but the field of the subclass is not in an instance of the base class */
+	cesk_object_field_ref_t ref5 = cesk_object_field_resolve(derived, value5);
+	assert(CESK_OBJECT_FIELD_REF_NULL != ref5);
+	assert(object->members[0].valuelist + 1 == cesk_object_field(object, derived, ref5));
+	assert(NULL == cesk_object_field(bobj, derived, ref5));
+	assert(NULL == cesk_object_get(bobj, derived, value5));
+	/* the static field and unknown field are not resolved */
+	assert(CESK_OBJECT_FIELD_REF_NULL == cesk_object_field_resolve(base, stringpool_query("counter")));
+	assert(CESK_OBJECT_FIELD_REF_NULL == cesk_object_field_resolve(derived, value2));
+	assert(CESK_OBJECT_FIELD_REF_NULL == cesk_object_field_resolve(stringpool_query("unknownClass"), value2));
+
+	/* the field used by an instruction is cached in the instruction */
+	const dalvik_instruction_t* iget = find_instruction(DVM_FLAG_INSTANCE_GET);
+	const dalvik_instruction_t* iput = find_instruction(DVM_FLAG_INSTANCE_PUT);
+	assert(NULL != iget && NULL != iput);
+	assert(0 == *dalvik_instruction_cache_slot(iget));
+	assert(ref == cesk_object_field_resolve_cached(iget, base, value2));
+	assert(ref == *dalvik_instruction_cache_slot(iget));
+	assert(ref == cesk_object_field_resolve_cached(iget, base, value2));
+	assert(ref5 == cesk_object_field_resolve_cached(iput, derived, value5));
+	assert(ref5 == *dalvik_instruction_cache_slot(iput));
+	/* the field does not match the instruction, it's not cached */
+	assert(ref == cesk_object_field_resolve_cached(iput, base, value2));
+	assert(ref5 == *dalvik_instruction_cache_slot(iput));
+
+	cesk_object_free(object);
+	cesk_object_free(bobj);
+	adam_finalize();
+	return 0;
+}
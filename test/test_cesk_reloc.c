@@ -0,0 +1,73 @@
+#include <assert.h>
+#include <adam.h>
+#include <cesk/cesk_store.h>
+#include <cesk/cesk_reloc.h>
+#define NOBJECTS 8
+/* the instruction that allocated the address */
+uint32_t get_idx(const cesk_store_t* store, uint32_t addr)
+{
+	return CESK_STORE_BLOCK_SLOT(cesk_store_get_block(store, addr / store->nslots), addr % store->nslots)->idx;
+}
+/* allocate an object for the instruction */
+uint32_t alloc(cesk_store_t** p_store, int i)
+{
+	uint32_t addr = cesk_store_allocate(p_store, dalvik_instruction_get(i), CESK_STORE_ADDR_NULL, 0);
+	assert(CESK_STORE_ADDR_NULL != addr);
+	cesk_value_t* val = cesk_value_from_classpath(stringpool_query("testClass"));
+	assert(NULL != val);
+	assert(0 == cesk_store_attach(*p_store, addr, val));
+	cesk_store_release_rw(*p_store, addr);
+	assert(0 < cesk_store_incref(*p_store, addr));
+	return addr;
+}
+int main()
+{
+	int i, round;
+	adam_init();
+	dalvik_loader_from_directory("test/cases/block_analyzer");
+	assert(dalvik_instruction_pool_size() >= 2 * NOBJECTS);
+	/* use small blocks, so that the objects conflict */
+	assert(0 == cesk_store_set_block_size(CESK_STORE_BLOCK_BYTES(CESK_STORE_BLOCK_MIN_SLOTS)));
+	for(round = 0; round < 2; round ++)
+	{
+		uint32_t sour_addrs[NOBJECTS];
+		cesk_store_t* dest = cesk_store_empty_store();
+		cesk_store_t* sour = cesk_store_empty_store();
+		assert(NULL != dest && NULL != sour);
+		for(i = 0; i < NOBJECTS; i ++)
+		{
+			alloc(&dest, i);
+			sour_addrs[i] = alloc(&sour, NOBJECTS + i);
+		}
+		cesk_reloc_table_t* rtab = cesk_reloc_table_from_store(&dest, sour);
+		assert(NULL != rtab);
+		int nconflicts = 0;
+		for(i = 0; i < NOBJECTS; i ++)
+		{
+			uint32_t addr = cesk_reloc_table_look_for(rtab, sour_addrs[i]);
+			assert(CESK_STORE_ADDR_NULL != addr);
+			if(addr != sour_addrs[i])
+			{
+				/* the address is relocated, because it's used by another instruction in the destination store */
+				nconflicts ++;
+				assert(NULL != cesk_store_get_ro(dest, addr));
+				assert(get_idx(dest, sour_addrs[i]) != NOBJECTS + i);
+			}
+			/* the relocated address is allocated by the same instruction */
+			if(NULL != cesk_store_get_ro(dest, addr))
+				assert(get_idx(dest, addr) == NOBJECTS + i);
+		}
+		assert(nconflicts > 0);
+		/* the constants and the unused addresses are not relocated */
+		assert(CESK_STORE_ADDR_ZERO == cesk_reloc_table_look_for(rtab, CESK_STORE_ADDR_ZERO));
+		assert(dest->nblocks * dest->nslots + 5 == cesk_reloc_table_look_for(rtab, dest->nblocks * dest->nslots + 5));
+		assert(CESK_STORE_ADDR_NULL == cesk_reloc_table_look_for(NULL, 1));
+		/* the table goes back to the pool, and it should be empty when it's reused in the next round */
+		cesk_reloc_table_free(rtab);
+		cesk_store_free(dest);
+		cesk_store_free(sour);
+	}
+	assert(0 == cesk_store_set_block_size(0));
+	adam_finalize();
+	return 0;
+}
@@ -75,7 +75,85 @@ int main()
     cesk_set_free(set2);
     cesk_set_free(set3);
 
+    /* a large set is stored in a hash table */
+    cesk_set_t* set5 = cesk_set_empty_set();
+    cesk_set_t* set6 = cesk_set_empty_set();
+    int i;
+    for(i = 0; i < 1000; i ++)
+    {
+        assert(0 == cesk_set_push(set5, i * 7 + 1));
+        assert(0 == cesk_set_push(set6, (999 - i) * 7 + 1));   /* in reversed order */
+        if(i == CESK_SET_ARRAY_MAX - 1)
+        {
+            /* this is a fork of set5, which is still an array */
+            set1 = cesk_set_fork(set5);
+        }
+    }
+    assert(0 == cesk_set_push(set5, 1));      /* duplicated */
+    assert(1000 == cesk_set_size(set5));
+    assert(CESK_SET_ARRAY_MAX == cesk_set_size(set1));
+    assert(cesk_set_compute_hashcode(set5) == cesk_set_hashcode(set5));
+    assert(cesk_set_compute_hashcode(set1) == cesk_set_hashcode(set1));
+    assert(1 == cesk_set_equal(set5, set6));
+    assert(0 == cesk_set_equal(set5, set1));
+    for(i = 0; i < 7000; i ++)
+        assert(cesk_set_contain(set5, i) == (i % 7 == 1));
+    cesk_set_iter_t iter;
+    uint32_t addr;
+    assert(NULL != cesk_set_iter(set5, &iter));
+    for(i = 0; CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(&iter)); i ++)
+        assert(addr % 7 == 1);
+    assert(1000 == i);
+
+    /* merge a small set to a large set and vice versa */
+    assert(0 == cesk_set_merge(set6, set1));
+    assert(cesk_set_equal(set5, set6));
+    assert(0 == cesk_set_merge(set1, set6));
+    assert(cesk_set_equal(set1, set5));
+    assert(cesk_set_compute_hashcode(set1) == cesk_set_hashcode(set1));
+    assert(0 == cesk_set_merge(set1, set1));
+    assert(1000 == cesk_set_size(set1));
 
+    cesk_set_free(set1);
+    cesk_set_free(set4);
+    cesk_set_free(set5);
+    cesk_set_free(set6);
+
+    /* hash-consing */
+    int enabled = cesk_set_hashcons_enabled();
+    cesk_set_hashcons_enable(1);
+    set1 = cesk_set_empty_set();
+    set2 = cesk_set_empty_set();
+    for(i = 0; i < 100; i ++)
+    {
+        assert(0 == cesk_set_push(set1, i + 1));
+        assert(0 == cesk_set_push(set2, 100 - i));
+        assert(cesk_set_equal(set1, set2) == (i == 99));
+    }
+    set3 = cesk_set_fork(set1);
+    assert(0 == cesk_set_push(set1, 1000));    /* set3 and set2 must not be changed */
+    assert(101 == cesk_set_size(set1));
+    assert(100 == cesk_set_size(set2));
+    assert(100 == cesk_set_size(set3));
+    assert(0 == cesk_set_contain(set2, 1000));
+    assert(0 == cesk_set_contain(set3, 1000));
+    assert(1 == cesk_set_equal(set2, set3));
+    assert(0 == cesk_set_equal(set1, set3));
+    assert(0 == cesk_set_merge(set2, set1));
+    assert(1 == cesk_set_equal(set1, set2));
+    assert(cesk_set_compute_hashcode(set2) == cesk_set_hashcode(set2));
+    /* the hash-consed set is equal to a set which is not hash-consed */
+    cesk_set_hashcons_enable(0);
+    set4 = cesk_set_empty_set();
+    for(i = 0; i < 100; i ++)
+        assert(0 == cesk_set_push(set4, i + 1));
+    assert(1 == cesk_set_equal(set4, set3));
+    assert(0 == cesk_set_equal(set4, set1));
+    cesk_set_free(set1);
+    cesk_set_free(set2);
+    cesk_set_free(set3);
+    cesk_set_free(set4);
+    cesk_set_hashcons_enable(enabled);
 
     adam_finalize();
     return 0;
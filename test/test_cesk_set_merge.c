@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <sys/time.h>
+#include <adam.h>
+
+/* a micro benchmark for merging sets, each join point merges a few sets into a fork of another set */
+#define NSETS    1024
+#define NJOINS   4096
+#define NSOURCES 4
+#define NROUNDS  16
+
+cesk_set_t* sets[NSETS];
+int sources[NJOINS][NSOURCES + 1];
+
+typedef cesk_set_t* (*merge_func_t)(int join);
+
+/* push the elements one by one */
+cesk_set_t* merge_push(int join)
+{
+    cesk_set_t* ret = cesk_set_fork(sets[sources[join][0]]);
+    int i;
+    for(i = 1; i <= NSOURCES; i ++)
+    {
+        cesk_set_iter_t iter;
+        uint32_t addr;
+        assert(NULL != cesk_set_iter(sets[sources[join][i]], &iter));
+        while(CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(&iter)))
+            assert(0 == cesk_set_push(ret, addr));
+    }
+    return ret;
+}
+/* merge the sets one by one */
+cesk_set_t* merge_pairwise(int join)
+{
+    cesk_set_t* ret = cesk_set_fork(sets[sources[join][0]]);
+    int i;
+    for(i = 1; i <= NSOURCES; i ++)
+        assert(0 == cesk_set_merge(ret, sets[sources[join][i]]));
+    return ret;
+}
+/* merge all sets at once */
+cesk_set_t* merge_batched(int join)
+{
+    cesk_set_t* ret = cesk_set_fork(sets[sources[join][0]]);
+    const cesk_set_t* srcs[NSOURCES];
+    int i;
+    for(i = 0; i < NSOURCES; i ++)
+        srcs[i] = sets[sources[join][i + 1]];
+    assert(0 == cesk_set_merge_n(ret, srcs, NSOURCES));
+    return ret;
+}
+double run(const char* name, merge_func_t func, cesk_set_t** results)
+{
+    struct timeval begin, end;
+    int round, i;
+    gettimeofday(&begin, NULL);
+    for(round = 0; round < NROUNDS; round ++)
+    {
+        for(i = 0; i < NJOINS; i ++)
+        {
+            cesk_set_t* set = func(i);
+            if(0 == round) results[i] = set;
+            else cesk_set_free(set);
+        }
+    }
+    gettimeofday(&end, NULL);
+    double t = (end.tv_sec - begin.tv_sec) + (end.tv_usec - begin.tv_usec) * 1e-6;
+    printf("%-10s: %.3fs, %.2f M merges/s\n", name, t, (double)NJOINS * NROUNDS * NSOURCES / t / 1e6);
+    return t;
+}
+int main()
+{
+    static cesk_set_t* results[3][NJOINS];
+    int i, j;
+    adam_init();
+    srand(12345);
+    for(i = 0; i < NSETS; i ++)
+    {
+        /* most sets are small, and a few sets are large */
+        int size = (i % 64 == 0) ? 100 : 1 + rand() % 8;
+        sets[i] = cesk_set_empty_set();
+        for(j = 0; j < size; j ++)
+            assert(0 == cesk_set_push(sets[i], 1 + rand() % 256));
+    }
+    for(i = 0; i < NJOINS; i ++)
+        for(j = 0; j <= NSOURCES; j ++)
+            sources[i][j] = rand() % NSETS;
+
+    run("push", merge_push, results[0]);
+    run("pairwise", merge_pairwise, results[1]);
+    run("batched", merge_batched, results[2]);
+
+    for(i = 0; i < NJOINS; i ++)
+    {
+        assert(cesk_set_equal(results[0][i], results[1][i]));
+        assert(cesk_set_equal(results[0][i], results[2][i]));
+        assert(cesk_set_hashcode(results[2][i]) == cesk_set_compute_hashcode(results[2][i]));
+        for(j = 0; j <= NSOURCES; j ++)
+        {
+            cesk_set_iter_t iter;
+            uint32_t addr;
+            assert(NULL != cesk_set_iter(sets[sources[i][j]], &iter));
+            while(CESK_STORE_ADDR_NULL != (addr = cesk_set_iter_next(&iter)))
+                assert(cesk_set_contain(results[2][i], addr));
+        }
+        for(j = 0; j < 3; j ++)
+            cesk_set_free(results[j][i]);
+    }
+    for(i = 0; i < NSETS; i ++)
+        cesk_set_free(sets[i]);
+    adam_finalize();
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <assert.h>
+#include <adam.h>
+#include <cesk/cesk_store.h>
+#define NOBJECTS 5000
+uint32_t addrs[NOBJECTS];
+/* allocate an address for (inst, parent, field) and put a value there */
+uint32_t alloc(cesk_store_t** p_store, int i)
+{
+	const dalvik_instruction_t* inst = dalvik_instruction_get(i % 10);
+	uint32_t addr = cesk_store_allocate(p_store, inst, i / 10, i % 7);
+	assert(CESK_STORE_ADDR_NULL != addr);
+	if(NULL == cesk_store_get_ro(*p_store, addr))
+	{
+		cesk_value_t* val = cesk_value_empty_set();
+		assert(NULL != val);
+		assert(0 == cesk_store_attach(*p_store, addr, val));
+		cesk_store_release_rw(*p_store, addr);
+		assert(0 < cesk_store_incref(*p_store, addr));
+	}
+	return addr;
+}
+int main()
+{
+	int i;
+	adam_init();
+	dalvik_loader_from_directory("test/cases/block_analyzer");
+	assert(dalvik_instruction_pool_size() >= 10);
+
+	cesk_store_t* store = cesk_store_empty_store();
+	assert(NULL != store);
+	for(i = 0; i < NOBJECTS; i ++)
+		addrs[i] = alloc(&store, i);
+	assert(NOBJECTS == store->num_ent);
+	/* the store should not be much larger than the objects */
+	assert(store->nblocks * store->nslots < 4 * NOBJECTS);
+	/* the same (instruction, parent, field) gets the same address */
+	for(i = 0; i < NOBJECTS; i ++)
+	{
+		assert(addrs[i] == alloc(&store, i));
+		assert(cesk_store_is_reuse(store, addrs[i]));
+	}
+	assert(NOBJECTS == store->num_ent);
+	/* all addresses are different */
+	for(i = 1; i < NOBJECTS; i ++)
+		assert(addrs[i] != addrs[i - 1]);
+
+	/* the fork of the store shares the index, and the allocation in the fork does not affect the original store */
+	cesk_store_t* store2 = cesk_store_fork(store);
+	assert(NULL != store2);
+	assert(addrs[123] == alloc(&store2, 123));
+	uint32_t addr = alloc(&store2, NOBJECTS);
+	assert(NULL != cesk_store_get_ro(store2, addr));
+	assert(NOBJECTS + 1 == store2->num_ent);
+	assert(NOBJECTS == store->num_ent);
+	assert(addr == alloc(&store2, NOBJECTS));
+
+	/* free an object, the address can be used by another object */
+	assert(0 == cesk_store_decref(store2, addrs[0]));
+	assert(NULL == cesk_store_get_ro(store2, addrs[0]));
+	assert(NULL != cesk_store_get_ro(store, addrs[0]));
+	assert(addrs[0] == alloc(&store, 0));
+
+	assert(cesk_store_hashcode(store) == cesk_store_compute_hashcode(store));
+	assert(cesk_store_hashcode(store2) == cesk_store_compute_hashcode(store2));
+
+	/* only the written slots are different in the blocks of two forks */
+	cesk_store_t* store3 = cesk_store_fork(store);
+	uint32_t a = addrs[10], b = addrs[20];
+	uint32_t diff[CESK_STORE_BITMAP_WORDS(store->nslots)];
+	assert(a / store->nslots == b / store->nslots);
+	const cesk_store_block_t* block = cesk_store_get_block(store, a / store->nslots);
+	assert(0 < cesk_store_incref(store3, a));
+	cesk_store_block_diff(block, cesk_store_get_block(store3, a / store->nslots), diff);
+	assert(a % store->nslots == cesk_store_bitmap_next(diff, store->nslots, 0));
+	assert(store->nslots == cesk_store_bitmap_next(diff, store->nslots, a % store->nslots + 1));
+	/* the original block is written after it's copied */
+	assert(0 < cesk_store_incref(store, b));
+	cesk_store_block_diff(cesk_store_get_block(store, b / store->nslots), cesk_store_get_block(store3, a / store->nslots), diff);
+	for(i = 0; i < store->nslots; i ++)
+		assert(((diff[i / 32] >> (i % 32)) & 1) == (i == a % store->nslots || i == b % store->nslots));
+	assert(0 < cesk_store_decref(store3, a));
+	assert(0 < cesk_store_decref(store, b));
+	assert(cesk_store_equal(store, store3));
+	cesk_store_free(store3);
+
+	cesk_store_free(store);
+	cesk_store_free(store2);
+
+	/* a merge may leave the same object in two slots, the allocator should still reuse the remaining one */
+	assert(0 == cesk_store_set_block_size(CESK_STORE_BLOCK_BYTES(16)));
+	cesk_store_t* empty = cesk_store_empty_store();
+	cesk_store_t* sa = cesk_store_fork(empty);
+	cesk_store_t* sb = cesk_store_fork(empty);
+	cesk_store_free(empty);
+	uint32_t ka = alloc(&sa, 0);
+	assert(ka < 16);
+	/* fill the first block of the other store, so that the same object is placed in another block */
+	for(i = 1; 0 == sb->nblocks || cesk_store_get_block(sb, 0)->num_ent < 16; i ++)
+		alloc(&sb, i);
+	uint32_t kb = alloc(&sb, 0);
+	assert(kb >= 16);
+	assert(0 <= cesk_store_merge(&sa, sb));
+	assert(NULL != cesk_store_get_ro(sa, ka) && NULL != cesk_store_get_ro(sa, kb));
+	assert(0 == cesk_store_decref(sa, kb));
+	assert(NULL == cesk_store_get_ro(sa, kb));
+	assert(ka == alloc(&sa, 0));
+	assert(cesk_store_is_reuse(sa, ka));
+	assert(ka == alloc(&sa, 0));
+	cesk_store_free(sa);
+	cesk_store_free(sb);
+	assert(0 == cesk_store_set_block_size(0));
+	adam_finalize();
+	return 0;
+}
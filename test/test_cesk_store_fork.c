@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <assert.h>
+#include <sys/time.h>
+#include <adam.h>
+#include <cesk/cesk_store.h>
+/* a micro benchmark for the store: fork a large store, write a few addresses in the fork and merge it back,
+ * and scan all values of the store like the GC does. The benchmark runs with different block sizes,
+ * build with -DCESK_STORE_PERSISTENT=1 or -DCESK_STORE_SLOT_SOA=1 to compare the store layouts */
+#define NOBJECTS 20000
+#define NWRITES  4
+#define NROUNDS  500
+uint32_t addrs[NOBJECTS];
+static const size_t block_sizes[] = {0x400, 0x1000, 0x4000, 0x10000};
+double now()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+/* put a new value at the address */
+void put(cesk_store_t* store, uint32_t addr, uint32_t elem)
+{
+	cesk_value_t* val = cesk_value_empty_set();
+	assert(NULL != val);
+	assert(0 == cesk_set_push(val->pointer.set, elem));
+	assert(0 == cesk_store_attach(store, addr, val));
+	cesk_store_release_rw(store, addr);
+}
+/* count the live objects in the store, like the sweep of the GC */
+uint32_t scan(const cesk_store_t* store)
+{
+	uint32_t ret = 0, i, j;
+	for(i = 0; i < store->nblocks; i ++)
+	{
+		const cesk_store_block_t* block = cesk_store_get_block(store, i);
+		for(j = 0; j < store->nslots; j ++)
+			if(NULL != CESK_STORE_BLOCK_VALUE(block, j)) ret ++;
+	}
+	return ret;
+}
+void bench(size_t block_size)
+{
+	int i, round;
+	assert(0 == cesk_store_set_block_size(block_size));
+	assert(block_size == cesk_store_get_block_size());
+	cesk_store_t* store = cesk_store_empty_store();
+	assert(NULL != store);
+	for(i = 0; i < NOBJECTS; i ++)
+	{
+		addrs[i] = cesk_store_allocate(&store, dalvik_instruction_get(i % 10), i / 10, 0);
+		assert(CESK_STORE_ADDR_NULL != addrs[i]);
+		put(store, addrs[i], CESK_STORE_ADDR_ZERO);
+		assert(0 < cesk_store_incref(store, addrs[i]));
+	}
+	hashval_t hash = cesk_store_hashcode(store);
+
+	double fork_time = 0, write_time = 0, merge_time = 0, scan_time = 0, begin;
+	for(round = 0; round < NROUNDS; round ++)
+	{
+		begin = now();
+		cesk_store_t* fork = cesk_store_fork(store);
+		assert(NULL != fork);
+		fork_time += now() - begin;
+
+		begin = now();
+		for(i = 0; i < NWRITES; i ++)
+			put(fork, addrs[(round * 7919 + i * 104729) % NOBJECTS], CESK_STORE_ADDR_POS);
+		write_time += now() - begin;
+
+		begin = now();
+		cesk_store_t* dest = cesk_store_fork(store);
+		assert(NULL != dest);
+		assert(0 <= cesk_store_merge(&dest, fork));
+		merge_time += now() - begin;
+
+		begin = now();
+		assert(NOBJECTS == scan(dest));
+		scan_time += now() - begin;
+
+		/* the original store is not affected */
+		assert(cesk_store_hashcode(fork) != hash);
+		assert(cesk_store_compute_hashcode(fork) == cesk_store_hashcode(fork));
+		cesk_store_free(fork);
+		cesk_store_free(dest);
+	}
+	assert(cesk_store_hashcode(store) == hash);
+	assert(cesk_store_compute_hashcode(store) == hash);
+	printf("%6zu bytes x %4d blocks: fork %8.3fus, write %8.3fus, merge %8.3fus, scan %8.3fus\n", 
+	       block_size, store->nblocks,
+	       fork_time / NROUNDS * 1e6, write_time / NROUNDS / NWRITES * 1e6,
+	       merge_time / NROUNDS * 1e6, scan_time / NROUNDS * 1e6);
+	cesk_store_free(store);
+}
+int main()
+{
+	int i;
+	adam_init();
+	dalvik_loader_from_directory("test/cases/block_analyzer");
+	assert(dalvik_instruction_pool_size() >= 10);
+
+	/* a block must have a few slots */
+	assert(0 > cesk_store_set_block_size(sizeof(cesk_store_block_t)));
+	assert(0 == cesk_store_set_block_size(0));
+	assert(CESK_STORE_BLOCK_SIZE == cesk_store_get_block_size());
+
+	printf("persistent = %d, soa = %d\n", CESK_STORE_PERSISTENT, CESK_STORE_SLOT_SOA);
+	for(i = 0; i < sizeof(block_sizes) / sizeof(block_sizes[0]); i ++)
+		bench(CESK_STORE_BLOCK_BYTES((block_sizes[i] - CESK_STORE_BLOCK_BYTES(0)) / (CESK_STORE_BLOCK_BYTES(1) - CESK_STORE_BLOCK_BYTES(0))));
+
+	/* the stores with different block size can not be merged */
+	cesk_store_t* a = cesk_store_empty_store();
+	assert(0 == cesk_store_set_block_size(0x400));
+	cesk_store_t* b = cesk_store_empty_store();
+	assert(a->nslots != b->nslots);
+	assert(0 > cesk_store_merge(&a, b));
+	cesk_store_free(a);
+	cesk_store_free(b);
+	assert(0 == cesk_store_set_block_size(0));
+
+	adam_finalize();
+	return 0;
+}
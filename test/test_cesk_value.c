@@ -0,0 +1,92 @@
+#include <assert.h>
+#include <pthread.h>
+#include <adam.h>
+#define NVALUES 1000
+#define NTHREADS 4
+/* the free values after the objects are freed, including the unused values in the slabs of the threads */
+#define NREUSE (NTHREADS * NVALUES + NTHREADS * CESK_VALUE_SLAB_SIZE)
+cesk_value_t* values[NTHREADS][NVALUES];
+/* allocate values, the main thread frees them */
+void* alloc_worker(void* data)
+{
+	cesk_value_t** buf = (cesk_value_t**)data;
+	int i;
+	for(i = 0; i < NVALUES; i ++)
+	{
+		buf[i] = cesk_value_empty_set();
+		assert(NULL != buf[i]);
+		cesk_value_incref(buf[i]);
+	}
+	return NULL;
+}
+/* free the values allocated by the main thread, and exit */
+void* free_worker(void* data)
+{
+	cesk_value_t** buf = (cesk_value_t**)data;
+	int i;
+	for(i = 0; i < NVALUES; i ++)
+		cesk_value_decref(buf[i]);
+	return NULL;
+}
+/* check if the value has been allocated before */
+int is_old(const cesk_value_t* val)
+{
+	int i, j;
+	for(i = 0; i < NTHREADS; i ++)
+		for(j = 0; j < NVALUES; j ++)
+			if(values[i][j] == val) return 1;
+	return 0;
+}
+int main()
+{
+	pthread_t threads[NTHREADS];
+	int i, j;
+	adam_init();
+	dalvik_loader_from_directory("test/cases/block_analyzer");
+
+	/* values allocated by other threads, freed by this thread */
+	for(i = 0; i < NTHREADS; i ++)
+		assert(0 == pthread_create(threads + i, NULL, alloc_worker, values[i]));
+	for(i = 0; i < NTHREADS; i ++)
+		assert(0 == pthread_join(threads[i], NULL));
+	for(i = 0; i < NTHREADS; i ++)
+		for(j = 0; j < NVALUES; j ++)
+		{
+			assert(CESK_TYPE_SET == values[i][j]->type);
+			assert(0 == cesk_set_size(values[i][j]->pointer.set));
+			cesk_value_decref(values[i][j]);
+		}
+	/* the freed values are reused by this thread */
+	for(i = 0; i < NVALUES; i ++)
+	{
+		cesk_value_t* val = cesk_value_from_classpath(stringpool_query("testClass"));
+		assert(NULL != val);
+		assert(CESK_TYPE_OBJECT == val->type);
+		assert(is_old(val));
+		values[0][i] = val;
+		cesk_value_incref(val);
+	}
+	/* the values freed by an exited thread are reused as well */
+	assert(0 == pthread_create(threads, NULL, free_worker, values[0]));
+	assert(0 == pthread_join(threads[0], NULL));
+	static cesk_value_t* reused[NREUSE];
+	cesk_value_t* val = NULL;
+	for(i = 0; i < NREUSE; i ++)
+	{
+		reused[i] = val = cesk_value_empty_set();
+		assert(NULL != val);
+		cesk_value_incref(val);
+	}
+	for(i = 0; i < NVALUES; i ++)
+	{
+		for(j = 0; j < NREUSE && reused[j] != values[0][i]; j ++);
+		assert(j < NREUSE);
+	}
+	/* a fork is a different value */
+	cesk_value_t* fork = cesk_value_fork(val);
+	assert(NULL != fork && fork != val);
+	assert(cesk_value_equal(fork, val));
+	/* the values alive are released by finalize */
+	adam_finalize();
+	return 0;
+}
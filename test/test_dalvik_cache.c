@@ -0,0 +1,85 @@
+#include <adam.h>
+#include <dalvik/dalvik_loader.h>
+#include <dalvik/dalvik_cache.h>
+#include <assert.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#define CACHE_FILE "test_dalvik_cache.bin"
+char* dump[4096];
+size_t ninsts;
+int nlabels;
+/* dump all instructions to strings */
+void save_dump()
+{
+    char buf[1024];
+    size_t i;
+    ninsts = dalvik_instruction_pool_size();
+    nlabels = dalvik_label_get_count();
+    assert(ninsts < 4096);
+    for(i = 0; i < ninsts; i ++)
+        dump[i] = strdup(dalvik_instruction_to_string(dalvik_instruction_get(i), buf, sizeof(buf)));
+}
+/* check the program is same as the dump */
+void check_dump()
+{
+    char buf[1024];
+    size_t i;
+    assert(ninsts == dalvik_instruction_pool_size());
+    assert(nlabels == dalvik_label_get_count());
+    for(i = 0; i < ninsts; i ++)
+    {
+        assert(0 == strcmp(dump[i], dalvik_instruction_to_string(dalvik_instruction_get(i), buf, sizeof(buf))));
+        assert(dalvik_instruction_get(i)->next == DALVIK_INSTRUCTION_INVALID || dalvik_instruction_get(i)->next < ninsts);
+    }
+    const dalvik_type_t* args[] = {NULL};
+    dalvik_class_t* class = dalvik_memberdict_get_class(stringpool_query("testClass"));
+    assert(NULL != class);
+    assert(class->super == stringpool_query("java/lang/object"));
+    dalvik_method_t* method = dalvik_memberdict_get_method(stringpool_query("testClass"), stringpool_query("case1"), args);
+    assert(NULL != method);
+    assert(method->num_regs == 20);
+    assert(method->entry < ninsts);
+    dalvik_field_t* field = dalvik_memberdict_get_field(stringpool_query("testClass"), stringpool_query("value2"));
+    assert(NULL != field);
+    assert(field->type->typecode == DALVIK_TYPECODE_OBJECT);
+    assert(field->type->data.object.path == stringpool_query("testClass"));
+}
+int main()
+{
+    unlink(CACHE_FILE);
+    adam_init();
+    /* nothing to load, so the cache is created */
+    assert(0 == dalvik_loader_from_directory_cached("test/cases", CACHE_FILE));
+    assert(0 == access(CACHE_FILE, R_OK));
+    save_dump();
+    assert(0 == dalvik_cache_save(CACHE_FILE, 1234));
+    /* the cache can not be loaded, because we have a program already */
+    assert(0 < dalvik_cache_load(CACHE_FILE, 1234));
+    adam_finalize();
+
+    adam_init();
+    assert(0 < dalvik_cache_load("test/nonexist", 1234));
+    /* stale cache */
+    assert(0 < dalvik_cache_load(CACHE_FILE, 4321));
+    assert(0 == dalvik_cache_load(CACHE_FILE, 1234));
+    check_dump();
+    adam_finalize();
+
+    /* the key of the cache does not match the files, so the files are loaded and the cache is updated */
+    adam_init();
+    assert(0 == dalvik_loader_from_directory_cached("test/cases", CACHE_FILE));
+    check_dump();
+    adam_finalize();
+
+    /* now the program is loaded from the cache */
+    adam_init();
+    assert(0 == dalvik_loader_from_directory_cached("test/cases", CACHE_FILE));
+    check_dump();
+    adam_finalize();
+
+    unlink(CACHE_FILE);
+    size_t i;
+    for(i = 0; i < ninsts; i ++) free(dump[i]);
+    return 0;
+}
@@ -5,6 +5,14 @@
 int main()
 {
     adam_init();
+    /* load with worker threads */
+    dalvik_loader_set_nthreads(4);
+    assert(4 == dalvik_loader_get_nthreads());
+    assert(0 == dalvik_loader_from_directory("test/cases"));
+    assert(NULL != dalvik_memberdict_get_class(stringpool_query("testClass")));
+    assert(0 > dalvik_loader_from_directory("test/nonexist"));
+    dalvik_loader_set_nthreads(1);
+
     assert(0 == dalvik_loader_from_directory("test/data"));
     dalvik_loader_summary();
     adam_finalize();
@@ -0,0 +1,65 @@
+#include <adam.h>
+#include <dalvik/dalvik_loader.h>
+#include <assert.h>
+
+char* dump[4096];
+size_t ninsts;
+int nlabels;
+/* load the test cases with the given number of threads */
+void load(int nthreads)
+{
+    adam_init();
+    dalvik_loader_set_nthreads(nthreads);
+    assert(nthreads == dalvik_loader_get_nthreads());
+    assert(0 == dalvik_loader_from_directory("test/cases"));
+}
+/* dump all instructions to strings */
+void save_dump()
+{
+    char buf[1024];
+    size_t i;
+    ninsts = dalvik_instruction_pool_size();
+    nlabels = dalvik_label_get_count();
+    assert(ninsts > 0 && ninsts < 4096);
+    for(i = 0; i < ninsts; i ++)
+        dump[i] = strdup(dalvik_instruction_to_string(dalvik_instruction_get(i), buf, sizeof(buf)));
+}
+/* check the program is the same as the one loaded serially */
+void check_dump()
+{
+    char buf[1024];
+    size_t i;
+    assert(ninsts == dalvik_instruction_pool_size());
+    assert(nlabels == dalvik_label_get_count());
+    for(i = 0; i < ninsts; i ++)
+    {
+        assert(0 == strcmp(dump[i], dalvik_instruction_to_string(dalvik_instruction_get(i), buf, sizeof(buf))));
+        assert(dalvik_instruction_get(i)->next == DALVIK_INSTRUCTION_INVALID || dalvik_instruction_get(i)->next < ninsts);
+    }
+    const dalvik_type_t* args[] = {NULL};
+    assert(NULL != dalvik_memberdict_get_class(stringpool_query("testClass")));
+    assert(NULL != dalvik_memberdict_get_class(stringpool_query("domainTestClass")));
+    dalvik_method_t* method = dalvik_memberdict_get_method(stringpool_query("testClass"), stringpool_query("case1"), args);
+    assert(NULL != method);
+    assert(method->entry < ninsts);
+}
+int main()
+{
+    /* the serial loader is the reference */
+    load(1);
+    save_dump();
+    adam_finalize();
+    /* the parallel loader must build exactly the same program */
+    int nthreads[] = {2, 4, DALVIK_LOADER_MAX_THREADS};
+    int i;
+    for(i = 0; i < sizeof(nthreads) / sizeof(nthreads[0]); i ++)
+    {
+        load(nthreads[i]);
+        check_dump();
+        adam_finalize();
+    }
+    dalvik_loader_set_nthreads(1);
+    size_t j;
+    for(j = 0; j < ninsts; j ++) free(dump[j]);
+    return 0;
+}
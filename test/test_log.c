@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <adam.h>
+#define NTHREADS 4
+#define NLOGS    (LOG_RING_SIZE + 100)
+int count = 0;
+/* keep the workers alive until their ring buffers are checked */
+pthread_barrier_t barrier;
+/* count how many times the argument is evaluated */
+int eval()
+{
+	return ++ count;
+}
+/* count the lines in the dump of the ring buffers */
+int dump_lines(const char* pattern)
+{
+	FILE* fp = tmpfile();
+	assert(NULL != fp);
+	int n = log_ring_dump(fp);
+	char buf[LOG_RING_RECORD_SIZE + 1];
+	int lines = 0, matches = 0;
+	rewind(fp);
+	while(NULL != fgets(buf, sizeof(buf), fp))
+	{
+		lines ++;
+		if(NULL != strstr(buf, pattern)) matches ++;
+	}
+	fclose(fp);
+	assert(n == lines);
+	return matches;
+}
+void* worker(void* data)
+{
+	int i;
+	for(i = 0; i < NLOGS; i ++)
+		LOG_DEBUG("worker %d log %d", (int)(uintptr_t)data, i);
+	pthread_barrier_wait(&barrier);
+	pthread_barrier_wait(&barrier);
+	return NULL;
+}
+/* flush the ring of the thread while other threads are writing */
+void* flusher(void* data)
+{
+	int i;
+	for(i = 0; i < NLOGS; i ++)
+	{
+		LOG_DEBUG("flusher %d log %d", (int)(uintptr_t)data, i);
+		if(i % 100 == 0) log_flush();
+	}
+	log_flush();
+	return NULL;
+}
+int main()
+{
+	int i;
+	adam_init();
+	log_set_backend(LOG_BACKEND_RING);
+	log_set_level(NULL, DEBUG);
+
+	/* the enabled log is written to the ring buffer */
+	LOG_DEBUG("first log %d", eval());
+	assert(1 == count);
+	assert(1 == dump_lines("first log 1"));
+
+	/* the arguments of a disabled log are not evaluated */
+	assert(0 == log_set_level("test_log", WARNING));
+	LOG_DEBUG("disabled log %d", eval());
+	LOG_INFO("disabled log %d", eval());
+	assert(1 == count);
+	assert(0 == dump_lines("disabled log"));
+	LOG_WARNING("enabled warning %d", eval());
+	assert(2 == count);
+	assert(1 == dump_lines("enabled warning 2"));
+
+	/* the longest prefix wins */
+	assert(0 == log_set_level("test", -1));
+	LOG_WARNING("prefix %d", eval());
+	assert(3 == count);
+	assert(0 == log_set_level("test_log", -1));
+	LOG_FATAL("prefix %d", eval());
+	assert(3 == count);
+	assert(0 == log_set_level("test_log", DEBUG));
+
+	/* each thread has its own ring buffer, and keeps the latest logs */
+	pthread_t threads[NTHREADS];
+	assert(0 == pthread_barrier_init(&barrier, NULL, NTHREADS + 1));
+	for(i = 0; i < NTHREADS; i ++)
+		assert(0 == pthread_create(threads + i, NULL, worker, (void*)(uintptr_t)i));
+	pthread_barrier_wait(&barrier);
+	assert(NTHREADS * LOG_RING_SIZE == dump_lines("worker"));
+	assert(0 == dump_lines("worker 0 log 99\n"));
+	assert(1 == dump_lines("worker 0 log 100\n"));
+
+	/* only the buffer of the calling thread is cleared after flush */
+	LOG_DEBUG("main log");
+	log_flush();
+	assert(0 == dump_lines("main log"));
+	assert(NTHREADS * LOG_RING_SIZE == dump_lines("worker"));
+
+	/* the buffer of a thread is flushed and released when the thread exits */
+	pthread_barrier_wait(&barrier);
+	for(i = 0; i < NTHREADS; i ++)
+		assert(0 == pthread_join(threads[i], NULL));
+	assert(0 == dump_lines("worker"));
+	pthread_barrier_destroy(&barrier);
+	for(i = 0; i < NTHREADS; i ++)
+		assert(0 == pthread_create(threads + i, NULL, flusher, (void*)(uintptr_t)i));
+	for(i = 0; i < NTHREADS; i ++)
+		assert(0 == pthread_join(threads[i], NULL));
+	assert(0 == dump_lines("flusher"));
+
+	log_set_backend(LOG_BACKEND_FILE);
+	adam_finalize();
+	return 0;
+}
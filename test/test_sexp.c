@@ -4,6 +4,16 @@
 #include <stringpool.h>
 #include <string.h>
 #include <adam.h>
+#define NDEEP 1000000
+static int nbegin, nend, natom;
+static int on_begin(void* ctx) { nbegin ++; return 0; }
+static int on_end(void* ctx, char sep) { nend ++; return 0; }
+static int on_atom(void* ctx, int type, const char* value, char sep) 
+{
+    if(natom == 0) assert(value == DALVIK_TOKEN_MOVE);
+    natom ++; 
+    return 0; 
+}
 int main()
 {
     adam_init();
@@ -54,6 +64,55 @@ int main()
     assert(0 == strcmp("", sexp_parse("(java/utils/xxxxx)", &exp)));
     assert(0 == strcmp("java/utils/xxxxx",sexp_get_object_path(exp, NULL)));
     sexp_free(exp);
+
+    // Arena test
+    sexp_arena_t* arena = sexp_arena_new();
+    assert(NULL != arena);
+    for(i = 0; i < 10000; i ++)
+    {
+        assert(0 == strcmp(" remaining", sexp_parse_arena(arena, "(move/from16 v123,v456) remaining", &exp)));
+        assert(1 == sexp_match(exp, "(L=L?L?L?", DALVIK_TOKEN_MOVE, &a, &b, &c));
+        assert(a == DALVIK_TOKEN_FROM16);
+        assert(0 == strcmp(c, "v456"));
+        if(i % 1000 == 999) sexp_arena_reset(arena);
+    }
+    assert(NULL == sexp_parse_arena(arena, "(move \"unterminated)", &exp));
+
+    // Event API test
+    const sexp_event_handler_t handler = {on_begin, on_end, on_atom};
+    assert(0 == strcmp(" tail", sexp_parse_events("(move (a [b] \"c\") #d) tail", &handler, NULL)));
+    assert(nbegin == 3 && nend == 3 && natom == 5);
+    assert(NULL == sexp_parse_events("(move (a b)", &handler, NULL));
+
+    // Deep and long S-Expressions do not use the C stack
+    static char deep[200001];
+    for(i = 0; i < 100000; i ++) deep[i] = '(', deep[200000 - i - 1] = ')';
+    deep[200000] = 0;
+    sexp_arena_reset(arena);
+    assert(0 == strcmp("", sexp_parse_arena(arena, deep, &exp)));
+    static char longlist[300003];
+    longlist[0] = '(';
+    for(i = 0; i < 100000; i ++) memcpy(longlist + 1 + 3 * i, "ab ", 3);
+    longlist[300001] = ')';
+    assert(0 == strcmp("", sexp_parse(longlist, &exp)));
+    assert(100000 == sexp_length(exp));
+    sexp_free(exp);
+    // Deep S-Expressions without arena are freed without the C stack, (((x) x) x)
+    static char deeplist[4 * NDEEP + 2];
+    char* p = deeplist;
+    for(i = 0; i < NDEEP; i ++) *(p ++) = '(';
+    *(p ++) = 'x';
+    for(i = 1; i < NDEEP; i ++) memcpy(p, ") x", 3), p += 3;
+    *(p ++) = ')';
+    *p = 0;
+    assert(0 == strcmp("", sexp_parse(deeplist, &exp)));
+    assert(2 == sexp_length(exp));
+    sexp_free(exp);
+    for(i = 0; i < NDEEP; i ++) deeplist[i] = '(', deeplist[2 * NDEEP - i - 1] = ')';
+    deeplist[2 * NDEEP] = 0;
+    assert(0 == strcmp("", sexp_parse(deeplist, &exp)));
+    sexp_free(exp);
+    sexp_arena_free(arena);
 	adam_finalize();
     return 0;
 }
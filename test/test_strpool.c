@@ -4,8 +4,8 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <adam.h>
-const int* stringpool_accumulator_hash(stringpool_accumulator_t* acc);
-const int* stringpool_hash(const char* str);
+uint64_t stringpool_accumulator_hash(stringpool_accumulator_t* acc);
+uint64_t stringpool_hash(const char* str);
 
 int main(int argc, char** argv) 
 {
@@ -38,14 +38,7 @@ int main(int argc, char** argv)
         stringpool_accumulator_init(&accumulator, buf);
         for(j = 0; j < len; j ++)
             stringpool_accumulator_next(&accumulator, buf[j]);
-        const int* h1;
-        const int* h2;
-        h1 = stringpool_accumulator_hash(&accumulator);
-        h2 = stringpool_hash(buf);
-        for(j = 0; j < 4; j ++)
-        {
-            assert(h1[j] == h2[j]);
-        }
+        assert(stringpool_accumulator_hash(&accumulator) == stringpool_hash(buf));
         stringpool_accumulator_init(&accumulator, buf);
         for(j = 0; j < len; j ++)
             stringpool_accumulator_next(&accumulator, buf[j]);
@@ -54,6 +47,36 @@ int main(int argc, char** argv)
     p = stringpool_query(first);
     assert(p != first);
     assert(strcmp(p, first) == 0);
+    puts("Tring growing the pool");
+    const char* pooled[100000];
+    for(i = 0; i < 100000; i ++)
+    {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "grow%d", i);
+        pooled[i] = stringpool_query(buf);
+        assert(NULL != pooled[i]);
+        assert(strcmp(pooled[i], buf) == 0);
+    }
+    /* the addresses should not be changed after the table is resized */
+    for(i = 0; i < 100000; i ++)
+    {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "grow%d", i);
+        assert(stringpool_query(buf) == pooled[i]);
+    }
+    assert(stringpool_query("teststring") == q);
+    /* a string which is larger than a slab page */
+    char* large = (char*)malloc(STRINGPOOL_PAGE_SIZE * 2);
+    memset(large, 'x', STRINGPOOL_PAGE_SIZE * 2 - 1);
+    large[STRINGPOOL_PAGE_SIZE * 2 - 1] = 0;
+    p = stringpool_query(large);
+    assert(p != large && strcmp(p, large) == 0);
+    large[STRINGPOOL_PAGE_SIZE] = 0;
+    assert(stringpool_query(large) != p);
+    large[STRINGPOOL_PAGE_SIZE] = 'x';
+    assert(stringpool_query(large) == p);
+    free(large);
+    assert(stringpool_query("") == stringpool_query(""));
 	adam_finalize();
     return 0;
 }
@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stringpool.h>
+#include <string.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <adam.h>
+
+/* a contention benchmark for the string pool, all threads query the same group of strings */
+#define NSTRINGS 50000
+#define NROUNDS  8
+#define MAX_THREADS 8
+
+char* strings[NSTRINGS];
+const char* results[MAX_THREADS][NSTRINGS];
+
+typedef struct {
+    int tid;
+    int nthreads;
+} task_t;
+
+void* worker(void* data)
+{
+    task_t* task = (task_t*)data;
+    int round, i;
+    for(round = 0; round < NROUNDS; round ++)
+    {
+        /* each thread starts from a different position, so the threads are inserting different strings at first */
+        int begin = (NSTRINGS / task->nthreads) * task->tid;
+        for(i = 0; i < NSTRINGS; i ++)
+        {
+            int idx = (begin + i) % NSTRINGS;
+            const char* ret = stringpool_query(strings[idx]);
+            assert(NULL != ret);
+            if(0 == round) results[task->tid][idx] = ret;
+            else assert(results[task->tid][idx] == ret);
+        }
+        /* the accumulator interface */
+        for(i = 0; i < NSTRINGS; i += 7)
+        {
+            stringpool_accumulator_t acc;
+            const char* p;
+            stringpool_accumulator_init(&acc, strings[i]);
+            for(p = strings[i]; *p; p ++)
+                stringpool_accumulator_next(&acc, *p);
+            assert(stringpool_accumulator_query(&acc) == results[task->tid][i]);
+        }
+    }
+    return NULL;
+}
+double run(int nthreads)
+{
+    pthread_t threads[MAX_THREADS];
+    task_t tasks[MAX_THREADS];
+    struct timeval begin, end;
+    int i, j;
+    adam_init();
+    gettimeofday(&begin, NULL);
+    for(i = 0; i < nthreads; i ++)
+    {
+        tasks[i].tid = i;
+        tasks[i].nthreads = nthreads;
+        assert(0 == pthread_create(threads + i, NULL, worker, tasks + i));
+    }
+    for(i = 0; i < nthreads; i ++)
+        pthread_join(threads[i], NULL);
+    gettimeofday(&end, NULL);
+    /* all threads should get the same address */
+    for(i = 1; i < nthreads; i ++)
+        for(j = 0; j < NSTRINGS; j ++)
+            assert(results[i][j] == results[0][j]);
+    for(j = 0; j < NSTRINGS; j ++)
+    {
+        assert(strcmp(results[0][j], strings[j]) == 0);
+        assert(stringpool_query(strings[j]) == results[0][j]);
+    }
+    adam_finalize();
+    return (end.tv_sec - begin.tv_sec) + (end.tv_usec - begin.tv_usec) * 1e-6;
+}
+int main()
+{
+    int i, nthreads;
+    for(i = 0; i < NSTRINGS; i ++)
+    {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "Ljava/lang/Class%d;->method%d", i, i * 31);
+        strings[i] = strdup(buf);
+    }
+    for(nthreads = 1; nthreads <= MAX_THREADS; nthreads *= 2)
+    {
+        double t = run(nthreads);
+        printf("%d threads: %.3fs, %.2f M queries/s\n", nthreads, t, 
+               nthreads * (double)NSTRINGS * NROUNDS * 8 / 7 / t / 1e6);
+    }
+    for(i = 0; i < NSTRINGS; i ++) free(strings[i]);
+    return 0;
+}